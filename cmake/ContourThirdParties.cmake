@@ -107,7 +107,7 @@ else()
     HandleThirdparty(libunicode "gh:contour-terminal/libunicode#v${LIBUNICODE_MINIMAL_VERSION}")
 endif()
 
-if(LIBTERMINAL_BUILD_BENCH_HEADLESS)
+if(LIBTERMINAL_BUILD_BENCH_HEADLESS OR VTRASTERIZER_BUILD_BENCH_RENDER)
     ContourThirdParties_Embed_termbench_pro()
     if (TARGET termbench)
         set(THIRDPARTY_BUILTIN_termbench "embedded")
@@ -116,7 +116,7 @@ if(LIBTERMINAL_BUILD_BENCH_HEADLESS)
         set(THIRDPARTY_BUILTIN_termbench "system package")
     endif()
 else()
-    set(THIRDPARTY_BUILTIN_termbench "(bench-headless disabled)")
+    set(THIRDPARTY_BUILTIN_termbench "(bench-headless and bench-render disabled)")
 endif()
 
 if(COMMAND ContourThirdParties_Embed_boxed_cpp)
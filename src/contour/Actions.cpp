@@ -28,11 +28,13 @@ optional<Action> fromString(string const& name)
     // NB: If we change that variable declaration to `static`,
     // then MSVC will not finish compiling. Yes. That's not a joke.
     auto const mappings = array {
+        mapAction<actions::CancelPaste>("CancelPaste"),
         mapAction<actions::CancelSelection>("CancelSelection"),
         mapAction<actions::ChangeProfile>("ChangeProfile"),
         mapAction<actions::ClearHistoryAndReset>("ClearHistoryAndReset"),
         mapAction<actions::CopyPreviousMarkRange>("CopyPreviousMarkRange"),
         mapAction<actions::CopySelection>("CopySelection"),
+        mapAction<actions::CopySelectionToFile>("CopySelectionToFile"),
         mapAction<actions::CreateDebugDump>("CreateDebugDump"),
         mapAction<actions::CreateSelection>("CreateSelection"),
         mapAction<actions::DecreaseFontSize>("DecreaseFontSize"),
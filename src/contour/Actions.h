@@ -29,11 +29,13 @@ enum class CopyFormat : uint8_t
 };
 
 // clang-format off
+struct CancelPaste{};
 struct CancelSelection{};
 struct ChangeProfile{ std::string name; };
 struct ClearHistoryAndReset{};
 struct CopyPreviousMarkRange{};
 struct CopySelection{ CopyFormat format = CopyFormat::Text; };
+struct CopySelectionToFile{ std::string path; };
 struct CreateDebugDump{};
 struct CreateSelection{ std::string delimiters; };
 struct DecreaseFontSize{};
@@ -84,11 +86,13 @@ struct WriteScreen{ std::string chars; }; // "\033[2J\033[3J"
 // OpenTab
 // clang-format on
 
-using Action = std::variant<CancelSelection,
+using Action = std::variant<CancelPaste,
+                            CancelSelection,
                             ChangeProfile,
                             ClearHistoryAndReset,
                             CopyPreviousMarkRange,
                             CopySelection,
+                            CopySelectionToFile,
                             CreateDebugDump,
                             CreateSelection,
                             DecreaseFontSize,
@@ -138,6 +142,9 @@ std::optional<Action> fromString(std::string const& name);
 
 namespace documentation
 {
+    constexpr inline std::string_view CancelPaste {
+        "Stops sending the rest of a large paste that is still being sent to the application, if any."
+    };
     constexpr inline std::string_view CancelSelection { "Cancels currently active selection, if any." };
     constexpr inline std::string_view ChangeProfile { "Changes the profile to the given profile `name`." };
     constexpr inline std::string_view ClearHistoryAndReset {
@@ -150,6 +157,9 @@ namespace documentation
     constexpr inline std::string_view CopySelection {
         "Copies the current selection into the clipboard buffer."
     };
+    constexpr inline std::string_view CopySelectionToFile {
+        "Writes the current selection into the file at `path` (defaults to `~/contour-selection.txt`)."
+    };
     constexpr inline std::string_view CreateSelection {
         "Creates selection with custom delimiters configured via `delimiters` member."
     };
@@ -244,11 +254,13 @@ namespace documentation
 inline auto getDocumentation()
 {
     return std::array {
+        std::tuple { Action { CancelPaste {} }, documentation::CancelPaste },
         std::tuple { Action { CancelSelection {} }, documentation::CancelSelection },
         std::tuple { Action { ChangeProfile {} }, documentation::ChangeProfile },
         std::tuple { Action { ClearHistoryAndReset {} }, documentation::ClearHistoryAndReset },
         std::tuple { Action { CopyPreviousMarkRange {} }, documentation::CopyPreviousMarkRange },
         std::tuple { Action { CopySelection {} }, documentation::CopySelection },
+        std::tuple { Action { CopySelectionToFile {} }, documentation::CopySelectionToFile },
         std::tuple { Action { CreateDebugDump {} }, documentation::CreateDebugDump },
         std::tuple { Action { CreateSelection {} }, documentation::CreateSelection },
         std::tuple { Action { DecreaseFontSize {} }, documentation::DecreaseFontSize },
@@ -310,11 +322,13 @@ inline auto getDocumentation()
     };
 
 // {{{ declare
+DECLARE_ACTION_FMT(CancelPaste)
 DECLARE_ACTION_FMT(CancelSelection)
 DECLARE_ACTION_FMT(ChangeProfile)
 DECLARE_ACTION_FMT(ClearHistoryAndReset)
 DECLARE_ACTION_FMT(CopyPreviousMarkRange)
 DECLARE_ACTION_FMT(CopySelection)
+DECLARE_ACTION_FMT(CopySelectionToFile)
 DECLARE_ACTION_FMT(CreateDebugDump)
 DECLARE_ACTION_FMT(CreateSelection)
 DECLARE_ACTION_FMT(DecreaseFontSize)
@@ -375,11 +389,13 @@ struct fmt::formatter<contour::actions::Action>: fmt::formatter<std::string>
     {
         std::string name = "Unknown action";
         // {{{ handle
+        HANDLE_ACTION(CancelPaste);
         HANDLE_ACTION(CancelSelection);
         HANDLE_ACTION(ChangeProfile);
         HANDLE_ACTION(ClearHistoryAndReset);
         HANDLE_ACTION(CopyPreviousMarkRange);
         HANDLE_ACTION(CopySelection);
+        HANDLE_ACTION(CopySelectionToFile);
         HANDLE_ACTION(CreateDebugDump);
         HANDLE_ACTION(DecreaseFontSize);
         HANDLE_ACTION(DecreaseOpacity);
@@ -427,6 +443,11 @@ struct fmt::formatter<contour::actions::Action>: fmt::formatter<std::string>
             const auto writeScreenAction = std::get<contour::actions::WriteScreen>(_action);
             name = fmt::format("{}, chars: '{}'", writeScreenAction, writeScreenAction.chars);
         }
+        if (std::holds_alternative<contour::actions::CopySelectionToFile>(_action))
+        {
+            const auto copySelectionToFileAction = std::get<contour::actions::CopySelectionToFile>(_action);
+            name = fmt::format("{}, path: '{}'", copySelectionToFileAction, copySelectionToFileAction.path);
+        }
         if (std::holds_alternative<contour::actions::CreateSelection>(_action))
         {
             const auto createSelectionAction = std::get<contour::actions::CreateSelection>(_action);
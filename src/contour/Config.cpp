@@ -179,6 +179,18 @@ fs::path configHome()
     return configHome("contour");
 }
 
+fs::path cacheHome()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    if (auto const* value = getenv("XDG_CACHE_HOME"); value && *value)
+        return fs::path { value } / "contour";
+    else
+        return Process::homeDirectory() / ".cache" / "contour";
+#else
+    return configHome() / "cache";
+#endif
+}
+
 std::string createString(Config const& c)
 {
     return createString(c, YAMLConfigWriter());
@@ -297,7 +309,10 @@ void YAMLConfigReader::load(Config& c)
         loadFromEntry("extended_word_delimiters", c.extendedWordDelimiters);
         loadFromEntry("read_buffer_size", c.ptyReadBufferSize);
         loadFromEntry("pty_buffer_size", c.ptyBufferObjectSize);
+        loadFromEntry("pty_input_pipeline", c.ptyInputPipeline);
+        loadFromEntry("pty_reactor_threads", c.ptyReactorThreads);
         loadFromEntry("images.sixel_register_count", c.maxImageColorRegisters);
+        loadFromEntry("images.cache_size", c.imageCacheSize);
         loadFromEntry("live_config", c.live);
         loadFromEntry("early_exit_threshold", c.earlyExitThreshold);
         loadFromEntry("spawn_new_process", c.spawnNewProcess);
@@ -307,6 +322,10 @@ void YAMLConfigReader::load(Config& c)
         loadFromEntry("renderer.tile_direct_mapping", c.textureAtlasDirectMapping);
         loadFromEntry("renderer.tile_hastable_slots", c.textureAtlasHashtableSlots);
         loadFromEntry("renderer.tile_cache_count", c.textureAtlasTileCount);
+        loadFromEntry("renderer.frame_reuse", c.frameReuse);
+        loadFromEntry("renderer.rasterizer_threads", c.rasterizerThreads);
+        loadFromEntry("renderer.deferred_glyphs", c.deferredGlyphs);
+        loadFromEntry("renderer.prewarm_cjk_glyphs", c.prewarmCJKGlyphs);
         loadFromEntry("bypass_mouse_protocol_modifier", c.bypassMouseProtocolModifiers);
         loadFromEntry("on_mouse_select", c.onMouseSelection);
         loadFromEntry("mouse_block_selection_modifier", c.mouseBlockSelectionModifiers);
@@ -372,6 +391,7 @@ void YAMLConfigReader::loadFromEntry(YAML::Node const& node, std::string const&
         {
             loadFromEntry(child["history"], "limit", where.maxHistoryLineCount);
             loadFromEntry(child["history"], "scroll_multiplier", where.historyScrollMultiplier);
+            loadFromEntry(child["history"], "hot_pages", where.hotHistoryPageCount);
             loadFromEntry(child["history"], "auto_scroll_on_update", where.autoScrollOnUpdate);
         }
         if (child["scrollbar"])
@@ -388,6 +408,7 @@ void YAMLConfigReader::loadFromEntry(YAML::Node const& node, std::string const&
             loadFromEntry(child["permissions"],
                           "display_host_writable_statusline",
                           where.displayHostWritableStatusLine);
+            loadFromEntry(child["permissions"], "read_image_files", where.readImageFiles);
         }
         loadFromEntry(child, "highlight_word_and_matches_on_double_click", where.highlightDoubleClickedWord);
         loadFromEntry(child, "font", where.fonts);
@@ -424,6 +445,12 @@ void YAMLConfigReader::loadFromEntry(YAML::Node const& node, std::string const&
                 loadFromEntry(child["status_line"]["indicator"], "left", where.indicatorStatusLineLeft);
                 loadFromEntry(child["status_line"]["indicator"], "middle", where.indicatorStatusLineMiddle);
                 loadFromEntry(child["status_line"]["indicator"], "right", where.indicatorStatusLineRight);
+                loadFromEntry(child["status_line"]["indicator"],
+                              "command_refresh_interval",
+                              where.indicatorStatusLineCommandRefreshInterval);
+                loadFromEntry(child["status_line"]["indicator"],
+                              "command_timeout",
+                              where.indicatorStatusLineCommandTimeout);
             }
         }
         if (child["background"])
@@ -1164,6 +1191,9 @@ void YAMLConfigReader::loadFromEntry(YAML::Node const& node,
         loadFromEntry(child, "locator", where.fontLocator);
         loadFromEntry(child, "text_shaping.engine", where.textShapingEngine);
         loadFromEntry(child, "builtin_box_drawing", where.builtinBoxDrawing);
+        bool glyphCache = false;
+        loadFromEntry(child, "glyph_cache", glyphCache);
+        where.glyphCacheFile = glyphCache ? (cacheHome() / "glyph-cache.bin").string() : std::string {};
         loadFromEntry(child, "render_mode", where.renderMode);
         loadFromEntry(child, "regular", where.regular);
 
@@ -1705,6 +1735,12 @@ std::optional<actions::Action> YAMLConfigReader::parseAction(YAML::Node const& n
             }
         }
 
+        if (holds_alternative<actions::CopySelectionToFile>(action))
+        {
+            if (auto path = node["path"]; path && path.IsScalar())
+                return actions::CopySelectionToFile { path.as<std::string>() };
+        }
+
         if (holds_alternative<actions::PasteClipboard>(action))
         {
             if (auto nodeStrip = node["strip"]; nodeStrip && nodeStrip.IsScalar())
@@ -1914,12 +1950,18 @@ std::string createString(Config const& c)
         process(c.textureAtlasHashtableSlots);
         process(c.textureAtlasTileCount);
         process(c.textureAtlasDirectMapping);
+        process(c.frameReuse);
+        process(c.rasterizerThreads);
+        process(c.deferredGlyphs);
+        process(c.prewarmCJKGlyphs);
     });
 
     processWordDelimiters();
     processExtendedWordDelimiters();
     process(c.ptyReadBufferSize);
     process(c.ptyBufferObjectSize);
+    process(c.ptyInputPipeline);
+    process(c.ptyReactorThreads);
     process(c.defaultProfileName);
     process(c.earlyExitThreshold);
     process(c.spawnNewProcess);
@@ -1936,6 +1978,7 @@ std::string createString(Config const& c)
     writer.scoped([&]() {
         process(c.sixelScrolling);
         process(c.maxImageColorRegisters);
+        process(c.imageCacheSize);
         process(c.maxImageSize);
     });
 
@@ -1979,6 +2022,7 @@ std::string createString(Config const& c)
                     process(entry.maxHistoryLineCount);
                     process(entry.autoScrollOnUpdate);
                     process(entry.historyScrollMultiplier);
+                    process(entry.hotHistoryPageCount);
                 }
 
                 // scrollbar: section
@@ -2015,6 +2059,7 @@ std::string createString(Config const& c)
                     process(entry.changeFont);
                     process(entry.captureBuffer);
                     process(entry.displayHostWritableStatusLine);
+                    process(entry.readImageFiles);
                 }
                 process(entry.highlightDoubleClickedWord);
                 process(entry.fonts);
@@ -2041,6 +2086,8 @@ std::string createString(Config const& c)
                         process(entry.indicatorStatusLineLeft);
                         process(entry.indicatorStatusLineMiddle);
                         process(entry.indicatorStatusLineRight);
+                        process(entry.indicatorStatusLineCommandRefreshInterval);
+                        process(entry.indicatorStatusLineCommandTimeout);
                     }
                 }
 
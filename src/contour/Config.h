@@ -326,6 +326,7 @@ struct TerminalProfile
     ConfigEntry<vtbackend::LineCount, documentation::HistoryScrollMultiplier> historyScrollMultiplier {
         vtbackend::LineCount(3)
     };
+    ConfigEntry<unsigned, documentation::HistoryHotPages> hotHistoryPageCount { 0 };
     ConfigEntry<ScrollBarPosition, documentation::ScrollbarPosition> scrollbarPosition {
         ScrollBarPosition::Right
     };
@@ -343,6 +344,10 @@ struct TerminalProfile
     ConfigEntry<std::string, documentation::IndicatorStatusLineRight> indicatorStatusLineRight {
         "{HistoryLineCount:Faint,Color=#c0c0c0} │ {Clock:Bold}"
     };
+    ConfigEntry<std::chrono::milliseconds, documentation::IndicatorStatusLineCommandRefreshInterval>
+        indicatorStatusLineCommandRefreshInterval { 5000 };
+    ConfigEntry<std::chrono::milliseconds, documentation::IndicatorStatusLineCommandTimeout>
+        indicatorStatusLineCommandTimeout { 5000 };
     ConfigEntry<bool, documentation::SyncWindowTitleWithHostWritableStatusDisplay>
         syncWindowTitleWithHostWritableStatusDisplay { false };
     ConfigEntry<bool, documentation::HideScrollbarInAltScreen> hideScrollbarInAltScreen { true };
@@ -354,6 +359,7 @@ struct TerminalProfile
     ConfigEntry<Permission, documentation::DisplayHostWritableStatusLine> displayHostWritableStatusLine {
         Permission::Ask
     };
+    ConfigEntry<Permission, documentation::ReadImageFiles> readImageFiles { Permission::Deny };
     ConfigEntry<bool, documentation::DrawBoldTextWithBrightColors> drawBoldTextWithBrightColors { false };
     ConfigEntry<ColorConfig, documentation::Colors> colors { SimpleColorConfig {} };
     ConfigEntry<vtbackend::LineCount, documentation::ModalCursorScrollOff> modalCursorScrollOff {
@@ -646,8 +652,14 @@ struct Config
     ConfigEntry<crispy::strong_hashtable_size, documentation::TextureAtlasHashtableSlots>
         textureAtlasHashtableSlots { 4096u };
     ConfigEntry<crispy::lru_capacity, documentation::TextureAtlasTileCount> textureAtlasTileCount { 4000u };
+    ConfigEntry<bool, documentation::FrameReuse> frameReuse { false };
+    ConfigEntry<int, documentation::RasterizerThreads> rasterizerThreads { 2 };
+    ConfigEntry<bool, documentation::DeferredGlyphs> deferredGlyphs { false };
+    ConfigEntry<bool, documentation::PrewarmCJKGlyphs> prewarmCJKGlyphs { false };
     ConfigEntry<int, documentation::PTYReadBufferSize> ptyReadBufferSize { 16384 };
     ConfigEntry<int, documentation::PTYBufferObjectSize> ptyBufferObjectSize { 1024 * 1024 };
+    ConfigEntry<bool, documentation::PTYInputPipeline> ptyInputPipeline { false };
+    ConfigEntry<int, documentation::PTYReactorThreads> ptyReactorThreads { 0 };
     ConfigEntry<bool, documentation::ReflowOnResize> reflowOnResize { true };
     ConfigEntry<std::unordered_map<std::string, vtbackend::ColorPalette>, documentation::ColorSchemes>
         colorschemes { { { "default", vtbackend::ColorPalette {} } } };
@@ -678,6 +690,7 @@ struct Config
     ConfigEntry<vtbackend::ImageSize, documentation::MaxImageSize> maxImageSize { { vtpty::Width { 0 },
                                                                                     vtpty::Height { 0 } } };
     ConfigEntry<int, documentation::MaxImageColorRegisters> maxImageColorRegisters { 4096 };
+    ConfigEntry<unsigned, documentation::ImageCacheSize> imageCacheSize { 64 };
     ConfigEntry<std::set<std::string>, documentation::ExperimentalFeatures> experimentalFeatures {};
 
     TerminalProfile* profile(std::string const& name) noexcept
@@ -1018,6 +1031,7 @@ struct YAMLConfigWriter: Writer
                       v.fontLocator,
                       v.textShapingEngine,
                       v.builtinBoxDrawing,
+                      !v.glyphCacheFile.empty(),
                       v.renderMode,
                       "true",
                       v.regular.familyName,
@@ -1122,6 +1136,7 @@ struct YAMLConfigWriter: Writer
 
 std::filesystem::path configHome();
 std::filesystem::path configHome(std::string const& programName);
+std::filesystem::path cacheHome();
 
 std::optional<std::string> readConfigFile(std::string const& filename);
 
@@ -181,6 +181,14 @@ constexpr StringLiteral HistoryScrollMultiplier {
     "\n"
 };
 
+constexpr StringLiteral HistoryHotPages {
+    "{comment} Number of pages of scrollback history to keep uncompressed.\n"
+    "{comment} Older history lines get compressed in memory and are decompressed on access.\n"
+    "{comment} A value of 0 disables compression of history lines.\n"
+    "hot_pages: {}\n"
+    "\n"
+};
+
 constexpr StringLiteral ScrollbarPosition {
     "{comment} scroll bar position: Left, Right, Hidden (ignore-case)\n"
     "position: {}\n"
@@ -198,6 +206,17 @@ constexpr StringLiteral IndicatorStatusLineLeft { "left: \"{}\"\n" };
 constexpr StringLiteral IndicatorStatusLineMiddle { "middle: \"{}\"\n" };
 constexpr StringLiteral IndicatorStatusLineRight { "right: \"{}\"\n" };
 
+constexpr StringLiteral IndicatorStatusLineCommandRefreshInterval {
+    "{comment} Time in milliseconds after which the programs of Command segments are run again.\n"
+    "{comment} Until then, and while they are running, their previous output is shown.\n"
+    "command_refresh_interval: {}\n"
+};
+
+constexpr StringLiteral IndicatorStatusLineCommandTimeout {
+    "{comment} Time in milliseconds after which the programs of Command segments are killed.\n"
+    "command_timeout: {}\n"
+};
+
 constexpr StringLiteral SyncWindowTitleWithHostWritableStatusDisplay {
     "{comment} Synchronize the window title with the Host Writable status_line if\n"
     "{comment} and only if the host writable status line was denied to be shown.\n"
@@ -249,6 +268,11 @@ constexpr StringLiteral Fonts {
     "    {comment} will be used (Default: true).\n"
     "    builtin_box_drawing: {}\n"
     "\n"
+    "    {comment} Keeps rasterized glyphs and text shaping results in a file in the cache directory,\n"
+    "    {comment} so that new windows and restarted sessions do not need to render them again\n"
+    "    {comment} (Default: false).\n"
+    "    glyph_cache: {}\n"
+    "\n"
     "    {comment} Font render modes tell the font rasterizer engine what rendering technique to use.\n"
     "    {comment}\n"
     "    {comment} Modes available are:\n"
@@ -317,6 +341,14 @@ constexpr StringLiteral DisplayHostWritableStatusLine {
     "\n"
 };
 
+constexpr StringLiteral ReadImageFiles {
+    "{comment} Allows displaying images read from files or shared memory\n"
+    "{comment} via `DCS Pw ; Ph ; Pf ; Pt ! i ST`.\n"
+    "{comment} The terminal then reads the given path on behalf of the application.\n"
+    "read_image_files: {}\n"
+    "\n"
+};
+
 constexpr StringLiteral DrawBoldTextWithBrightColors {
     "{comment} Indicates whether or not bold text should be rendered in bright colors,\n"
     "{comment} for indexed colors.\n"
@@ -528,6 +560,40 @@ constexpr StringLiteral TextureAtlasTileCount {
     "\n"
 };
 
+constexpr StringLiteral FrameReuse {
+    "{comment} Enables/disables taking over the unchanged parts of the previously rendered frame, \n"
+    "{comment} such as the lines that have only been moved up when scrolling. \n"
+    "{comment} This renders each frame into an offscreen buffer first. \n"
+    "{comment} \n"
+    "frame_reuse: {} \n"
+    "\n"
+};
+
+constexpr StringLiteral RasterizerThreads {
+    "{comment} Number of threads rasterizing glyphs that are not yet in the texture atlas, \n"
+    "{comment} in addition to the render thread. With 0, glyphs are rasterized by the render thread only. \n"
+    "{comment} \n"
+    "rasterizer_threads: {} \n"
+    "\n"
+};
+
+constexpr StringLiteral DeferredGlyphs {
+    "{comment} Enables/disables rendering glyphs that are not yet rasterized in the next frame, \n"
+    "{comment} rather than waiting for them. Requires rasterizer_threads to be greater than 0. \n"
+    "{comment} \n"
+    "deferred_glyphs: {} \n"
+    "\n"
+};
+
+constexpr StringLiteral PrewarmCJKGlyphs {
+    "{comment} Enables/disables rasterizing the CJK Unified Ideographs (U+4E00..U+9FFF) \n"
+    "{comment} in the background, bit by bit with every rendered frame. \n"
+    "{comment} Requires rasterizer_threads to be greater than 0. \n"
+    "{comment} \n"
+    "prewarm_cjk_glyphs: {} \n"
+    "\n"
+};
+
 constexpr StringLiteral PTYReadBufferSize { "{comment} Default PTY read buffer size. \n"
                                             "{comment} \n"
                                             "{comment} This is an advance option. Use with care! \n"
@@ -542,6 +608,27 @@ constexpr StringLiteral PTYBufferObjectSize {
     "\n"
 };
 
+constexpr StringLiteral PTYInputPipeline {
+    "{comment} Reads from the PTY on a dedicated thread and hands the data over to the parsing thread \n"
+    "{comment} via a lock-free queue, so that the PTY keeps being drained while the parser is busy. \n"
+    "{comment} \n"
+    "{comment} This is an advanced option. Use with care! \n"
+    "pty_input_pipeline: {} \n"
+    "\n"
+};
+
+constexpr StringLiteral PTYReactorThreads {
+    "{comment} Number of worker threads processing the PTY input of all terminal sessions. \n"
+    "{comment} If greater than 0, a single thread waits for all PTYs (using epoll) and hands the ready \n"
+    "{comment} ones over to this many worker threads, instead of using one input thread per terminal \n"
+    "{comment} session. \n"
+    "{comment} A value of 0 disables this. This setting is ignored if pty_input_pipeline is enabled. \n"
+    "{comment} \n"
+    "{comment} This is an advanced option. Use with care! \n"
+    "pty_reactor_threads: {} \n"
+    "\n"
+};
+
 constexpr StringLiteral ReflowOnResize {
     "\n"
     "{comment} Whether or not to reflow the lines on terminal resize events. \n"
@@ -690,6 +777,8 @@ constexpr StringLiteral InputMappings {
     "{comment}   Left, Middle, Right, WheelUp, WheelDown\n"
     "{comment}\n"
     "{comment} Actions:\n"
+    "{comment} - CancelPaste       Stops sending the rest of a large paste that is still being sent to "
+    "the application, if any.\n"
     "{comment} - CancelSelection   Cancels currently active selection, if any.\n"
     "{comment} - ChangeProfile     Changes the profile to the given profile `name`.\n"
     "{comment} - ClearHistoryAndReset    Clears the history, performs a terminal hard reset and attempts "
@@ -699,6 +788,8 @@ constexpr StringLiteral InputMappings {
     "marks "
     "into clipboard.\n"
     "{comment} - CopySelection     Copies the current selection into the clipboard buffer.\n"
+    "{comment} - CopySelectionToFile     Writes the current selection into the file at `path` (defaults to "
+    "`~/contour-selection.txt`).\n"
     "{comment} - CreateSelection   Creates selection with custom delimiters configured via `delimiters` "
     "member.\n"
     "{comment} - DecreaseFontSize  Decreases the font size by 1 pixel.\n"
@@ -806,6 +897,13 @@ constexpr StringLiteral MaxImageColorRegisters {
     "sixel_register_count: {} \n"
 };
 
+constexpr StringLiteral ImageCacheSize {
+    "\n"
+    "{comment} Maximum amount of image data in megabytes kept for reuse when the same image is "
+    "displayed again. \n"
+    "cache_size: {} \n"
+};
+
 constexpr StringLiteral ExperimentalFeatures {
     "\n"
     "{comment} Section of experimental features.\n"
@@ -11,6 +11,7 @@
 #include <crispy/App.h>
 #include <crispy/CLI.h>
 #include <crispy/StackTrace.h>
+#include <crispy/logstore.h>
 #include <crispy/utils.h>
 
 #include <fmt/chrono.h>
@@ -75,6 +76,7 @@ namespace
     void segvHandler(int signum)
     {
         signal(signum, SIG_DFL);
+        logstore::sink::console().dump_flight_recorder_from_signal_handler(STDERR_FILENO);
         return;
 
         std::stringstream sstr;
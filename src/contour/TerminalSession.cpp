@@ -37,6 +37,8 @@
 #include <limits>
 
 #if !defined(_WIN32)
+    #include <vtpty/PtyReactor.h>
+
     #include <pthread.h>
 #endif
 
@@ -75,6 +77,17 @@ namespace
 #endif
     }
 
+#if !defined(_WIN32)
+    /// Returns the PTY reactor shared by all terminal sessions of this process.
+    ///
+    /// The worker count is taken from the first call, as the reactor lives until the process exits.
+    vtpty::PtyReactor& sharedPtyReactor(size_t workerCount)
+    {
+        static auto reactor = vtpty::PtyReactor(workerCount);
+        return reactor;
+    }
+#endif
+
     ColorPalette const* preferredColorPalette(config::ColorConfig const& config,
                                               vtbackend::ColorPreference preference)
     {
@@ -129,7 +142,9 @@ namespace
         settings.pageSize = profile.terminalSize.value();
         settings.ptyBufferObjectSize = config.ptyBufferObjectSize.value();
         settings.ptyReadBufferSize = config.ptyReadBufferSize.value();
+        settings.pipelinedPtyInput = config.ptyInputPipeline.value();
         settings.maxHistoryLineCount = profile.maxHistoryLineCount.value();
+        settings.hotHistoryPageCount = profile.hotHistoryPageCount.value();
         settings.copyLastMarkRangeOffset = profile.copyLastMarkRangeOffset.value();
         settings.cursorBlinkInterval = profile.modeInsert.value().cursor.cursorBlinkInterval;
         settings.cursorShape = profile.modeInsert.value().cursor.cursorShape;
@@ -139,11 +154,15 @@ namespace
         settings.mouseProtocolBypassModifiers = config.bypassMouseProtocolModifiers.value();
         settings.maxImageSize = config.maxImageSize.value();
         settings.maxImageRegisterCount = config.maxImageColorRegisters.value();
+        settings.imageCacheSize = size_t { config.imageCacheSize.value() } * 1024 * 1024;
         settings.statusDisplayType = profile.initialStatusDisplayType.value();
         settings.statusDisplayPosition = profile.statusDisplayPosition.value();
         settings.indicatorStatusLine.left = profile.indicatorStatusLineLeft.value();
         settings.indicatorStatusLine.middle = profile.indicatorStatusLineMiddle.value();
         settings.indicatorStatusLine.right = profile.indicatorStatusLineRight.value();
+        settings.indicatorStatusLine.commandRefreshInterval =
+            profile.indicatorStatusLineCommandRefreshInterval.value();
+        settings.indicatorStatusLine.commandTimeout = profile.indicatorStatusLineCommandTimeout.value();
         settings.syncWindowTitleWithHostWritableStatusDisplay =
             profile.syncWindowTitleWithHostWritableStatusDisplay.value();
         if (auto const* p = preferredColorPalette(profile.colors.value(), colorPreference))
@@ -217,8 +236,16 @@ TerminalSession::~TerminalSession()
     sessionLog()("Destroying terminal session.");
     _terminating = true;
     _terminal.device().wakeupReader();
+#if !defined(_WIN32)
+    if (_ptyReactor)
+        _ptyReactor->remove(_ptyReactorPollHandle);
+#endif
+    if (auto* pipeline = _terminal.ptyInputPipeline())
+        pipeline->close();
     if (_exitWatcherThread->isRunning())
         _exitWatcherThread->terminate();
+    if (_ptyReaderThread)
+        _ptyReaderThread->join();
     if (_screenUpdateThread)
         _screenUpdateThread->join();
 }
@@ -267,10 +294,52 @@ void TerminalSession::start()
 {
     sessionLog()("Starting terminal session.");
     _terminal.device().start();
-    _screenUpdateThread = make_unique<std::thread>(bind(&TerminalSession::mainLoop, this));
+    if (_terminal.ptyInputPipeline())
+        _ptyReaderThread = make_unique<std::thread>(bind(&TerminalSession::ptyReaderLoop, this));
+    if (!attachToPtyReactor())
+        _screenUpdateThread = make_unique<std::thread>(bind(&TerminalSession::mainLoop, this));
     _exitWatcherThread->start(QThread::LowPriority);
 }
 
+bool TerminalSession::attachToPtyReactor()
+{
+#if !defined(_WIN32) && !defined(LIBTERMINAL_PASSIVE_RENDER_BUFFER_UPDATE)
+    if (_config.ptyReactorThreads.value() <= 0 || _terminal.ptyInputPipeline())
+        return false;
+
+    auto const pollHandle = _terminal.device().pollHandle();
+    if (!pollHandle.has_value())
+    {
+        sessionLog()("PTY does not support the PTY reactor. Using a dedicated thread instead.");
+        return false;
+    }
+
+    _ptyReactor = &sharedPtyReactor(static_cast<size_t>(_config.ptyReactorThreads.value()));
+    _ptyReactorPollHandle = *pollHandle;
+    _ptyReactor->add(_ptyReactorPollHandle,
+                     [this]() { return !_terminating && _terminal.processReadyInput(); });
+    sessionLog()("Attached PTY (poll handle {}) to the PTY reactor.", _ptyReactorPollHandle);
+    return true;
+#else
+    return false;
+#endif
+}
+
+void TerminalSession::ptyReaderLoop()
+{
+    setThreadName("Terminal.Reader");
+
+    sessionLog()("Starting PTY reader loop.");
+
+    while (!_terminating)
+    {
+        if (!_terminal.readPtyInputOnce())
+            break;
+    }
+
+    sessionLog()("PTY reader loop terminating.");
+}
+
 void TerminalSession::mainLoop()
 {
     setThreadName("Terminal.Loop");
@@ -344,7 +413,17 @@ void TerminalSession::screenUpdated()
 void TerminalSession::flushInput()
 {
     terminal().flushInput();
-    if (terminal().hasInput() && _display)
+
+    // Input held back by a paste being streamed or a full write queue is flushed upon requestFlushInput().
+    auto const heldBack = terminal().isPasting() || terminal().device().pendingWriteBytes() != 0;
+    if (terminal().hasInput() && !heldBack && _display)
+        _display->post(bind(&TerminalSession::flushInput, this));
+}
+
+void TerminalSession::requestFlushInput()
+{
+    // Invoked from the PTY reader thread.
+    if (_display)
         _display->post(bind(&TerminalSession::flushInput, this));
 }
 
@@ -365,6 +444,7 @@ void TerminalSession::executeRole(GuardedRole role, bool allow, bool remember)
         case GuardedRole::ShowHostWritableStatusLine:
             executeShowHostWritableStatusLine(allow, remember);
             break;
+        case GuardedRole::ReadImageFile: executePendingImageFile(allow, remember); break;
     }
 }
 
@@ -398,6 +478,7 @@ void TerminalSession::requestPermission(config::Permission allowedByConfig, Guar
                     case GuardedRole::ChangeFont: emit requestPermissionForFontChange(); break;
                     case GuardedRole::CaptureBuffer: emit requestPermissionForBufferCapture(); break;
                     case GuardedRole::ShowHostWritableStatusLine: emit requestPermissionForShowHostWritableStatusLine(); break;
+                    case GuardedRole::ReadImageFile: emit requestPermissionForImageFile(); break;
                         // clang-format on
                 }
             }
@@ -475,6 +556,50 @@ void TerminalSession::executeShowHostWritableStatusLine(bool allow, bool remembe
     _terminal.setSyncWindowTitleWithHostWritableStatusDisplay(false);
 }
 
+void TerminalSession::requestImageFile(vtbackend::ImageFileRequest request)
+{
+    // Invoked while processing the VT sequence, so that images allowed by configuration
+    // are placed right where the application expects them.
+    switch (_profile.readImageFiles.value())
+    {
+        case config::Permission::Allow: _terminal.imageFile(request); return;
+        case config::Permission::Deny:
+            sessionLog()("Permission for {} denied by configuration.", GuardedRole::ReadImageFile);
+            return;
+        case config::Permission::Ask:
+            if (!_display)
+                return;
+            // Asking the user is up to the GUI thread. The image is placed at the cursor position
+            // of the time the permission is granted. Only the most recent request is kept.
+            _pendingImageFile = std::move(request);
+            _display->post([this]() {
+                requestPermission(_profile.readImageFiles.value(), GuardedRole::ReadImageFile);
+            });
+            return;
+    }
+}
+
+void TerminalSession::executePendingImageFile(bool allow, bool remember)
+{
+    if (remember)
+        _rememberedPermissions[GuardedRole::ReadImageFile] = allow;
+
+    {
+        auto const _ = std::lock_guard { _terminal };
+        if (!_pendingImageFile)
+            return;
+
+        auto const request = std::move(_pendingImageFile.value());
+        _pendingImageFile.reset();
+
+        if (!allow)
+            return;
+
+        _terminal.imageFile(request);
+    }
+    _terminal.screenUpdated();
+}
+
 vtbackend::FontDef TerminalSession::getFontDef()
 {
     return _display->getFontDef();
@@ -664,6 +789,12 @@ void TerminalSession::pasteFromClipboard(unsigned count, bool strip)
         sessionLog()("Could not access clipboard.");
 }
 
+void TerminalSession::pasteProgress(size_t sentBytes, size_t totalBytes)
+{
+    // Invoked from the PTY reader thread for pastes that are streamed in chunks.
+    sessionLog()("Paste progress: {} of {} bytes sent.", sentBytes, totalBytes);
+}
+
 void TerminalSession::onSelectionCompleted()
 {
     switch (_config.onMouseSelection.value())
@@ -931,6 +1062,18 @@ void TerminalSession::cursorPositionChanged()
 }
 // }}}
 // {{{ Actions
+bool TerminalSession::operator()(actions::CancelPaste)
+{
+    if (!_terminal.isPasting())
+        return false;
+
+    _terminal.cancelPaste();
+
+    // Sends what has been typed while pasting.
+    flushInput();
+    return true;
+}
+
 bool TerminalSession::operator()(actions::CancelSelection)
 {
     _terminal.clearSelection();
@@ -967,9 +1110,20 @@ bool TerminalSession::operator()(actions::CopySelection copySelection)
     switch (copySelection.format)
     {
         case actions::CopyFormat::Text:
+        {
             // Copy the selection in pure text, plus whitespaces and newline.
-            crispy::locked(_terminal, [&]() { copyToClipboard(terminal().extractSelectionText()); });
+            // It is extracted in chunks, so that huge selections do not stall processing the output.
+            auto text = string {};
+            if (!_terminal.extractSelectionText([&](string_view chunk) { text += chunk; }))
+            {
+                // Rather nothing than only a part of the selection.
+                sessionLog()("Selection has been cleared or changed while copying it. Nothing copied.");
+                return false;
+            }
+            if (_display)
+                _display->post([this, text = std::move(text)]() { _display->copyToClipboard(text); });
             break;
+        }
         case actions::CopyFormat::HTML:
             // TODO: This requires walking through each selected cell and construct HTML+CSS for it.
         case actions::CopyFormat::VT:
@@ -982,6 +1136,44 @@ bool TerminalSession::operator()(actions::CopySelection copySelection)
     return true;
 }
 
+bool TerminalSession::operator()(actions::CopySelectionToFile const& action)
+{
+    auto const path = crispy::homeResolvedPath(action.path.empty() ? "~/contour-selection.txt" : action.path,
+                                               vtpty::Process::homeDirectory());
+    auto output = ofstream { path, ios::trunc | ios::binary };
+    if (!output)
+    {
+        errorLog()("Could not open {} to write the selection into.", path.string());
+        return false;
+    }
+
+    // Streams the selection straight to disk, chunk by chunk.
+    auto bytesWritten = size_t { 0 };
+    auto const complete = _terminal.extractSelectionText([&](string_view chunk) {
+        output.write(chunk.data(), static_cast<streamsize>(chunk.size()));
+        bytesWritten += chunk.size();
+    });
+    output.close();
+
+    if (!output)
+    {
+        errorLog()("Failed to write the selection into {}.", path.string());
+        return false;
+    }
+
+    if (!complete)
+    {
+        // Rather no file than one with only a part of the selection.
+        errorLog()("Selection has been cleared or changed while writing it into {}.", path.string());
+        auto ec = std::error_code {};
+        filesystem::remove(path, ec);
+        return false;
+    }
+
+    sessionLog()("Written {} bytes of the selection into {}.", bytesWritten, path.string());
+    return true;
+}
+
 bool TerminalSession::operator()(actions::CreateDebugDump)
 {
     _terminal.inspect();
@@ -1475,6 +1667,7 @@ void TerminalSession::configureTerminal()
     _terminal.setTerminalId(_profile.terminalId.value());
     _terminal.setMaxSixelColorRegisters(_config.maxImageColorRegisters.value());
     _terminal.setMaxImageSize(_config.maxImageSize.value());
+    _terminal.imagePool().setMemoryBudget(size_t { _config.imageCacheSize.value() } * 1024 * 1024);
     _terminal.setMode(vtbackend::DECMode::NoSixelScrolling, !_config.sixelScrolling.value());
     _terminal.setStatusDisplay(_profile.initialStatusDisplayType.value());
     sessionLog()(
@@ -1487,6 +1680,7 @@ void TerminalSession::configureTerminal()
     configureCursor(_profile.modeInsert.value().cursor);
     updateColorPreference(_app.colorPreference());
     _terminal.setMaxHistoryLineCount(_profile.maxHistoryLineCount.value());
+    _terminal.setHotHistoryPageCount(_profile.hotHistoryPageCount.value());
     _terminal.setHighlightTimeout(_profile.highlightTimeout.value());
     _terminal.viewport().setScrollOff(_profile.modalCursorScrollOff.value());
     _terminal.inputHandler().setSearchModeSwitch(_profile.searchModeSwitch.value());
@@ -24,6 +24,11 @@
 
 #include <qcolor.h>
 
+namespace vtpty
+{
+class PtyReactor;
+}
+
 namespace contour
 {
 
@@ -42,6 +47,7 @@ enum class GuardedRole : uint8_t
     ChangeFont,
     CaptureBuffer,
     ShowHostWritableStatusLine,
+    ReadImageFile,
 };
 
 /**
@@ -246,6 +252,7 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     Q_INVOKABLE void applyPendingFontChange(bool allow, bool remember);
     Q_INVOKABLE void executePendingBufferCapture(bool allow, bool remember);
     Q_INVOKABLE void executeShowHostWritableStatusLine(bool allow, bool remember);
+    Q_INVOKABLE void executePendingImageFile(bool allow, bool remember);
     Q_INVOKABLE void adaptToWidgetSize();
 
     void updateColorPreference(vtbackend::ColorPreference preference);
@@ -265,6 +272,8 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     void notify(std::string_view title, std::string_view content) override;
     void onClosed() override;
     void pasteFromClipboard(unsigned count, bool strip) override;
+    void pasteProgress(size_t sentBytes, size_t totalBytes) override;
+    void requestFlushInput() override;
     void onSelectionCompleted() override;
     void requestWindowResize(vtbackend::LineCount, vtbackend::ColumnCount) override;
     void requestWindowResize(vtbackend::Width, vtbackend::Height) override;
@@ -275,6 +284,7 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     void updateHighlights() override;
     void playSound(vtbackend::Sequence::Parameters const& params) override;
     void requestShowHostWritableStatusLine() override;
+    void requestImageFile(vtbackend::ImageFileRequest request) override;
     void cursorPositionChanged() override;
 
     bool isClosed() const noexcept { return _onClosedHandled; }
@@ -305,11 +315,13 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     void sendFocusOutEvent();
 
     // Actions
+    bool operator()(actions::CancelPaste);
     bool operator()(actions::CancelSelection);
     bool operator()(actions::ChangeProfile const&);
     bool operator()(actions::ClearHistoryAndReset);
     bool operator()(actions::CopyPreviousMarkRange);
     bool operator()(actions::CopySelection);
+    bool operator()(actions::CopySelectionToFile const&);
     bool operator()(actions::CreateDebugDump);
     bool operator()(actions::CreateSelection const&);
     bool operator()(actions::DecreaseFontSize);
@@ -394,6 +406,7 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     void requestPermissionForFontChange();
     void requestPermissionForBufferCapture();
     void requestPermissionForShowHostWritableStatusLine();
+    void requestPermissionForImageFile();
     void showNotification(QString const& title, QString const& content);
     void fontSizeChanged();
 
@@ -419,6 +432,11 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     uint8_t matchModeFlags() const;
     void flushInput();
     void mainLoop();
+    void ptyReaderLoop();
+
+    /// Registers the PTY with the shared PTY reactor, if enabled and supported,
+    /// instead of processing its input on a dedicated thread.
+    bool attachToPtyReactor();
 
     // private data
     //
@@ -443,6 +461,9 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     bool _terminating = false;
     std::thread::id _mainLoopThreadID {};
     std::unique_ptr<std::thread> _screenUpdateThread;
+    std::unique_ptr<std::thread> _ptyReaderThread;
+    vtpty::PtyReactor* _ptyReactor = nullptr;
+    int _ptyReactorPollHandle = -1;
 
     // state vars
     //
@@ -461,6 +482,7 @@ class TerminalSession: public QAbstractItemModel, public vtbackend::Terminal::Ev
     };
     std::optional<CaptureBufferRequest> _pendingBufferCapture;
     std::optional<vtbackend::FontDef> _pendingFontChange;
+    std::optional<vtbackend::ImageFileRequest> _pendingImageFile; // guarded by the terminal's lock
     PermissionCache _rememberedPermissions;
     std::unique_ptr<QThread> _exitWatcherThread;
 
@@ -493,6 +515,7 @@ struct formatter<contour::GuardedRole>
             case contour::GuardedRole::ChangeFont: return fmt::format_to(ctx.out(), "Change Font");
             case contour::GuardedRole::CaptureBuffer: return fmt::format_to(ctx.out(), "Capture Buffer");
             case contour::GuardedRole::ShowHostWritableStatusLine:  return fmt::format_to(ctx.out(), "show Host Writable Statusline");
+            case contour::GuardedRole::ReadImageFile: return fmt::format_to(ctx.out(), "Read Image File");
                 // clang-format on
         }
         crispy::unreachable();
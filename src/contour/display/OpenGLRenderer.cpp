@@ -13,6 +13,8 @@
 #include <crispy/defines.h>
 #include <crispy/utils.h>
 
+#include <fmt/format.h>
+
 #include <range/v3/all.hpp>
 
 #include <QtCore/QtGlobal>
@@ -189,6 +191,7 @@ void OpenGLRenderer::setRenderSize(vtbackend::ImageSize targetSurfaceSize)
         return;
 
     _renderTargetSize = targetSurfaceSize;
+    _previousFrameValid = false;
     _projectionMatrix = ortho(/* left */ 0.0f,
                               /* right */ unbox<float>(_renderTargetSize.width),
                               /* bottom */ unbox<float>(_renderTargetSize.height),
@@ -213,6 +216,23 @@ void OpenGLRenderer::setMargin(vtrasterizer::PageMargin margin) noexcept
     _margin = margin;
 }
 
+void OpenGLRenderer::setFrameReuse(bool enabled) noexcept
+{
+    _frameReuseEnabled = enabled;
+    _previousFrameValid = false;
+}
+
+bool OpenGLRenderer::reuseFrame(vector<vtrasterizer::FrameCopy> const& copies)
+{
+    // The offscreen frame is rendered without the model matrix, which must therefore not alter anything.
+    if (!_frameReuseEnabled || !_previousFrameValid || _frameBufferSize != _renderTargetSize
+        || !_modelMatrix.isIdentity())
+        return false;
+
+    _frameCopies = copies;
+    return true;
+}
+
 atlas::AtlasBackend& OpenGLRenderer::textureScheduler()
 {
     return *this;
@@ -284,6 +304,7 @@ OpenGLRenderer::~OpenGLRenderer()
     displayLog()("~OpenGLRenderer");
     CHECKED_GL(glDeleteVertexArrays(1, &_rectVAO));
     CHECKED_GL(glDeleteBuffers(1, &_rectVBO));
+    destroyFrameBuffers();
 }
 
 void OpenGLRenderer::initialize()
@@ -369,6 +390,7 @@ void OpenGLRenderer::logInfo()
 
 void OpenGLRenderer::clearCache()
 {
+    _previousFrameValid = false;
 }
 
 int OpenGLRenderer::maxTextureDepth()
@@ -548,7 +570,8 @@ void OpenGLRenderer::execute(std::chrono::steady_clock::time_point now)
     //              _scheduledExecutions.uploadTiles.size(),
     //              _scheduledExecutions.renderBatch.renderTiles.size());
 
-    auto const mvp = _projectionMatrix * _viewMatrix * _modelMatrix;
+    auto const offscreen = beginOffscreenFrame();
+    auto const mvp = offscreen ? _projectionMatrix : _projectionMatrix * _viewMatrix * _modelMatrix;
 
     // render filled rects
     //
@@ -595,6 +618,9 @@ void OpenGLRenderer::execute(std::chrono::steady_clock::time_point now)
         executeRenderTextures();
     });
 
+    if (offscreen)
+        endOffscreenFrame(timeValue);
+
     if (_pendingScreenshotCallback)
     {
         auto result = takeScreenshot();
@@ -627,6 +653,155 @@ void OpenGLRenderer::executeRenderTextures()
     _scheduledExecutions.clear();
 }
 
+// {{{ frame reuse
+bool OpenGLRenderer::beginOffscreenFrame()
+{
+    if (!_frameReuseEnabled || !_modelMatrix.isIdentity())
+    {
+        _previousFrameValid = false;
+        _frameCopies.clear();
+        return false;
+    }
+
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &_savedDrawFrameBuffer);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &_savedReadFrameBuffer);
+    glGetIntegerv(GL_VIEWPORT, _savedViewport.data());
+    _savedScissorTest = glIsEnabled(GL_SCISSOR_TEST) != GL_FALSE;
+
+    if (_frameBufferSize != _renderTargetSize)
+        createFrameBuffers();
+
+    auto const width = unbox<GLint>(_frameBufferSize.width);
+    auto const height = unbox<GLint>(_frameBufferSize.height);
+    auto const& previous = _frameBuffers[_currentFrameBuffer];
+    _currentFrameBuffer = (_currentFrameBuffer + 1) % _frameBuffers.size();
+    auto const& current = _frameBuffers[_currentFrameBuffer];
+
+    glDisable(GL_SCISSOR_TEST);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, current.fbo);
+    glViewport(0, 0, width, height);
+
+    GLfloat savedClearColor[4] {};
+    glGetFloatv(GL_COLOR_CLEAR_VALUE, savedClearColor);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glClearColor(savedClearColor[0], savedClearColor[1], savedClearColor[2], savedClearColor[3]);
+
+    if (!_frameCopies.empty())
+    {
+        // Frame buffer rows are bottom-up, whereas the copies are given in top-down render coordinates.
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, previous.fbo);
+        for (vtrasterizer::FrameCopy const& copy: _frameCopies)
+        {
+            auto const clipped = std::max({ 0, -copy.sourceY, -copy.targetY });
+            auto const sourceY = copy.sourceY + clipped;
+            auto const targetY = copy.targetY + clipped;
+            auto const rows = std::min({ copy.height - clipped, height - sourceY, height - targetY });
+            if (rows <= 0)
+                continue;
+            glBlitFramebuffer(0,
+                              height - sourceY - rows,
+                              width,
+                              height - sourceY,
+                              0,
+                              height - targetY - rows,
+                              width,
+                              height - targetY,
+                              GL_COLOR_BUFFER_BIT,
+                              GL_NEAREST);
+        }
+        _frameCopies.clear();
+        ++_reusedFrameCount;
+    }
+
+    ++_offscreenFrameCount;
+    return true;
+}
+
+void OpenGLRenderer::endOffscreenFrame(float timeValue)
+{
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, static_cast<GLuint>(_savedDrawFrameBuffer));
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, static_cast<GLuint>(_savedReadFrameBuffer));
+    glViewport(_savedViewport[0], _savedViewport[1], _savedViewport[2], _savedViewport[3]);
+    if (_savedScissorTest)
+        glEnable(GL_SCISSOR_TEST);
+
+    _previousFrameValid = true;
+
+    // Composite the offscreen frame onto the window, as a single RGBA image tile.
+    // Its colors are already multiplied by their alpha values.
+    auto const x = 0.0f;
+    auto const y = 0.0f;
+    auto const z = ZAxisDepths::Text;
+    auto const r = unbox<GLfloat>(_frameBufferSize.width);
+    auto const s = unbox<GLfloat>(_frameBufferSize.height);
+    auto const u = static_cast<GLfloat>(FRAGMENT_SELECTOR_IMAGE_BGRA);
+
+    // clang-format off
+    GLfloat const vertices[6 * 11] = {
+    // <X      Y      Z> <X     Y     I     U>  <R     G     B     A>
+        x,     y + s, z,  0.0f, 0.0f, 0.0f, u,  1.0f, 1.0f, 1.0f, 1.0f, // left bottom
+        x,     y,     z,  0.0f, 1.0f, 0.0f, u,  1.0f, 1.0f, 1.0f, 1.0f, // left top
+        x + r, y,     z,  1.0f, 1.0f, 0.0f, u,  1.0f, 1.0f, 1.0f, 1.0f, // right top
+
+        x,     y + s, z,  0.0f, 0.0f, 0.0f, u,  1.0f, 1.0f, 1.0f, 1.0f, // left bottom
+        x + r, y,     z,  1.0f, 1.0f, 0.0f, u,  1.0f, 1.0f, 1.0f, 1.0f, // right top
+        x + r, y + s, z,  1.0f, 0.0f, 0.0f, u,  1.0f, 1.0f, 1.0f, 1.0f, // right bottom
+    };
+    // clang-format on
+
+    bound(*_textShader, [&]() {
+        _textShader->setUniformValue(_textProjectionLocation, _projectionMatrix * _viewMatrix);
+        _textShader->setUniformValue(_textTimeLocation, timeValue);
+
+        glBlendFuncSeparate(GL_ONE, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
+        glBindTexture(GL_TEXTURE_2D, _frameBuffers[_currentFrameBuffer].texture);
+        glBindVertexArray(_textVAO);
+        glBindBuffer(GL_ARRAY_BUFFER, _textVBO);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STREAM_DRAW);
+        glDrawArrays(GL_TRIANGLES, 0, 6);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE);
+    });
+}
+
+void OpenGLRenderer::createFrameBuffers()
+{
+    destroyFrameBuffers();
+
+    auto const size = QSize(unbox<int>(_renderTargetSize.width), unbox<int>(_renderTargetSize.height));
+    for (OffscreenFrameBuffer& frameBuffer: _frameBuffers)
+    {
+        frameBuffer.texture = createAndUploadImage(size, vtbackend::ImageFormat::RGBA, 1, nullptr);
+        CHECKED_GL(glGenFramebuffers(1, &frameBuffer.fbo));
+        CHECKED_GL(glBindFramebuffer(GL_FRAMEBUFFER, frameBuffer.fbo));
+        CHECKED_GL(glFramebufferTexture2D(
+            GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, frameBuffer.texture, 0));
+    }
+    CHECKED_GL(glBindTexture(GL_TEXTURE_2D, 0));
+
+    _frameBufferSize = _renderTargetSize;
+    _previousFrameValid = false;
+
+    displayLog()("Created offscreen frame buffers of size {}.", _frameBufferSize);
+}
+
+void OpenGLRenderer::destroyFrameBuffers()
+{
+    for (OffscreenFrameBuffer& frameBuffer: _frameBuffers)
+    {
+        if (frameBuffer.fbo)
+            CHECKED_GL(glDeleteFramebuffers(1, &frameBuffer.fbo));
+        if (frameBuffer.texture)
+            CHECKED_GL(glDeleteTextures(1, &frameBuffer.texture));
+        frameBuffer = {};
+    }
+    _frameBufferSize = {};
+    _previousFrameValid = false;
+}
+// }}}
+
 void OpenGLRenderer::executeConfigureAtlas(atlas::ConfigureAtlas const& param)
 {
     Require(isPowerOfTwo(unbox(param.size.width)));
@@ -814,8 +989,12 @@ pair<ImageSize, vector<uint8_t>> OpenGLRenderer::takeScreenshot()
 }
 // }}}
 
-void OpenGLRenderer::inspect(std::ostream& /*output*/) const
+void OpenGLRenderer::inspect(std::ostream& output) const
 {
+    if (_frameReuseEnabled)
+        output << fmt::format("Frame reuse: {} of {} frames started with parts of the previous one\n",
+                              _reusedFrameCount,
+                              _offscreenFrameCount);
 }
 
 // {{{ background (image)
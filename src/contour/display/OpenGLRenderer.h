@@ -26,6 +26,7 @@
 
 #include <QtQuick/QQuickWindow>
 
+#include <array>
 #include <chrono>
 #include <memory>
 #include <optional>
@@ -79,6 +80,9 @@ class OpenGLRenderer final:
     void setViewSize(vtbackend::ImageSize size) noexcept { _viewSize = size; }
     void setModelMatrix(QMatrix4x4 matrix) noexcept;
     void setMargin(vtrasterizer::PageMargin margin) noexcept override;
+    void setFrameReuse(bool enabled) noexcept;
+    [[nodiscard]] bool frameReuseEnabled() const noexcept override { return _frameReuseEnabled; }
+    bool reuseFrame(std::vector<vtrasterizer::FrameCopy> const& copies) override;
     std::optional<AtlasTextureScreenshot> readAtlas() override;
     AtlasBackend& textureScheduler() override;
     void scheduleScreenshot(ScreenshotCallback callback) override;
@@ -126,6 +130,11 @@ class OpenGLRenderer final:
     void executeUploadTile(UploadTile const& param);
     void executeRenderTile(RenderTile const& param);
 
+    bool beginOffscreenFrame();
+    void endOffscreenFrame(float timeValue);
+    void createFrameBuffers();
+    void destroyFrameBuffers();
+
     //? void renderRectangle(int _x, int _y, int width, int height, QVector4D const& color);
 
     // -------------------------------------------------------------------------------------------
@@ -214,6 +223,28 @@ class OpenGLRenderer final:
 
     std::optional<ScreenshotCallback> _pendingScreenshotCallback;
 
+    // {{{ frame reuse
+    // With frame reuse enabled, each frame is rendered into an offscreen framebuffer first,
+    // alternating between two of them, so that bands of the previous frame can be copied over.
+    struct OffscreenFrameBuffer
+    {
+        GLuint fbo {};
+        GLuint texture {};
+    };
+    bool _frameReuseEnabled = false;
+    bool _previousFrameValid = false;
+    std::array<OffscreenFrameBuffer, 2> _frameBuffers {};
+    size_t _currentFrameBuffer = 0;
+    ImageSize _frameBufferSize {};
+    std::vector<vtrasterizer::FrameCopy> _frameCopies; // Bands to take over into the next frame.
+    GLint _savedDrawFrameBuffer {};
+    GLint _savedReadFrameBuffer {};
+    std::array<GLint, 4> _savedViewport {};
+    bool _savedScissorTest = false;
+    uint64_t _offscreenFrameCount = 0;
+    uint64_t _reusedFrameCount = 0;
+    // }}}
+
     QQuickWindow* _window = nullptr;
 
     // render state cache
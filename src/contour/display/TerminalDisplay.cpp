@@ -37,6 +37,7 @@
 #include <QtQml/QQmlContext>
 #include <QtQuick/QQuickWindow>
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <string_view>
@@ -302,6 +303,11 @@ void TerminalDisplay::setSession(TerminalSession* newSession)
                                             newSession->profile().hyperlinkDecorationHover.value()
                                             // TODO: , WindowMargin(windowMargin_.left, windowMargin_.bottom);
         );
+    _renderer->configureGlyphRasterizer(
+        static_cast<size_t>(std::max(0, newSession->config().rasterizerThreads.value())),
+        newSession->config().deferredGlyphs.value());
+    if (newSession->config().prewarmCJKGlyphs.value())
+        _renderer->prewarmGlyphs(0x4E00, 0x9FFF); // CJK Unified Ideographs
 
     applyFontDPI();
     updateImplicitSize();
@@ -598,6 +604,7 @@ void TerminalDisplay::createRenderer()
                                        textureTileSize,
                                        viewportMargin);
     _renderTarget->setWindow(window());
+    _renderTarget->setFrameReuse(_session->config().frameReuse.value());
     _renderer->setRenderTarget(*_renderTarget);
 
     connect(window(),
@@ -699,6 +706,8 @@ void TerminalDisplay::paint()
 
         terminal().tick(steady_clock::now());
         _renderer->render(terminal(), _renderingPressure);
+        if (_renderer->hasDeferredGlyphs())
+            scheduleRedraw(); // Renders the glyphs that are still being rasterized.
         if (_doDumpState)
         {
             doDumpStateInternal();
@@ -1119,6 +1128,14 @@ void TerminalDisplay::doDumpStateInternal()
         fs.close();
     }
 
+    if (logstore::sink::console().is_flight_recorder())
+    {
+        auto const flightRecorderFilePath = targetDir / "flight-recorder.log";
+        displayLog()("Saving flight recorder to: {}", flightRecorderFilePath.generic_string());
+        auto fs = ofstream { flightRecorderFilePath.string(), ios::trunc };
+        logstore::sink::console().dump_flight_recorder(fs);
+    }
+
     enum class ImageBufferFormat : uint8_t
     {
         RGBA,
@@ -116,6 +116,16 @@ app::app(std::string appName, std::string appTitle, std::string appVersion, std:
         customizeLogStoreOutput();
     }
 
+    // Keeps logging off the hot paths: "async" writes the log on a background thread,
+    // "flight-recorder" keeps the most recent messages in memory, to be dumped on demand or on crash.
+    if (char const* logSink = getenv("LOG_SINK"))
+    {
+        if (string_view(logSink) == "async")
+            logstore::sink::console().start_async();
+        else if (string_view(logSink) == "flight-recorder")
+            logstore::sink::console().start_flight_recorder();
+    }
+
     _instance = this;
 
     link(_appName + ".help", bind(&app::helpAction, this));
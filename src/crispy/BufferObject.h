@@ -9,6 +9,7 @@
 #include <gsl/span_ext>
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -102,8 +103,8 @@ class buffer_object: public std::enable_shared_from_this<buffer_object<T>>
     T const* begin() const noexcept { return data(); }
 
     /// Returns a pointer one byte past the last used byte.
-    T* hotEnd() noexcept { return _hotEnd; }
-    T const* hotEnd() const noexcept { return _hotEnd; }
+    T* hotEnd() noexcept { return _hotEnd.load(std::memory_order_relaxed); }
+    T const* hotEnd() const noexcept { return _hotEnd.load(std::memory_order_relaxed); }
 
     /// Returns a pointer one byte past the underlying storage's last byte.
     T* end() noexcept { return _end; }
@@ -112,6 +113,11 @@ class buffer_object: public std::enable_shared_from_this<buffer_object<T>>
     /// Advances the end of the used area by the given amount of bytes.
     gsl::span<T> advance(size_t n) noexcept;
 
+    /// Ensures the used area extends at least up to the given pointer.
+    ///
+    /// The hot end is never moved backwards, so that a buffer that is being filled
+    /// by a dedicated PTY reader thread (which advances the hot end itself) can be
+    /// referenced by the parsing thread at the same time.
     void advanceHotEndUntil(T const* ptr) noexcept;
 
     /// Appends the given amount of data to the buffer object
@@ -127,7 +133,7 @@ class buffer_object: public std::enable_shared_from_this<buffer_object<T>>
 #if !defined(BUFFER_OBJECT_INLINE)
     T* data_;
 #endif
-    T* _hotEnd;
+    std::atomic<T*> _hotEnd;
     T* _end;
 
     friend class buffer_fragment<T>;
@@ -156,8 +162,9 @@ class buffer_object_pool
   private:
     void release(buffer_object<T>* ptr);
 
-    bool _reuseBuffers = true;
+    std::atomic<bool> _reuseBuffers = true;
     size_t _bufferSize;
+    mutable std::mutex _mutex; // Guards _unusedBuffers, as buffers may be released by any thread.
     std::list<buffer_object_ptr<T>> _unusedBuffers;
 };
 
@@ -260,15 +267,16 @@ buffer_object_ptr<T> buffer_object<T>::create(size_t capacity, buffer_object_rel
 template <BufferObjectElementType T>
 gsl::span<T const> buffer_object<T>::writeAtEnd(gsl::span<T const> data) noexcept
 {
-    assert(_hotEnd + data.size() <= _end);
-    memcpy(_hotEnd, data.data(), data.size());
-    return gsl::span<T const> { _hotEnd, data.size() };
+    auto* const hotEnd = this->hotEnd();
+    assert(hotEnd + data.size() <= _end);
+    memcpy(hotEnd, data.data(), data.size());
+    return gsl::span<T const> { hotEnd, data.size() };
 }
 
 template <BufferObjectElementType T>
 void buffer_object<T>::reset() noexcept
 {
-    _hotEnd = data();
+    _hotEnd.store(data(), std::memory_order_relaxed);
 }
 
 template <BufferObjectElementType T>
@@ -294,23 +302,25 @@ inline T const* buffer_object<T>::data() const noexcept
 template <BufferObjectElementType T>
 inline gsl::span<T> buffer_object<T>::advance(size_t n) noexcept
 {
-    assert(_hotEnd + n <= _end);
-    auto result = gsl::span<T>(_hotEnd, _hotEnd + n);
-    _hotEnd += n;
+    auto* const hotEnd = this->hotEnd();
+    assert(hotEnd + n <= _end);
+    auto result = gsl::span<T>(hotEnd, hotEnd + n);
+    _hotEnd.store(hotEnd + n, std::memory_order_relaxed);
     return result;
 }
 
 template <BufferObjectElementType T>
 inline void buffer_object<T>::advanceHotEndUntil(T const* ptr) noexcept
 {
-    assert(_hotEnd <= ptr && ptr <= _end);
-    _hotEnd = const_cast<T*>(ptr);
+    assert(data() <= ptr && ptr <= _end);
+    if (hotEnd() < ptr)
+        _hotEnd.store(const_cast<T*>(ptr), std::memory_order_relaxed);
 }
 
 template <BufferObjectElementType T>
 inline void buffer_object<T>::clear() noexcept
 {
-    _hotEnd = data();
+    _hotEnd.store(data(), std::memory_order_relaxed);
 }
 
 template <BufferObjectElementType T>
@@ -358,20 +368,27 @@ buffer_object_pool<T>::~buffer_object_pool()
 template <BufferObjectElementType T>
 size_t buffer_object_pool<T>::unusedBuffers() const noexcept
 {
+    auto const _ = std::lock_guard { _mutex };
     return _unusedBuffers.size();
 }
 
 template <BufferObjectElementType T>
 void buffer_object_pool<T>::releaseUnusedBuffers()
 {
+    auto unusedBuffers = std::list<buffer_object_ptr<T>> {};
+    {
+        auto const _ = std::lock_guard { _mutex };
+        unusedBuffers.swap(_unusedBuffers);
+    }
     _reuseBuffers = false;
-    _unusedBuffers.clear();
+    unusedBuffers.clear();
     _reuseBuffers = true;
 }
 
 template <BufferObjectElementType T>
 buffer_object_ptr<T> buffer_object_pool<T>::allocateBufferObject()
 {
+    auto const _ = std::lock_guard { _mutex };
     if (_unusedBuffers.empty())
         return buffer_object<T>::create(_bufferSize, [this](auto p) { release(p); });
 
@@ -390,6 +407,7 @@ void buffer_object_pool<T>::release(buffer_object<T>* ptr)
         if (bufferObjectLog)
             bufferObjectLog()("Releasing BufferObject from pool: @{}", (void*) ptr);
         ptr->reset();
+        auto const _ = std::lock_guard { _mutex };
         _unusedBuffers.emplace_back(ptr, [this](auto p) { release(p); });
     }
     else
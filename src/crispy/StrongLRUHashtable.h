@@ -113,6 +113,9 @@ class strong_lru_hashtable
     /// counting from zero again.
     lru_hashtable_stats fetchAndClearStats() noexcept;
 
+    /// Returns the stats gathered so far.
+    [[nodiscard]] lru_hashtable_stats stats() const noexcept { return _stats; }
+
     /// Clears all entries from the hashtable.
     void clear();
 
@@ -1,9 +1,161 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <crispy/logstore.h>
+#include <crispy/mpsc_ring.h>
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <mutex>
+#include <thread>
+
+#if defined(_WIN32)
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
 
 namespace logstore
 {
 
+namespace
+{
+    // Size of the length prefix of each message recorded by the flight recorder.
+    constexpr size_t RecordHeaderSize = sizeof(uint32_t);
+
+    // Writes all of the given data to the file descriptor, as far as possible. Async-signal-safe.
+    void writeFully(int fd, char const* data, size_t size) noexcept
+    {
+        while (size > 0)
+        {
+#if defined(_WIN32)
+            auto const n = ::_write(fd, data, static_cast<unsigned>(size));
+#else
+            auto const n = ::write(fd, data, size);
+#endif
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return;
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    void writeFully(int fd, std::string_view text) noexcept
+    {
+        writeFully(fd, text.data(), text.size());
+    }
+} // namespace
+
+/// In-memory ring of the most recent messages, stored as length-prefixed records in one byte buffer,
+/// so that recording a message never allocates.
+class flight_recorder
+{
+  public:
+    explicit flight_recorder(size_t capacity): _buffer(std::max(capacity, RecordHeaderSize + 1)) {}
+
+    void record(std::string_view text, uint64_t& overwritten)
+    {
+        text = text.substr(0, _buffer.size() - RecordHeaderSize);
+        auto const recordSize = RecordHeaderSize + text.size();
+
+        while (_buffer.size() - _size < recordSize)
+        {
+            auto const oldestRecordSize = RecordHeaderSize + recordLength(_begin);
+            _begin = (_begin + oldestRecordSize) % _buffer.size();
+            _size -= oldestRecordSize;
+            ++overwritten;
+        }
+
+        auto const length = static_cast<uint32_t>(text.size());
+        auto const end = (_begin + _size) % _buffer.size();
+        copyIn(end, &length, RecordHeaderSize);
+        copyIn((end + RecordHeaderSize) % _buffer.size(), text.data(), text.size());
+        _size += recordSize;
+    }
+
+    void dump(std::ostream& output) const
+    {
+        auto text = std::string {};
+        for (size_t offset = 0; offset < _size;)
+        {
+            auto const position = (_begin + offset) % _buffer.size();
+            auto const length = recordLength(position);
+            text.resize(length);
+            copyOut((position + RecordHeaderSize) % _buffer.size(), text.data(), length);
+            output << text;
+            offset += RecordHeaderSize + length;
+        }
+    }
+
+    /// Writes the records straight out of the ring buffer. Async-signal-safe.
+    void dump(int fd) const noexcept
+    {
+        for (size_t offset = 0; offset < _size;)
+        {
+            auto const position = (_begin + offset) % _buffer.size();
+            auto const length = size_t { recordLength(position) };
+            auto const textPosition = (position + RecordHeaderSize) % _buffer.size();
+            auto const firstPart = std::min(length, _buffer.size() - textPosition);
+            writeFully(fd, _buffer.data() + textPosition, firstPart);
+            writeFully(fd, _buffer.data(), length - firstPart);
+            offset += RecordHeaderSize + length;
+        }
+    }
+
+  private:
+    uint32_t recordLength(size_t position) const noexcept
+    {
+        auto length = uint32_t {};
+        copyOut(position, &length, RecordHeaderSize);
+        return length;
+    }
+
+    void copyIn(size_t position, void const* data, size_t count)
+    {
+        auto const firstPart = std::min(count, _buffer.size() - position);
+        std::memcpy(_buffer.data() + position, data, firstPart);
+        std::memcpy(_buffer.data(), static_cast<char const*>(data) + firstPart, count - firstPart);
+    }
+
+    void copyOut(size_t position, void* data, size_t count) const noexcept
+    {
+        auto const firstPart = std::min(count, _buffer.size() - position);
+        std::memcpy(data, _buffer.data() + position, firstPart);
+        std::memcpy(static_cast<char*>(data) + firstPart, _buffer.data(), count - firstPart);
+    }
+
+    std::vector<char> _buffer;
+    size_t _begin = 0; // offset of the oldest record
+    size_t _size = 0;  // number of bytes used by all records
+};
+
+struct sink::async_state
+{
+    explicit async_state(size_t capacity): queue { capacity } {}
+
+    crispy::mpsc_ring<std::string> queue;
+
+    std::atomic<uint64_t> queued = 0;  // messages pushed into the queue
+    std::atomic<uint64_t> written = 0; // messages popped off the queue and written
+    std::atomic<uint64_t> dropped = 0; // messages not pushed because the queue was full
+    std::atomic<uint32_t> wakeups = 0; // incremented to wake up the writer thread
+    std::atomic<bool> stopping = false;
+
+    std::unique_ptr<flight_recorder> recorder;
+    mutable std::mutex recorderMutex;
+    uint64_t overwritten = 0; // guarded by recorderMutex
+
+    // Lets a signal handler tell whether the recorder is consistent, without locking:
+    // no more messages are recorded once frozen, and recording is set while one is.
+    std::atomic<bool> recording = false;
+    std::atomic<bool> frozen = false;
+
+    std::thread writer;
+};
+
 sink::sink(bool enabled, writer wr): _enabled { enabled }, _writer { std::move(wr) }
 {
 }
@@ -24,6 +176,166 @@ sink::sink(bool enabled, std::shared_ptr<std::ostream> f):
 {
 }
 
+sink::~sink()
+{
+    stop_async();
+}
+
+void sink::start_async(size_t capacity)
+{
+    if (_async)
+        return;
+
+    _async = std::make_unique<async_state>(capacity);
+    _async->writer = std::thread([this]() { drain(); });
+}
+
+void sink::start_flight_recorder(size_t byteCapacity, size_t capacity)
+{
+    if (_async)
+        return;
+
+    _async = std::make_unique<async_state>(capacity);
+    _async->recorder = std::make_unique<flight_recorder>(byteCapacity);
+    _async->writer = std::thread([this]() { drain(); });
+}
+
+void sink::stop_async()
+{
+    if (!_async)
+        return;
+
+    _async->stopping = true;
+    ++_async->wakeups;
+    _async->wakeups.notify_one();
+    _async->writer.join();
+    _async.reset();
+}
+
+void sink::flush()
+{
+    if (!_async)
+        return;
+
+    auto const target = _async->queued.load(std::memory_order_acquire);
+    for (auto written = _async->written.load(std::memory_order_acquire); written < target;
+         written = _async->written.load(std::memory_order_acquire))
+        _async->written.wait(written, std::memory_order_acquire);
+}
+
+bool sink::is_flight_recorder() const noexcept
+{
+    return _async && _async->recorder;
+}
+
+sink_stats sink::stats() const noexcept
+{
+    if (!_async)
+        return {};
+
+    auto const _ = std::scoped_lock { _async->recorderMutex };
+    return sink_stats { .written = _async->written.load(),
+                        .dropped = _async->dropped.load(),
+                        .overwritten = _async->overwritten };
+}
+
+void sink::dump_flight_recorder(std::ostream& output) const
+{
+    if (!is_flight_recorder())
+        return;
+
+    auto const _ = std::scoped_lock { _async->recorderMutex };
+    _async->recorder->dump(output);
+    output << fmt::format("({} messages dropped, {} overwritten)\n",
+                          _async->dropped.load(),
+                          _async->overwritten);
+}
+
+void sink::dump_flight_recorder_from_signal_handler(int fd) const noexcept
+{
+    if (!is_flight_recorder())
+        return;
+
+    auto const savedErrno = errno;
+
+    // Either the writer thread sees the recorder frozen, or we see it recording.
+    _async->frozen.store(true);
+    if (_async->recording.load())
+        writeFully(fd, "(The flight recorder is busy.)\n");
+    else
+    {
+        _async->recorder->dump(fd);
+
+        // Formatted into a buffer on the stack, as allocating is not async-signal-safe.
+        auto buffer = std::array<char, 96> {};
+        auto* const end = buffer.data() + buffer.size();
+        auto* out = buffer.data();
+        auto const append = [&](std::string_view text) {
+            out = std::copy_n(text.data(), std::min(text.size(), size_t(end - out)), out);
+        };
+        append("(");
+        out = std::to_chars(out, end, _async->dropped.load()).ptr;
+        append(" messages dropped, ");
+        out = std::to_chars(out, end, _async->overwritten).ptr;
+        append(" overwritten)\n");
+        writeFully(fd, buffer.data(), static_cast<size_t>(out - buffer.data()));
+    }
+
+    errno = savedErrno;
+}
+
+void sink::write_async(std::string text)
+{
+    if (!_async->queue.try_push(text))
+    {
+        _async->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    _async->queued.fetch_add(1, std::memory_order_release);
+    _async->wakeups.fetch_add(1, std::memory_order_release);
+    _async->wakeups.notify_one();
+}
+
+void sink::drain()
+{
+    auto& state = *_async;
+    auto reportedDropped = uint64_t { 0 };
+    while (true)
+    {
+        auto const wakeups = state.wakeups.load(std::memory_order_acquire);
+
+        while (auto text = state.queue.try_pop())
+        {
+            if (state.recorder)
+            {
+                auto const _ = std::scoped_lock { state.recorderMutex };
+                state.recording.store(true);
+                if (!state.frozen.load())
+                    state.recorder->record(*text, state.overwritten);
+                state.recording.store(false);
+            }
+            else
+                _writer(*text);
+
+            state.written.fetch_add(1, std::memory_order_release);
+            state.written.notify_all();
+        }
+
+        if (auto const dropped = state.dropped.load(std::memory_order_relaxed);
+            dropped != reportedDropped && !state.recorder)
+        {
+            _writer(fmt::format("[logstore] {} messages dropped.\n", dropped - reportedDropped));
+            reportedDropped = dropped;
+        }
+
+        if (state.stopping)
+            return;
+
+        state.wakeups.wait(wakeups, std::memory_order_acquire);
+    }
+}
+
 sink& sink::console()
 {
     static auto instance = sink(false, std::cout);
@@ -10,6 +10,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstdint>
 #include <functional>
 #include <iostream>
 #include <iterator>
@@ -87,30 +88,17 @@ class message_builder
 
     [[nodiscard]] std::string const& text() const noexcept { return _buffer; }
 
-    message_builder& append(std::string_view msg)
-    {
-        _buffer += msg;
-        return *this;
-    }
+    // NB: Messages of disabled categories are never written, so they are not formatted either.
+
+    message_builder& append(std::string_view msg);
 
     template <typename... T>
-    message_builder& append(fmt::format_string<T...> fmt, T const&... args)
-    {
-        _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
-        return *this;
-    }
+    message_builder& append(fmt::format_string<T...> fmt, T const&... args);
+
+    message_builder& operator()(std::string const& msg) { return append(msg); }
 
-    message_builder& operator()(std::string const& msg)
-    {
-        _buffer += msg;
-        return *this;
-    }
     template <typename... Ts>
-    message_builder& operator()(std::string_view fmt, Ts const&... args)
-    {
-        _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
-        return *this;
-    }
+    message_builder& operator()(std::string_view fmt, Ts const&... args);
 
     [[nodiscard]] std::string message() const;
 
@@ -181,17 +169,40 @@ class category
     std::reference_wrapper<logstore::sink> _sink;
 };
 
+/// Counters of an asynchronous sink.
+struct sink_stats
+{
+    uint64_t written = 0;     //!< messages written (or recorded) by the writer thread
+    uint64_t dropped = 0;     //!< messages dropped because the queue was full
+    uint64_t overwritten = 0; //!< recorded messages overwritten by newer ones in the flight recorder
+};
+
 /// Logging sink API.
 ///
 /// Such as the console, a log file, or UDP endpoint.
+///
+/// By default, messages are written synchronously on the logging thread.
+/// An asynchronous sink rather queues the formatted messages into a lock-free ring,
+/// which is drained by a writer thread, so that logging never waits for I/O.
+/// In flight recorder mode, messages are not written at all but kept in an in-memory ring
+/// of the most recent messages, to be dumped on demand (or on crash).
 class sink
 {
   public:
     using writer = std::function<void(std::string_view const&)>;
 
+    static constexpr size_t DefaultQueueCapacity = 4096;
+    static constexpr size_t DefaultFlightRecorderSize = 4 * 1024 * 1024;
+
     sink(bool enabled, writer writer);
     sink(bool enabled, std::ostream& output);
     sink(bool enabled, std::shared_ptr<std::ostream> f);
+    ~sink();
+
+    sink(sink const&) = delete;
+    sink(sink&&) = delete;
+    sink& operator=(sink const&) = delete;
+    sink& operator=(sink&&) = delete;
 
     void set_writer(writer writer);
 
@@ -200,13 +211,54 @@ class sink
 
     void set_enabled(bool enabled) { _enabled = enabled; }
 
+    /// Moves writing onto a writer thread, queuing up to @p capacity messages.
+    ///
+    /// Messages are dropped (and counted) while the queue is full rather than blocking
+    /// the logging thread.
+    ///
+    /// Must be called before any other thread logs to this sink.
+    void start_async(size_t capacity = DefaultQueueCapacity);
+
+    /// Like start_async(), but records messages into an in-memory ring of @p byteCapacity bytes
+    /// instead of writing them, overwriting the oldest messages once full.
+    void start_flight_recorder(size_t byteCapacity = DefaultFlightRecorderSize,
+                               size_t capacity = DefaultQueueCapacity);
+
+    /// Writes all queued messages and returns to writing synchronously.
+    ///
+    /// Must not be called while any other thread logs to this sink.
+    void stop_async();
+
+    /// Blocks until all messages queued so far have been written (or recorded).
+    void flush();
+
+    /// Writes the messages kept by the flight recorder to @p output, oldest first.
+    void dump_flight_recorder(std::ostream& output) const;
+
+    /// Like dump_flight_recorder(), but writes to the file descriptor @p fd with neither locking
+    /// nor allocating, so that it may be called from a signal handler.
+    ///
+    /// No more messages are recorded afterwards. If a message was just being recorded,
+    /// only a notice is written, as the recorder's contents are inconsistent.
+    void dump_flight_recorder_from_signal_handler(int fd) const noexcept;
+
+    [[nodiscard]] bool is_async() const noexcept { return _async != nullptr; }
+    [[nodiscard]] bool is_flight_recorder() const noexcept;
+    [[nodiscard]] sink_stats stats() const noexcept;
+
     /// Retrieves reference to standard debug-logging sink.
     static sink& console();
     static sink& error_console(); // NOLINT(readability-identifier-naming)
 
   private:
+    struct async_state;
+
+    void write_async(std::string text);
+    void drain();
+
     bool _enabled;
     writer _writer;
+    std::unique_ptr<async_state> _async;
 };
 
 std::vector<std::reference_wrapper<category>>& get();
@@ -297,6 +349,29 @@ inline message_builder::message_builder(logstore::category const& cat, source_lo
 {
 }
 
+inline message_builder& message_builder::append(std::string_view msg)
+{
+    if (_category->is_enabled())
+        _buffer += msg;
+    return *this;
+}
+
+template <typename... T>
+message_builder& message_builder::append(fmt::format_string<T...> fmt, T const&... args)
+{
+    if (_category->is_enabled())
+        _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
+    return *this;
+}
+
+template <typename... Ts>
+message_builder& message_builder::operator()(std::string_view fmt, Ts const&... args)
+{
+    if (_category->is_enabled())
+        _buffer += fmt::vformat(fmt, fmt::make_format_args(args...));
+    return *this;
+}
+
 inline message_builder::~message_builder()
 {
     _category->sink().write(*this);
@@ -339,7 +414,12 @@ inline std::string category::defaultFormatter(message_builder const& message)
 
 inline void sink::write(message_builder const& message)
 {
-    if (_enabled && message.get_category().is_enabled())
+    if (!_enabled || !message.get_category().is_enabled())
+        return;
+
+    if (_async)
+        write_async(message.message());
+    else
         _writer(message.message());
 }
 
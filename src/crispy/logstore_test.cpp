@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <crispy/logstore.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::string_literals;
+
+TEST_CASE("logstore.disabled_category_is_not_formatted")
+{
+    auto category = logstore::category("test.disabled", "Test category");
+    auto builder = category();
+    builder("Hello, {}!", "World");
+    CHECK(builder.text().empty());
+
+    category.enable();
+    builder("Hello, {}!", "World");
+    CHECK(builder.text() == "Hello, World!");
+}
+
+TEST_CASE("logstore.async")
+{
+    auto mutex = std::mutex {};
+    auto written = std::string {};
+    auto sink = logstore::sink(true, [&](std::string_view text) {
+        auto const _ = std::scoped_lock { mutex };
+        written += text;
+    });
+    auto category = logstore::category("test.async", "Test category", logstore::category::state::Enabled);
+    category.set_sink(sink);
+
+    sink.start_async();
+    CHECK(sink.is_async());
+
+    auto threads = std::vector<std::thread> {};
+    for (int i = 0; i < 4; ++i)
+        threads.emplace_back([&category]() {
+            for (int k = 0; k < 100; ++k)
+                category()("message");
+        });
+    for (auto& thread: threads)
+        thread.join();
+
+    sink.flush();
+    auto const stats = sink.stats();
+    CHECK(stats.written + stats.dropped == 400);
+    {
+        auto const _ = std::scoped_lock { mutex };
+        CHECK(written.size() >= stats.written * "message\n"s.size());
+    }
+
+    sink.stop_async();
+    CHECK_FALSE(sink.is_async());
+
+    // Synchronous again.
+    auto const sizeBefore = written.size();
+    category()("sync");
+    CHECK(written.size() == sizeBefore + "sync\n"s.size());
+}
+
+TEST_CASE("logstore.flight_recorder")
+{
+    auto written = std::string {};
+    auto sink = logstore::sink(true, [&](std::string_view text) { written += text; });
+    auto category =
+        logstore::category("test.flight_recorder", "Test category", logstore::category::state::Enabled);
+    category.set_sink(sink);
+
+    // Room for two messages of 4 bytes each (plus their length prefixes).
+    sink.start_flight_recorder(2 * (4 + 4));
+    CHECK(sink.is_flight_recorder());
+
+    category()("one");
+    category()("two");
+    category()("six");
+    sink.flush();
+
+    // Messages are recorded rather than written.
+    CHECK(written.empty());
+
+    auto output = std::ostringstream {};
+    sink.dump_flight_recorder(output);
+    CHECK(output.str() == "two\nsix\n(0 messages dropped, 1 overwritten)\n");
+    CHECK(sink.stats().overwritten == 1);
+}
+
+#if !defined(_WIN32)
+TEST_CASE("logstore.flight_recorder.signal_handler")
+{
+    auto written = std::string {};
+    auto sink = logstore::sink(true, [&](std::string_view text) { written += text; });
+    auto category = logstore::category(
+        "test.flight_recorder.signal_handler", "Test category", logstore::category::state::Enabled);
+    category.set_sink(sink);
+
+    sink.start_flight_recorder(2 * (4 + 4));
+    category()("one");
+    category()("two");
+    category()("six");
+    sink.flush();
+
+    auto* const file = std::tmpfile();
+    REQUIRE(file != nullptr);
+    sink.dump_flight_recorder_from_signal_handler(::fileno(file));
+
+    auto dumped = std::string(128, '\0');
+    std::rewind(file);
+    dumped.resize(std::fread(dumped.data(), 1, dumped.size(), file));
+    std::fclose(file);
+    CHECK(dumped == "two\nsix\n(0 messages dropped, 1 overwritten)\n");
+
+    // Nothing is recorded anymore.
+    category()("ten");
+    sink.flush();
+    auto output = std::ostringstream {};
+    sink.dump_flight_recorder(output);
+    CHECK(output.str() == "two\nsix\n(0 messages dropped, 1 overwritten)\n");
+}
+#endif
@@ -0,0 +1,113 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <crispy/utils.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace crispy
+{
+
+/**
+ * Bounded, lock-free, multi-producer/single-consumer ring buffer.
+ *
+ * Any number of threads may call try_push() concurrently, while exactly one thread may call try_pop().
+ * Each slot carries a sequence number that tells whether it is free for the producer claiming it,
+ * or holds a published value for the consumer (D. Vyukov's bounded queue), so that producers never
+ * wait for each other beyond a compare-and-swap on the tail index.
+ *
+ * The capacity is rounded up to the next power of two, and is at least two.
+ */
+template <typename T>
+class mpsc_ring // NOLINT(readability-identifier-naming)
+{
+  public:
+    using value_type = T;
+
+    explicit mpsc_ring(size_t capacity):
+        _capacity { nextPowerOfTwo(std::max(capacity, size_t { 2 })) },
+        _mask { _capacity - 1 },
+        _slots { std::make_unique<slot[]>(_capacity) }
+    {
+        assert(capacity > 0);
+        for (size_t i = 0; i < _capacity; ++i)
+            _slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    mpsc_ring(mpsc_ring const&) = delete;
+    mpsc_ring(mpsc_ring&&) = delete;
+    mpsc_ring& operator=(mpsc_ring const&) = delete;
+    mpsc_ring& operator=(mpsc_ring&&) = delete;
+    ~mpsc_ring() = default;
+
+    /// Enqueues the given value unless the ring is full.
+    ///
+    /// @retval true  the value has been moved into the ring.
+    /// @retval false the ring is full and @p value is left untouched.
+    [[nodiscard]] bool try_push(T& value)
+    {
+        auto tail = _tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            auto& slot = _slots[tail & _mask];
+            auto const sequence = slot.sequence.load(std::memory_order_acquire);
+            auto const difference = static_cast<std::ptrdiff_t>(sequence - tail);
+            if (difference == 0)
+            {
+                // The slot is free. Claim it, unless another producer was faster.
+                if (_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_relaxed))
+                {
+                    slot.value = std::move(value);
+                    slot.sequence.store(tail + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+                return false; // The slot still holds a value from one lap ago.
+            else
+                tail = _tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    [[nodiscard]] bool try_push(T&& value) { return try_push(value); }
+
+    /// Dequeues the oldest value, if any.
+    [[nodiscard]] std::optional<T> try_pop()
+    {
+        auto& slot = _slots[_head & _mask];
+        if (slot.sequence.load(std::memory_order_acquire) != _head + 1)
+            return std::nullopt;
+
+        auto value = std::optional<T> { std::move(slot.value) };
+        slot.value = T {};
+        slot.sequence.store(_head + _capacity, std::memory_order_release);
+        ++_head;
+        return value;
+    }
+
+    [[nodiscard]] size_t capacity() const noexcept { return _capacity; }
+
+  private:
+    struct slot
+    {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    size_t _capacity;
+    size_t _mask;
+    std::unique_ptr<slot[]> _slots;
+
+    // Consumer side: the index of the next element to pop.
+    alignas(CacheLineSize) size_t _head = 0;
+
+    // Producer side: the index of the next slot to claim.
+    alignas(CacheLineSize) std::atomic<size_t> _tail = 0;
+};
+
+} // namespace crispy
@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <crispy/mpsc_ring.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+using crispy::mpsc_ring;
+
+TEST_CASE("mpsc_ring.capacity")
+{
+    CHECK(mpsc_ring<int>(5).capacity() == 8);
+    CHECK(mpsc_ring<int>(1).capacity() == 2);
+}
+
+TEST_CASE("mpsc_ring.push_pop")
+{
+    auto ring = mpsc_ring<int>(2);
+    CHECK(ring.try_push(1));
+    CHECK(ring.try_push(2));
+    CHECK_FALSE(ring.try_push(3));
+
+    CHECK(ring.try_pop() == 1);
+    CHECK(ring.try_push(3));
+    CHECK(ring.try_pop() == 2);
+    CHECK(ring.try_pop() == 3);
+    CHECK_FALSE(ring.try_pop().has_value());
+}
+
+TEST_CASE("mpsc_ring.push_keeps_value_when_full")
+{
+    auto ring = mpsc_ring<std::unique_ptr<int>>(2);
+    CHECK(ring.try_push(std::make_unique<int>(1)));
+    CHECK(ring.try_push(std::make_unique<int>(2)));
+
+    auto value = std::make_unique<int>(3);
+    CHECK_FALSE(ring.try_push(value));
+    REQUIRE(value != nullptr);
+    CHECK(*value == 3);
+}
+
+TEST_CASE("mpsc_ring.threaded")
+{
+    auto constexpr ProducerCount = 4;
+    auto constexpr Count = 50'000;
+    auto ring = mpsc_ring<int>(64);
+
+    auto producers = std::vector<std::thread> {};
+    for (int producer = 0; producer < ProducerCount; ++producer)
+        producers.emplace_back([&ring, producer]() {
+            for (int i = 0; i < Count; ++i)
+                while (!ring.try_push(producer * Count + i))
+                    std::this_thread::yield();
+        });
+
+    // Values of each producer arrive in the order they have been pushed.
+    auto nextExpected = std::vector<int>(ProducerCount, 0);
+    auto inOrder = true;
+    for (int received = 0; received < ProducerCount * Count;)
+    {
+        if (auto const value = ring.try_pop(); value.has_value())
+        {
+            auto const producer = *value / Count;
+            inOrder = inOrder && *value % Count == nextExpected[producer];
+            ++nextExpected[producer];
+            ++received;
+        }
+        else
+            std::this_thread::yield();
+    }
+
+    for (auto& producer: producers)
+        producer.join();
+    CHECK(inOrder);
+    CHECK_FALSE(ring.try_pop().has_value());
+}
@@ -16,14 +16,13 @@
 
     #include <sys/select.h>
 
+    #include <fcntl.h>
     #include <unistd.h>
 #endif
 
 #if defined(__linux__)
     #include <sys/epoll.h>
     #include <sys/eventfd.h>
-#else
-    #include <fcntl.h>
 #endif
 
 namespace crispy
@@ -72,6 +71,35 @@ class posix_read_selector
     {
         assert(std::count(_fds.begin(), _fds.end(), fd) == 1);
         _fds.erase(std::remove(_fds.begin(), _fds.end(), fd), _fds.end());
+        if (std::count(_writeFds.begin(), _writeFds.end(), fd) != 0)
+            cancel_write(fd);
+    }
+
+    /// Additionally waits for the given file descriptor, which must be waited for to become readable,
+    /// to become writable.
+    void want_write(int fd) noexcept
+    {
+        assert(std::count(_fds.begin(), _fds.end(), fd) == 1);
+        assert(std::count(_writeFds.begin(), _writeFds.end(), fd) == 0);
+        _writeFds.push_back(fd);
+    }
+
+    void cancel_write(int fd) noexcept
+    {
+        assert(std::count(_writeFds.begin(), _writeFds.end(), fd) == 1);
+        _writeFds.erase(std::remove(_writeFds.begin(), _writeFds.end(), fd), _writeFds.end());
+        _writable.erase(std::remove(_writable.begin(), _writable.end(), fd), _writable.end());
+    }
+
+    /// Tests if the given file descriptor has been found writable by wait_one(),
+    /// and resets that state.
+    [[nodiscard]] bool consume_writable(int fd) noexcept
+    {
+        auto const i = std::find(_writable.begin(), _writable.end(), fd);
+        if (i == _writable.end())
+            return false;
+        _writable.erase(i);
+        return true;
     }
 
     void wakeup() noexcept
@@ -103,6 +131,8 @@ class posix_read_selector
             if (fd > maxfd)
                 maxfd = fd;
         }
+        for (auto const fd: _writeFds)
+            FD_SET(fd, &_writer);
 
         auto tv = std::unique_ptr<timeval>();
         if (timeout.has_value())
@@ -129,7 +159,17 @@ class posix_read_selector
             if (FD_ISSET(fd, &_reader))
                 _pending.push_back(fd);
 
-        return try_pop_pending();
+        for (int const fd: _writeFds)
+            if (FD_ISSET(fd, &_writer) && std::count(_writable.begin(), _writable.end(), fd) == 0)
+                _writable.push_back(fd);
+
+        if (auto fd = try_pop_pending(); fd.has_value())
+            return fd;
+
+        // A file descriptor that has only become writable is reported like a wakeup.
+        if (!_writable.empty())
+            errno = EINTR;
+        return std::nullopt;
     }
 
   private:
@@ -151,7 +191,9 @@ class posix_read_selector
     fd_set _writer {};
     fd_set _except {};
     std::vector<int> _fds;
+    std::vector<int> _writeFds;
     std::deque<int> _pending;
+    std::vector<int> _writable;
     file_descriptor _breakPipeReader;
     file_descriptor _breakPipeWriter;
 };
@@ -171,9 +213,21 @@ class epoll_read_selector
     void cancel_read(int fd) noexcept;
     [[nodiscard]] size_t size() const noexcept;
 
+    /// Additionally waits for the given file descriptor, which must be waited for to become readable,
+    /// to become writable.
+    void want_write(int fd) noexcept;
+    void cancel_write(int fd) noexcept;
+
+    /// Tests if the given file descriptor has been found writable by wait_one(),
+    /// and resets that state.
+    [[nodiscard]] bool consume_writable(int fd) noexcept;
+
     void wakeup() const noexcept;
     std::optional<int> wait_one(std::optional<std::chrono::milliseconds> timeout = std::nullopt) noexcept;
 
+    /// Returns the epoll file descriptor, which is readable whenever wait_one() would not block.
+    [[nodiscard]] int native_handle() const noexcept { return _epollFd; }
+
   private:
     std::optional<int> try_pop_pending() noexcept;
 
@@ -182,6 +236,8 @@ class epoll_read_selector
     file_descriptor _eventFd;
     size_t _size = 0;
     std::deque<int> _pending;
+    std::vector<int> _writeFds;
+    std::vector<int> _writable;
 };
 
 inline epoll_read_selector::epoll_read_selector()
@@ -213,6 +269,38 @@ inline void epoll_read_selector::cancel_read(int fd) noexcept
     event.data.fd = fd;
     epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, &event);
     _size--;
+    _writeFds.erase(std::remove(_writeFds.begin(), _writeFds.end(), fd), _writeFds.end());
+    _writable.erase(std::remove(_writable.begin(), _writable.end(), fd), _writable.end());
+}
+
+inline void epoll_read_selector::want_write(int fd) noexcept
+{
+    assert(std::count(_writeFds.begin(), _writeFds.end(), fd) == 0);
+    auto event = epoll_event {};
+    event.events = EPOLLIN | EPOLLOUT;
+    event.data.fd = fd;
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &event);
+    _writeFds.push_back(fd);
+}
+
+inline void epoll_read_selector::cancel_write(int fd) noexcept
+{
+    assert(std::count(_writeFds.begin(), _writeFds.end(), fd) == 1);
+    auto event = epoll_event {};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &event);
+    _writeFds.erase(std::remove(_writeFds.begin(), _writeFds.end(), fd), _writeFds.end());
+    _writable.erase(std::remove(_writable.begin(), _writable.end(), fd), _writable.end());
+}
+
+inline bool epoll_read_selector::consume_writable(int fd) noexcept
+{
+    auto const i = std::find(_writable.begin(), _writable.end(), fd);
+    if (i == _writable.end())
+        return false;
+    _writable.erase(i);
+    return true;
 }
 
 inline size_t epoll_read_selector::size() const noexcept
@@ -265,21 +353,32 @@ inline std::optional<int> epoll_read_selector::wait_one(
         }
 
         bool piped = false;
+        bool written = false;
         for (size_t i = 0; i < static_cast<size_t>(result); ++i)
         {
-            if (events[i].data.fd == _eventFd)
+            auto const fd = events[i].data.fd;
+            if (fd == _eventFd)
             {
                 eventfd_t dummy {};
                 piped = ::read(_eventFd, &dummy, sizeof(dummy)) > 0;
+                continue;
             }
-            else
-                _pending.push_back(events[i].data.fd);
+
+            if ((events[i].events & EPOLLOUT) && std::count(_writable.begin(), _writable.end(), fd) == 0)
+            {
+                _writable.push_back(fd);
+                written = true;
+            }
+
+            if (events[i].events & ~static_cast<uint32_t>(EPOLLOUT))
+                _pending.push_back(fd);
         }
 
         if (auto fd = try_pop_pending(); fd.has_value())
             return fd;
 
-        errno = piped ? EINTR : EAGAIN;
+        // A file descriptor that has only become writable is reported like a wakeup.
+        errno = piped || written ? EINTR : EAGAIN;
         return std::nullopt;
     }
 }
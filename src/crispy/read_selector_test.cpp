@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: Apache-2.0
+#if !defined(_WIN32)
+    #include <crispy/read_selector.h>
+
+    #include <catch2/catch_test_macros.hpp>
+
+    #include <sys/socket.h>
+
+    #include <unistd.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+struct socket_pair
+{
+    socket_pair() { REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0); }
+    ~socket_pair()
+    {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+    socket_pair(socket_pair const&) = delete;
+    socket_pair& operator=(socket_pair const&) = delete;
+
+    int fds[2] {};
+};
+
+template <typename Selector>
+void testReadable()
+{
+    auto const sockets = socket_pair {};
+    auto selector = Selector {};
+    selector.want_read(sockets.fds[0]);
+
+    CHECK_FALSE(selector.wait_one(0ms).has_value());
+
+    REQUIRE(::write(sockets.fds[1], "x", 1) == 1);
+    CHECK(selector.wait_one(0ms) == sockets.fds[0]);
+
+    selector.cancel_read(sockets.fds[0]);
+    CHECK(selector.size() == 0);
+}
+
+template <typename Selector>
+void testWritable()
+{
+    auto const sockets = socket_pair {};
+    auto selector = Selector {};
+    selector.want_read(sockets.fds[0]);
+    selector.want_write(sockets.fds[0]);
+
+    // Becoming writable only is reported like a wakeup.
+    errno = 0;
+    CHECK_FALSE(selector.wait_one(0ms).has_value());
+    CHECK(errno == EINTR);
+    CHECK(selector.consume_writable(sockets.fds[0]));
+    CHECK_FALSE(selector.consume_writable(sockets.fds[0]));
+
+    // Readability is still reported while waiting for writability.
+    REQUIRE(::write(sockets.fds[1], "x", 1) == 1);
+    CHECK(selector.wait_one(0ms) == sockets.fds[0]);
+
+    selector.cancel_write(sockets.fds[0]);
+    CHECK_FALSE(selector.consume_writable(sockets.fds[0]));
+    selector.cancel_read(sockets.fds[0]);
+}
+
+} // namespace
+
+TEST_CASE("read_selector.readable")
+{
+    testReadable<crispy::posix_read_selector>();
+    testReadable<crispy::read_selector>();
+}
+
+TEST_CASE("read_selector.writable")
+{
+    testWritable<crispy::posix_read_selector>();
+    testWritable<crispy::read_selector>();
+}
+#endif
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <crispy/utils.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+namespace crispy
+{
+
+/**
+ * Bounded, lock-free, single-producer/single-consumer ring buffer.
+ *
+ * Exactly one thread may call try_push() and exactly one (other) thread may call try_pop().
+ * Elements are published with release semantics and consumed with acquire semantics, so that
+ * everything the producer wrote before pushing an element is visible to the consumer after popping it.
+ *
+ * The capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class spsc_ring // NOLINT(readability-identifier-naming)
+{
+  public:
+    using value_type = T;
+
+    explicit spsc_ring(size_t capacity):
+        _slots(nextPowerOfTwo(capacity)), _mask { _slots.size() - 1 }
+    {
+        assert(capacity > 0);
+    }
+
+    spsc_ring(spsc_ring const&) = delete;
+    spsc_ring(spsc_ring&&) = delete;
+    spsc_ring& operator=(spsc_ring const&) = delete;
+    spsc_ring& operator=(spsc_ring&&) = delete;
+    ~spsc_ring() = default;
+
+    /// Enqueues the given value unless the ring is full.
+    ///
+    /// @retval true  the value has been moved into the ring.
+    /// @retval false the ring is full and @p value is left untouched.
+    [[nodiscard]] bool try_push(T& value)
+    {
+        auto const tail = _tail.load(std::memory_order_relaxed);
+        if (tail - _cachedHead == _slots.size())
+        {
+            _cachedHead = _head.load(std::memory_order_acquire);
+            if (tail - _cachedHead == _slots.size())
+                return false;
+        }
+
+        _slots[tail & _mask] = std::move(value);
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    [[nodiscard]] bool try_push(T&& value) { return try_push(value); }
+
+    /// Dequeues the oldest value, if any.
+    [[nodiscard]] std::optional<T> try_pop()
+    {
+        auto const head = _head.load(std::memory_order_relaxed);
+        if (head == _cachedTail)
+        {
+            _cachedTail = _tail.load(std::memory_order_acquire);
+            if (head == _cachedTail)
+                return std::nullopt;
+        }
+
+        auto value = std::optional<T> { std::move(_slots[head & _mask]) };
+        _slots[head & _mask] = T {};
+        _head.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    /// Returns the number of elements currently stored.
+    ///
+    /// This value is only a snapshot when called concurrently to the producer or consumer.
+    [[nodiscard]] size_t size() const noexcept
+    {
+        auto const head = _head.load(std::memory_order_acquire);
+        auto const tail = _tail.load(std::memory_order_acquire);
+        return tail - head;
+    }
+
+    [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+    [[nodiscard]] size_t capacity() const noexcept { return _slots.size(); }
+
+  private:
+    std::vector<T> _slots;
+    size_t _mask;
+
+    // Consumer side: the index of the next element to pop, and the consumer's last seen tail.
+    alignas(CacheLineSize) std::atomic<size_t> _head = 0;
+    size_t _cachedTail = 0;
+
+    // Producer side: the index of the next free slot, and the producer's last seen head.
+    alignas(CacheLineSize) std::atomic<size_t> _tail = 0;
+    size_t _cachedHead = 0;
+};
+
+} // namespace crispy
@@ -0,0 +1,75 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <crispy/spsc_ring.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <memory>
+#include <thread>
+
+using crispy::spsc_ring;
+
+TEST_CASE("spsc_ring.capacity")
+{
+    auto const ring = spsc_ring<int>(5);
+    CHECK(ring.capacity() == 8);
+    CHECK(ring.empty());
+}
+
+TEST_CASE("spsc_ring.push_pop")
+{
+    auto ring = spsc_ring<int>(2);
+    CHECK(ring.try_push(1));
+    CHECK(ring.try_push(2));
+    CHECK_FALSE(ring.try_push(3));
+    CHECK(ring.size() == 2);
+
+    CHECK(ring.try_pop() == 1);
+    CHECK(ring.try_push(3));
+    CHECK(ring.try_pop() == 2);
+    CHECK(ring.try_pop() == 3);
+    CHECK_FALSE(ring.try_pop().has_value());
+    CHECK(ring.empty());
+}
+
+TEST_CASE("spsc_ring.push_keeps_value_when_full")
+{
+    auto ring = spsc_ring<std::unique_ptr<int>>(1);
+    CHECK(ring.try_push(std::make_unique<int>(1)));
+
+    auto value = std::make_unique<int>(2);
+    CHECK_FALSE(ring.try_push(value));
+    REQUIRE(value != nullptr);
+    CHECK(*value == 2);
+
+    auto popped = ring.try_pop();
+    REQUIRE(popped.has_value());
+    CHECK(**popped == 1);
+}
+
+TEST_CASE("spsc_ring.threaded")
+{
+    auto constexpr Count = 100'000;
+    auto ring = spsc_ring<int>(64);
+
+    auto producer = std::thread { [&]() {
+        for (int i = 0; i < Count; ++i)
+            while (!ring.try_push(i))
+                std::this_thread::yield();
+    } };
+
+    auto inOrder = true;
+    for (int expected = 0; expected < Count;)
+    {
+        if (auto const value = ring.try_pop(); value.has_value())
+        {
+            inOrder = inOrder && *value == expected;
+            ++expected;
+        }
+        else
+            std::this_thread::yield();
+    }
+
+    producer.join();
+    CHECK(inOrder);
+    CHECK(ring.empty());
+}
@@ -42,6 +42,12 @@ namespace views
     }
 } // namespace views
 
+/// Assumed size of a cache line, for keeping data written by different threads apart.
+///
+/// Not std::hardware_destructive_interference_size, as its value depends on the compiler flags,
+/// which GCC warns about (-Winterference-size) when used in headers.
+constexpr inline size_t CacheLineSize = 64;
+
 constexpr std::string_view trimRight(std::string_view value) noexcept
 {
     while (!value.empty())
@@ -217,7 +217,8 @@ struct directwrite_shaper::Private
         familyNames->GetString(index, resolvedFamilyName.data(), length + 1);
 
         for (auto&& [fontKey, fontInfo]: fonts)
-            if (_description == fontInfo.description && fontInfo.fontFace->Equals(fontFace))
+            if (_description == fontInfo.description && fontInfo.size.pt == _size.pt
+                && fontInfo.fontFace->Equals(fontFace))
                 return fontKey;
 
         auto dwMetrics = DWRITE_FONT_METRICS {};
@@ -599,6 +600,24 @@ void directwrite_shaper::clear_cache()
     // TODO: clear the cache
 }
 
+void directwrite_shaper::unload_fonts(font_size _size)
+{
+    auto count = 0;
+    for (auto i = d->fonts.begin(); i != d->fonts.end();)
+    {
+        if (i->second.size.pt != _size.pt)
+        {
+            ++i;
+            continue;
+        }
+        i->second.fontFace->Release();
+        d->fontsHasColor.erase(i->first);
+        i = d->fonts.erase(i);
+        ++count;
+    }
+    locatorLog()("Unloaded {} fonts of size {}.", count, _size);
+}
+
 optional<glyph_position> directwrite_shaper::shape(font_key _font, char32_t _codepoint)
 {
     return nullopt; // TODO
@@ -21,6 +21,7 @@ class directwrite_shaper: public shaper
     void set_dpi(DPI _dpi) override;
     void set_locator(font_locator& _locator) override;
     void clear_cache() override;
+    void unload_fonts(font_size _size) override;
 
     std::optional<font_key> load_font(font_description const& _description, font_size _size) override;
 
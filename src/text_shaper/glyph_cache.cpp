@@ -0,0 +1,265 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <text_shaper/glyph_cache.h>
+#include <text_shaper/shaper.h>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+
+#if defined(_WIN32)
+    #include <io.h>
+    #include <process.h>
+#else
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+
+    #include <unistd.h>
+#endif
+
+using std::nullopt;
+using std::optional;
+using std::unique_ptr;
+
+namespace fs = std::filesystem;
+
+namespace text
+{
+
+namespace
+{
+    // File header: magic and format version.
+    constexpr auto FileHeader = std::array<uint8_t, 8> { 'C', 'T', 'G', 'C', 1, 0, 0, 0 };
+
+    // Every record starts with its key, value size and checksum, and is padded to RecordAlignment.
+    constexpr size_t RecordHeaderSize = 16;
+    constexpr size_t RecordAlignment = 8;
+
+    constexpr size_t alignedSize(size_t size) noexcept
+    {
+        return (size + RecordAlignment - 1) / RecordAlignment * RecordAlignment;
+    }
+
+    uint32_t checksum(uint64_t key, gsl::span<uint8_t const> value) noexcept
+    {
+        auto hash = glyph_cache_key {};
+        hash.add(key).add(static_cast<uint32_t>(value.size())).add(value);
+        return static_cast<uint32_t>(hash.value() ^ (hash.value() >> 32));
+    }
+
+    template <typename T>
+    T load(uint8_t const* data) noexcept
+    {
+        T value {};
+        std::memcpy(&value, data, sizeof(T));
+        return value;
+    }
+
+#if defined(_WIN32)
+    int openFile(fs::path const& path)
+    {
+        return _wopen(path.c_str(), _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+    }
+    bool writeFile(int fd, void const* data, size_t size)
+    {
+        return _write(fd, data, static_cast<unsigned>(size)) == static_cast<int>(size);
+    }
+    void closeFile(int fd)
+    {
+        _close(fd);
+    }
+    int processId()
+    {
+        return _getpid();
+    }
+#else
+    int openFile(fs::path const& path)
+    {
+        return ::open(path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0600);
+    }
+    bool writeFile(int fd, void const* data, size_t size)
+    {
+        return ::write(fd, data, size) == static_cast<ssize_t>(size);
+    }
+    void closeFile(int fd)
+    {
+        ::close(fd);
+    }
+    int processId()
+    {
+        return static_cast<int>(::getpid());
+    }
+#endif
+} // namespace
+
+unique_ptr<glyph_cache> glyph_cache::open(fs::path const& path, size_t maxFileSize)
+{
+    auto ec = std::error_code {};
+    fs::create_directories(path.parent_path(), ec);
+
+    auto const fd = openFile(path);
+    if (fd < 0)
+    {
+        errorLog()("Failed to open glyph cache file {}. {}", path.string(), strerror(errno));
+        return nullptr;
+    }
+
+    auto cache = unique_ptr<glyph_cache>(new glyph_cache(path, fd, maxFileSize));
+    cache->map_file();
+    rasterizerLog()("Opened glyph cache file {} with {} entries.", path.string(), cache->_index.size());
+    return cache;
+}
+
+glyph_cache::glyph_cache(fs::path path, int fd, size_t maxFileSize):
+    _path { std::move(path) }, _fd { fd }, _maxFileSize { maxFileSize }
+{
+}
+
+glyph_cache::~glyph_cache()
+{
+#if defined(_WIN32)
+    delete[] _mapping;
+#else
+    if (_mapping)
+        ::munmap(const_cast<uint8_t*>(_mapping), _mappingSize);
+#endif
+    if (_fd >= 0)
+        closeFile(_fd);
+}
+
+void glyph_cache::map_file()
+{
+    auto ec = std::error_code {};
+    auto const fileSize = static_cast<size_t>(fs::file_size(_path, ec));
+    auto const valid = !ec && fileSize >= FileHeader.size() && fileSize <= _maxFileSize;
+
+    if (valid)
+    {
+#if defined(_WIN32)
+        auto* contents = new uint8_t[fileSize];
+        _lseeki64(_fd, 0, SEEK_SET);
+        if (_read(_fd, contents, static_cast<unsigned>(fileSize)) == static_cast<int>(fileSize))
+            _mapping = contents;
+        else
+            delete[] contents;
+#else
+        if (auto* p = ::mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, _fd, 0); p != MAP_FAILED)
+            _mapping = static_cast<uint8_t const*>(p);
+#endif
+    }
+
+    if (!_mapping || !std::equal(FileHeader.begin(), FileHeader.end(), _mapping))
+    {
+        // Missing, outdated, oversized, or otherwise unusable file. Start afresh.
+        if (_mapping || fileSize != 0)
+            rasterizerLog()("Resetting glyph cache file {} ({} bytes).", _path.string(), fileSize);
+        replace_file({});
+        _mappingSize = _mapping ? fileSize : 0;
+        return;
+    }
+
+    _mappingSize = fileSize;
+    auto offset = FileHeader.size();
+    while (offset + RecordHeaderSize <= fileSize)
+    {
+        auto const key = load<uint64_t>(_mapping + offset);
+        auto const size = load<uint32_t>(_mapping + offset + 8);
+        auto const sum = load<uint32_t>(_mapping + offset + 12);
+        if (alignedSize(RecordHeaderSize + size) > fileSize - offset)
+            break;
+        auto const value = gsl::span<uint8_t const>(_mapping + offset + RecordHeaderSize, size);
+        if (checksum(key, value) != sum)
+            break;
+        _index.emplace(key, value);
+        offset += alignedSize(RecordHeaderSize + size);
+    }
+    _fileSize = offset;
+
+    // Records appended behind an incomplete or corrupt one would never be read again,
+    // so the valid records are carried over into a new file instead.
+    if (_fileSize != fileSize)
+    {
+        rasterizerLog()("Dropping {} trailing bytes of glyph cache file {}.",
+                        fileSize - _fileSize,
+                        _path.string());
+        replace_file(gsl::span(_mapping + FileHeader.size(), _fileSize - FileHeader.size()));
+    }
+
+    _stats.entries = _index.size();
+}
+
+void glyph_cache::replace_file(gsl::span<uint8_t const> records)
+{
+    // The file is never truncated in place, because other processes may still have it mapped.
+    // Instead, the new file is written aside and then renamed over the old one.
+    auto ec = std::error_code {};
+    auto const tempPath = fs::path(_path).concat("." + std::to_string(processId()) + ".tmp");
+    fs::remove(tempPath, ec);
+
+    auto const fd = openFile(tempPath);
+    auto const written = fd >= 0 && writeFile(fd, FileHeader.data(), FileHeader.size())
+                         && (records.empty() || writeFile(fd, records.data(), records.size()));
+    if (fd >= 0)
+        closeFile(fd);
+
+    // Windows does not rename over files that are still open.
+    if (_fd >= 0)
+        closeFile(_fd);
+    _fd = -1;
+
+    if (written)
+        fs::rename(tempPath, _path, ec);
+    if (!written || ec)
+    {
+        errorLog()("Failed to initialize glyph cache file {}.", _path.string());
+        fs::remove(tempPath, ec);
+        return;
+    }
+
+    _fd = openFile(_path);
+    _fileSize = FileHeader.size() + records.size();
+}
+
+optional<gsl::span<uint8_t const>> glyph_cache::find(uint64_t key)
+{
+    if (auto const i = _index.find(key); i != _index.end())
+    {
+        ++_stats.hits;
+        return i->second;
+    }
+    ++_stats.misses;
+    return nullopt;
+}
+
+void glyph_cache::store(uint64_t key, gsl::span<uint8_t const> value)
+{
+    if (_index.contains(key))
+        return;
+
+    auto record = std::make_unique<std::vector<uint8_t>>(alignedSize(RecordHeaderSize + value.size()));
+    auto* data = record->data();
+    auto const size = static_cast<uint32_t>(value.size());
+    auto const sum = checksum(key, value);
+    std::memcpy(data, &key, sizeof(key));
+    std::memcpy(data + 8, &size, sizeof(size));
+    std::memcpy(data + 12, &sum, sizeof(sum));
+    std::copy(value.begin(), value.end(), data + RecordHeaderSize);
+
+    // Records are written with a single call, so that processes sharing the file do not interleave them.
+    if (_fd >= 0 && _fileSize + record->size() <= _maxFileSize)
+    {
+        if (writeFile(_fd, record->data(), record->size()))
+            _fileSize += record->size();
+        else
+            errorLog()("Failed to write to glyph cache file {}.", _path.string());
+    }
+
+    _index.emplace(key, gsl::span<uint8_t const>(data + RecordHeaderSize, value.size()));
+    _appended.emplace_back(std::move(record));
+    ++_stats.stores;
+    _stats.entries = _index.size();
+}
+
+} // namespace text
@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <crispy/FNV.h>
+
+#include <gsl/span>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace text
+{
+
+struct glyph_cache_stats
+{
+    size_t entries = 0; //!< number of entries available
+    size_t hits = 0;    //!< number of lookups that found an entry
+    size_t misses = 0;  //!< number of lookups that did not find an entry
+    size_t stores = 0;  //!< number of entries added by this process
+};
+
+/**
+ * Persistent key/value store for rasterized glyphs and text shaping results.
+ *
+ * The cache file is memory-mapped when opened, and new entries are appended to it,
+ * so that later processes start with everything earlier ones have already computed.
+ * Keys must therefore identify their values across processes, i.e. must not be derived from
+ * process-local identifiers such as font_key.
+ *
+ * The file is an append-only sequence of checksummed records. Records that are incomplete or
+ * corrupt (e.g. due to a crash or concurrent writers) and everything behind them are dropped
+ * the next time the file is opened, and a file that exceeds its size limit is started afresh then.
+ * Either way the file is replaced rather than modified, as other processes may still have it mapped.
+ */
+class glyph_cache
+{
+  public:
+    static constexpr size_t default_max_file_size = 64 * 1024 * 1024;
+
+    /// Opens (or creates) the given cache file.
+    ///
+    /// @returns the cache or nullptr if the file could not be opened.
+    [[nodiscard]] static std::unique_ptr<glyph_cache> open(std::filesystem::path const& path,
+                                                           size_t maxFileSize = default_max_file_size);
+
+    ~glyph_cache();
+
+    glyph_cache(glyph_cache const&) = delete;
+    glyph_cache(glyph_cache&&) = delete;
+    glyph_cache& operator=(glyph_cache const&) = delete;
+    glyph_cache& operator=(glyph_cache&&) = delete;
+
+    /// Looks up the value stored for the given key.
+    ///
+    /// The returned view stays valid for the lifetime of this cache.
+    [[nodiscard]] std::optional<gsl::span<uint8_t const>> find(uint64_t key);
+
+    /// Stores the given value, unless a value is stored for the given key already.
+    void store(uint64_t key, gsl::span<uint8_t const> value);
+
+    [[nodiscard]] glyph_cache_stats const& stats() const noexcept { return _stats; }
+    [[nodiscard]] std::filesystem::path const& path() const noexcept { return _path; }
+
+  private:
+    glyph_cache(std::filesystem::path path, int fd, size_t maxFileSize);
+
+    void map_file();
+
+    /// Replaces the cache file with a new one, containing the given (already validated) records.
+    void replace_file(gsl::span<uint8_t const> records);
+
+    std::filesystem::path _path;
+    int _fd = -1; // Or -1 if the file cannot be appended to.
+    size_t _maxFileSize;
+    size_t _fileSize = 0; // Size of the valid part of the file, including appended records.
+
+    uint8_t const* _mapping = nullptr; // The file contents at the time of opening, if any.
+    size_t _mappingSize = 0;
+
+    std::unordered_map<uint64_t, gsl::span<uint8_t const>> _index;
+    std::vector<std::unique_ptr<std::vector<uint8_t>>> _appended; // Values stored by this process.
+
+    glyph_cache_stats _stats;
+};
+
+/// Incrementally computes a 64-bit FNV-1a hash to be used as glyph_cache key.
+class glyph_cache_key
+{
+  public:
+    glyph_cache_key& add(gsl::span<uint8_t const> bytes) noexcept
+    {
+        for (auto const byte: bytes)
+            _value = _fnv(_value, byte);
+        return *this;
+    }
+
+    template <typename T>
+    glyph_cache_key& add(T const& value) noexcept
+        requires(std::is_trivially_copyable_v<T>)
+    {
+        return add(gsl::span(reinterpret_cast<uint8_t const*>(&value), sizeof(value)));
+    }
+
+    glyph_cache_key& add(std::string const& value) noexcept
+    {
+        add(value.size());
+        return add(gsl::span(reinterpret_cast<uint8_t const*>(value.data()), value.size()));
+    }
+
+    [[nodiscard]] uint64_t value() const noexcept { return _value; }
+
+  private:
+    crispy::fnv<uint8_t, uint64_t> _fnv { 0x100000001b3ull, 0xcbf29ce484222325ull };
+    uint64_t _value = _fnv.basis();
+};
+
+} // namespace text
@@ -0,0 +1,127 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <text_shaper/glyph_cache.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+fs::path cachePath(std::string const& name)
+{
+    auto const path = fs::temp_directory_path() / ("contour-glyph_cache-test-" + name + ".bin");
+    fs::remove(path);
+    return path;
+}
+
+std::vector<uint8_t> valueOf(text::glyph_cache& cache, uint64_t key)
+{
+    auto const value = cache.find(key);
+    if (!value)
+        return {};
+    return { value->begin(), value->end() };
+}
+
+auto const valueA = std::vector<uint8_t> { 1, 2, 3 };
+auto const valueB = std::vector<uint8_t> { 4, 5, 6, 7, 8, 9, 10, 11, 12 };
+
+// File header (8 bytes), followed by record A (16 bytes record header, 3 bytes value, padded to 8 bytes).
+constexpr auto RecordBOffset = 8 + 24;
+
+} // namespace
+
+TEST_CASE("glyph_cache.round_trip", "[glyph_cache]")
+{
+    auto const path = cachePath("round_trip");
+    {
+        auto cache = text::glyph_cache::open(path);
+        REQUIRE(cache);
+        CHECK(cache->stats().entries == 0);
+        cache->store(1, valueA);
+        cache->store(2, valueB);
+        CHECK(valueOf(*cache, 1) == valueA);
+        CHECK(cache->stats().stores == 2);
+    }
+
+    auto cache = text::glyph_cache::open(path);
+    REQUIRE(cache);
+    CHECK(cache->stats().entries == 2);
+    CHECK(valueOf(*cache, 1) == valueA);
+    CHECK(valueOf(*cache, 2) == valueB);
+    CHECK_FALSE(cache->find(3).has_value());
+    CHECK(cache->stats().hits == 2);
+    CHECK(cache->stats().misses == 1);
+
+    cache.reset();
+    fs::remove(path);
+}
+
+TEST_CASE("glyph_cache.partial_trailing_record", "[glyph_cache]")
+{
+    auto const path = cachePath("partial_trailing_record");
+    {
+        auto cache = text::glyph_cache::open(path);
+        REQUIRE(cache);
+        cache->store(1, valueA);
+    }
+    auto const validSize = fs::file_size(path);
+
+    // A record that was cut short, e.g. by a crash while writing it.
+    auto const partialRecord = std::array<char, 10> { 2, 0, 0, 0, 0, 0, 0, 0, 9, 0 };
+    std::ofstream(path, std::ios::binary | std::ios::app).write(partialRecord.data(), partialRecord.size());
+
+    auto first = text::glyph_cache::open(path);
+    REQUIRE(first);
+    CHECK(first->stats().entries == 1);
+    CHECK(valueOf(*first, 1) == valueA);
+    CHECK(fs::file_size(path) == validSize);
+
+    // Records appended after dropping the partial one are read again,
+    // and entries already read by earlier opened caches are left untouched.
+    first->store(2, valueB);
+    auto second = text::glyph_cache::open(path);
+    REQUIRE(second);
+    CHECK(second->stats().entries == 2);
+    CHECK(valueOf(*second, 2) == valueB);
+    CHECK(valueOf(*first, 1) == valueA);
+
+    first.reset();
+    second.reset();
+    fs::remove(path);
+}
+
+TEST_CASE("glyph_cache.corrupt_trailing_record", "[glyph_cache]")
+{
+    auto const path = cachePath("corrupt_trailing_record");
+    {
+        auto cache = text::glyph_cache::open(path);
+        REQUIRE(cache);
+        cache->store(1, valueA);
+        cache->store(2, valueB);
+    }
+
+    // Flips a byte in the value of the last record, so that its checksum no longer matches.
+    {
+        auto file = std::fstream(path, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(RecordBOffset + 16);
+        file.put(char(0xFF));
+    }
+
+    auto cache = text::glyph_cache::open(path);
+    REQUIRE(cache);
+    CHECK(cache->stats().entries == 1);
+    CHECK(valueOf(*cache, 1) == valueA);
+    CHECK_FALSE(cache->find(2).has_value());
+    CHECK(fs::file_size(path) == RecordBOffset);
+
+    cache.reset();
+    fs::remove(path);
+}
@@ -1,11 +1,13 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <text_shaper/font.h>
 #include <text_shaper/font_locator.h>
+#include <text_shaper/glyph_cache.h>
 #include <text_shaper/open_shaper.h>
 
 #include <crispy/algorithm.h>
 #include <crispy/assert.h>
 #include <crispy/times.h>
+#include <crispy/utils.h>
 
 #include <libunicode/convert.h>
 #include <libunicode/ucd_fmt.h>
@@ -35,8 +37,12 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
 #include <sstream>
 #include <stdexcept>
+#include <thread>
 #include <tuple>
 #include <unordered_map>
 #include <utility>
@@ -54,6 +60,7 @@ using std::optional;
 using std::ostringstream;
 using std::pair;
 using std::runtime_error;
+using std::shared_ptr;
 using std::size_t;
 using std::string;
 using std::string_view;
@@ -115,6 +122,8 @@ struct HbFontInfo // NOLINT(readability-identifier-naming)
     hb_font_ptr hbFont;
     std::optional<font_metrics> metrics {};
     font_description description {};
+    uint64_t cacheId = 0;      // Identifies this font (file, size and DPI) in the glyph_cache.
+    uint64_t shapeCacheId = 0; // Identifies this font along with its fallbacks and features.
 };
 
 namespace
@@ -322,6 +331,167 @@ namespace
                 gpos.glyph.index = glyph_index { missingGlyph };
     }
 
+    /// Rasterizes the given glyph of the given face, which must have been loaded into the given library.
+    optional<rasterized_glyph> rasterizeGlyph(FT_Library ft,
+                                              FT_Face ftFace,
+                                              glyph_key glyph,
+                                              render_mode mode)
+    {
+        auto const glyphIndex = glyph.index;
+        auto const flags =
+            static_cast<FT_Int32>(ftRenderFlag(mode) | (FT_HAS_COLOR(ftFace) ? FT_LOAD_COLOR : 0));
+
+        FT_Error ec = FT_Load_Glyph(ftFace, glyphIndex.value, flags);
+        if (ec != FT_Err_Ok)
+        {
+            auto const missingGlyph = FT_Get_Char_Index(ftFace, MissingGlyphId);
+
+            if (missingGlyph)
+                ec = FT_Load_Glyph(ftFace, missingGlyph, flags);
+
+            if (ec != FT_Err_Ok)
+            {
+                if (locatorLog)
+                    locatorLog()("Error loading glyph index {} for font {} {}. {}",
+                                 glyphIndex.value,
+                                 ftFace->family_name,
+                                 ftFace->style_name,
+                                 ftErrorStr(ec));
+                return nullopt;
+            }
+        }
+
+        // NB: colored fonts are bitmap fonts, they do not need rendering
+        if (!FT_HAS_COLOR(ftFace))
+        {
+            if (FT_Render_Glyph(ftFace->glyph, ftRenderMode(mode)) != FT_Err_Ok)
+            {
+                rasterizerLog()("Failed to rasterize glyph {}.", glyph);
+                return nullopt;
+            }
+        }
+
+        auto output = rasterized_glyph {};
+        output.bitmapSize.width = vtbackend::Width::cast_from(ftFace->glyph->bitmap.width);
+        output.bitmapSize.height = vtbackend::Height::cast_from(ftFace->glyph->bitmap.rows);
+        output.position.x = ftFace->glyph->bitmap_left;
+        output.position.y = ftFace->glyph->bitmap_top;
+
+        switch (ftFace->glyph->bitmap.pixel_mode)
+        {
+            case FT_PIXEL_MODE_MONO: {
+                auto const width = output.bitmapSize.width;
+                auto const height = output.bitmapSize.height;
+
+                // convert mono to gray
+                FT_Bitmap ftBitmap;
+                FT_Bitmap_Init(&ftBitmap);
+
+                auto const ec = FT_Bitmap_Convert(ft, &ftFace->glyph->bitmap, &ftBitmap, 1);
+                if (ec != FT_Err_Ok)
+                    return nullopt;
+
+                ftBitmap.num_grays = 256;
+
+                output.format = bitmap_format::alpha_mask;
+                output.bitmap.resize(height.as<size_t>()
+                                     * width.as<size_t>()); // 8-bit channel (with values 0 or 255)
+
+                auto const pitch = static_cast<size_t>(ftBitmap.pitch);
+                for (auto const i: iota(size_t { 0 }, static_cast<size_t>(ftBitmap.rows)))
+                    for (auto const j: iota(size_t { 0 }, static_cast<size_t>(ftBitmap.width)))
+                        output.bitmap[i * width.as<size_t>() + j] =
+                            min(static_cast<uint8_t>(uint8_t(ftBitmap.buffer[i * pitch + j]) * 255),
+                                uint8_t { 255 });
+
+                FT_Bitmap_Done(ft, &ftBitmap);
+                break;
+            }
+            case FT_PIXEL_MODE_GRAY: {
+                output.format = bitmap_format::alpha_mask;
+                output.bitmap.resize(unbox<size_t>(output.bitmapSize.height)
+                                     * unbox<size_t>(output.bitmapSize.width));
+
+                auto const pitch = static_cast<unsigned>(ftFace->glyph->bitmap.pitch);
+                auto const* const s = ftFace->glyph->bitmap.buffer;
+                for (auto const i: iota(0u, *output.bitmapSize.height))
+                    for (auto const j: iota(0u, *output.bitmapSize.width))
+                        output.bitmap[i * *output.bitmapSize.width + j] = s[i * pitch + j];
+                break;
+            }
+            case FT_PIXEL_MODE_LCD: {
+                auto const& ftBitmap = ftFace->glyph->bitmap;
+                // rasterizerLog()("Rasterizing using pixel mode: {}, rows={}, width={}, pitch={}, mode={}",
+                //                 "lcd",
+                //                 ftBitmap.rows,
+                //                 ftBitmap.width / 3,
+                //                 ftBitmap.pitch,
+                //                 ftBitmap.pixel_mode);
+
+                output.format = bitmap_format::rgb; // LCD
+                output.bitmap.resize(static_cast<size_t>(ftBitmap.width)
+                                     * static_cast<size_t>(ftBitmap.rows));
+                output.bitmapSize.width /= vtbackend::Width(3);
+
+                auto const* s = ftBitmap.buffer;
+                auto* t = output.bitmap.data();
+                if (ftBitmap.width == static_cast<unsigned>(std::abs(ftBitmap.pitch)))
+                {
+                    std::copy_n(s, ftBitmap.width * ftBitmap.rows, t);
+                }
+                else
+                {
+                    for (auto const _: iota(0u, ftBitmap.rows))
+                    {
+                        crispy::ignore_unused(_);
+                        std::copy_n(s, ftBitmap.width, t);
+                        s += ftBitmap.pitch;
+                        t += ftBitmap.width;
+                    }
+                }
+                break;
+            }
+            case FT_PIXEL_MODE_BGRA: {
+                auto const width = output.bitmapSize.width;
+                auto const height = output.bitmapSize.height;
+                // rasterizerLog()("rasterize.RGBA: {} + {}\n", output.bitmapSize, output.position);
+
+                output.format = bitmap_format::rgba;
+                output.bitmap.resize(output.bitmapSize.area() * 4);
+                auto t = output.bitmap.begin();
+
+                auto const pitch = static_cast<unsigned>(ftFace->glyph->bitmap.pitch);
+                for (auto const i: iota(0u, height.as<size_t>()))
+                {
+                    for (auto const j: iota(0u, width.as<size_t>()))
+                    {
+                        auto const* s =
+                            &ftFace->glyph->bitmap
+                                 .buffer[static_cast<size_t>(i) * pitch + static_cast<size_t>(j) * 4u];
+
+                        // BGRA -> RGBA
+                        *t++ = s[2];
+                        *t++ = s[1];
+                        *t++ = s[0];
+                        *t++ = s[3];
+                    }
+                }
+                break;
+            }
+            default:
+                rasterizerLog()("Glyph requested that has an unsupported pixel_mode:{}",
+                                ftFace->glyph->bitmap.pixel_mode);
+                return nullopt;
+        }
+
+        Ensures(output.valid());
+
+        if (rasterizerLog)
+            rasterizerLog()("rasterize {} to {}", glyph, output);
+
+        return output;
+    }
+
     void prepareBuffer(hb_buffer_t* hbBuf,
                        u32string_view codepoints,
                        gsl::span<unsigned> clusters,
@@ -394,6 +564,118 @@ namespace
 
         return crispy::none_of(result, glyphMissing);
     }
+
+    // {{{ glyph_cache helpers
+    /// Identifies the given font in the glyph_cache across processes.
+    ///
+    /// Font files are identified by their path, size and modification time rather than their contents,
+    /// so that no font file needs to be read in full just to compute its identity.
+    uint64_t cacheIdentityOf(font_source const& source, font_size size, DPI dpi)
+    {
+        auto key = glyph_cache_key {};
+        if (holds_alternative<font_path>(source))
+        {
+            auto const& path = get<font_path>(source);
+            auto ec = std::error_code {};
+            auto const fileSize = std::filesystem::file_size(path.value, ec);
+            auto const lastWriteTime = std::filesystem::last_write_time(path.value, ec);
+            key.add(path.value).add(path.collectionIndex).add(fileSize);
+            key.add(lastWriteTime.time_since_epoch().count());
+        }
+        else if (holds_alternative<font_memory_ref>(source))
+        {
+            auto const& memory = get<font_memory_ref>(source);
+            key.add(memory.identifier).add(gsl::span<uint8_t const>(memory.data));
+        }
+        return key.add(size.pt).add(dpi.x).add(dpi.y).value();
+    }
+
+    uint64_t shapeCacheIdentityOf(HbFontInfo const& fontInfo)
+    {
+        auto key = glyph_cache_key {};
+        key.add(fontInfo.cacheId).add(fontInfo.fallbacks.size());
+        for (font_source const& fallback: fontInfo.fallbacks)
+            key.add(identifierOf(fallback));
+        key.add(fontInfo.description.features.size());
+        for (font_feature const& feature: fontInfo.description.features)
+            key.add(feature.name).add(feature.enabled);
+        key.add(fontInfo.description.strictSpacing).add(fontInfo.description.spacing);
+        return key.value();
+    }
+
+    uint64_t rasterizeCacheKey(uint64_t fontCacheId, glyph_index glyph, render_mode mode)
+    {
+        return glyph_cache_key {}.add('R').add(fontCacheId).add(mode).add(glyph.value).value();
+    }
+
+    uint64_t shapeCacheKey(HbFontInfo const& fontInfo,
+                           unicode::Script script,
+                           unicode::PresentationStyle presentation,
+                           u32string_view codepoints,
+                           gsl::span<unsigned> clusters)
+    {
+        auto key = glyph_cache_key {};
+        key.add('S').add(fontInfo.shapeCacheId).add(script).add(presentation).add(codepoints.size());
+        key.add(gsl::span(reinterpret_cast<uint8_t const*>(codepoints.data()), codepoints.size_bytes()));
+        // Only the relative cluster values affect shaping, so the same text shapes identically anywhere.
+        for (auto const cluster: clusters)
+            key.add(cluster - clusters[0]);
+        return key.value();
+    }
+
+    template <typename T>
+    void appendTo(vector<uint8_t>& buffer, T value)
+    {
+        auto const* bytes = reinterpret_cast<uint8_t const*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    bool readFrom(gsl::span<uint8_t const>& buffer, T& value)
+    {
+        if (buffer.size() < sizeof(T))
+            return false;
+        std::memcpy(&value, buffer.data(), sizeof(T));
+        buffer = buffer.subspan(sizeof(T));
+        return true;
+    }
+
+    vector<uint8_t> serialize(rasterized_glyph const& glyph)
+    {
+        auto buffer = vector<uint8_t> {};
+        buffer.reserve(17 + glyph.bitmap.size());
+        appendTo(buffer, unbox<uint32_t>(glyph.bitmapSize.width));
+        appendTo(buffer, unbox<uint32_t>(glyph.bitmapSize.height));
+        appendTo(buffer, static_cast<int32_t>(glyph.position.x));
+        appendTo(buffer, static_cast<int32_t>(glyph.position.y));
+        appendTo(buffer, glyph.format);
+        buffer.insert(buffer.end(), glyph.bitmap.begin(), glyph.bitmap.end());
+        return buffer;
+    }
+
+    optional<rasterized_glyph> deserializeRasterizedGlyph(gsl::span<uint8_t const> buffer)
+    {
+        auto width = uint32_t {};
+        auto height = uint32_t {};
+        auto x = int32_t {};
+        auto y = int32_t {};
+        auto format = bitmap_format {};
+        if (!readFrom(buffer, width) || !readFrom(buffer, height) || !readFrom(buffer, x)
+            || !readFrom(buffer, y) || !readFrom(buffer, format) || format > bitmap_format::rgba)
+            return nullopt;
+
+        auto output = rasterized_glyph {};
+        output.bitmapSize.width = vtbackend::Width::cast_from(width);
+        output.bitmapSize.height = vtbackend::Height::cast_from(height);
+        output.position.x = x;
+        output.position.y = y;
+        output.format = format;
+        output.bitmap.assign(buffer.begin(), buffer.end());
+        if (!output.valid())
+            return nullopt;
+        return output;
+    }
+    // }}}
 } // namespace
 
 struct open_shaper::private_open_shaper // {{{
@@ -415,6 +697,125 @@ struct open_shaper::private_open_shaper // {{{
     hb_buffer_ptr hbBuf;
     font_key nextFontKey;
 
+    // Persistent cache of rasterized glyphs and shaping results, shared with other shapers (optional).
+    shared_ptr<glyph_cache> glyphCache;
+    std::mutex glyphCacheLock; // Guards glyphCache, as glyphs may be rasterized concurrently.
+
+    // {{{ concurrent rasterization
+    // FreeType faces must not be used by multiple threads at once. Therefore every thread rasterizing
+    // concurrently loads the fonts once more into a FreeType library of its own.
+    struct concurrent_font
+    {
+        font_source source;
+        font_size size;
+        DPI dpi;
+        uint64_t cacheId;
+    };
+
+    struct rasterizer_context
+    {
+        FT_Library ft {};
+        uint64_t generation = 0;
+        unordered_map<font_key, ft_face_ptr> faces {};
+
+        rasterizer_context(rasterizer_context const&) = delete;
+        rasterizer_context& operator=(rasterizer_context const&) = delete;
+        rasterizer_context()
+        {
+            if (auto const ec = FT_Init_FreeType(&ft); ec != FT_Err_Ok)
+                throw runtime_error { "freetype: Failed to initialize. "s + ftErrorStr(ec) };
+            if (auto const ec = FT_Library_SetLcdFilter(ft, FT_LCD_FILTER_DEFAULT); ec != FT_Err_Ok)
+                errorLog()("freetype: Failed to set LCD filter. {}", ftErrorStr(ec));
+        }
+        ~rasterizer_context()
+        {
+            faces.clear();
+            FT_Done_FreeType(ft);
+        }
+    };
+
+    std::mutex concurrentLock; // Guards the members below.
+    unordered_map<font_key, concurrent_font> concurrentFonts;
+    uint64_t concurrentFontsGeneration = 0; // Incremented whenever fonts are unloaded.
+    unordered_map<std::thread::id, unique_ptr<rasterizer_context>> rasterizerContexts;
+
+    void addConcurrentFont(font_key key, concurrent_font font)
+    {
+        auto const _ = std::scoped_lock { concurrentLock };
+        concurrentFonts.emplace(key, std::move(font));
+    }
+
+    void clearConcurrentFonts()
+    {
+        auto const _ = std::scoped_lock { concurrentLock };
+        concurrentFonts.clear();
+        ++concurrentFontsGeneration;
+    }
+
+    void unloadConcurrentFonts(font_size size)
+    {
+        auto const _ = std::scoped_lock { concurrentLock };
+        std::erase_if(concurrentFonts, [size](auto const& entry) { return entry.second.size.pt == size.pt; });
+        ++concurrentFontsGeneration;
+    }
+
+    struct concurrent_face
+    {
+        FT_Library ft;
+        FT_Face face;
+        uint64_t cacheId;
+    };
+
+    /// Retrieves the calling thread's FreeType face of the given font, if available.
+    optional<concurrent_face> concurrentFace(font_key key)
+    {
+        auto lock = std::unique_lock { concurrentLock };
+        auto const font = concurrentFonts.find(key);
+        if (font == concurrentFonts.end())
+            return nullopt;
+        auto const fontInfo = font->second;
+        auto const generation = concurrentFontsGeneration;
+        auto& context = rasterizerContexts[std::this_thread::get_id()];
+        if (!context)
+            context = std::make_unique<rasterizer_context>();
+        lock.unlock();
+
+        // The context is only ever used by the calling thread, so it is safe to use it unlocked.
+        if (context->generation != generation)
+        {
+            context->faces.clear();
+            context->generation = generation;
+        }
+        auto face = context->faces.find(key);
+        if (face == context->faces.end())
+        {
+            auto ftFace = loadFace(fontInfo.source, fontInfo.size, fontInfo.dpi, context->ft);
+            face = context->faces
+                       .emplace(key, ftFace ? std::move(*ftFace) : ft_face_ptr(nullptr, [](FT_Face) {}))
+                       .first;
+        }
+        if (!face->second)
+            return nullopt;
+
+        return concurrent_face { context->ft, face->second.get(), fontInfo.cacheId };
+    }
+    // }}}
+
+    optional<rasterized_glyph> findCachedGlyph(uint64_t key)
+    {
+        auto const _ = std::scoped_lock { glyphCacheLock };
+        if (auto const cached = glyphCache->find(key); cached.has_value())
+            return deserializeRasterizedGlyph(*cached);
+        return nullopt;
+    }
+
+    void storeCachedGlyph(uint64_t key, rasterized_glyph const& glyph)
+    {
+        auto const buffer = serialize(glyph);
+        auto const _ = std::scoped_lock { glyphCacheLock };
+        glyphCache->store(key, buffer);
+    }
+
     font_key create_font_key()
     {
         auto result = nextFontKey;
@@ -451,8 +852,11 @@ struct open_shaper::private_open_shaper // {{{
             hb_font_ptr(hb_ft_font_create_referenced(ftFacePtr.get()), [](auto p) { hb_font_destroy(p); });
 
         auto fontInfo = HbFontInfo { source, {}, fontSize, std::move(ftFacePtr), std::move(hbFontPtr) };
+        if (glyphCache)
+            fontInfo.cacheId = cacheIdentityOf(source, fontSize, dpi);
 
         auto key = create_font_key();
+        addConcurrentFont(key, concurrent_font { source, fontSize, dpi, fontInfo.cacheId });
         fontPathAndSizeToKeyMapping.emplace(pair { FontInfo { sourceId, fontSize, fontWeight }, key });
         fontKeyToHbFontInfoMapping.emplace(pair { key, std::move(fontInfo) });
         locatorLog()(
@@ -479,14 +883,15 @@ struct open_shaper::private_open_shaper // {{{
         return output;
     }
 
-    private_open_shaper(DPI dpi, font_locator& locator):
+    private_open_shaper(DPI dpi, font_locator& locator, shared_ptr<glyph_cache> glyphCache):
         ftCleanup { [this]() {
             FT_Done_FreeType(ft);
         } },
         locator { &locator },
         dpi { dpi },
         hbBuf(hb_buffer_create(), [](auto p) { hb_buffer_destroy(p); }),
-        nextFontKey {}
+        nextFontKey {},
+        glyphCache { std::move(glyphCache) }
     {
         if (auto const ec = FT_Init_FreeType(&ft); ec != FT_Err_Ok)
             throw runtime_error { "freetype: Failed to initialize. "s + ftErrorStr(ec) };
@@ -551,10 +956,108 @@ struct open_shaper::private_open_shaper // {{{
 
         return false;
     }
+
+    // {{{ glyph_cache access
+    // A cached shape result is stored as a sequence of glyph records, each referring to the font it
+    // was shaped with by its position in the font list (0 for the primary font, i for the i-th fallback),
+    // along with that font's cache identity, as font keys are only meaningful within this process.
+    struct cached_glyph_position
+    {
+        uint64_t fontCacheId;
+        uint32_t fontIndex;
+        uint32_t glyphIndex;
+        int32_t offsetX;
+        int32_t offsetY;
+        int32_t advanceX;
+        int32_t advanceY;
+    };
+
+    [[nodiscard]] optional<uint32_t> fontIndexOf(font_key font,
+                                                 font_key primaryFont,
+                                                 HbFontInfo const& fontInfo) const
+    {
+        if (font == primaryFont)
+            return 0;
+        for (auto&& [i, fallback]: ranges::views::enumerate(fontInfo.fallbacks))
+        {
+            auto const fontKey = fontPathAndSizeToKeyMapping.find(
+                FontInfo { identifierOf(fallback), fontInfo.size, fontInfo.description.weight });
+            if (fontKey != fontPathAndSizeToKeyMapping.end() && fontKey->second == font)
+                return static_cast<uint32_t>(i + 1);
+        }
+        return nullopt;
+    }
+
+    void storeShapeResult(uint64_t key, font_key font, HbFontInfo const& fontInfo, shape_result const& result)
+    {
+        auto buffer = vector<uint8_t> {};
+        buffer.reserve(result.size() * sizeof(cached_glyph_position));
+        for (glyph_position const& gpos: result)
+        {
+            auto const fontIndex = fontIndexOf(gpos.glyph.font, font, fontInfo);
+            if (!fontIndex.has_value())
+                return;
+            appendTo(buffer,
+                     cached_glyph_position {
+                         .fontCacheId = fontKeyToHbFontInfoMapping.at(gpos.glyph.font).cacheId,
+                         .fontIndex = *fontIndex,
+                         .glyphIndex = gpos.glyph.index.value,
+                         .offsetX = gpos.offset.x,
+                         .offsetY = gpos.offset.y,
+                         .advanceX = gpos.advance.x,
+                         .advanceY = gpos.advance.y,
+                     });
+        }
+        auto const _ = std::scoped_lock { glyphCacheLock };
+        glyphCache->store(key, buffer);
+    }
+
+    bool loadShapeResult(uint64_t key,
+                         font_key font,
+                         HbFontInfo const& fontInfo,
+                         unicode::PresentationStyle presentation,
+                         shape_result& result)
+    {
+        auto buffer = [&]() {
+            auto const _ = std::scoped_lock { glyphCacheLock };
+            return glyphCache->find(key);
+        }();
+        if (!buffer.has_value() || buffer->size() % sizeof(cached_glyph_position) != 0)
+            return false;
+
+        auto const initialResultOffset = result.size();
+        auto cached = cached_glyph_position {};
+        while (readFrom(*buffer, cached))
+        {
+            auto fontKey = optional<font_key> { font };
+            if (cached.fontIndex != 0)
+            {
+                if (cached.fontIndex > fontInfo.fallbacks.size())
+                    fontKey = nullopt;
+                else
+                    fontKey = getOrCreateKeyForFont(
+                        fontInfo.fallbacks[cached.fontIndex - 1], fontInfo.size, fontInfo.description.weight);
+            }
+            if (!fontKey.has_value() || fontKeyToHbFontInfoMapping.at(*fontKey).cacheId != cached.fontCacheId)
+            {
+                result.resize(initialResultOffset);
+                return false;
+            }
+
+            glyph_position gpos {};
+            gpos.glyph = glyph_key { fontInfo.size, *fontKey, glyph_index { cached.glyphIndex } };
+            gpos.offset = crispy::point { cached.offsetX, cached.offsetY };
+            gpos.advance = crispy::point { cached.advanceX, cached.advanceY };
+            gpos.presentation = presentation;
+            result.emplace_back(gpos);
+        }
+        return true;
+    }
+    // }}}
 }; // }}}
 
-open_shaper::open_shaper(DPI dpi, font_locator& locator):
-    _d(new private_open_shaper(dpi, locator), [](private_open_shaper* p) { delete p; })
+open_shaper::open_shaper(DPI dpi, font_locator& locator, shared_ptr<glyph_cache> glyphCache):
+    _d(new private_open_shaper(dpi, locator, std::move(glyphCache)), [](private_open_shaper* p) { delete p; })
 {
 }
 
@@ -578,6 +1081,20 @@ void open_shaper::clear_cache()
                  _d->fontKeyToHbFontInfoMapping.size());
     _d->fontPathAndSizeToKeyMapping.clear();
     _d->fontKeyToHbFontInfoMapping.clear();
+    _d->clearConcurrentFonts();
+}
+
+void open_shaper::unload_fonts(font_size size)
+{
+    auto const isOfSize = [size](font_size other) {
+        return other.pt == size.pt;
+    };
+    auto const count = std::erase_if(_d->fontKeyToHbFontInfoMapping,
+                                     [&](auto const& entry) { return isOfSize(entry.second.size); });
+    std::erase_if(_d->fontPathAndSizeToKeyMapping,
+                  [&](auto const& entry) { return isOfSize(entry.first.size); });
+    _d->unloadConcurrentFonts(size);
+    locatorLog()("Unloaded {} fonts of size {}.", count, size);
 }
 
 optional<font_key> open_shaper::load_font(font_description const& description, font_size size)
@@ -595,6 +1112,8 @@ optional<font_key> open_shaper::load_font(font_description const& description, f
     HbFontInfo& fontInfo = _d->fontKeyToHbFontInfoMapping.at(*fontKeyOpt);
     fontInfo.fallbacks = std::move(sources);
     fontInfo.description = description;
+    if (_d->glyphCache)
+        fontInfo.shapeCacheId = shapeCacheIdentityOf(fontInfo);
 
     return fontKeyOpt;
 }
@@ -677,6 +1196,17 @@ void open_shaper::shape(font_key font,
         logMessage.append("Using font: key={}, path=\"{}\"\n", font, identifierOf(fontInfo.primary));
     }
 
+    auto const cacheKey =
+        _d->glyphCache && result.empty()
+            ? optional { shapeCacheKey(fontInfo, script, presentation, codepoints, clusters) }
+            : nullopt;
+    if (cacheKey && _d->loadShapeResult(*cacheKey, font, fontInfo, presentation, result))
+        return;
+    auto const storeInCache = crispy::finally { [&]() {
+        if (cacheKey)
+            _d->storeShapeResult(*cacheKey, font, fontInfo, result);
+    } };
+
     if (_d->tryShapeWithFallback(
             font, fontInfo, hbBuf, hbFont, script, presentation, codepoints, clusters, result))
         return;
@@ -724,156 +1254,38 @@ void open_shaper::shape(font_key font,
 
 optional<rasterized_glyph> open_shaper::rasterize(glyph_key glyph, render_mode mode)
 {
-    auto const font = glyph.font;
-    auto* ftFace = _d->fontKeyToHbFontInfoMapping.at(font).ftFace.get();
-    auto const glyphIndex = glyph.index;
-    auto const flags = static_cast<FT_Int32>(ftRenderFlag(mode) | (FT_HAS_COLOR(ftFace) ? FT_LOAD_COLOR : 0));
-
-    FT_Error ec = FT_Load_Glyph(ftFace, glyphIndex.value, flags);
-    if (ec != FT_Err_Ok)
-    {
-        auto const missingGlyph = FT_Get_Char_Index(ftFace, MissingGlyphId);
-
-        if (missingGlyph)
-            ec = FT_Load_Glyph(ftFace, missingGlyph, flags);
-
-        if (ec != FT_Err_Ok)
-        {
-            if (locatorLog)
-                locatorLog()("Error loading glyph index {} for font {} {}. {}",
-                             glyphIndex.value,
-                             ftFace->family_name,
-                             ftFace->style_name,
-                             ftErrorStr(ec));
-            return nullopt;
-        }
-    }
-
-    // NB: colored fonts are bitmap fonts, they do not need rendering
-    if (!FT_HAS_COLOR(ftFace))
-    {
-        if (FT_Render_Glyph(ftFace->glyph, ftRenderMode(mode)) != FT_Err_Ok)
-        {
-            rasterizerLog()("Failed to rasterize glyph {}.", glyph);
-            return nullopt;
-        }
-    }
-
-    auto output = rasterized_glyph {};
-    output.bitmapSize.width = vtbackend::Width::cast_from(ftFace->glyph->bitmap.width);
-    output.bitmapSize.height = vtbackend::Height::cast_from(ftFace->glyph->bitmap.rows);
-    output.position.x = ftFace->glyph->bitmap_left;
-    output.position.y = ftFace->glyph->bitmap_top;
-
-    switch (ftFace->glyph->bitmap.pixel_mode)
-    {
-        case FT_PIXEL_MODE_MONO: {
-            auto const width = output.bitmapSize.width;
-            auto const height = output.bitmapSize.height;
+    auto const& fontInfo = _d->fontKeyToHbFontInfoMapping.at(glyph.font);
 
-            // convert mono to gray
-            FT_Bitmap ftBitmap;
-            FT_Bitmap_Init(&ftBitmap);
+    auto const cacheKey =
+        _d->glyphCache ? optional { rasterizeCacheKey(fontInfo.cacheId, glyph.index, mode) } : nullopt;
+    if (cacheKey)
+        if (auto output = _d->findCachedGlyph(*cacheKey); output.has_value())
+            return output;
 
-            auto const ec = FT_Bitmap_Convert(_d->ft, &ftFace->glyph->bitmap, &ftBitmap, 1);
-            if (ec != FT_Err_Ok)
-                return nullopt;
-
-            ftBitmap.num_grays = 256;
-
-            output.format = bitmap_format::alpha_mask;
-            output.bitmap.resize(height.as<size_t>()
-                                 * width.as<size_t>()); // 8-bit channel (with values 0 or 255)
+    auto output = rasterizeGlyph(_d->ft, fontInfo.ftFace.get(), glyph, mode);
 
-            auto const pitch = static_cast<size_t>(ftBitmap.pitch);
-            for (auto const i: iota(size_t { 0 }, static_cast<size_t>(ftBitmap.rows)))
-                for (auto const j: iota(size_t { 0 }, static_cast<size_t>(ftBitmap.width)))
-                    output.bitmap[i * width.as<size_t>() + j] = min(
-                        static_cast<uint8_t>(uint8_t(ftBitmap.buffer[i * pitch + j]) * 255), uint8_t { 255 });
+    if (cacheKey && output.has_value())
+        _d->storeCachedGlyph(*cacheKey, *output);
 
-            FT_Bitmap_Done(_d->ft, &ftBitmap);
-            break;
-        }
-        case FT_PIXEL_MODE_GRAY: {
-            output.format = bitmap_format::alpha_mask;
-            output.bitmap.resize(unbox<size_t>(output.bitmapSize.height)
-                                 * unbox<size_t>(output.bitmapSize.width));
-
-            auto const pitch = static_cast<unsigned>(ftFace->glyph->bitmap.pitch);
-            auto const* const s = ftFace->glyph->bitmap.buffer;
-            for (auto const i: iota(0u, *output.bitmapSize.height))
-                for (auto const j: iota(0u, *output.bitmapSize.width))
-                    output.bitmap[i * *output.bitmapSize.width + j] = s[i * pitch + j];
-            break;
-        }
-        case FT_PIXEL_MODE_LCD: {
-            auto const& ftBitmap = ftFace->glyph->bitmap;
-            // rasterizerLog()("Rasterizing using pixel mode: {}, rows={}, width={}, pitch={}, mode={}",
-            //                 "lcd",
-            //                 ftBitmap.rows,
-            //                 ftBitmap.width / 3,
-            //                 ftBitmap.pitch,
-            //                 ftBitmap.pixel_mode);
-
-            output.format = bitmap_format::rgb; // LCD
-            output.bitmap.resize(static_cast<size_t>(ftBitmap.width) * static_cast<size_t>(ftBitmap.rows));
-            output.bitmapSize.width /= vtbackend::Width(3);
-
-            auto const* s = ftBitmap.buffer;
-            auto* t = output.bitmap.data();
-            if (ftBitmap.width == static_cast<unsigned>(std::abs(ftBitmap.pitch)))
-            {
-                std::copy_n(s, ftBitmap.width * ftBitmap.rows, t);
-            }
-            else
-            {
-                for (auto const _: iota(0u, ftBitmap.rows))
-                {
-                    crispy::ignore_unused(_);
-                    std::copy_n(s, ftBitmap.width, t);
-                    s += ftBitmap.pitch;
-                    t += ftBitmap.width;
-                }
-            }
-            break;
-        }
-        case FT_PIXEL_MODE_BGRA: {
-            auto const width = output.bitmapSize.width;
-            auto const height = output.bitmapSize.height;
-            // rasterizerLog()("rasterize.RGBA: {} + {}\n", output.bitmapSize, output.position);
+    return output;
+}
 
-            output.format = bitmap_format::rgba;
-            output.bitmap.resize(output.bitmapSize.area() * 4);
-            auto t = output.bitmap.begin();
+optional<rasterized_glyph> open_shaper::rasterize_concurrently(glyph_key glyph, render_mode mode)
+{
+    auto const face = _d->concurrentFace(glyph.font);
+    if (!face.has_value())
+        return nullopt;
 
-            auto const pitch = static_cast<unsigned>(ftFace->glyph->bitmap.pitch);
-            for (auto const i: iota(0u, height.as<size_t>()))
-            {
-                for (auto const j: iota(0u, width.as<size_t>()))
-                {
-                    auto const* s =
-                        &ftFace->glyph->bitmap
-                             .buffer[static_cast<size_t>(i) * pitch + static_cast<size_t>(j) * 4u];
-
-                    // BGRA -> RGBA
-                    *t++ = s[2];
-                    *t++ = s[1];
-                    *t++ = s[0];
-                    *t++ = s[3];
-                }
-            }
-            break;
-        }
-        default:
-            rasterizerLog()("Glyph requested that has an unsupported pixel_mode:{}",
-                            ftFace->glyph->bitmap.pixel_mode);
-            return nullopt;
-    }
+    auto const cacheKey =
+        _d->glyphCache ? optional { rasterizeCacheKey(face->cacheId, glyph.index, mode) } : nullopt;
+    if (cacheKey)
+        if (auto output = _d->findCachedGlyph(*cacheKey); output.has_value())
+            return output;
 
-    Ensures(output.valid());
+    auto output = rasterizeGlyph(face->ft, face->face, glyph, mode);
 
-    if (rasterizerLog)
-        rasterizerLog()("rasterize {} to {}", glyph, output);
+    if (cacheKey && output.has_value())
+        _d->storeCachedGlyph(*cacheKey, *output);
 
     return output;
 }
@@ -10,15 +10,21 @@ namespace text
 {
 
 class font_locator;
+class glyph_cache;
 
 /**
  * Text shaping and rendering engine using open source technologies,
  * fontconfig + harfbuzz + freetype.
+ *
+ * If a glyph_cache is given, rasterized glyphs and text shaping results are looked up there first,
+ * and newly computed ones are stored there.
+ *
+ * Concurrent rasterization loads each font once more per rasterizing thread.
  */
 class open_shaper: public shaper
 {
   public:
-    explicit open_shaper(DPI dpi, font_locator& locator);
+    explicit open_shaper(DPI dpi, font_locator& locator, std::shared_ptr<glyph_cache> glyphCache = {});
 
     void set_dpi(DPI dpi) override;
 
@@ -26,6 +32,8 @@ class open_shaper: public shaper
 
     void clear_cache() override;
 
+    void unload_fonts(font_size size) override;
+
     [[nodiscard]] std::optional<font_key> load_font(font_description const& description,
                                                     font_size size) override;
 
@@ -42,6 +50,11 @@ class open_shaper: public shaper
 
     [[nodiscard]] std::optional<rasterized_glyph> rasterize(glyph_key glyph, render_mode mode) override;
 
+    [[nodiscard]] bool supports_concurrent_rasterization() const noexcept override { return true; }
+
+    [[nodiscard]] std::optional<rasterized_glyph> rasterize_concurrently(glyph_key glyph,
+                                                                         render_mode mode) override;
+
   private:
     struct private_open_shaper;
     std::unique_ptr<private_open_shaper, void (*)(private_open_shaper*)> _d;
@@ -106,6 +106,13 @@ class shaper
      */
     virtual void clear_cache() = 0;
 
+    /**
+     * Unloads all fonts of the given size, including the fallback fonts loaded for them.
+     *
+     * The font keys of these fonts must not be used anymore.
+     */
+    virtual void unload_fonts(font_size size) = 0;
+
     /**
      * Returns a font matching the given font description.
      *
@@ -151,6 +158,27 @@ class shaper
      * @param mode  render technique to use.
      */
     [[nodiscard]] virtual std::optional<rasterized_glyph> rasterize(glyph_key glyph, render_mode mode) = 0;
+
+    /**
+     * Tells whether or not rasterize_concurrently() is supported by this shaper.
+     */
+    [[nodiscard]] virtual bool supports_concurrent_rasterization() const noexcept { return false; }
+
+    /**
+     * Rasterizes the glyph like rasterize(), but may be invoked from any thread, concurrently to
+     * each other as well as to all other member functions.
+     *
+     * Glyphs of fonts that have been unloaded via clear_cache() or unload_fonts() meanwhile
+     * are not rasterized.
+     *
+     * @param glyph glyph identifier.
+     * @param mode  render technique to use.
+     */
+    [[nodiscard]] virtual std::optional<rasterized_glyph> rasterize_concurrently(glyph_key /*glyph*/,
+                                                                                 render_mode /*mode*/)
+    {
+        return std::nullopt;
+    }
 };
 
 } // end namespace text
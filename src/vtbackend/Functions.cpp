@@ -31,6 +31,148 @@ using std::stringstream;
 namespace vtbackend
 {
 
+namespace
+{
+    constexpr uint32_t mixBits(uint32_t x) noexcept
+    {
+        x ^= x >> 16;
+        x *= 0x7feb352dU;
+        x ^= x >> 15;
+        x *= 0x846ca68bU;
+        x ^= x >> 16;
+        return x;
+    }
+
+    /// Perfect hash table (hash and displace) mapping the dispatch key of a function
+    /// to the range of functions in SortedFunctions sharing that key.
+    struct FunctionDispatchTable
+    {
+        static constexpr size_t BucketCount = 64;
+        static constexpr size_t SlotCount = 256;
+        static constexpr size_t MaxBucketSize = 16;
+        static constexpr uint32_t EmptyKey = 0xFFFFFFFF;
+
+        struct Slot
+        {
+            uint32_t key = EmptyKey;
+            uint16_t first = 0;
+            uint16_t count = 0;
+        };
+
+        std::array<uint16_t, BucketCount> displacements {};
+        std::array<Slot, SlotCount> slots {};
+        bool complete = false;
+
+        static constexpr size_t bucketOf(uint32_t key) noexcept { return mixBits(key) >> 26; }
+
+        static constexpr size_t slotOf(uint32_t key, uint32_t displacement) noexcept
+        {
+            return mixBits(key + (displacement * 0x9E3779B9U)) % SlotCount;
+        }
+
+        [[nodiscard]] constexpr Slot const& find(uint32_t key) const noexcept
+        {
+            return slots[slotOf(key, displacements[bucketOf(key)])];
+        }
+    };
+
+    constexpr FunctionDispatchTable buildFunctionDispatchTable() noexcept
+    {
+        using Table = FunctionDispatchTable;
+        auto table = Table {};
+
+        // Functions sharing the same key are adjacent, as the key fields are compared first.
+        auto groups = std::array<Table::Slot, FunctionCount> {};
+        auto groupCount = size_t { 0 };
+        for (size_t i = 0; i < FunctionCount; ++i)
+        {
+            auto const key = dispatchKey(SortedFunctions[i]);
+            if (groupCount && groups[groupCount - 1].key == key)
+                ++groups[groupCount - 1].count;
+            else
+                groups[groupCount++] = Table::Slot { key, static_cast<uint16_t>(i), 1 };
+        }
+        if (groupCount > Table::SlotCount)
+            return table;
+
+        // Order the groups by bucket.
+        auto bucketStart = std::array<size_t, Table::BucketCount + 1> {};
+        for (size_t i = 0; i < groupCount; ++i)
+            ++bucketStart[Table::bucketOf(groups[i].key) + 1];
+        for (size_t bucket = 0; bucket < Table::BucketCount; ++bucket)
+            bucketStart[bucket + 1] += bucketStart[bucket];
+        auto bucketed = std::array<Table::Slot, FunctionCount> {};
+        auto fill = bucketStart;
+        for (size_t i = 0; i < groupCount; ++i)
+            bucketed[fill[Table::bucketOf(groups[i].key)]++] = groups[i];
+
+        // Place the largest buckets first, each with the first displacement that maps
+        // all of its keys into distinct free slots.
+        for (size_t size = Table::MaxBucketSize; size > 0; --size)
+        {
+            for (size_t bucket = 0; bucket < Table::BucketCount; ++bucket)
+            {
+                auto const first = bucketStart[bucket];
+                auto const count = bucketStart[bucket + 1] - first;
+                if (count > Table::MaxBucketSize)
+                    return table;
+                if (count != size)
+                    continue;
+
+                auto placed = false;
+                for (uint32_t displacement = 0; displacement <= 0xFFFF && !placed; ++displacement)
+                {
+                    auto candidates = std::array<size_t, Table::MaxBucketSize> {};
+                    placed = true;
+                    for (size_t i = 0; i < count && placed; ++i)
+                    {
+                        candidates[i] = Table::slotOf(bucketed[first + i].key, displacement);
+                        placed = table.slots[candidates[i]].key == Table::EmptyKey;
+                        for (size_t k = 0; k < i && placed; ++k)
+                            placed = candidates[k] != candidates[i];
+                    }
+                    if (placed)
+                    {
+                        table.displacements[bucket] = static_cast<uint16_t>(displacement);
+                        for (size_t i = 0; i < count; ++i)
+                            table.slots[candidates[i]] = bucketed[first + i];
+                    }
+                }
+                if (!placed)
+                    return table;
+            }
+        }
+
+        table.complete = true;
+        return table;
+    }
+
+    constexpr auto FunctionDispatch = buildFunctionDispatchTable();
+    static_assert(FunctionDispatch.complete, "Failed to construct the perfect hash table of all functions.");
+} // namespace
+
+Function const* select(FunctionSelector const& selector, EnabledFunctions const& enabledFunctions) noexcept
+{
+    auto const key = dispatchKey(selector);
+    auto const& slot = FunctionDispatch.find(key);
+    if (slot.key != key)
+        return nullptr;
+
+    for (size_t i = slot.first; i < size_t { slot.first } + slot.count; ++i)
+    {
+        if (!enabledFunctions[i])
+            continue;
+
+        auto const& function = SortedFunctions[i];
+        if (selector.category == FunctionCategory::OSC ? selector.argc == function.maximumParameters
+                                                       : function.minimumParameters <= selector.argc
+                                                             && selector.argc <= function.maximumParameters)
+            return &function;
+    }
+
+    return nullptr;
+}
+
 Function const* select(FunctionSelector const& selector,
                        gsl::span<Function const> availableDefinitions) noexcept
 {
@@ -129,6 +129,8 @@ constexpr inline auto XTVERSION = FunctionDocumentation { .mnemonic = "XTVERSION
 // DCS
 constexpr inline auto DECRQSS = FunctionDocumentation { .mnemonic = "DECRQSS", .comment = "Request Status String" };
 constexpr inline auto DECSIXEL = FunctionDocumentation { .mnemonic = "DECSIXEL", .comment = "Sixel Graphics Image" };
+constexpr inline auto IMAGEFILE =
+    FunctionDocumentation { .mnemonic = "IMAGEFILE", .comment = "Display image from file or shared memory" };
 constexpr inline auto STP = FunctionDocumentation { .mnemonic = "STP", .comment = "Set Terminal Profile" };
 constexpr inline auto XTGETTCAP = FunctionDocumentation { .mnemonic = "XTGETTCAP", .comment = "Request Termcap/Terminfo String" };
 
@@ -317,6 +319,31 @@ constexpr int compare(FunctionSelector const& a, Function const& b) noexcept
     return 0;
 }
 
+/// Computes the key a function is looked up by when dispatching, i.e. all of its syntax
+/// but the accepted parameter count range, or, for OSC functions, the OSC code.
+constexpr uint32_t dispatchKey(
+    FunctionCategory category, char leader, char intermediate, char finalSymbol, unsigned oscCode) noexcept
+{
+    auto const key = static_cast<uint32_t>(category) << 24;
+
+    if (category == FunctionCategory::OSC)
+        return key | (oscCode & 0xFFFF);
+
+    return key | static_cast<uint32_t>(static_cast<uint8_t>(leader)) << 16
+           | static_cast<uint32_t>(static_cast<uint8_t>(intermediate)) << 8
+           | static_cast<uint32_t>(static_cast<uint8_t>(finalSymbol));
+}
+
+constexpr uint32_t dispatchKey(Function const& f) noexcept
+{
+    return dispatchKey(f.category, f.leader, f.intermediate, f.finalSymbol, f.maximumParameters);
+}
+
+constexpr uint32_t dispatchKey(FunctionSelector const& s) noexcept
+{
+    return dispatchKey(s.category, s.leader, s.intermediate, s.finalSymbol, static_cast<unsigned>(s.argc));
+}
+
 namespace detail // {{{
 {
     constexpr auto C0(char finalCharacter,
@@ -592,6 +619,8 @@ constexpr inline auto XTVERSION   = detail::CSI('>', 0, 1, std::nullopt, 'q', VT
 // DCS functions
 constexpr inline auto DECRQSS     = detail::DCS(std::nullopt, 0, 0, '$', 'q', VTType::VT420, documentation::DECRQSS);
 constexpr inline auto DECSIXEL    = detail::DCS(std::nullopt, 0, 3, std::nullopt, 'q', VTType::VT330, documentation::DECSIXEL);
+constexpr inline auto IMAGEFILE   =
+    detail::DCS(std::nullopt, 2, 4, '!', 'i', VTExtension::Contour, documentation::IMAGEFILE);
 constexpr inline auto STP         = detail::DCS(std::nullopt, 0, 0, '$', 'p', VTExtension::Contour, documentation::STP);
 constexpr inline auto XTGETTCAP   = detail::DCS(std::nullopt, 0, 0, '+', 'q', VTExtension::XTerm, documentation::XTGETTCAP);
 
@@ -748,6 +777,7 @@ constexpr static auto allFunctionsArray() noexcept
         STP,
         DECRQSS,
         DECSIXEL,
+        IMAGEFILE,
         XTGETTCAP,
 
         // OSC
@@ -781,17 +811,52 @@ constexpr static auto allFunctionsArray() noexcept
     return funcs;
 }
 
-inline auto allFunctions() noexcept
+/// All supported functions, sorted by compare().
+///
+/// The position of a function in this array is its function index.
+constexpr inline auto SortedFunctions = []() constexpr {
+    auto funcs = allFunctionsArray();
+    crispy::sort(funcs, [](Function const& a, Function const& b) constexpr { return compare(a, b); });
+    return funcs;
+}();
+
+constexpr inline size_t FunctionCount = SortedFunctions.size();
+
+/// Set of enabled functions, indexed by function index.
+using EnabledFunctions = std::array<bool, FunctionCount>;
+
+inline auto const& allFunctions() noexcept
 {
-    static auto const funcs = []() constexpr {
-        auto funcs = allFunctionsArray();
-        crispy::sort(funcs, [](Function const& a, Function const& b) constexpr { return compare(a, b); });
-        return funcs;
-    }();
+    return SortedFunctions;
+}
 
-    return funcs;
+/// @return the index of the given function in SortedFunctions, or FunctionCount if unknown.
+constexpr size_t functionIndex(Function const& function) noexcept
+{
+    auto a = size_t { 0 };
+    auto b = FunctionCount;
+    while (a < b)
+    {
+        auto const i = (a + b) / 2;
+        auto const rel = compare(function, SortedFunctions[i]);
+        if (rel > 0)
+            a = i + 1;
+        else if (rel < 0)
+            b = i;
+        else
+            return i;
+    }
+    return FunctionCount;
 }
 
+/// Selects a FunctionDefinition based on a FunctionSelector in constant time,
+/// using a perfect hash table over all functions that is computed at compile time.
+///
+/// If multiple enabled functions match, the one with the lowest function index is selected.
+///
+/// @return the matching enabled FunctionDefinition or nullptr if none matched.
+Function const* select(FunctionSelector const& selector, EnabledFunctions const& enabledFunctions) noexcept;
+
 // Class to store all supported VT sequence and support properly enabling/disabling them
 // The storage stores all available definition at all time and is partitioned into
 // two parts first part contains all active sequences and last part contains all
@@ -832,6 +897,9 @@ class SupportedSequences
         gsl::span<Function> availableDefinition(begin(), _lastIndex);
         crispy::sort(availableDefinition,
                      [](Function const& a, Function const& b) constexpr { return compare(a, b); });
+
+        for (size_t i = 0; i < FunctionCount; ++i)
+            _enabledFunctions[i] = SortedFunctions[i].conformanceLevel <= vt;
     }
 
     CRISPY_CONSTEXPR void disableSequence(Function seq) noexcept
@@ -842,6 +910,7 @@ class SupportedSequences
             // Move the disabled sequence to the end of array, keep the rest of active sequences sorted
             std::rotate(seqIter, seqIter + 1, _supportedSequences.data() + _supportedSequences.size());
             --_lastIndex;
+            _enabledFunctions[functionIndex(seq)] = false;
         }
     }
 
@@ -854,14 +923,28 @@ class SupportedSequences
             // Maybe could be done better since rest of the data is sorted
             std::iter_swap(end(), seqIter);
             ++_lastIndex;
+            _enabledFunctions[functionIndex(seq)] = true;
             gsl::span<Function> arr(begin(), end());
             crispy::sort(arr, [](Function const& a, Function const& b) constexpr { return compare(a, b); });
         }
     }
 
+    /// Selects the active function matching the given selector in constant time.
+    ///
+    /// @return the matching FunctionDefinition or nullptr if none matched.
+    [[nodiscard]] Function const* select(FunctionSelector const& selector) const noexcept
+    {
+        return vtbackend::select(selector, _enabledFunctions);
+    }
+
   private:
-    std::array<Function, allFunctionsArray().size()> _supportedSequences = allFunctions();
-    size_t _lastIndex = allFunctions().size(); // No of total active sequences
+    std::array<Function, FunctionCount> _supportedSequences = SortedFunctions;
+    size_t _lastIndex = FunctionCount; // No of total active sequences
+    EnabledFunctions _enabledFunctions = []() constexpr {
+        auto enabled = EnabledFunctions {};
+        enabled.fill(true);
+        return enabled;
+    }();
 };
 
 /// Selects a FunctionDefinition based on a FunctionSelector.
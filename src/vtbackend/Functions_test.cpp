@@ -92,3 +92,47 @@ TEST_CASE("Functions.EnableAndDisable", "[Functions]")
     REQUIRE(f);
     CHECK(*f == DECSLRM);
 }
+
+TEST_CASE("Functions.select.PerfectHash", "[Functions]")
+{
+    SupportedSequences const availableSequences;
+    for (auto const& function: availableSequences.allSequences())
+    {
+        INFO(fmt::format("{}", function));
+        auto const selector = FunctionSelector {
+            .category = function.category,
+            .leader = function.leader,
+            .argc = function.category == FunctionCategory::OSC ? function.maximumParameters
+                                                               : function.minimumParameters,
+            .intermediate = function.intermediate,
+            .finalSymbol = function.finalSymbol,
+        };
+        Function const* expected = vtbackend::select(selector, availableSequences.activeSequences());
+        Function const* actual = availableSequences.select(selector);
+        REQUIRE(actual);
+        REQUIRE(expected);
+        CHECK(*actual == *expected);
+    }
+
+    CHECK(!availableSequences.select(FunctionSelector { FunctionCategory::CSI, 0, 0, 0, '\x7F' }));
+    CHECK(!availableSequences.select(FunctionSelector { FunctionCategory::OSC, 0, 4242, 0, 0 }));
+}
+
+TEST_CASE("Functions.select.PerfectHash.EnableAndDisable", "[Functions]")
+{
+    SupportedSequences availableSequences;
+    availableSequences.disableSequence(DECSLRM);
+    Function const* f = availableSequences.select(FunctionSelector { FunctionCategory::CSI, 0, 0, 0, 's' });
+    REQUIRE(f);
+    CHECK(*f == SCOSC);
+    CHECK(!availableSequences.select(FunctionSelector { FunctionCategory::CSI, 0, 2, 0, 's' }));
+
+    availableSequences.enableSequence(DECSLRM);
+    availableSequences.disableSequence(SCOSC);
+    f = availableSequences.select(FunctionSelector { FunctionCategory::CSI, 0, 0, 0, 's' });
+    REQUIRE(f);
+    CHECK(*f == DECSLRM);
+
+    availableSequences.reset(VTType::VT100);
+    CHECK(!availableSequences.select(FunctionSelector { FunctionCategory::CSI, 0, 2, 0, 's' }));
+}
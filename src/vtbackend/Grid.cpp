@@ -8,7 +8,10 @@
 #include <fmt/format.h>
 
 #include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <limits>
+#include <thread>
 
 using std::max;
 using std::min;
@@ -25,12 +28,12 @@ auto const inline gridLog = logstore::category(
 namespace detail
 {
     template <CellConcept Cell>
-    gsl::span<Cell const> trimRight(gsl::span<Cell const> cells)
+    LineCells<Cell> trimRight(LineCells<Cell> const& cells)
     {
         size_t n = cells.size();
         while (n && CellUtil::empty(cells[n - 1]))
             --n;
-        return cells.subspan(0, n);
+        return cells.first(n);
     }
 
     template <CellConcept Cell>
@@ -96,6 +99,154 @@ namespace detail
         return LineCount::cast_from(i);
     }
 
+    /// Reflows lines to a larger column count by joining each logical line's wrapped lines
+    /// and splitting them up again at the new column count.
+    ///
+    /// @param targetLines       receives the reflowed lines
+    /// @param newColumnCount    column count to reflow to
+    /// @param lineCount         number of lines to reflow, the first one starting a logical line
+    /// @param takeLine          returns the line at the given index, from 0 to lineCount - 1
+    /// @param logicalLineFlags  line flags for continuation lines not preceded by an inflated line
+    template <CellConcept Cell, typename TakeLine>
+    void growLogicalLines(Lines<Cell>& targetLines,
+                          ColumnCount newColumnCount,
+                          size_t lineCount,
+                          TakeLine&& takeLine,
+                          LineFlags logicalLineFlags)
+    {
+        using LineBuffer = typename Line<Cell>::InflatedBuffer;
+
+        // Temporary state, representing wrapped columns from the line "below".
+        LineBuffer logicalLineBuffer;
+
+        auto const appendToLogicalLine = [&logicalLineBuffer](LineCells<Cell> const& cells) {
+            for (auto const& cell: cells)
+                logicalLineBuffer.push_back(cell);
+        };
+
+        auto const flushLogicalLine = [&]() {
+            if (!logicalLineBuffer.empty())
+            {
+                addNewWrappedLines(
+                    targetLines, newColumnCount, std::move(logicalLineBuffer), logicalLineFlags, true);
+                logicalLineBuffer.clear();
+            }
+        };
+
+        for (size_t i = 0; i < lineCount; ++i)
+        {
+            Line<Cell> line = takeLine(i);
+            if (line.wrapped())
+                appendToLogicalLine(line.trim_blank_right());
+            else // line is not wrapped
+            {
+                flushLogicalLine();
+                if (line.isTrivialBuffer())
+                {
+                    line.trivialBuffer().displayWidth = newColumnCount;
+                    targetLines.emplace_back(std::move(line));
+                }
+                else
+                {
+                    appendToLogicalLine(line.cells());
+                    logicalLineFlags = line.flags().without(LineFlag::Wrapped);
+                }
+            }
+        }
+
+        flushLogicalLine(); // Flush last (bottom) line, if anything pending.
+    }
+
+    /// Reflows lines to a smaller column count by wrapping the overflowing columns of wrappable lines
+    /// into their continuation lines, or into newly inserted ones.
+    ///
+    /// {{{ Shrinking progress
+    /// -----------------------------------------------------------------------
+    ///  (one-by-one)        | (from-5-to-2)
+    /// -----------------------------------------------------------------------
+    /// "ABCDE"              | "ABCDE"
+    /// "abcde"              | "xy   "
+    /// ->                   | "abcde"
+    /// "ABCD"               | ->
+    /// "E   "   Wrapped     | "AB"                  push "AB", wrap "CDE"
+    /// "abcd"               | "CD"      Wrapped     push "CD", wrap "E"
+    /// "e   "   Wrapped     | "E"       Wrapped     push "E",  inc line
+    /// ->                   | "xy"      no-wrapped  push "xy", inc line
+    /// "ABC"                | "ab"      no-wrapped  push "ab", wrap "cde"
+    /// "DE "    Wrapped     | "cd"      Wrapped     push "cd", wrap "e"
+    /// "abc"                | "e "      Wrapped     push "e",  inc line
+    /// "de "    Wrapped
+    /// ->
+    /// "AB"
+    /// "DE"     Wrapped
+    /// "E "     Wrapped
+    /// "ab"
+    /// "cd"     Wrapped
+    /// "e "     Wrapped
+    /// }}}
+    ///
+    /// @param targetLines     receives the reflowed lines
+    /// @param newColumnCount  column count to reflow to
+    /// @param lineCount       number of lines to reflow, the first one starting a logical line
+    /// @param takeLine        returns the line at the given index, from 0 to lineCount - 1
+    template <CellConcept Cell, typename TakeLine>
+    void shrinkLogicalLines(Lines<Cell>& targetLines,
+                            ColumnCount newColumnCount,
+                            size_t lineCount,
+                            TakeLine&& takeLine)
+    {
+        using LineBuffer = typename Line<Cell>::InflatedBuffer;
+
+        LineBuffer wrappedColumns;
+        LineFlags previousFlags = LineFlag::None;
+
+        for (size_t i = 0; i < lineCount; ++i)
+        {
+            Line<Cell> line = takeLine(i);
+
+            // do we have previous columns carried?
+            if (!wrappedColumns.empty())
+            {
+                if (line.wrapped() && line.inheritableFlags() == previousFlags)
+                {
+                    // Prepend previously wrapped columns into current line.
+                    auto& editable = line.inflatedBuffer();
+                    editable.insert(editable.begin(), wrappedColumns.begin(), wrappedColumns.end());
+                }
+                else
+                {
+                    // Insert NEW line(s) between previous and this line with previously wrapped columns.
+                    addNewWrappedLines(
+                        targetLines, newColumnCount, std::move(wrappedColumns), previousFlags, false);
+                    previousFlags = line.inheritableFlags();
+                }
+            }
+            else
+            {
+                previousFlags = line.inheritableFlags();
+            }
+
+            wrappedColumns = line.reflow(newColumnCount);
+
+            targetLines.emplace_back(std::move(line));
+            Ensures(targetLines.back().size() >= newColumnCount);
+        }
+        addNewWrappedLines(targetLines, newColumnCount, std::move(wrappedColumns), previousFlags, false);
+    }
+
+    /// @returns the line flags growLogicalLines() continues with after having reflowed the given lines.
+    template <CellConcept Cell, typename LineAt>
+    LineFlags logicalLineFlagsAfter(size_t lineCount, LineAt&& lineAt, LineFlags logicalLineFlags)
+    {
+        for (size_t i = 0; i < lineCount; ++i)
+        {
+            Line<Cell> const& line = lineAt(i);
+            if (!line.wrapped() && !line.isTrivialBuffer())
+                logicalLineFlags = line.flags().without(LineFlag::Wrapped);
+        }
+        return logicalLineFlags;
+    }
+
 } // namespace detail
 // {{{ Grid impl
 template <CellConcept Cell>
@@ -118,6 +269,15 @@ Grid<Cell>::Grid(PageSize pageSize, bool reflowOnResize, MaxHistoryLineCount max
     verifyState();
 }
 
+template <CellConcept Cell>
+Grid<Cell>::Grid(Grid&&) noexcept = default;
+
+template <CellConcept Cell>
+Grid<Cell>& Grid<Cell>::operator=(Grid&&) noexcept = default;
+
+template <CellConcept Cell>
+Grid<Cell>::~Grid() = default;
+
 template <CellConcept Cell>
 void Grid<Cell>::setMaxHistoryLineCount(MaxHistoryLineCount maxHistoryLineCount)
 {
@@ -126,13 +286,188 @@ void Grid<Cell>::setMaxHistoryLineCount(MaxHistoryLineCount maxHistoryLineCount)
     _historyLimit = maxHistoryLineCount;
     _lines.resize(unbox<size_t>(_pageSize.lines + this->maxHistoryLineCount()));
     _linesUsed = min(_linesUsed, _pageSize.lines + this->maxHistoryLineCount());
+    invalidateSearchIndex();
     verifyState();
 }
 
+template <CellConcept Cell>
+void Grid<Cell>::compressColdHistory(LineCount linesScrolledUp) noexcept
+{
+    // Maximum number of cold lines to check for having been inflated again per call.
+    auto constexpr ColdHistorySweepCount = 4;
+
+    if (!_hotHistoryPageCount)
+        return;
+
+    auto const hotLineCount = LineCount::cast_from(_hotHistoryPageCount * unbox<unsigned>(_pageSize.lines));
+    auto const historyCount = historyLineCount();
+    if (historyCount <= hotLineCount)
+        return;
+
+    // Lines being displayed or selected are left alone, as they would only be inflated again right away.
+    auto const compressUnlessRetained = [this](LineOffset line) {
+        auto const number = historyLineNumber(line);
+        if (number < _retainedLinesBegin || number >= _retainedLinesEnd)
+            lineAt(line).compress();
+    };
+
+    auto const coldLineCount = unbox<size_t>(historyCount - hotLineCount);
+    auto const bottomColdLine = -boxed_cast<LineOffset>(hotLineCount) - 1;
+    for (auto i = 0; i < std::min(*linesScrolledUp, static_cast<int>(coldLineCount)); ++i)
+        compressUnlessRetained(bottomColdLine - i);
+
+    // Lines inflated by searching, selecting, or scrolling through the history become cold again over time.
+    auto const topLine = -boxed_cast<LineOffset>(historyCount);
+    for (auto i = 0; i < ColdHistorySweepCount; ++i)
+    {
+        if (_coldHistorySweepIndex >= coldLineCount)
+            _coldHistorySweepIndex = 0;
+        compressUnlessRetained(topLine + LineOffset::cast_from(_coldHistorySweepIndex++));
+    }
+}
+
+template <CellConcept Cell>
+bool Grid<Cell>::updateSearchIndex(size_t maxLineCount)
+{
+    if (!_searchIndexer)
+        return true;
+
+    auto const historyCount = unbox<ScrollbackIndex::LineNumber>(historyLineCount());
+    if (_scrolledLineCount < historyCount)
+    {
+        // History lines have been added other than by scrolling, e.g. by resizing.
+        _scrolledLineCount = historyCount;
+        _searchIndexValid = false;
+    }
+
+    auto const firstLine = _scrolledLineCount - historyCount;
+    auto batch = ScrollbackIndexer::Batch { .reset = std::nullopt, .firstLine = firstLine, .lines = {} };
+    if (!_searchIndexValid)
+    {
+        batch.reset = firstLine;
+        _searchIndexNextLine = firstLine;
+        _searchIndexValid = true;
+    }
+
+    // Only the text is captured here, while the index is updated on the indexer's worker thread.
+    auto const first = std::min(std::max(_searchIndexNextLine, firstLine), _scrolledLineCount);
+    auto const last = first + std::min<ScrollbackIndex::LineNumber>(maxLineCount, _scrolledLineCount - first);
+    batch.lines.reserve(static_cast<size_t>(last - first));
+    for (auto number = first; number < last; ++number)
+    {
+        auto const& line = lineAt(historyLineOffset(number));
+        auto& entry = batch.lines.emplace_back(ScrollbackIndexer::Line { number, {}, line.wrapped() });
+        line.searchableText(entry.text);
+    }
+    _searchIndexNextLine = last;
+
+    if (batch.reset || !batch.lines.empty())
+        _searchIndexer->enqueue(std::move(batch));
+
+    return last == _scrolledLineCount;
+}
+
+template <CellConcept Cell>
+bool Grid<Cell>::searchIndexReady()
+{
+    if (!_searchIndexer)
+    {
+        _searchIndexer = std::make_unique<ScrollbackIndexer>(_searchIndexIdle);
+        return false;
+    }
+    return updateSearchIndex(0) && _searchIndexer->idle();
+}
+
+template <CellConcept Cell>
+std::optional<std::vector<LineOffset>> Grid<Cell>::searchCandidates(std::u32string_view text)
+{
+    if (!_searchIndexer)
+        _searchIndexer = std::make_unique<ScrollbackIndexer>(_searchIndexIdle);
+    (void) updateSearchIndex(std::numeric_limits<size_t>::max());
+
+    auto const blocks = _searchIndexer->candidateBlocks(text);
+    if (!blocks)
+        return std::nullopt;
+
+    auto const topLine = -boxed_cast<LineOffset>(historyLineCount());
+    auto const boundary = searchIndexBoundary();
+    auto candidates = std::vector<LineOffset> {};
+
+    // Narrows the blocks down to the logical lines containing all trigrams of the text,
+    // without unpacking their cells.
+    auto logicalLineText = std::u32string {};
+    auto lineText = std::u32string {};
+    auto const addCandidate = [&](LineOffset top) {
+        if (!candidates.empty() && candidates.back() == top)
+            return;
+        logicalLineText.clear();
+        auto line = top;
+        do
+        {
+            lineAt(line).searchableText(lineText);
+            logicalLineText += lineText;
+            ++line;
+        } while (line < boundary && lineAt(line).wrapped());
+        if (ScrollbackIndex::mayContain(logicalLineText, text))
+            candidates.emplace_back(top);
+    };
+
+    // The top-most history line may continue a logical line whose beginning has already been
+    // dropped from the history, and with it from the index.
+    if (topLine < boundary && lineAt(topLine).wrapped())
+        addCandidate(topLine);
+
+    for (auto const block: *blocks)
+    {
+        auto const blockStart = ScrollbackIndex::LineNumber { block } * ScrollbackIndex::BlockSize;
+        auto const first = std::max(historyLineOffset(blockStart), topLine);
+        auto const last = std::min(historyLineOffset(blockStart + ScrollbackIndex::BlockSize), boundary);
+        for (auto line = first; line < last; ++line)
+            if (!lineAt(line).wrapped() || line == topLine)
+                addCandidate(line);
+    }
+
+    return candidates;
+}
+
+template <CellConcept Cell>
+LineOffset Grid<Cell>::searchIndexBoundary() const noexcept
+{
+    auto const topLine = -boxed_cast<LineOffset>(historyLineCount());
+    auto line = LineOffset(0);
+    while (line > topLine && lineAt(line).wrapped())
+        --line;
+    return line;
+}
+
+template <CellConcept Cell>
+GridHistoryStats Grid<Cell>::historyStats() const noexcept
+{
+    auto stats = GridHistoryStats {};
+    for (auto line = -boxed_cast<LineOffset>(historyLineCount()); line < LineOffset(0); ++line)
+    {
+        auto const& historyLine = lineAt(line);
+        if (!historyLine.isCompressedBuffer())
+        {
+            ++stats.hotLines;
+            continue;
+        }
+
+        auto const& buffer = historyLine.compressedBuffer();
+        ++stats.coldLines;
+        stats.compressedBytes += buffer.data.capacity();
+        if (buffer.inflatedSize > buffer.data.capacity())
+            stats.bytesSaved += buffer.inflatedSize - buffer.data.capacity();
+    }
+    return stats;
+}
+
 template <CellConcept Cell>
 void Grid<Cell>::clearHistory()
 {
+    _backgroundReflow.reset();
     _linesUsed = _pageSize.lines;
+    invalidateSearchIndex();
     verifyState();
 }
 
@@ -246,7 +581,7 @@ gsl::span<Line<Cell>> Grid<Cell>::mainPage()
 // }}}
 // {{{ Grid impl: Line access
 template <CellConcept Cell>
-gsl::span<Cell const> Grid<Cell>::lineBufferRightTrimmed(LineOffset line) const noexcept
+LineCells<Cell> Grid<Cell>::lineBufferRightTrimmed(LineOffset line) const
 {
     return detail::trimRight(lineBuffer(line));
 }
@@ -289,7 +624,7 @@ std::string Grid<Cell>::lineText(Line<Cell> const& line) const
 {
     std::stringstream sstr;
     int skipCount = 0;
-    for (Cell const& cell: line.inflatedBuffer())
+    for (Cell const& cell: line.cells())
     {
         if (skipCount > 0)
         {
@@ -375,6 +710,7 @@ LineCount Grid<Cell>::scrollUp(LineCount linesCountToScrollUp, GraphicsAttribute
         }
         return scrollUp(linesCountToScrollUp, defaultAttributes);
     }
+    _scrolledLineCount += unbox<ScrollbackIndex::LineNumber>(linesCountToScrollUp);
     if (unbox<size_t>(_linesUsed) == _lines.size()) // with all grid lines in-use
     {
         // TODO: ensure explicit test for this case
@@ -438,7 +774,11 @@ LineCount Grid<Cell>::scrollUp(LineCount n, GraphicsAttributes defaultAttributes
     if (fullHorizontal)
     {
         if (fullVertical) // full-screen scroll-up
-            return scrollUp(n, defaultAttributes);
+        {
+            auto const scrolledLines = scrollUp(n, defaultAttributes);
+            compressColdHistory(n);
+            return scrolledLines;
+        }
 
         // scroll up only inside vertical margin with full horizontal extend
         auto const marginHeight = LineCount(margin.vertical.length());
@@ -519,6 +859,7 @@ void Grid<Cell>::scrollDown(LineCount vN, GraphicsAttributes const& defaultAttri
         // bottom N lines are wiped out
 
         rotateBuffersRight(n);
+        invalidateSearchIndex();
 
         for (Line<Cell>& line: mainPage().subspan(0, unbox<size_t>(n)))
             line.reset(defaultLineFlags(), defaultAttributes);
@@ -578,13 +919,337 @@ void Grid<Cell>::scrollLeft(GraphicsAttributes defaultAttributes, Margin margin)
     }
 }
 
+// }}}
+// {{{ Grid impl: background reflow
+/// Reflows the older history lines, that have been moved out of the grid upon resize,
+/// on a few worker threads.
+///
+/// The lines are split at logical line boundaries into chunks that are reflowed independently
+/// of each other, moving the lines out of their segments. When being resized again before done,
+/// the chunks reflowed so far are kept at their new column count, and reflowing is restarted
+/// with the new column count from there.
+template <CellConcept Cell>
+class Grid<Cell>::BackgroundReflow
+{
+  public:
+    explicit BackgroundReflow(std::function<void()> ready): _ready { std::move(ready) } {}
+
+    BackgroundReflow(BackgroundReflow const&) = delete;
+    BackgroundReflow(BackgroundReflow&&) = delete;
+    BackgroundReflow& operator=(BackgroundReflow const&) = delete;
+    BackgroundReflow& operator=(BackgroundReflow&&) = delete;
+    ~BackgroundReflow()
+    {
+        _stopping = true;
+        join();
+    }
+
+    /// Appends lines of the given column count, that are newer than all lines appended so far.
+    /// Must not be called while reflowing.
+    void append(Lines<Cell> lines, ColumnCount columnCount)
+    {
+        _segments.emplace_back(Segment { std::move(lines), columnCount });
+    }
+
+    /// Starts reflowing all lines to the given column count.
+    void start(ColumnCount newColumnCount, bool compressLines)
+    {
+        Require(_workers.empty());
+
+        _newColumnCount = newColumnCount;
+        _compressLines = compressLines;
+        planChunks();
+        _outputs.clear();
+        _outputs.resize(_chunks.size());
+        _nextChunk = 0;
+        _completedChunks = 0;
+        _stopping = false;
+
+        auto const workerCount =
+            std::min({ size_t { std::max(std::thread::hardware_concurrency() / 2, 1u) },
+                       MaxWorkerCount,
+                       _chunks.size() });
+        for (size_t i = 0; i < workerCount; ++i)
+            _workers.emplace_back([this]() { work(); });
+    }
+
+    /// Stops reflowing as soon as possible.
+    ///
+    /// The chunks reflowed so far are put back as segments of the column count they have been
+    /// reflowed to, the others as they were.
+    void stop()
+    {
+        _stopping = true;
+        join();
+
+        if (_chunks.empty())
+            return;
+
+        // Chunks are always reflowed to completion once taken by a worker.
+        auto const reflowedCount = std::min(_nextChunk.load(), _chunks.size());
+        auto segments = std::vector<Segment> {};
+        for (size_t index = 0; index < _chunks.size(); ++index)
+        {
+            auto const& chunk = _chunks[index];
+            auto& segment = _segments[chunk.segment];
+            auto const reflowed = index < reflowedCount;
+            auto const columnCount = reflowed ? _newColumnCount : segment.columnCount;
+            if (segments.empty() || segments.back().columnCount != columnCount)
+                segments.emplace_back(Segment { Lines<Cell> {}, columnCount });
+
+            auto& lines = segments.back().lines;
+            if (reflowed)
+                for (auto& line: _outputs[index])
+                    lines.emplace_back(std::move(line));
+            else
+                for (size_t i = 0; i < chunk.count; ++i)
+                    lines.emplace_back(std::move(segment.lines[chunk.first + i]));
+        }
+
+        _segments = std::move(segments);
+        _chunks.clear();
+        _outputs.clear();
+        _nextChunk = 0;
+        _completedChunks = 0;
+    }
+
+    [[nodiscard]] bool done() const noexcept
+    {
+        return _completedChunks.load(std::memory_order_acquire) == _chunks.size();
+    }
+
+    /// Helps reflowing the remaining chunks and waits for them to be done.
+    ///
+    /// @returns all lines reflowed, oldest first.
+    [[nodiscard]] Lines<Cell> take()
+    {
+        work();
+        join();
+
+        auto lineCount = size_t { 0 };
+        for (auto const& output: _outputs)
+            lineCount += output.size();
+
+        auto lines = Lines<Cell> {};
+        lines.reserve(lineCount);
+        for (auto& output: _outputs)
+            for (auto& line: output)
+                lines.emplace_back(std::move(line));
+        _outputs.clear();
+        return lines;
+    }
+
+  private:
+    // Number of lines per chunk, which is extended up to the next logical line's top.
+    static constexpr size_t ChunkLineCount = 4096;
+    static constexpr size_t MaxWorkerCount = 4;
+
+    struct Segment
+    {
+        Lines<Cell> lines;
+        ColumnCount columnCount;
+    };
+
+    struct Chunk
+    {
+        size_t segment;
+        size_t first;
+        size_t count;
+        LineFlags logicalLineFlags; // see detail::growLogicalLines()
+    };
+
+    void planChunks()
+    {
+        _chunks.clear();
+        LineFlags logicalLineFlags = LineFlag::None;
+        for (size_t segment = 0; segment < _segments.size(); ++segment)
+        {
+            auto const& lines = _segments[segment].lines;
+            auto chunk = Chunk { segment, 0, 0, logicalLineFlags };
+            for (size_t i = 0; i < lines.size(); ++i)
+            {
+                auto const& line = lines[i];
+                if (i - chunk.first >= ChunkLineCount && !line.wrapped())
+                {
+                    chunk.count = i - chunk.first;
+                    _chunks.push_back(chunk);
+                    chunk = Chunk { segment, i, 0, logicalLineFlags };
+                }
+                if (!line.wrapped() && !line.isTrivialBuffer())
+                    logicalLineFlags = line.flags().without(LineFlag::Wrapped);
+            }
+            chunk.count = lines.size() - chunk.first;
+            if (chunk.count)
+                _chunks.push_back(chunk);
+        }
+    }
+
+    void work()
+    {
+        while (!_stopping.load(std::memory_order_relaxed))
+        {
+            auto const index = _nextChunk.fetch_add(1, std::memory_order_relaxed);
+            if (index >= _chunks.size())
+                return;
+
+            reflow(_chunks[index], _outputs[index]);
+
+            if (_completedChunks.fetch_add(1, std::memory_order_acq_rel) + 1 == _chunks.size() && _ready)
+                _ready();
+        }
+    }
+
+    void reflow(Chunk const& chunk, Lines<Cell>& output)
+    {
+        // Chunks never overlap, so each line is moved out by one worker only.
+        auto& segment = _segments[chunk.segment];
+        auto const takeLine = [&](size_t i) -> Line<Cell> {
+            return std::move(segment.lines[chunk.first + i]);
+        };
+
+        using crispy::comparison;
+        switch (crispy::strongCompare(_newColumnCount, segment.columnCount))
+        {
+            case comparison::Greater:
+                detail::growLogicalLines(
+                    output, _newColumnCount, chunk.count, takeLine, chunk.logicalLineFlags);
+                break;
+            case comparison::Less:
+                detail::shrinkLogicalLines(output, _newColumnCount, chunk.count, takeLine);
+                break;
+            case comparison::Equal:
+                for (size_t i = 0; i < chunk.count; ++i)
+                    output.emplace_back(takeLine(i));
+                break;
+        }
+
+        if (_compressLines)
+            for (auto& line: output)
+                line.compress();
+    }
+
+    void join()
+    {
+        for (auto& worker: _workers)
+            worker.join();
+        _workers.clear();
+    }
+
+    std::function<void()> _ready;
+    std::vector<Segment> _segments;
+    ColumnCount _newColumnCount {};
+    bool _compressLines = false;
+
+    std::vector<Chunk> _chunks;
+    std::vector<Lines<Cell>> _outputs; // reflowed lines of each chunk
+    std::atomic<size_t> _nextChunk = 0;
+    std::atomic<size_t> _completedChunks = 0;
+    std::atomic<bool> _stopping = false;
+    std::vector<std::thread> _workers;
+};
+
+template <CellConcept Cell>
+bool Grid<Cell>::tryCompleteReflow()
+{
+    if (!_backgroundReflow)
+        return true;
+
+    if (!_backgroundReflow->done())
+        return false;
+
+    completeReflow();
+    return true;
+}
+
+template <CellConcept Cell>
+void Grid<Cell>::completeReflow()
+{
+    if (!_backgroundReflow)
+        return;
+
+    auto lines = _backgroundReflow->take();
+    _backgroundReflow.reset();
+    prependHistory(std::move(lines));
+}
+
+template <CellConcept Cell>
+LineOffset Grid<Cell>::eagerReflowTop() const noexcept
+{
+    auto const historyTop = -boxed_cast<LineOffset>(historyLineCount());
+    if (!*_eagerReflowLineCount || historyLineCount() <= _eagerReflowLineCount)
+        return historyTop;
+
+    // Reflowing can only be split at the top of a logical line.
+    auto top = -boxed_cast<LineOffset>(_eagerReflowLineCount);
+    while (top > historyTop && lineAt(top).wrapped())
+        --top;
+    return top;
+}
+
+template <CellConcept Cell>
+void Grid<Cell>::deferReflow(LineOffset top)
+{
+    auto const historyTop = -boxed_cast<LineOffset>(historyLineCount());
+    if (top == historyTop)
+        return;
+
+    auto lines = Lines<Cell> {};
+    lines.reserve(unbox<size_t>(top - historyTop));
+    for (auto i = historyTop; i < top; ++i)
+        lines.emplace_back(std::move(lineAt(i)));
+
+    gridLog()("Reflowing {} history lines in the background.", lines.size());
+
+    if (!_backgroundReflow)
+        _backgroundReflow = std::make_unique<BackgroundReflow>(_reflowReady);
+    _backgroundReflow->append(std::move(lines), _pageSize.columns);
+}
+
+template <CellConcept Cell>
+void Grid<Cell>::prependHistory(Lines<Cell> olderLines)
+{
+    auto const prependCount =
+        std::holds_alternative<Infinite>(_historyLimit)
+            ? olderLines.size()
+            : std::min(olderLines.size(), unbox<size_t>(maxHistoryLineCount() - historyLineCount()));
+    if (!prependCount)
+        return;
+
+    if (_lines.size() - unbox<size_t>(_linesUsed) < prependCount)
+    {
+        // With infinite history only: Grow the ring buffer to make room for the older lines.
+        auto lines = Lines<Cell> {};
+        lines.reserve(unbox<size_t>(_linesUsed) + prependCount);
+        for (auto i = -*historyLineCount(); i < *_pageSize.lines; ++i)
+            lines.emplace_back(std::move(_lines[i]));
+        while (lines.size() < unbox<size_t>(_linesUsed) + prependCount)
+            lines.emplace_back(defaultLineFlags(),
+                               TrivialLineBuffer { _pageSize.columns, GraphicsAttributes {} });
+        lines.rotate_left(unbox<size_t>(historyLineCount()));
+        _lines = std::move(lines);
+    }
+
+    auto const historyTop = -boxed_cast<LineOffset>(historyLineCount());
+    for (size_t i = 0; i < prependCount; ++i)
+        lineAt(historyTop - LineOffset::cast_from(i + 1)) = std::move(olderLines[olderLines.size() - 1 - i]);
+    _linesUsed += LineCount::cast_from(prependCount);
+
+    // Line positions counted from the top of the history have changed.
+    _coldHistorySweepIndex = 0;
+    _damageTrackedLines.clear();
+    invalidateSearchIndex();
+    verifyState();
+}
+
 // }}}
 // {{{ Grid impl: resize
 template <CellConcept Cell>
 void Grid<Cell>::reset()
 {
+    _backgroundReflow.reset();
     _linesUsed = _pageSize.lines;
     _lines.rotate_right(_lines.zero_index());
+    invalidateSearchIndex();
     for (int i = 0; i < unbox(_pageSize.lines); ++i)
         _lines[i].reset(defaultLineFlags(), GraphicsAttributes {});
     verifyState();
@@ -642,6 +1307,18 @@ CellLocation Grid<Cell>::resize(PageSize newSize, CellLocation currentCursorPos,
 
     gridLog()("resize {} -> {} (cursor {})", _pageSize, newSize, currentCursorPos);
 
+    // History lines are moved and possibly reflowed.
+    invalidateSearchIndex();
+
+    // Lines being reflowed in the background are reflowed to the new column count instead.
+    if (_backgroundReflow && newSize.columns != _pageSize.columns)
+    {
+        if (_reflowOnResize)
+            _backgroundReflow->stop();
+        else
+            completeReflow();
+    }
+
     // Growing in line count with scrollback lines present will move
     // the scrollback lines into the visible area.
     //
@@ -702,8 +1379,6 @@ CellLocation Grid<Cell>::resize(PageSize newSize, CellLocation currentCursorPos,
     };
 
     auto const growColumns = [this, wrapPending](ColumnCount newColumnCount) -> CellLocation {
-        using LineBuffer = typename Line<Cell>::InflatedBuffer;
-
         if (!_reflowOnResize)
         {
             for (auto& line: _lines)
@@ -721,65 +1396,36 @@ CellLocation Grid<Cell>::resize(PageSize newSize, CellLocation currentCursorPos,
             auto const extendCount = newColumnCount - _pageSize.columns;
             Require(*extendCount > 0);
 
+            auto const historyTop = -boxed_cast<LineOffset>(historyLineCount());
+            auto const top = eagerReflowTop();
+            auto const logicalLineFlags = detail::logicalLineFlagsAfter<Cell>(
+                unbox<size_t>(top - historyTop),
+                [&](size_t i) -> Line<Cell> const& { return lineAt(historyTop + LineOffset::cast_from(i)); },
+                LineFlag::None);
+            deferReflow(top);
+
             Lines<Cell> grownLines;
-            LineBuffer
-                logicalLineBuffer; // Temporary state, representing wrapped columns from the line "below".
-            LineFlags logicalLineFlags = LineFlag::None;
-
-            auto const appendToLogicalLine = [&logicalLineBuffer](gsl::span<Cell const> cells) {
-                for (auto const& cell: cells)
-                    logicalLineBuffer.push_back(cell);
-            };
-
-            auto const flushLogicalLine =
-                [newColumnCount, &grownLines, &logicalLineBuffer, &logicalLineFlags]() {
-                    if (!logicalLineBuffer.empty())
-                    {
-                        detail::addNewWrappedLines(
-                            grownLines, newColumnCount, std::move(logicalLineBuffer), logicalLineFlags, true);
-                        logicalLineBuffer.clear();
-                    }
-                };
-
-            [[maybe_unused]] auto const logLogicalLine =
-                [&logicalLineBuffer]([[maybe_unused]] LineFlags lineFlags,
-                                     [[maybe_unused]] std::string_view msg) {
-                    gridLog()("{} |> \"{}\"", msg, Line<Cell>(lineFlags, logicalLineBuffer).toUtf8());
-                };
-
-            for (int i = -*historyLineCount(); i < *_pageSize.lines; ++i)
+            detail::growLogicalLines(grownLines,
+                                     newColumnCount,
+                                     unbox<size_t>(boxed_cast<LineOffset>(_pageSize.lines) - top),
+                                     [&](size_t i) -> Line<Cell> {
+                                         auto& line = lineAt(top + LineOffset::cast_from(i));
+                                         Require(line.size() >= _pageSize.columns);
+                                         return std::move(line);
+                                     },
+                                     logicalLineFlags);
+
+            if (_backgroundReflow && LineCount::cast_from(grownLines.size()) < _pageSize.lines)
             {
-                auto& line = _lines[i];
-                // logLogicalLine(line.flags(), fmt::format("Line[{:>2}]: next line: \"{}\"", i,
-                // line.toUtf8()));
-                Require(line.size() >= _pageSize.columns);
-
-                if (line.wrapped())
-                {
-                    // logLogicalLine(line.flags(), fmt::format(" - appending: \"{}\"",
-                    // line.toUtf8Trimmed()));
-                    appendToLogicalLine(line.trim_blank_right());
-                }
-                else // line is not wrapped
-                {
-                    flushLogicalLine();
-                    if (line.isTrivialBuffer())
-                    {
-                        auto& buffer = line.trivialBuffer();
-                        buffer.displayWidth = newColumnCount;
-                        grownLines.emplace_back(line);
-                    }
-                    else
-                    {
-                        // logLogicalLine(line.flags(), " - start new logical line");
-                        appendToLogicalLine(line.cells());
-                        logicalLineFlags = line.flags().without(LineFlag::Wrapped);
-                    }
-                }
+                // The lines reflowed do not fill the page, so reflow the older lines right away.
+                _backgroundReflow->start(newColumnCount, false);
+                auto lines = _backgroundReflow->take();
+                _backgroundReflow.reset();
+                for (auto& line: grownLines)
+                    lines.emplace_back(std::move(line));
+                grownLines = std::move(lines);
             }
 
-            flushLogicalLine(); // Flush last (bottom) line, if anything pending.
-
             // auto diff = int(_lines.size()) - unbox<int>(_pageSize.lines);
             auto cy = LineCount(0);
             if (_pageSize.lines > LineCount::cast_from(grownLines.size()))
@@ -810,6 +1456,9 @@ CellLocation Grid<Cell>::resize(PageSize newSize, CellLocation currentCursorPos,
             auto const newHistoryLineCount = _linesUsed - _pageSize.lines;
             rotateBuffersLeft(newHistoryLineCount);
 
+            if (_backgroundReflow)
+                _backgroundReflow->start(newColumnCount, _hotHistoryPageCount != 0);
+
             verifyState();
             return CellLocation { -boxed_cast<LineOffset>(cy), ColumnOffset(wrapPending ? 1 : 0) };
         }
@@ -817,8 +1466,6 @@ CellLocation Grid<Cell>::resize(PageSize newSize, CellLocation currentCursorPos,
 
     auto const shrinkColumns =
         [this](ColumnCount newColumnCount, LineCount /*newLineCount*/, CellLocation cursor) -> CellLocation {
-        using LineBuffer = typename Line<Cell>::InflatedBuffer;
-
         if (!_reflowOnResize)
         {
             _pageSize.columns = newColumnCount;
@@ -831,76 +1478,22 @@ CellLocation Grid<Cell>::resize(PageSize newSize, CellLocation currentCursorPos,
         }
         else
         {
-            // {{{ Shrinking progress
-            // -----------------------------------------------------------------------
-            //  (one-by-one)        | (from-5-to-2)
-            // -----------------------------------------------------------------------
-            // "ABCDE"              | "ABCDE"
-            // "abcde"              | "xy   "
-            // ->                   | "abcde"
-            // "ABCD"               | ->
-            // "E   "   Wrapped     | "AB"                  push "AB", wrap "CDE"
-            // "abcd"               | "CD"      Wrapped     push "CD", wrap "E"
-            // "e   "   Wrapped     | "E"       Wrapped     push "E",  inc line
-            // ->                   | "xy"      no-wrapped  push "xy", inc line
-            // "ABC"                | "ab"      no-wrapped  push "ab", wrap "cde"
-            // "DE "    Wrapped     | "cd"      Wrapped     push "cd", wrap "e"
-            // "abc"                | "e "      Wrapped     push "e",  inc line
-            // "de "    Wrapped
-            // ->
-            // "AB"
-            // "DE"     Wrapped
-            // "E "     Wrapped
-            // "ab"
-            // "cd"     Wrapped
-            // "e "     Wrapped
-            // }}}
-
             Lines<Cell> shrinkedLines;
-            LineBuffer wrappedColumns;
-            LineFlags previousFlags = _lines.front().inheritableFlags();
 
             auto const totalLineCount = unbox<size_t>(_pageSize.lines + maxHistoryLineCount());
             shrinkedLines.reserve(totalLineCount);
             Require(totalLineCount == unbox<size_t>(this->totalLineCount()));
 
-            auto numLinesWritten = LineCount(0);
-            for (auto i = -*historyLineCount(); i < *_pageSize.lines; ++i)
-            {
-                auto& line = _lines[i];
+            auto const top = eagerReflowTop();
+            deferReflow(top);
 
-                // do we have previous columns carried?
-                if (!wrappedColumns.empty())
-                {
-                    if (line.wrapped() && line.inheritableFlags() == previousFlags)
-                    {
-                        // Prepend previously wrapped columns into current line.
-                        auto& editable = line.inflatedBuffer();
-                        editable.insert(editable.begin(), wrappedColumns.begin(), wrappedColumns.end());
-                    }
-                    else
-                    {
-                        // Insert NEW line(s) between previous and this line with previously wrapped columns.
-                        auto const numLinesInserted = detail::addNewWrappedLines(
-                            shrinkedLines, newColumnCount, std::move(wrappedColumns), previousFlags, false);
-                        numLinesWritten += numLinesInserted;
-                        previousFlags = line.inheritableFlags();
-                    }
-                }
-                else
-                {
-                    previousFlags = line.inheritableFlags();
-                }
-
-                wrappedColumns = line.reflow(newColumnCount);
-
-                shrinkedLines.emplace_back(std::move(line));
-                numLinesWritten++;
-                Ensures(shrinkedLines.back().size() >= newColumnCount);
-            }
-            numLinesWritten += detail::addNewWrappedLines(
-                shrinkedLines, newColumnCount, std::move(wrappedColumns), previousFlags, false);
-            Require(unbox<size_t>(numLinesWritten) == shrinkedLines.size());
+            detail::shrinkLogicalLines(shrinkedLines,
+                                       newColumnCount,
+                                       unbox<size_t>(boxed_cast<LineOffset>(_pageSize.lines) - top),
+                                       [&](size_t i) -> Line<Cell> {
+                                           return std::move(lineAt(top + LineOffset::cast_from(i)));
+                                       });
+            auto const numLinesWritten = LineCount::cast_from(shrinkedLines.size());
             Require(numLinesWritten >= _pageSize.lines);
 
             while (shrinkedLines.size() < totalLineCount)
@@ -922,6 +1515,9 @@ CellLocation Grid<Cell>::resize(PageSize newSize, CellLocation currentCursorPos,
             _lines = std::move(shrinkedLines);
             _pageSize.columns = newColumnCount;
 
+            if (_backgroundReflow)
+                _backgroundReflow->start(newColumnCount, _hotHistoryPageCount != 0);
+
             verifyState();
             return cursor; // TODO
         }
@@ -3,6 +3,7 @@
 
 #include <vtbackend/GraphicsAttributes.h>
 #include <vtbackend/Line.h>
+#include <vtbackend/ScrollbackIndex.h>
 #include <vtbackend/cell/CellConcept.h>
 #include <vtbackend/primitives.h>
 
@@ -21,8 +22,12 @@
 #include <gsl/span_ext>
 
 #include <algorithm>
+#include <functional>
+#include <memory>
+#include <optional>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace vtbackend
 {
@@ -109,6 +114,15 @@ struct RenderPassHints
     bool containsBlinkingCells = false;
 };
 
+/// Memory usage metrics of the scrollback history.
+struct GridHistoryStats
+{
+    LineCount hotLines {};       ///< Number of history lines kept uncompressed.
+    LineCount coldLines {};      ///< Number of history lines stored compressed.
+    size_t compressedBytes = 0;  ///< Number of bytes occupied by the compressed lines.
+    size_t bytesSaved = 0;       ///< Number of bytes saved by compressing the cold lines.
+};
+
 /**
  * Represents a logical grid line, i.e. a sequence lines that were written without
  * an explicit linefeed, triggering an auto-wrap.
@@ -351,6 +365,75 @@ bool operator!=(LogicalLine<Cell> const& a, LogicalLine<Cell> const& b) noexcept
     return !(a == b);
 }
 
+/// Text of a LogicalLine, as searched by SearchPattern, read from its lines on demand.
+///
+/// The text has one codepoint per grid column: the first codepoint of the cell,
+/// or U+0020 for empty cells. Trailing blank columns are omitted.
+template <CellConcept Cell>
+class LogicalLineText
+{
+  public:
+    explicit LogicalLineText(LogicalLine<Cell> const& logicalLine):
+        _lines { logicalLine.lines },
+        _top { logicalLine.top },
+        _columns { std::max(unbox<size_t>(logicalLine.lines.front().get().size()), size_t { 1 }) }
+    {
+        _cells.reserve(_lines.size());
+        for (Line<Cell> const& line: _lines)
+        {
+            // Columns of trivial lines can only be addressed by byte offset if the text is ASCII only,
+            // which is the case if, and only if, its number of bytes equals its number of columns.
+            if (line.isTrivialBuffer()
+                && line.trivialBuffer().text.size() == unbox<size_t>(line.trivialBuffer().usedColumns))
+                _cells.emplace_back(std::nullopt);
+            else
+                _cells.emplace_back(line.cells());
+        }
+
+        _size = _lines.size() * _columns;
+        while (_size && (*this)[_size - 1] == U' ')
+            --_size;
+    }
+
+    [[nodiscard]] size_t size() const noexcept { return _size; }
+
+    [[nodiscard]] char32_t operator[](size_t index) const noexcept
+    {
+        auto const& lineCells = _cells[index / _columns];
+        auto const column = index % _columns;
+        if (!lineCells)
+        {
+            auto const text = _lines[index / _columns].get().trivialBuffer().text.view();
+            return column < text.size() ? static_cast<char32_t>(static_cast<unsigned char>(text[column]))
+                                        : U' ';
+        }
+
+        auto const& cells = *lineCells;
+        if (column >= cells.size() || !cells[column].codepointCount())
+            return U' ';
+        return cells[column].codepoint(0);
+    }
+
+    /// @returns the index of the text at the given grid location, which must be within the logical line.
+    [[nodiscard]] size_t indexOf(CellLocation location) const noexcept
+    {
+        return unbox<size_t>(location.line - _top) * _columns + unbox<size_t>(location.column);
+    }
+
+    [[nodiscard]] CellLocation locationOf(size_t index) const noexcept
+    {
+        return CellLocation { _top + LineOffset::cast_from(index / _columns),
+                              ColumnOffset::cast_from(index % _columns) };
+    }
+
+  private:
+    std::vector<std::reference_wrapper<Line<Cell>>> const& _lines;
+    std::vector<std::optional<LineCells<Cell>>> _cells; // By line, unless its text is read as is.
+    LineOffset _top;
+    size_t _columns;
+    size_t _size = 0;
+};
+
 template <CellConcept Cell>
 struct LogicalLines
 {
@@ -590,6 +673,12 @@ class Grid
 
     Grid(): Grid(PageSize { LineCount(25), ColumnCount(80) }, false, LineCount(0)) {}
 
+    Grid(Grid const&) = delete;
+    Grid(Grid&&) noexcept;
+    Grid& operator=(Grid const&) = delete;
+    Grid& operator=(Grid&&) noexcept;
+    ~Grid();
+
     void reset();
 
     // {{{ grid global properties
@@ -613,8 +702,56 @@ class Grid
     [[nodiscard]] bool reflowOnResize() const noexcept { return _reflowOnResize; }
     void setReflowOnResize(bool enabled) { _reflowOnResize = enabled; }
 
+    /// Sets the number of pages of scrollback history, counted from the main page upwards,
+    /// that are kept uncompressed. History lines scrolled out of this range are compressed
+    /// and transparently inflated again when being accessed.
+    ///
+    /// A value of 0 disables compression of scrollback history lines.
+    void setHotHistoryPageCount(unsigned pageCount) noexcept { _hotHistoryPageCount = pageCount; }
+    [[nodiscard]] unsigned hotHistoryPageCount() const noexcept { return _hotHistoryPageCount; }
+
+    /// Keeps the lines from @p top to @p bottom (inclusive) from being compressed,
+    /// e.g. because they are currently displayed or selected.
+    ///
+    /// The range follows its lines as they scroll up, and replaces any previously retained range.
+    void retainHistoryLines(LineOffset top, LineOffset bottom) noexcept
+    {
+        _retainedLinesBegin = historyLineNumber(top);
+        _retainedLinesEnd = historyLineNumber(bottom) + 1;
+    }
+
+    /// Computes the memory usage metrics of the scrollback history.
+    ///
+    /// This walks all history lines and is therefore not meant to be called on hot paths.
+    [[nodiscard]] GridHistoryStats historyStats() const noexcept;
+
     [[nodiscard]] PageSize pageSize() const noexcept { return _pageSize; }
 
+    /// Sets the number of history lines, counted from the main page upwards, that are reflowed
+    /// right away upon resize. Older history lines are reflowed in the background, split at logical
+    /// line boundaries, and prepended to the history once done (see tryCompleteReflow()).
+    ///
+    /// A value of 0 reflows all history lines right away.
+    void setEagerReflowLineCount(LineCount count) noexcept { _eagerReflowLineCount = count; }
+    [[nodiscard]] LineCount eagerReflowLineCount() const noexcept { return _eagerReflowLineCount; }
+
+    /// Sets the callback to be invoked, from a worker thread, once the older history lines have been
+    /// reflowed in the background and can be prepended to the history by calling tryCompleteReflow().
+    void setReflowReadyCallback(std::function<void()> callback) { _reflowReady = std::move(callback); }
+
+    /// @returns whether older history lines are being reflowed in the background,
+    ///          and thus not yet part of the history.
+    [[nodiscard]] bool reflowPending() const noexcept { return _backgroundReflow != nullptr; }
+
+    /// Prepends the history lines reflowed in the background to the history, if they are ready.
+    ///
+    /// @returns true if no reflow is pending anymore.
+    bool tryCompleteReflow();
+
+    /// Prepends the history lines reflowed in the background to the history,
+    /// helping with and waiting for their reflow if not done yet.
+    void completeReflow();
+
     /// Resizes the main page area of the grid and adapts the scrollback area's width accordingly.
     ///
     /// @param pageSize          new size of the main page area
@@ -630,11 +767,8 @@ class Grid
     [[nodiscard]] Line<Cell>& lineAt(LineOffset line) noexcept;
     [[nodiscard]] Line<Cell> const& lineAt(LineOffset line) const noexcept;
 
-    [[nodiscard]] gsl::span<Cell const> lineBuffer(LineOffset line) const noexcept
-    {
-        return lineAt(line).cells();
-    }
-    [[nodiscard]] gsl::span<Cell const> lineBufferRightTrimmed(LineOffset line) const noexcept;
+    [[nodiscard]] LineCells<Cell> lineBuffer(LineOffset line) const { return lineAt(line).cells(); }
+    [[nodiscard]] LineCells<Cell> lineBufferRightTrimmed(LineOffset line) const;
 
     [[nodiscard]] std::string lineText(LineOffset line) const;
     [[nodiscard]] std::string lineTextTrimmed(LineOffset line) const;
@@ -689,6 +823,50 @@ class Grid
         return ReverseLogicalLines<Cell> { boxed_cast<LineOffset>(-historyLineCount()), offset, _lines };
     }
 
+    /// @returns the logical line starting at the given line.
+    [[nodiscard]] LogicalLine<Cell> logicalLineAt(LineOffset top) { return *logicalLinesFrom(top).begin(); }
+
+    // {{{ scrollback search index
+    /// Retrieves the logical lines above searchIndexBoundary() that may contain the given text.
+    ///
+    /// The underlying search index is built upon first use, and from then on incrementally
+    /// updated in the background (see updateSearchIndex()).
+    ///
+    /// @returns the top lines of these logical lines in ascending order,
+    ///          or std::nullopt if the text is too short to narrow down the lines to search.
+    [[nodiscard]] std::optional<std::vector<LineOffset>> searchCandidates(std::u32string_view text);
+
+    /// @returns the top line of the logical line containing the main page's first line,
+    ///          i.e. the first line not covered by searchCandidates().
+    [[nodiscard]] LineOffset searchIndexBoundary() const noexcept;
+
+    /// Hands up to @p maxLineCount of the lines scrolled into the history since the last update
+    /// over to the search index, which indexes them on a worker thread.
+    ///
+    /// This does nothing until the search index has been put to use by searchCandidates().
+    ///
+    /// @returns whether all history lines have been handed over.
+    bool updateSearchIndex(size_t maxLineCount);
+
+    /// Tests, without waiting, whether searchCandidates() would return right away, i.e. whether all
+    /// history lines have been handed over to the search index and indexed.
+    ///
+    /// Puts the search index to use, if not yet, to be caught up with by updateSearchIndex().
+    [[nodiscard]] bool searchIndexReady();
+
+    /// Sets the callback to be invoked, from a worker thread, whenever the search index has indexed
+    /// all lines handed over to it.
+    void setSearchIndexIdleCallback(std::function<void()> callback)
+    {
+        _searchIndexIdle = std::move(callback);
+    }
+
+    [[nodiscard]] ScrollbackIndexStats searchIndexStats() const
+    {
+        return _searchIndexer ? _searchIndexer->stats() : ScrollbackIndexStats {};
+    }
+    // }}}
+
     // {{{ buffer manipulation
 
     /// Completely deletes all scrollback lines.
@@ -725,6 +903,14 @@ class Grid
         ScrollOffset scrollOffset = {},
         HighlightSearchMatches highlightSearchMatches = HighlightSearchMatches::Yes) const;
 
+    /// Invokes @p damaged with the offset of every line of the page at the given scroll offset
+    /// that has changed since the last call, i.e. that has been written to, or that is now showing
+    /// another line than before (e.g. due to scrolling).
+    ///
+    /// All lines of that page are considered unchanged afterwards.
+    template <typename F>
+    void collectDamagedLines(ScrollOffset scrollOffset, F&& damaged);
+
     /// Takes text-screenshot of the main page.
     [[nodiscard]] std::string renderMainPageText() const;
 
@@ -791,10 +977,40 @@ class Grid
     }
 
   private:
+    class BackgroundReflow;
+
     CellLocation growLines(LineCount newHeight, CellLocation cursor);
     void appendNewLines(LineCount count, GraphicsAttributes attr);
     void clampHistory();
 
+    // Returns the top line of the lines to be reflowed right away upon resize.
+    [[nodiscard]] LineOffset eagerReflowTop() const noexcept;
+
+    // Moves the history lines above the given (logical line's top) line out of the grid,
+    // in order to reflow them in the background.
+    void deferReflow(LineOffset top);
+
+    // Prepends the given lines, that are older than all history lines, to the history.
+    void prependHistory(Lines<Cell> olderLines);
+
+    // Compresses the history lines that have just been scrolled out of the hot history range,
+    // plus a few cold lines that have been inflated again since.
+    void compressColdHistory(LineCount linesScrolledUp) noexcept;
+
+    // Drops the search index, e.g. after reflowing the history. It is rebuilt on next use.
+    void invalidateSearchIndex() noexcept { _searchIndexValid = false; }
+
+    [[nodiscard]] LineOffset historyLineOffset(ScrollbackIndex::LineNumber number) const noexcept
+    {
+        return LineOffset::cast_from(static_cast<int64_t>(number) - static_cast<int64_t>(_scrolledLineCount));
+    }
+
+    [[nodiscard]] ScrollbackIndex::LineNumber historyLineNumber(LineOffset line) const noexcept
+    {
+        return static_cast<ScrollbackIndex::LineNumber>(std::max<int64_t>(
+            0, static_cast<int64_t>(_scrolledLineCount) + unbox<int64_t>(line)));
+    }
+
     // {{{ buffer helpers
     void resizeBuffers(PageSize newSize)
     {
@@ -825,6 +1041,33 @@ class Grid
 
     // Number of lines used in the Lines buffer.
     LineCount _linesUsed;
+
+    // Number of history pages not to be compressed, or 0 if compression is disabled.
+    unsigned _hotHistoryPageCount = 0;
+
+    // Position (counted from the top of the history) of the next cold line
+    // to be checked for having been inflated again.
+    size_t _coldHistorySweepIndex = 0;
+
+    // Numbers of the first and one past the last line exempt from compression (see retainHistoryLines()).
+    ScrollbackIndex::LineNumber _retainedLinesBegin = 0;
+    ScrollbackIndex::LineNumber _retainedLinesEnd = 0;
+
+    // Number of lines scrolled into the history, numbering the history lines for the search index.
+    ScrollbackIndex::LineNumber _scrolledLineCount = 0;
+
+    std::unique_ptr<ScrollbackIndexer> _searchIndexer; // Created upon first search.
+    ScrollbackIndex::LineNumber _searchIndexNextLine = 0; // Next line to be handed over to the indexer.
+    bool _searchIndexValid = false;
+    std::function<void()> _searchIndexIdle;
+
+    // The lines that have been shown on each page line at the last collectDamagedLines() call.
+    std::vector<Line<Cell> const*> _damageTrackedLines;
+
+    // Older history lines being reflowed in the background (see setEagerReflowLineCount()).
+    std::unique_ptr<BackgroundReflow> _backgroundReflow;
+    std::function<void()> _reflowReady;
+    LineCount _eagerReflowLineCount = LineCount(10'000);
 };
 
 template <CellConcept Cell>
@@ -866,6 +1109,12 @@ template <typename RendererT>
     auto hints = RenderPassHints {};
     for (int i = -*scrollOffset, e = i + *_pageSize.lines; i != e; ++i, ++y)
     {
+        // Incremental renderers may keep what they have rendered for this line in a previous pass.
+        // The render pass hints of such lines are to be tracked by the renderer itself.
+        if constexpr (requires { render.reuseLine(y); })
+            if (render.reuseLine(y))
+                continue;
+
         auto x = ColumnOffset(0);
         Line<Cell> const& line = _lines[i];
         // NB: trivial liner rendering only works trivially if we don't do cell-based operations
@@ -894,6 +1143,27 @@ template <typename RendererT>
     render.finish();
     return hints;
 }
+
+template <CellConcept Cell>
+template <typename F>
+void Grid<Cell>::collectDamagedLines(ScrollOffset scrollOffset,
+                                     F&& damaged) // NOLINT(cppcoreguidelines-missing-std-forward)
+{
+    assert(!scrollOffset || unbox<LineCount>(scrollOffset) <= historyLineCount());
+
+    _damageTrackedLines.resize(unbox<size_t>(_pageSize.lines), nullptr);
+
+    auto y = LineOffset(0);
+    for (int i = -*scrollOffset, e = i + *_pageSize.lines; i != e; ++i, ++y)
+    {
+        Line<Cell>& line = _lines[i];
+        auto& trackedLine = _damageTrackedLines[unbox<size_t>(y)];
+        if (line.dirty() || trackedLine != &line)
+            damaged(y);
+        line.setDirty(false);
+        trackedLine = &line;
+    }
+}
 // }}}
 
 } // namespace vtbackend
@@ -9,6 +9,10 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 using namespace vtbackend;
 using namespace std::string_literals;
 using namespace std::string_view_literals;
@@ -171,6 +175,76 @@ TEST_CASE("Grid.writeAndScrollUp", "[grid]")
     CHECK(grid.lineText(LineOffset(1)) == "     ");
 }
 
+TEST_CASE("Grid.compressColdHistory", "[grid]")
+{
+    auto const pageSize = PageSize { LineCount(2), ColumnCount(5) };
+    auto grid = Grid<Cell>(pageSize, true, LineCount(10));
+    grid.setHotHistoryPageCount(1);
+    grid.setLineText(LineOffset(0), "ABCDE");
+    grid.setLineText(LineOffset(1), "FGHIJ");
+    for (auto const text: { "KLMNO"sv, "PQRST"sv, "UVWXY"sv, "Z1234"sv })
+    {
+        (void) grid.scrollUp(LineCount(1), GraphicsAttributes {}, fullPageMargin(pageSize));
+        grid.setLineText(LineOffset(1), text);
+    }
+    logGridText(grid, "after scrolling");
+
+    // The bottom-most history page is kept hot, the lines above are compressed.
+    REQUIRE(grid.historyLineCount() == LineCount(4));
+    CHECK(grid.lineAt(LineOffset(-4)).isCompressedBuffer());
+    CHECK(grid.lineAt(LineOffset(-3)).isCompressedBuffer());
+    CHECK(grid.lineAt(LineOffset(-2)).isInflatedBuffer());
+    CHECK(grid.lineAt(LineOffset(-1)).isInflatedBuffer());
+
+    auto const stats = grid.historyStats();
+    CHECK(stats.hotLines == LineCount(2));
+    CHECK(stats.coldLines == LineCount(2));
+    CHECK(stats.compressedBytes > 0);
+    CHECK(stats.bytesSaved > 0);
+
+    // Reading cold lines unpacks them without altering their storage.
+    CHECK(grid.lineText(LineOffset(-4)) == "ABCDE");
+    CHECK(grid.lineText(LineOffset(-3)) == "FGHIJ");
+    CHECK(grid.lineAt(LineOffset(-4)).isCompressedBuffer());
+    CHECK(grid.lineText(LineOffset(-2)) == "KLMNO");
+    CHECK(grid.lineText(LineOffset(-1)) == "PQRST");
+    CHECK(grid.lineText(LineOffset(0)) == "UVWXY");
+    CHECK(grid.lineText(LineOffset(1)) == "Z1234");
+
+    // Modifying cold lines transparently inflates them again.
+    grid.lineAt(LineOffset(-4)).useCellAt(ColumnOffset(0)).setCharacter('a');
+    CHECK(grid.lineAt(LineOffset(-4)).isInflatedBuffer());
+    CHECK(grid.lineText(LineOffset(-4)) == "aBCDE");
+}
+
+TEST_CASE("Grid.compressColdHistory.retained", "[grid]")
+{
+    auto const pageSize = PageSize { LineCount(2), ColumnCount(5) };
+    auto grid = Grid<Cell>(pageSize, true, LineCount(10));
+    grid.setHotHistoryPageCount(1);
+    grid.setLineText(LineOffset(0), "ABCDE");
+    grid.setLineText(LineOffset(1), "FGHIJ");
+
+    // The top-most two lines stay retained while scrolling up, e.g. because they are being selected.
+    grid.retainHistoryLines(LineOffset(0), LineOffset(1));
+    for (auto const text: { "KLMNO"sv, "PQRST"sv, "UVWXY"sv, "Z1234"sv })
+    {
+        (void) grid.scrollUp(LineCount(1), GraphicsAttributes {}, fullPageMargin(pageSize));
+        grid.setLineText(LineOffset(1), text);
+    }
+
+    REQUIRE(grid.historyLineCount() == LineCount(4));
+    CHECK(grid.lineText(LineOffset(-4)) == "ABCDE");
+    CHECK(grid.lineAt(LineOffset(-4)).isInflatedBuffer());
+    CHECK(grid.lineAt(LineOffset(-3)).isInflatedBuffer());
+
+    // Once released, the sweep compresses them eventually.
+    grid.retainHistoryLines(LineOffset(0), LineOffset(-1));
+    (void) grid.scrollUp(LineCount(1), GraphicsAttributes {}, fullPageMargin(pageSize));
+    CHECK(grid.lineAt(LineOffset(-5)).isCompressedBuffer());
+    CHECK(grid.lineAt(LineOffset(-4)).isCompressedBuffer());
+}
+
 TEST_CASE("iteratorAt", "[grid]")
 {
     auto grid = Grid<Cell>(PageSize { LineCount(3), ColumnCount(3) }, true, LineCount(0));
@@ -899,5 +973,71 @@ TEST_CASE("Grid resize", "[grid]")
     REQUIRE(grid.lineAt(LineOffset(1)).isTrivialBuffer());
 }
 
+TEST_CASE("Grid.reflow.background", "[grid]")
+{
+    auto const setup = [](LineCount eagerReflowLineCount) {
+        auto grid = Grid<Cell>(PageSize { LineCount(2), ColumnCount(8) }, true, LineCount(100));
+        grid.setEagerReflowLineCount(eagerReflowLineCount);
+        for (int i = 0; i < 20; ++i)
+        {
+            grid.scrollUp(LineCount(1));
+            grid.setLineText(LineOffset(1), fmt::format("{:02}ABCDEF", i));
+        }
+        return grid;
+    };
+
+    auto const linesOf = [](Grid<Cell> const& grid) {
+        auto lines = std::vector<string> {};
+        for (auto line = -boxed_cast<LineOffset>(grid.historyLineCount());
+             line < boxed_cast<LineOffset>(grid.pageSize().lines);
+             ++line)
+            lines.emplace_back(fmt::format("\"{}\" {}", grid.lineText(line), grid.lineAt(line).flags()));
+        return lines;
+    };
+
+    // Reflows all lines right away.
+    auto expected = setup(LineCount(0));
+
+    auto grid = setup(LineCount(4));
+    auto ready = std::atomic<bool> { false };
+    grid.setReflowReadyCallback([&]() { ready = true; });
+
+    SECTION("shrink")
+    {
+        (void) expected.resize(PageSize { LineCount(2), ColumnCount(3) }, CellLocation {}, false);
+        (void) grid.resize(PageSize { LineCount(2), ColumnCount(3) }, CellLocation {}, false);
+        REQUIRE(grid.reflowPending());
+        CHECK(grid.historyLineCount() < expected.historyLineCount());
+        CHECK(grid.lineText(LineOffset(1)) == expected.lineText(LineOffset(1)));
+
+        while (!grid.tryCompleteReflow())
+            std::this_thread::yield();
+
+        CHECK(ready);
+        CHECK_FALSE(grid.reflowPending());
+        CHECK(linesOf(grid) == linesOf(expected));
+    }
+
+    SECTION("shrink and grow again before done")
+    {
+        (void) expected.resize(PageSize { LineCount(2), ColumnCount(3) }, CellLocation {}, false);
+        (void) expected.resize(PageSize { LineCount(2), ColumnCount(5) }, CellLocation {}, false);
+        (void) grid.resize(PageSize { LineCount(2), ColumnCount(3) }, CellLocation {}, false);
+        (void) grid.resize(PageSize { LineCount(2), ColumnCount(5) }, CellLocation {}, false);
+
+        grid.completeReflow();
+        CHECK_FALSE(grid.reflowPending());
+        CHECK(linesOf(grid) == linesOf(expected));
+    }
+
+    SECTION("clear history")
+    {
+        (void) grid.resize(PageSize { LineCount(2), ColumnCount(3) }, CellLocation {}, false);
+        grid.clearHistory();
+        CHECK_FALSE(grid.reflowPending());
+        CHECK(grid.historyLineCount() == LineCount(0));
+    }
+}
+
 // }}}
 // NOLINTEND(misc-const-correctness)
@@ -1,15 +1,28 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <vtbackend/Image.h>
+#include <vtbackend/logging.h>
 
 #include <crispy/StrongLRUHashtable.h>
 
 #include <algorithm>
+#include <cerrno>
+#include <cstring>
 #include <memory>
 
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
 using std::copy;
 using std::make_shared;
 using std::min;
 using std::move;
+using std::nullopt;
+using std::optional;
 using std::ostream;
 using std::shared_ptr;
 using std::string;
@@ -39,11 +52,15 @@ ImageFragment::~ImageFragment()
     --ImageStats::get().fragments;
 }
 
-ImagePool::ImagePool(OnImageRemove onImageRemove, ImageId nextImageId):
+ImagePool::ImagePool(OnImageRemove onImageRemove, ImageId nextImageId, size_t memoryBudget):
     _nextImageId { nextImageId },
     _imageNameToImageCache { crispy::strong_hashtable_size { 1024 },
                              crispy::lru_capacity { 100 },
                              "ImagePool name-to-image mappings" },
+    _contentToImage { ContentToImageCache::create(crispy::strong_hashtable_size { 256 },
+                                                  crispy::lru_capacity { 128 },
+                                                  "ImagePool content-to-image mappings") },
+    _memoryBudget { memoryBudget },
     _onImageRemove { std::move(onImageRemove) }
 {
 }
@@ -118,10 +135,61 @@ Image::Data RasterizedImage::fragment(CellLocation pos) const
 
 shared_ptr<Image const> ImagePool::create(ImageFormat format, ImageSize size, Image::Data&& data)
 {
-    // TODO: This operation should be idempotent, i.e. if that image has been created already, return a
-    // reference to that.
+    auto const hash = crispy::strong_hash::compute(data.data(), data.size())
+                      * crispy::strong_hash(unbox(size.width),
+                                            unbox(size.height),
+                                            static_cast<uint32_t>(format),
+                                            0);
+
+    if (auto const* cached = _contentToImage->try_get(hash))
+    {
+        // Hash collisions are unlikely but not impossible, so the pixels are compared, too,
+        // which is still far cheaper than having decoded them.
+        Image const& image = **cached;
+        if (image.format() == format && image.size() == size && image.data() == data)
+        {
+            ++_deduplicatedCount;
+            return *cached;
+        }
+    }
+
     auto const id = _nextImageId++;
-    return make_shared<Image>(id, format, std::move(data), size, _onImageRemove);
+    auto image = make_shared<Image const>(id, format, std::move(data), size, _onImageRemove);
+
+    if (image->data().size() <= _memoryBudget)
+    {
+        _contentToImage->emplace(hash, image);
+        enforceMemoryBudget();
+    }
+
+    return image;
+}
+
+void ImagePool::setMemoryBudget(size_t bytes)
+{
+    _memoryBudget = bytes;
+    enforceMemoryBudget();
+}
+
+size_t ImagePool::cachedMemorySize() const noexcept
+{
+    auto total = size_t { 0 };
+    for (crispy::strong_hash const& hash: _contentToImage->hashes())
+        total += _contentToImage->peek(hash)->data().size();
+    return total;
+}
+
+void ImagePool::enforceMemoryBudget()
+{
+    // Walks the images from the most to the least recently used one,
+    // dropping all images once the budget is exceeded.
+    auto total = size_t { 0 };
+    for (crispy::strong_hash const& hash: _contentToImage->hashes())
+    {
+        total += _contentToImage->peek(hash)->data().size();
+        if (total > _memoryBudget)
+            _contentToImage->remove(hash);
+    }
 }
 
 shared_ptr<RasterizedImage> rasterize(shared_ptr<Image const> image,
@@ -156,13 +224,73 @@ void ImagePool::unlink(string const& name)
 void ImagePool::clear()
 {
     _imageNameToImageCache.clear();
+    _contentToImage->clear();
 }
 
 void ImagePool::inspect(ostream& os) const
 {
     os << "Image pool:\n";
     os << fmt::format("global image stats: {}\n", ImageStats::get());
+    os << fmt::format("deduplication: {} images with {} bytes cached (budget {}), {} uploads reused\n",
+                      _contentToImage->size(),
+                      cachedMemorySize(),
+                      _memoryBudget,
+                      _deduplicatedCount);
     _imageNameToImageCache.inspect(os);
 }
 
+#if defined(_WIN32)
+optional<Image::Data> readImageData(ImageTransmission /*transmission*/,
+                                    string const& /*path*/,
+                                    size_t /*byteCount*/)
+{
+    terminalLog()("Transferring images via files or shared memory is not supported on this platform.");
+    return nullopt;
+}
+#else
+optional<Image::Data> readImageData(ImageTransmission transmission, string const& path, size_t byteCount)
+{
+    // Opening must not block (e.g. on a FIFO) nor follow a symbolic link to somewhere else.
+    auto const fd = transmission == ImageTransmission::SharedMemory
+                        ? ::shm_open(path.c_str(), O_RDONLY, 0)
+                        : ::open(path.c_str(), O_RDONLY | O_CLOEXEC | O_NONBLOCK | O_NOFOLLOW);
+    if (fd < 0)
+    {
+        terminalLog()("Failed to open image data {}. {}", path, std::strerror(errno));
+        return nullopt;
+    }
+
+    auto data = optional<Image::Data> {};
+    struct stat st {};
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || static_cast<size_t>(st.st_size) < byteCount)
+        terminalLog()("Image data {} is not a regular file of at least {} bytes.", path, byteCount);
+    else
+    {
+        // Shared memory objects are handed over to the terminal, just like kitty does.
+        // Anything failing the above checks is left alone.
+        if (transmission == ImageTransmission::SharedMemory)
+            ::shm_unlink(path.c_str());
+
+        data.emplace(byteCount);
+        auto offset = size_t { 0 };
+        while (offset < byteCount)
+        {
+            auto const n = ::pread(fd, data->data() + offset, byteCount - offset, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+            {
+                terminalLog()("Failed to read image data {}. {}", path, n < 0 ? std::strerror(errno) : "EOF");
+                data.reset();
+                break;
+            }
+            offset += static_cast<size_t>(n);
+        }
+    }
+
+    ::close(fd);
+    return data;
+}
+#endif
+
 } // namespace vtbackend
@@ -6,12 +6,15 @@
 
 #include <crispy/StrongHash.h>
 #include <crispy/StrongLRUCache.h>
+#include <crispy/StrongLRUHashtable.h>
 
 #include <fmt/format.h>
 
 #include <cstdint>
 #include <functional>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace vtbackend
@@ -221,19 +224,69 @@ inline bool operator<(ImageFragment const& a, ImageFragment const& b) noexcept
                && a.offset() < b.offset());
 }
 
+/// Medium an image's pixel data is transferred through, other than the PTY itself.
+enum class ImageTransmission : uint8_t
+{
+    File,         //!< A regular file, which is left untouched.
+    SharedMemory, //!< A POSIX shared memory object, which is unlinked once read.
+};
+
+/// Reads @p byteCount bytes of raw pixel data from the file or shared memory object at @p path.
+///
+/// Symbolic links are not followed, and shared memory objects are only unlinked
+/// once they have been found to hold enough data.
+///
+/// @returns the pixel data, or std::nullopt if the path does not denote a regular file
+///          (or shared memory object) of at least @p byteCount bytes.
+[[nodiscard]] std::optional<Image::Data> readImageData(ImageTransmission transmission,
+                                                      std::string const& path,
+                                                      size_t byteCount);
+
+/// An application's request to display an image read from a file or shared memory object.
+///
+/// Such requests are subject to the user's permission, as the terminal reads the given path
+/// on behalf of the application.
+struct ImageFileRequest
+{
+    ImageSize size;                 //!< image size in pixels
+    ImageFormat format;             //!< pixel format of the image data
+    ImageTransmission transmission; //!< medium to read the image data from
+    std::string path;               //!< path of the file or name of the shared memory object
+};
+
 /// Highlevel Image Storage Pool.
 ///
 /// Stores RGBA images in host memory, also taking care of eviction.
+///
+/// Images are deduplicated by their content, so that uploading the same pixels again
+/// (such as an application redrawing a chart) shares the existing Image instead of storing
+/// another copy. The most recently uploaded images are kept alive by the pool for this purpose,
+/// up to the pool's memory budget.
 class ImagePool
 {
   public:
     using OnImageRemove = std::function<void(Image const*)>;
 
-    ImagePool(OnImageRemove onImageRemove = [](auto) {}, ImageId nextImageId = ImageId(1));
+    static constexpr size_t DefaultMemoryBudget = 64 * 1024 * 1024;
+
+    ImagePool(
+        OnImageRemove onImageRemove = [](auto) {},
+        ImageId nextImageId = ImageId(1),
+        size_t memoryBudget = DefaultMemoryBudget);
 
-    /// Creates an RGBA image of given size in pixels.
+    /// Creates an RGBA image of given size in pixels,
+    /// or returns the existing image if one with the very same pixels exists already.
     std::shared_ptr<Image const> create(ImageFormat format, ImageSize pixelSize, Image::Data&& data);
 
+    /// Sets the number of bytes of pixel data the pool may keep alive for deduplication.
+    ///
+    /// Images still referenced elsewhere (e.g. by the grid) are not affected.
+    void setMemoryBudget(size_t bytes);
+    [[nodiscard]] size_t memoryBudget() const noexcept { return _memoryBudget; }
+
+    /// @returns the number of bytes of pixel data currently kept alive for deduplication.
+    [[nodiscard]] size_t cachedMemorySize() const noexcept;
+
     // named image access
     //
     void link(std::string const& name, std::shared_ptr<Image const> imageRef);
@@ -246,13 +299,18 @@ class ImagePool
 
   private:
     void removeRasterizedImage(RasterizedImage* image); //!< Removes a rasterized image from pool.
+    void enforceMemoryBudget();
 
     using NameToImageIdCache = crispy::strong_lru_cache<std::string, std::shared_ptr<Image const>>;
+    using ContentToImageCache = crispy::strong_lru_hashtable<std::shared_ptr<Image const>>;
 
     // data members
     //
     ImageId _nextImageId;                      //!< ID for next image to be put into the pool
     NameToImageIdCache _imageNameToImageCache; //!< keeps mapping from name to raw image
+    ContentToImageCache::ptr _contentToImage;  //!< keeps recent images by their content hash
+    size_t _memoryBudget;                      //!< maximum pixel data kept alive by _contentToImage
+    uint64_t _deduplicatedCount = 0;           //!< number of uploads that reused an existing image
     OnImageRemove _onImageRemove;              //!< Callback to be invoked when image gets removed from pool.
 };
 
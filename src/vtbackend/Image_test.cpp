@@ -0,0 +1,141 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/Image.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#if !defined(_WIN32)
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+using namespace vtbackend;
+
+namespace
+{
+
+Image::Data pixels(uint8_t value)
+{
+    return Image::Data(2 * 4, value);
+}
+
+auto constexpr TwoPixels = ImageSize { Width(2), Height(1) };
+
+} // namespace
+
+TEST_CASE("ImagePool.deduplicate", "[ImagePool]")
+{
+    auto pool = ImagePool();
+
+    auto const a = pool.create(ImageFormat::RGBA, TwoPixels, pixels(1));
+    auto const b = pool.create(ImageFormat::RGBA, TwoPixels, pixels(1));
+    auto const c = pool.create(ImageFormat::RGBA, TwoPixels, pixels(2));
+    auto const d = pool.create(ImageFormat::RGBA, ImageSize { Width(1), Height(2) }, pixels(1));
+
+    CHECK(a == b);
+    CHECK(a != c);
+    CHECK(a != d);
+    CHECK(a->id() != c->id());
+    CHECK(pool.cachedMemorySize() == 3 * 8);
+}
+
+TEST_CASE("ImagePool.memoryBudget", "[ImagePool]")
+{
+    auto pool = ImagePool([](auto) {}, ImageId(1), 2 * 8);
+
+    auto a = pool.create(ImageFormat::RGBA, TwoPixels, pixels(1));
+    auto const idA = a->id();
+    a.reset();
+    auto const b = pool.create(ImageFormat::RGBA, TwoPixels, pixels(2));
+    CHECK(pool.cachedMemorySize() == 2 * 8);
+
+    // The least recently used image is dropped to make room for the new one.
+    auto const c = pool.create(ImageFormat::RGBA, TwoPixels, pixels(3));
+    CHECK(pool.cachedMemorySize() == 2 * 8);
+    CHECK(pool.create(ImageFormat::RGBA, TwoPixels, pixels(1))->id() != idA);
+
+    // Images referenced elsewhere stay alive.
+    pool.setMemoryBudget(0);
+    CHECK(pool.cachedMemorySize() == 0);
+    CHECK(b->data() == pixels(2));
+}
+
+#if !defined(_WIN32)
+TEST_CASE("readImageData.file", "[ImagePool]")
+{
+    auto const path = (std::filesystem::temp_directory_path() / "contour-readImageData-test.rgba").string();
+    {
+        auto file = std::ofstream(path, std::ios::binary);
+        file.write("\x01\x02\x03\x04\x05\x06\x07\x08", 8);
+    }
+
+    auto const data = readImageData(ImageTransmission::File, path, 8);
+    REQUIRE(data.has_value());
+    CHECK(*data == Image::Data { 1, 2, 3, 4, 5, 6, 7, 8 });
+
+    // Files are left untouched, but must hold enough pixel data.
+    CHECK_FALSE(readImageData(ImageTransmission::File, path, 9).has_value());
+    CHECK_FALSE(readImageData(ImageTransmission::File, path + ".missing", 8).has_value());
+
+    // Symbolic links are not followed.
+    auto const link = path + ".link";
+    std::remove(link.c_str());
+    std::filesystem::create_symlink(path, link);
+    CHECK_FALSE(readImageData(ImageTransmission::File, link, 8).has_value());
+
+    std::remove(link.c_str());
+    std::remove(path.c_str());
+}
+
+TEST_CASE("readImageData.fifo", "[ImagePool]")
+{
+    // Opening a FIFO without a writer must neither block nor be accepted.
+    auto const path = (std::filesystem::temp_directory_path() / "contour-readImageData-test.fifo").string();
+    std::remove(path.c_str());
+    REQUIRE(::mkfifo(path.c_str(), 0600) == 0);
+
+    CHECK_FALSE(readImageData(ImageTransmission::File, path, 4).has_value());
+
+    std::remove(path.c_str());
+}
+
+TEST_CASE("readImageData.sharedMemory", "[ImagePool]")
+{
+    auto const name = std::string("/contour-readImageData-test");
+    auto const fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    REQUIRE(fd >= 0);
+    REQUIRE(::write(fd, "\x01\x02\x03\x04", 4) == 4);
+    ::close(fd);
+
+    auto const data = readImageData(ImageTransmission::SharedMemory, name, 4);
+    REQUIRE(data.has_value());
+    CHECK(*data == Image::Data { 1, 2, 3, 4 });
+
+    // The shared memory object is unlinked once read.
+    CHECK(::shm_open(name.c_str(), O_RDONLY, 0) < 0);
+}
+
+TEST_CASE("readImageData.sharedMemory.tooSmall", "[ImagePool]")
+{
+    auto const name = std::string("/contour-readImageData-test-small");
+    auto const fd = ::shm_open(name.c_str(), O_CREAT | O_RDWR | O_TRUNC, 0600);
+    REQUIRE(fd >= 0);
+    REQUIRE(::write(fd, "\x01\x02", 2) == 2);
+    ::close(fd);
+
+    // Shared memory objects failing validation are left alone.
+    CHECK_FALSE(readImageData(ImageTransmission::SharedMemory, name, 4).has_value());
+    auto const reopened = ::shm_open(name.c_str(), O_RDONLY, 0);
+    CHECK(reopened >= 0);
+    if (reopened >= 0)
+        ::close(reopened);
+
+    ::shm_unlink(name.c_str());
+}
+#endif
@@ -96,15 +96,15 @@ inline void Line<Cell>::resize(ColumnCount count)
 }
 
 template <CellConcept Cell>
-gsl::span<Cell const> Line<Cell>::trim_blank_right() const noexcept
+LineCells<Cell> Line<Cell>::trim_blank_right() const
 {
-    auto i = inflatedBuffer().data();
-    auto e = inflatedBuffer().data() + inflatedBuffer().size();
+    auto const lineCells = cells();
+    auto n = lineCells.size();
 
-    while (i != e && (e - 1)->empty())
-        --e;
+    while (n && lineCells[n - 1].empty())
+        --n;
 
-    return gsl::make_span(i, e);
+    return lineCells.first(n);
 }
 
 template <CellConcept Cell>
@@ -120,7 +120,7 @@ std::string Line<Cell>::toUtf8() const
     }
 
     std::string str;
-    for (Cell const& cell: inflatedBuffer())
+    for (Cell const& cell: cells())
     {
         if (cell.codepointCount() == 0)
             str += ' ';
@@ -156,6 +156,225 @@ std::string Line<Cell>::toUtf8Trimmed(bool stripLeadingSpaces, bool stripTrailin
     return output;
 }
 
+template <CellConcept Cell>
+bool Line<Cell>::compress()
+{
+    if (!isInflatedBuffer())
+        return releaseReadCache() && isCompressedBuffer();
+
+    auto compressed = vtbackend::compress<Cell>(std::get<InflatedBuffer>(_storage));
+    if (!compressed)
+        return false;
+
+    _storage = std::move(*compressed);
+    return true;
+}
+
+namespace
+{
+    // {{{ compressed line encoding
+    //
+    // A compressed line is a sequence of records, each introduced by a tag byte:
+    //
+    // - AttributesTag, followed by the foreground, background, and underline color,
+    //   the cell flags (each 32-bit), and the hyperlink ID (16-bit).
+    //   These attributes apply to all subsequent cells.
+    // - CellTag | (width << 3) | codepointCount, followed by the codepoints of the cell,
+    //   each encoded as a variable length integer of 7 bits per byte.
+    //
+    // Trailing cells that are indistinguishable from a default constructed cell are omitted.
+
+    constexpr uint8_t AttributesTag = 0x00;
+    constexpr uint8_t CellTag = 0x80;
+    constexpr size_t MaxEncodedWidth = 0x0F;
+    constexpr size_t MaxEncodedCodepoints = 0x07;
+
+    struct CellAttributes
+    {
+        GraphicsAttributes graphics {};
+        HyperlinkId hyperlink {};
+
+        bool operator==(CellAttributes const&) const noexcept = default;
+    };
+
+    template <CellConcept Cell>
+    CellAttributes attributesOf(Cell const& cell) noexcept
+    {
+        return CellAttributes { .graphics = GraphicsAttributes { .foregroundColor = cell.foregroundColor(),
+                                                                 .backgroundColor = cell.backgroundColor(),
+                                                                 .underlineColor = cell.underlineColor(),
+                                                                 .flags = cell.flags() },
+                                .hyperlink = cell.hyperlink() };
+    }
+
+    template <CellConcept Cell>
+    bool isDefaultCell(Cell const& cell) noexcept
+    {
+        return cell.codepointCount() == 0 && cell.width() == 1 && attributesOf(cell) == CellAttributes {};
+    }
+
+    void encode32(std::vector<uint8_t>& output, uint32_t value)
+    {
+        for (auto i = 0; i < 4; ++i)
+            output.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    uint32_t decode32(uint8_t const*& input) noexcept
+    {
+        auto value = uint32_t { 0 };
+        for (auto i = 0; i < 4; ++i)
+            value |= static_cast<uint32_t>(*input++) << (8 * i);
+        return value;
+    }
+
+    void encodeCodepoint(std::vector<uint8_t>& output, char32_t codepoint)
+    {
+        auto value = static_cast<uint32_t>(codepoint);
+        while (value >= 0x80)
+        {
+            output.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        output.push_back(static_cast<uint8_t>(value));
+    }
+
+    char32_t decodeCodepoint(uint8_t const*& input) noexcept
+    {
+        auto value = uint32_t { 0 };
+        auto shift = 0;
+        while (*input & 0x80)
+        {
+            value |= static_cast<uint32_t>(*input++ & 0x7F) << shift;
+            shift += 7;
+        }
+        value |= static_cast<uint32_t>(*input++) << shift;
+        return static_cast<char32_t>(value);
+    }
+    // }}}
+} // namespace
+
+template <CellConcept Cell>
+std::optional<CompressedLineBuffer> compress(InflatedLineBuffer<Cell> const& input)
+{
+    auto end = input.end();
+    while (end != input.begin() && isDefaultCell(*std::prev(end)))
+        --end;
+
+    auto output = CompressedLineBuffer {};
+    output.displayWidth = ColumnCount::cast_from(input.size());
+    output.inflatedSize = input.size() * sizeof(Cell);
+
+    auto currentAttributes = CellAttributes {};
+    for (auto cell = input.begin(); cell != end; ++cell)
+    {
+        if (cell->imageFragment() || cell->width() > MaxEncodedWidth
+            || cell->codepointCount() > MaxEncodedCodepoints)
+            return std::nullopt;
+
+        if (auto const attributes = attributesOf(*cell); attributes != currentAttributes)
+        {
+            output.data.push_back(AttributesTag);
+            encode32(output.data, attributes.graphics.foregroundColor.content);
+            encode32(output.data, attributes.graphics.backgroundColor.content);
+            encode32(output.data, attributes.graphics.underlineColor.content);
+            encode32(output.data, attributes.graphics.flags.value());
+            output.data.push_back(static_cast<uint8_t>(unbox(attributes.hyperlink) & 0xFF));
+            output.data.push_back(static_cast<uint8_t>(unbox(attributes.hyperlink) >> 8));
+            currentAttributes = attributes;
+        }
+
+        auto const codepointCount = cell->codepointCount();
+        output.data.push_back(
+            static_cast<uint8_t>(CellTag | (cell->width() << 3) | static_cast<uint8_t>(codepointCount)));
+        for (size_t i = 0; i < codepointCount; ++i)
+            encodeCodepoint(output.data, cell->codepoint(i));
+    }
+
+    output.data.shrink_to_fit();
+    return output;
+}
+
+template <CellConcept Cell>
+InflatedLineBuffer<Cell> inflate(CompressedLineBuffer const& input)
+{
+    auto columns = InflatedLineBuffer<Cell> {};
+    columns.reserve(unbox<size_t>(input.displayWidth));
+
+    auto attributes = CellAttributes {};
+    auto const* i = input.data.data();
+    auto const* const e = i + input.data.size();
+    while (i != e)
+    {
+        auto const tag = *i++;
+        if (tag == AttributesTag)
+        {
+            attributes.graphics.foregroundColor.content = decode32(i);
+            attributes.graphics.backgroundColor.content = decode32(i);
+            attributes.graphics.underlineColor.content = decode32(i);
+            attributes.graphics.flags = CellFlags::from_value(decode32(i));
+            attributes.hyperlink = HyperlinkId(static_cast<uint16_t>(i[0] | (i[1] << 8)));
+            i += 2;
+            continue;
+        }
+
+        auto const width = static_cast<uint8_t>((tag >> 3) & MaxEncodedWidth);
+        auto const codepointCount = static_cast<size_t>(tag & MaxEncodedCodepoints);
+
+        Cell& cell = columns.emplace_back(attributes.graphics, attributes.hyperlink);
+        if (codepointCount != 0)
+        {
+            cell.write(attributes.graphics, decodeCodepoint(i), width, attributes.hyperlink);
+            for (size_t k = 1; k < codepointCount; ++k)
+                (void) cell.appendCharacter(decodeCodepoint(i));
+        }
+        cell.setWidth(width);
+    }
+
+    while (columns.size() < unbox<size_t>(input.displayWidth))
+        columns.emplace_back();
+
+    return columns;
+}
+
+template <CellConcept Cell>
+void Line<Cell>::searchableText(std::u32string& text) const
+{
+    text.clear();
+
+    if (auto const* cells = std::get_if<InflatedBuffer>(&_storage))
+    {
+        for (Cell const& cell: *cells)
+            text.push_back(cell.codepointCount() ? cell.codepoint(0) : 0);
+        return;
+    }
+
+    if (isTrivialBuffer())
+    {
+        text = unicode::convert_to<char32_t>(trivialBuffer().text.view());
+        return;
+    }
+
+    // Walk the cell records of the compressed line, skipping its attributes.
+    auto const& compressed = compressedBuffer();
+    auto const* i = compressed.data.data();
+    auto const* const e = i + compressed.data.size();
+    while (i != e)
+    {
+        auto const tag = *i++;
+        if (tag == AttributesTag)
+        {
+            i += 4 * sizeof(uint32_t) + sizeof(uint16_t);
+            continue;
+        }
+
+        auto const codepointCount = static_cast<size_t>(tag & MaxEncodedCodepoints);
+        text.push_back(codepointCount ? decodeCodepoint(i) : 0);
+        for (size_t k = 1; k < codepointCount; ++k)
+            (void) decodeCodepoint(i);
+    }
+    text.resize(unbox<size_t>(compressed.displayWidth), 0);
+}
+
 template <CellConcept Cell>
 InflatedLineBuffer<Cell> inflate(TrivialLineBuffer const& input)
 {
@@ -17,6 +17,10 @@
 #include <gsl/span>
 #include <gsl/span_ext>
 
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <stdexcept>
 #include <string>
 #include <variant>
 #include <vector>
@@ -65,6 +69,21 @@ struct TrivialLineBuffer
     }
 };
 
+/**
+ * Line storage for lines in the cold part of the scrollback history.
+ *
+ * The cells are serialized into a compact byte stream of graphics attribute runs
+ * and codepoints, which is unpacked again on first access of the line's cells.
+ */
+struct CompressedLineBuffer
+{
+    ColumnCount displayWidth;
+    std::vector<uint8_t> data {};
+
+    /// Number of bytes the cells occupied before compression (not counting heap-allocated extras).
+    size_t inflatedSize = 0;
+};
+
 template <CellConcept Cell>
 using InflatedLineBuffer = std::vector<Cell>;
 
@@ -72,8 +91,78 @@ using InflatedLineBuffer = std::vector<Cell>;
 template <CellConcept Cell>
 InflatedLineBuffer<Cell> inflate(TrivialLineBuffer const& input);
 
+/// Unpacks a CompressedLineBuffer into an InflatedLineBuffer<Cell>.
 template <CellConcept Cell>
-using LineStorage = std::variant<TrivialLineBuffer, InflatedLineBuffer<Cell>>;
+InflatedLineBuffer<Cell> inflate(CompressedLineBuffer const& input);
+
+/// Packs an InflatedLineBuffer<Cell> into a CompressedLineBuffer.
+///
+/// @returns the compressed line, or std::nullopt if the line holds cells that
+///          cannot be compressed, such as image fragments.
+template <CellConcept Cell>
+std::optional<CompressedLineBuffer> compress(InflatedLineBuffer<Cell> const& input);
+
+template <CellConcept Cell>
+using LineStorage = std::variant<TrivialLineBuffer, InflatedLineBuffer<Cell>, CompressedLineBuffer>;
+
+/**
+ * Read-only view of the grid cells of a line.
+ *
+ * Cells unpacked for reading a trivial or compressed line are shared with the view,
+ * so that they stay valid for as long as the view exists, even if the line is modified or compressed
+ * meanwhile. Cells of an inflated line are referred to directly, just like the elements of a vector.
+ */
+template <CellConcept Cell>
+class LineCells
+{
+  public:
+    using iterator = typename gsl::span<Cell const>::iterator;
+
+    LineCells() = default;
+    explicit LineCells(InflatedLineBuffer<Cell> const& cells) noexcept: _cells { cells } {}
+    explicit LineCells(std::shared_ptr<InflatedLineBuffer<Cell> const> cells) noexcept:
+        _cells { *cells }, _owner { std::move(cells) }
+    {
+    }
+
+    [[nodiscard]] iterator begin() const noexcept { return _cells.begin(); }
+    [[nodiscard]] iterator end() const noexcept { return _cells.end(); }
+    [[nodiscard]] size_t size() const noexcept { return _cells.size(); }
+    [[nodiscard]] bool empty() const noexcept { return _cells.empty(); }
+    [[nodiscard]] Cell const* data() const noexcept { return _cells.data(); }
+
+    [[nodiscard]] Cell const& operator[](size_t index) const noexcept { return _cells[index]; }
+
+    [[nodiscard]] Cell const& at(size_t index) const
+    {
+        if (index >= _cells.size())
+            throw std::out_of_range("LineCells::at");
+        return _cells[index];
+    }
+
+    /// @returns a view of the first @p count cells.
+    [[nodiscard]] LineCells first(size_t count) const
+    {
+        auto result = *this;
+        result._cells = _cells.first(count);
+        return result;
+    }
+
+    /// @returns a view of the @p count cells starting at @p offset, or of all cells from there by default.
+    [[nodiscard]] LineCells subspan(size_t offset, size_t count = gsl::dynamic_extent) const
+    {
+        auto result = *this;
+        result._cells = _cells.subspan(offset, count);
+        return result;
+    }
+
+    /// @returns the viewed cells, which stay valid only for as long as this view (or a copy of it) exists.
+    [[nodiscard]] gsl::span<Cell const> span() const noexcept { return _cells; }
+
+  private:
+    gsl::span<Cell const> _cells;
+    std::shared_ptr<InflatedLineBuffer<Cell> const> _owner; // Set if unpacked for reading.
+};
 
 /**
  * Line<Cell> API.
@@ -86,12 +175,38 @@ class Line
 {
   public:
     Line() = default;
-    Line(Line const&) = default;
-    Line(Line&&) noexcept = default;
-    Line& operator=(Line const&) = default;
-    Line& operator=(Line&&) noexcept = default;
+    ~Line() { releaseReadCache(); }
+
+    // Copying or moving a line marks the target as dirty, as it now holds different contents.
+    Line(Line const& other): _storage { other._storage }, _flags { other._flags } {}
+    Line(Line&& other) noexcept:
+        _storage { std::move(other._storage) },
+        _flags { other._flags },
+        _readCache { other._readCache.exchange(nullptr) }
+    {
+    }
+
+    Line& operator=(Line const& other)
+    {
+        releaseReadCache();
+        _storage = other._storage;
+        _flags = other._flags;
+        _dirty = true;
+        return *this;
+    }
+
+    Line& operator=(Line&& other) noexcept
+    {
+        releaseReadCache();
+        _storage = std::move(other._storage);
+        _flags = other._flags;
+        _readCache = other._readCache.exchange(nullptr);
+        _dirty = true;
+        return *this;
+    }
 
     using TrivialBuffer = TrivialLineBuffer;
+    using CompressedBuffer = CompressedLineBuffer;
     using InflatedBuffer = InflatedLineBuffer<Cell>;
     using Storage = LineStorage<Cell>;
     using value_type = Cell;
@@ -109,7 +224,7 @@ class Line
         if (isTrivialBuffer())
             trivialBuffer().reset(attributes);
         else
-            setBuffer(TrivialBuffer { ColumnCount::cast_from(inflatedBuffer().size()), attributes });
+            setBuffer(TrivialBuffer { size(), attributes });
     }
 
     void reset(LineFlags flags, GraphicsAttributes attributes, ColumnCount count) noexcept
@@ -142,7 +257,7 @@ class Line
         if (isTrivialBuffer())
             return trivialBuffer().text.empty();
 
-        for (auto const& cell: inflatedBuffer())
+        for (auto const& cell: cells())
             if (!cell.empty())
                 return false;
         return true;
@@ -178,15 +293,23 @@ class Line
     {
         if (isTrivialBuffer())
             return trivialBuffer().displayWidth;
+        else if (isCompressedBuffer())
+            return compressedBuffer().displayWidth;
         else
-            return ColumnCount::cast_from(inflatedBuffer().size());
+            return ColumnCount::cast_from(std::get<InflatedBuffer>(_storage).size());
     }
 
     void resize(ColumnCount count);
 
-    [[nodiscard]] gsl::span<Cell const> trim_blank_right() const noexcept;
+    [[nodiscard]] LineCells<Cell> trim_blank_right() const;
 
-    [[nodiscard]] gsl::span<Cell const> cells() const noexcept { return inflatedBuffer(); }
+    // Returns a view of the grid cells of this line for reading.
+    //
+    // This never alters the storage of the line, so that concurrent readers are safe.
+    // Trivial and compressed lines are unpacked into a separate read cache instead, which is shared
+    // by all readers. Modifying or compressing the line drops the read cache, but the views
+    // handed out keep sharing the cells unpacked so far.
+    [[nodiscard]] LineCells<Cell> cells() const;
 
     [[nodiscard]] gsl::span<Cell> useRange(ColumnOffset start, ColumnCount count) noexcept
     {
@@ -215,7 +338,7 @@ class Line
             return unbox<size_t>(column) >= trivialBuffer().text.size()
                    || trivialBuffer().text[column.as<size_t>()] == 0x20;
         }
-        return inflatedBuffer().at(unbox<size_t>(column)).empty();
+        return cells().at(unbox<size_t>(column)).empty();
     }
 
     [[nodiscard]] uint8_t cellWidthAt(ColumnOffset column) const noexcept
@@ -228,7 +351,7 @@ class Line
             return 1; // TODO: When trivial line is to support Unicode, this should be adapted here.
         }
 #endif
-        return inflatedBuffer().at(unbox<size_t>(column)).width();
+        return cells().at(unbox<size_t>(column)).width();
     }
 
     [[nodiscard]] LineFlags flags() const noexcept { return static_cast<LineFlags>(_flags); }
@@ -276,14 +399,24 @@ class Line
     [[nodiscard]] std::string toUtf8Trimmed() const;
     [[nodiscard]] std::string toUtf8Trimmed(bool stripLeadingSpaces, bool stripTrailingSpaces) const;
 
+    // Extracts the text of this line the way it is matched by matchTextAt(),
+    // i.e. the first codepoint of every column, or 0 for empty columns.
+    //
+    // Unlike cells(), this does not unpack trivial or compressed lines.
+    void searchableText(std::u32string& text) const;
+
     // Returns a reference to this mutable grid-line buffer.
     //
     // If this line has been stored in an optimized state, then
     // the line will be first unpacked into a vector of grid cells.
     [[nodiscard]] InflatedBuffer& inflatedBuffer();
-    [[nodiscard]] InflatedBuffer const& inflatedBuffer() const;
 
-    [[nodiscard]] TrivialBuffer& trivialBuffer() noexcept { return std::get<TrivialBuffer>(_storage); }
+    [[nodiscard]] TrivialBuffer& trivialBuffer() noexcept
+    {
+        _dirty = true;
+        releaseReadCache();
+        return std::get<TrivialBuffer>(_storage);
+    }
     [[nodiscard]] TrivialBuffer const& trivialBuffer() const noexcept
     {
         return std::get<TrivialBuffer>(_storage);
@@ -293,9 +426,42 @@ class Line
     {
         return std::holds_alternative<TrivialBuffer>(_storage);
     }
-    [[nodiscard]] bool isInflatedBuffer() const noexcept { return !isTrivialBuffer(); }
+    [[nodiscard]] bool isInflatedBuffer() const noexcept
+    {
+        return std::holds_alternative<InflatedBuffer>(_storage);
+    }
+
+    [[nodiscard]] CompressedBuffer const& compressedBuffer() const noexcept
+    {
+        return std::get<CompressedBuffer>(_storage);
+    }
+
+    [[nodiscard]] bool isCompressedBuffer() const noexcept
+    {
+        return std::holds_alternative<CompressedBuffer>(_storage);
+    }
+
+    /// Compresses this line if it is currently inflated,
+    /// or drops the cells unpacked for reading a compressed line.
+    ///
+    /// The line gets transparently inflated again on the next access to its cells.
+    ///
+    /// @returns true if the line has been compressed.
+    bool compress();
+
+    void setBuffer(Storage buffer) noexcept
+    {
+        releaseReadCache();
+        _storage = std::move(buffer);
+        _dirty = true;
+    }
 
-    void setBuffer(Storage buffer) noexcept { _storage = std::move(buffer); }
+    /// Tests if the contents of this line may have changed since the dirty state has been reset.
+    ///
+    /// Any mutable access to the cells of this line marks it dirty.
+    /// This is used to only update the changed lines of a render buffer.
+    [[nodiscard]] bool dirty() const noexcept { return _dirty; }
+    void setDirty(bool dirty) noexcept { _dirty = dirty; }
 
     // Tests if the given text can be matched in this line at the exact given start column.
     [[nodiscard]] bool matchTextAt(std::u32string_view text, ColumnOffset startColumn) const noexcept
@@ -316,14 +482,14 @@ class Line
         }
         else
         {
-            InflatedBuffer const& cells = inflatedBuffer();
+            auto const lineCells = cells();
             if (text.size() > unbox<size_t>(size()) - unbox<size_t>(startColumn))
                 return false;
             auto const baseColumn = unbox<size_t>(startColumn);
             size_t i = 0;
             while (i < text.size())
             {
-                if (!CellUtil::beginsWith(text.substr(i), cells[baseColumn + i]))
+                if (!CellUtil::beginsWith(text.substr(i), lineCells[baseColumn + i]))
                     return false;
                 ++i;
             }
@@ -353,7 +519,7 @@ class Line
         }
         else
         {
-            InflatedBuffer const& buffer = inflatedBuffer();
+            auto const buffer = cells();
             if (buffer.size() < text.size())
                 return std::nullopt; // not found: line is smaller than search term
 
@@ -399,7 +565,7 @@ class Line
         }
         else
         {
-            InflatedBuffer const& buffer = inflatedBuffer();
+            auto const buffer = cells();
             if (buffer.size() < text.size())
                 return std::nullopt; // not found: line is smaller than search term
 
@@ -424,22 +590,86 @@ class Line
     }
 
   private:
+    // Unpacks the storage into a vector of grid cells (if not done yet) without altering its contents.
+    InflatedBuffer& inflateStorage();
+
+    // Unpacks a trivial or compressed storage into a new vector of grid cells.
+    [[nodiscard]] InflatedBuffer unpackStorage() const;
+
+    // Cells unpacked for reading, shared with the views handed out by cells().
+    using ReadCache = std::shared_ptr<InflatedBuffer const>;
+
+    // Drops the cells unpacked for reading, if any. Views still sharing them keep them alive.
+    //
+    // @returns true if there were any.
+    bool releaseReadCache() noexcept
+    {
+        auto const* cells = _readCache.exchange(nullptr);
+        delete cells;
+        return cells != nullptr;
+    }
+
     Storage _storage;
     LineFlags _flags;
+    bool _dirty = true;
+
+    // Cells unpacked by cells() from a trivial or compressed storage.
+    mutable std::atomic<ReadCache*> _readCache = nullptr;
 };
 
 template <CellConcept Cell>
-inline typename Line<Cell>::InflatedBuffer& Line<Cell>::inflatedBuffer()
+inline typename Line<Cell>::InflatedBuffer Line<Cell>::unpackStorage() const
+{
+    if (auto const* trivialbuffer = std::get_if<TrivialBuffer>(&_storage))
+        return inflate<Cell>(*trivialbuffer);
+    else
+        return inflate<Cell>(std::get<CompressedBuffer>(_storage));
+}
+
+template <CellConcept Cell>
+inline typename Line<Cell>::InflatedBuffer& Line<Cell>::inflateStorage()
 {
-    if (auto trivialbuffer = std::get_if<TrivialBuffer>(&_storage))
-        _storage = inflate<Cell>(*trivialbuffer);
+    if (isInflatedBuffer())
+        return std::get<InflatedBuffer>(_storage);
+
+    // Render buffers may still refer to the text of the trivial buffer.
+    if (isTrivialBuffer())
+        _dirty = true;
+
+    auto* cells = _readCache.exchange(nullptr);
+    if (!cells)
+        _storage = unpackStorage();
+    else if (cells->use_count() == 1)
+        _storage = std::move(const_cast<InflatedBuffer&>(**cells)); // Not shared with any view.
+    else
+        _storage = InflatedBuffer(**cells);
+    delete cells;
     return std::get<InflatedBuffer>(_storage);
 }
 
 template <CellConcept Cell>
-inline typename Line<Cell>::InflatedBuffer const& Line<Cell>::inflatedBuffer() const
+inline typename Line<Cell>::InflatedBuffer& Line<Cell>::inflatedBuffer()
+{
+    _dirty = true;
+    return inflateStorage();
+}
+
+template <CellConcept Cell>
+inline LineCells<Cell> Line<Cell>::cells() const
 {
-    return const_cast<Line<Cell>*>(this)->inflatedBuffer();
+    if (auto const* cells = std::get_if<InflatedBuffer>(&_storage))
+        return LineCells<Cell>(*cells);
+
+    if (auto const* cells = _readCache.load(std::memory_order_acquire))
+        return LineCells<Cell>(*cells);
+
+    // Concurrent readers may unpack the line at the same time, in which case the first one wins.
+    // The cells are not created const, so that inflateStorage() may take them over once no longer shared.
+    auto unpacked = std::make_unique<ReadCache>(std::make_shared<InflatedBuffer>(unpackStorage()));
+    ReadCache* expected = nullptr;
+    if (_readCache.compare_exchange_strong(expected, unpacked.get(), std::memory_order_acq_rel))
+        return LineCells<Cell>(*unpacked.release());
+    return LineCells<Cell>(*expected);
 }
 
 } // namespace vtbackend
@@ -6,6 +6,8 @@
 
 #include <catch2/catch_test_macros.hpp>
 
+#include <utility>
+
 using namespace std;
 
 using namespace vtbackend;
@@ -109,6 +111,98 @@ TEST_CASE("Line.inflate", "[Line]")
     }
 }
 
+TEST_CASE("Line.compress", "[Line]")
+{
+    auto sgr = GraphicsAttributes {};
+    sgr.foregroundColor = RGBColor(0x123456);
+    sgr.backgroundColor = Color::Indexed(IndexedColor::Yellow);
+    sgr.flags |= CellFlag::Bold;
+
+    auto buffer = Line<Cell>::InflatedBuffer(8);
+    buffer[0].write(sgr, U'A', 1);
+    buffer[1].write(GraphicsAttributes {}, U'\u2705', 2, HyperlinkId(3));
+    buffer[2].reset(GraphicsAttributes {}, HyperlinkId(3));
+    buffer[3].write(sgr, U'e', 1);
+    (void) buffer[3].appendCharacter(U'\u0301');
+    buffer[4].reset(sgr); // blank cell with non-default attributes
+
+    auto line = Line<Cell>(LineFlag::Wrappable, buffer);
+    REQUIRE(line.compress());
+    CHECK(line.isCompressedBuffer());
+    CHECK(line.size() == ColumnCount(8));
+    CHECK(line.compressedBuffer().data.size() < line.compressedBuffer().inflatedSize);
+    CHECK_FALSE(line.compress());
+
+    // Reading the cells keeps the line compressed, and re-compressing drops the unpacked cells.
+    CHECK(std::as_const(line).cells().size() == buffer.size());
+    CHECK(line.isCompressedBuffer());
+    CHECK(line.compress());
+    CHECK_FALSE(line.compress());
+
+    auto const& inflated = line.inflatedBuffer();
+    CHECK(line.isInflatedBuffer());
+    REQUIRE(inflated.size() == buffer.size());
+    for (size_t i = 0; i < inflated.size(); ++i)
+    {
+        INFO(fmt::format("column {}", i));
+        CHECK(inflated[i].codepoints() == buffer[i].codepoints());
+        CHECK(inflated[i].width() == buffer[i].width());
+        CHECK(inflated[i].foregroundColor() == buffer[i].foregroundColor());
+        CHECK(inflated[i].backgroundColor() == buffer[i].backgroundColor());
+        CHECK(inflated[i].underlineColor() == buffer[i].underlineColor());
+        CHECK(inflated[i].flags() == buffer[i].flags());
+        CHECK(inflated[i].hyperlink() == buffer[i].hyperlink());
+    }
+}
+
+TEST_CASE("Line.cells.outlive_read_cache", "[Line]")
+{
+    auto const sgr = GraphicsAttributes {};
+    auto buffer = Line<Cell>::InflatedBuffer(4);
+    buffer[0].write(sgr, U'a', 1);
+    buffer[1].write(sgr, U'b', 1);
+
+    auto line = Line<Cell>(LineFlag::None, buffer);
+    REQUIRE(line.compress());
+
+    // Views of the unpacked cells stay valid when the line drops them, or gets modified.
+    auto const cells = std::as_const(line).cells();
+    CHECK(line.compress());
+    CHECK(cells.size() == 4);
+    CHECK(cells[0].codepoint(0) == U'a');
+
+    auto const cells2 = std::as_const(line).cells();
+    line.useCellAt(ColumnOffset(0)).write(sgr, U'x', 1);
+    CHECK(line.isInflatedBuffer());
+    CHECK(cells2[0].codepoint(0) == U'a');
+    CHECK(std::as_const(line).cells()[0].codepoint(0) == U'x');
+    CHECK(cells2[1].codepoint(0) == U'b');
+}
+
+TEST_CASE("Line.searchableText", "[Line]")
+{
+    auto buffer = Line<Cell>::InflatedBuffer(6);
+    buffer[0].write(GraphicsAttributes {}, U'a', 1);
+    buffer[1].write(GraphicsAttributes {}, U'\u2705', 2);
+    buffer[2].reset(GraphicsAttributes {}.with(CellFlag::WideCharContinuation));
+    buffer[3].write(GraphicsAttributes {}.with(CellFlag::Bold), U'e', 1);
+    (void) buffer[3].appendCharacter(U'\u0301');
+
+    auto const expected = U"a\u2705\0e\0\0"s;
+
+    auto line = Line<Cell>(LineFlag::None, buffer);
+    auto text = u32string { U"garbage" };
+    line.searchableText(text);
+    CHECK(text == expected);
+
+    // The text of a compressed line is read without unpacking its cells.
+    REQUIRE(line.compress());
+    line.searchableText(text);
+    CHECK(text == expected);
+    CHECK(line.isCompressedBuffer());
+    CHECK_FALSE(line.compress()); // There are no cells unpacked for reading to be dropped.
+}
+
 TEST_CASE("Line.inflate.Unicode", "[Line]")
 {
     auto constexpr DisplayWidth = ColumnCount(10);
@@ -90,6 +90,8 @@ class MockTerm: public Terminal::NullEvents
     {
         terminal.primaryScreen().captureBuffer(lines, logical);
     }
+
+    void requestImageFile(ImageFileRequest request) override { terminal.imageFile(request); }
 };
 
 template <typename PtyDevice>
@@ -3,11 +3,36 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <mutex>
 
 namespace vtbackend
 {
 
+bool RenderBuffer::containsBlinkingCells() const noexcept
+{
+    return std::any_of(lineSpans.begin(), lineSpans.end(), [](RenderLineSpan const& span) {
+        return span.containsBlinkingCells;
+    });
+}
+
+std::vector<Rect> RenderBuffer::damageSince(uint64_t lastFrameID) const
+{
+    auto const right = Right(unbox<int>(context.pageSize.columns) - 1);
+    auto damage = std::vector<Rect> {};
+    for (auto line = 0; line < static_cast<int>(lineSpans.size()); ++line)
+    {
+        if (lastFrameID != 0 && lineSpans[static_cast<size_t>(line)].frameID <= lastFrameID)
+            continue;
+
+        if (!damage.empty() && *damage.back().bottom + 1 == line)
+            damage.back().bottom = Bottom(line);
+        else
+            damage.emplace_back(Rect { Top(line), Left(0), Bottom(line), right });
+    }
+    return damage;
+}
+
 bool RenderDoubleBuffer::swapBuffers(std::chrono::steady_clock::time_point now) noexcept
 {
     // If the terminal thread (writer) cannot try_lock (w/o wait time)
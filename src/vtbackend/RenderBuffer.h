@@ -4,6 +4,7 @@
 #include <vtbackend/CellFlags.h>
 #include <vtbackend/Color.h>
 #include <vtbackend/Grid.h>
+#include <vtbackend/Hyperlink.h>
 #include <vtbackend/Image.h>
 #include <vtbackend/primitives.h>
 
@@ -13,8 +14,12 @@
 
 #include <atomic>
 #include <chrono>
+#include <limits>
+#include <memory>
 #include <mutex>
 #include <optional>
+#include <string_view>
+#include <type_traits>
 #include <vector>
 
 namespace vtbackend
@@ -28,14 +33,26 @@ struct RenderAttributes
     CellFlags flags {};
 };
 
+/// Handle to an image fragment of a RenderBuffer.
+///
+/// @see RenderBuffer::imageFragment()
+enum class RenderImageHandle : uint32_t
+{
+    None = std::numeric_limits<uint32_t>::max()
+};
+
 /**
  * Renderable representation of a grid cell with color-altering pre-applied and
  * additional information for cell ranges that can be text-shaped together.
+ *
+ * Render cells are trivially copyable. Their codepoints and images are stored in the RenderBuffer
+ * they belong to.
  */
 struct RenderCell
 {
-    std::u32string codepoints;
-    std::shared_ptr<ImageFragment> image;
+    uint32_t codepointsBegin = 0; ///< Index of the first codepoint in RenderBuffer::codepoints.
+    uint32_t codepointCount = 0;
+    RenderImageHandle image = RenderImageHandle::None;
     CellLocation position;
     RenderAttributes attributes;
     uint8_t width = 1;
@@ -44,6 +61,8 @@ struct RenderCell
     bool groupEnd = false;
 };
 
+static_assert(std::is_trivially_copyable_v<RenderCell>);
+
 /**
  * Renderable representation of a grid line with monochrome SGR styling.
  */
@@ -64,19 +83,123 @@ struct RenderCursor
     int width = 1;
 };
 
+/**
+ * Locates the render data of a single screen line within a RenderBuffer.
+ *
+ * A screen line is either rendered as a range of RenderCell objects, or as a single RenderLine.
+ */
+struct RenderLineSpan
+{
+    size_t cellsBegin = 0; ///< Index of the first RenderCell of this line.
+    size_t cellsEnd = 0;   ///< Index one past the last RenderCell of this line.
+    size_t linesBegin = 0; ///< Index of the RenderLine of this line, if any.
+    size_t linesEnd = 0;   ///< Index one past the RenderLine of this line.
+
+    /// ID of the frame the render data of this line has been built in, or 0 if not rendered at all.
+    uint64_t frameID = 0;
+
+    bool containsBlinkingCells = false;
+
+    /// Whether or not the colors of this line are affected by the text cursor or the vi-mode cursor line.
+    bool cursorLine = false;
+};
+
+/**
+ * Terminal state, other than the grid contents, that a RenderBuffer has been built with.
+ *
+ * Lines of a RenderBuffer may only be reused for a later frame if all of it is unchanged.
+ */
+struct RenderBufferContext
+{
+    PageSize pageSize {};
+    LineOffset mainPageBaseLine {}; ///< Screen line the main page starts at (below a status line).
+    bool primaryScreen = true;
+    bool reverseVideo = false;
+    HyperlinkId hoveringHyperlink {};
+    uint64_t colorPaletteGeneration = 0;
+
+    /// Whether or not selection, search matches, highlights, or input method text are shown.
+    /// These are not tracked per line and therefore always require a full update.
+    bool overlays = false;
+
+    bool operator==(RenderBufferContext const&) const noexcept = default;
+};
+
 struct RenderBuffer
 {
     std::vector<RenderCell> cells {};
     std::vector<RenderLine> lines {};
+
+    /// Codepoints of all cells, in the order the cells have been added.
+    std::vector<char32_t> codepoints {};
+
+    /// Image fragments of all cells, indexed by RenderImageHandle.
+    std::vector<std::shared_ptr<ImageFragment>> imageFragments {};
+
     std::optional<RenderCursor> cursor {};
     uint64_t frameID {};
 
+    /// Location of the render data, indexed by screen line.
+    std::vector<RenderLineSpan> lineSpans {};
+    RenderBufferContext context {};
+    bool blinkState = false;
+    bool rapidBlinkState = false;
+
+    /// Position of the top-most displayed main page line in the contents the screen has scrolled through.
+    ///
+    /// The difference between two frames tells by how many lines the displayed contents have moved up.
+    int64_t pageTopLine = 0;
+
+    /// Clears the render data, keeping the allocated memory to be reused by the next frame.
     void clear()
     {
         cells.clear();
         lines.clear();
+        codepoints.clear();
+        imageFragments.clear();
         cursor.reset();
+        lineSpans.clear();
     }
+
+    /// Appends the given codepoints to the given cell.
+    ///
+    /// The codepoints of a cell must be appended before those of any other cell.
+    void appendCodepoints(RenderCell& cell, std::u32string_view text)
+    {
+        if (cell.codepointCount == 0)
+            cell.codepointsBegin = static_cast<uint32_t>(codepoints.size());
+        codepoints.insert(codepoints.end(), text.begin(), text.end());
+        cell.codepointCount += static_cast<uint32_t>(text.size());
+    }
+
+    /// Adds an image fragment to be referenced by the cells of this buffer.
+    [[nodiscard]] RenderImageHandle addImageFragment(std::shared_ptr<ImageFragment> fragment)
+    {
+        imageFragments.emplace_back(std::move(fragment));
+        return static_cast<RenderImageHandle>(imageFragments.size() - 1);
+    }
+
+    [[nodiscard]] std::u32string_view codepointsOf(RenderCell const& cell) const noexcept
+    {
+        return { codepoints.data() + cell.codepointsBegin, cell.codepointCount };
+    }
+
+    /// Returns the image fragment of the given cell, or nullptr if it has none.
+    [[nodiscard]] ImageFragment const* imageFragmentOf(RenderCell const& cell) const noexcept
+    {
+        if (cell.image == RenderImageHandle::None)
+            return nullptr;
+        return imageFragments[static_cast<size_t>(cell.image)].get();
+    }
+
+    /// Tests if any line of this buffer contains blinking cells.
+    [[nodiscard]] bool containsBlinkingCells() const noexcept;
+
+    /// Computes the screen areas whose render data has changed since the given frame.
+    ///
+    /// Each area covers one or more consecutive full screen lines.
+    /// Passing a frame ID of 0 marks the full screen as damaged.
+    [[nodiscard]] std::vector<Rect> damageSince(uint64_t lastFrameID) const;
 };
 
 /// Lock-guarded handle to a read-only RenderBuffer object.
@@ -10,6 +10,9 @@
 #include <libunicode/convert.h>
 #include <libunicode/utf8_grapheme_segmenter.h>
 
+#include <algorithm>
+#include <iterator>
+
 using namespace std;
 
 namespace vtbackend
@@ -108,15 +111,18 @@ RenderBufferBuilder<Cell>::RenderBufferBuilder(Terminal const& terminal,
                                                HighlightSearchMatches highlightSearchMatches,
                                                InputMethodData inputMethodData,
                                                optional<CellLocation> theCursorPosition,
-                                               bool includeSelection):
+                                               bool includeSelection,
+                                               PreviousRenderFrame previousFrame):
     _output { &output },
     _terminal { &terminal },
+    _previousFrame { previousFrame },
     _cursorPosition { theCursorPosition },
     _baseLine { base },
     _reverseVideo { theReverseVideo },
-    _highlightSearchMatches { highlightSearchMatches },
     _inputMethodData { std::move(inputMethodData) },
-    _includeSelection { includeSelection }
+    _includeSelection { includeSelection },
+    _searchPattern { highlightSearchMatches == HighlightSearchMatches::Yes ? terminal.searchPattern()
+                                                                           : nullptr }
 {
     output.frameID = terminal.lastFrameID();
 
@@ -124,6 +130,58 @@ RenderBufferBuilder<Cell>::RenderBufferBuilder(Terminal const& terminal,
         output.cursor = renderCursor();
 }
 
+template <CellConcept Cell>
+bool RenderBufferBuilder<Cell>::reuseLine(LineOffset line)
+{
+    if (!_previousFrame.buffer)
+        return false;
+
+    auto& previous = *_previousFrame.buffer;
+    auto const screenLine = unbox<size_t>(_baseLine + line);
+    auto const pageLine = unbox<size_t>(line);
+    if (screenLine >= previous.lineSpans.size() || pageLine >= _previousFrame.lineChangeFrameIDs.size())
+        return false;
+
+    auto const& span = previous.lineSpans[screenLine];
+    auto const blinkStateChanged = previous.blinkState != _terminal->blinkState()
+                                   || previous.rapidBlinkState != _terminal->rapidBlinkState();
+
+    if (!span.frameID || span.cursorLine || _previousFrame.lineChangeFrameIDs[pageLine] > previous.frameID
+        || (span.containsBlinkingCells && blinkStateChanged) || isCursorAffectedLine(line))
+        return false;
+
+    auto reusedSpan = span;
+    reusedSpan.cellsBegin = _output->cells.size();
+    reusedSpan.linesBegin = _output->lines.size();
+    for (auto i = span.cellsBegin; i < span.cellsEnd; ++i)
+    {
+        // Codepoints and images are stored in the buffer, and thus copied over to this one.
+        auto cell = previous.cells[i];
+        auto const text = previous.codepointsOf(cell);
+        cell.codepointsBegin = static_cast<uint32_t>(_output->codepoints.size());
+        _output->codepoints.insert(_output->codepoints.end(), text.begin(), text.end());
+        if (cell.image != RenderImageHandle::None)
+            cell.image = _output->addImageFragment(previous.imageFragments[static_cast<size_t>(cell.image)]);
+        _output->cells.push_back(cell);
+    }
+    std::move(next(previous.lines.begin(), static_cast<ptrdiff_t>(span.linesBegin)),
+              next(previous.lines.begin(), static_cast<ptrdiff_t>(span.linesEnd)),
+              back_inserter(_output->lines));
+    reusedSpan.cellsEnd = _output->cells.size();
+    reusedSpan.linesEnd = _output->lines.size();
+    setLineSpan(line, reusedSpan);
+    return true;
+}
+
+template <CellConcept Cell>
+void RenderBufferBuilder<Cell>::setLineSpan(LineOffset line, RenderLineSpan span)
+{
+    auto const screenLine = unbox<size_t>(_baseLine + line);
+    if (_output->lineSpans.size() <= screenLine)
+        _output->lineSpans.resize(screenLine + 1);
+    _output->lineSpans[screenLine] = span;
+}
+
 template <CellConcept Cell>
 optional<RenderCursor> RenderBufferBuilder<Cell>::renderCursor() const
 {
@@ -148,7 +206,7 @@ optional<RenderCursor> RenderBufferBuilder<Cell>::renderCursor() const
 
 template <CellConcept Cell>
 RenderCell RenderBufferBuilder<Cell>::makeRenderCellExplicit(ColorPalette const& colorPalette,
-                                                             u32string graphemeCluster,
+                                                             u32string_view graphemeCluster,
                                                              ColumnCount width,
                                                              CellFlags flags,
                                                              RGBColor fg,
@@ -165,7 +223,7 @@ RenderCell RenderBufferBuilder<Cell>::makeRenderCellExplicit(ColorPalette const&
     renderCell.position.line = line;
     renderCell.position.column = column;
     renderCell.width = unbox<uint8_t>(width);
-    renderCell.codepoints = std::move(graphemeCluster);
+    _output->appendCodepoints(renderCell, graphemeCluster);
     return renderCell;
 }
 
@@ -188,7 +246,7 @@ RenderCell RenderBufferBuilder<Cell>::makeRenderCellExplicit(ColorPalette const&
     renderCell.position.column = column;
     renderCell.width = 1;
     if (codepoint)
-        renderCell.codepoints.push_back(codepoint);
+        _output->appendCodepoints(renderCell, u32string_view(&codepoint, 1));
     return renderCell;
 }
 
@@ -210,13 +268,16 @@ RenderCell RenderBufferBuilder<Cell>::makeRenderCell(ColorPalette const& colorPa
     renderCell.position.column = column;
     renderCell.width = screenCell.width();
 
-    if (screenCell.codepointCount() != 0)
+    if (auto const codepointCount = screenCell.codepointCount(); codepointCount != 0)
     {
-        for (size_t i = 0; i < screenCell.codepointCount(); ++i)
-            renderCell.codepoints.push_back(screenCell.codepoint(i));
+        renderCell.codepointsBegin = static_cast<uint32_t>(_output->codepoints.size());
+        renderCell.codepointCount = static_cast<uint32_t>(codepointCount);
+        for (size_t i = 0; i < codepointCount; ++i)
+            _output->codepoints.push_back(screenCell.codepoint(i));
     }
 
-    renderCell.image = screenCell.imageFragment();
+    if (auto fragment = screenCell.imageFragment())
+        renderCell.image = _output->addImageFragment(std::move(fragment));
 
     if (auto href = hyperlinks.hyperlinkById(screenCell.hyperlink()))
     {
@@ -334,6 +395,14 @@ void RenderBufferBuilder<Cell>::renderTrivialLine(TrivialLineBuffer const& lineB
     _useCursorlineColoring = false;
 
     auto const frontIndex = _output->cells.size();
+    auto const blinkingFlags = CellFlags { CellFlag::Blinking, CellFlag::RapidBlinking };
+    auto span = RenderLineSpan {};
+    span.cellsBegin = frontIndex;
+    span.linesBegin = _output->lines.size();
+    span.frameID = _output->frameID;
+    span.containsBlinkingCells =
+        ((lineBuffer.textAttributes.flags | lineBuffer.fillAttributes.flags) & blinkingFlags).any();
+    span.cursorLine = isCursorAffectedLine(lineOffset);
 
     // Visual selection can alter colors for some columns in this line.
     // In that case, it seems like we cannot just pass it bare over but have to take the slower path.
@@ -352,6 +421,9 @@ void RenderBufferBuilder<Cell>::renderTrivialLine(TrivialLineBuffer const& lineB
         _lineNr = lineOffset;
         _prevWidth = 0;
         _prevHasCursor = false;
+        span.cellsEnd = _output->cells.size();
+        span.linesEnd = _output->lines.size();
+        setLineSpan(lineOffset, span);
         return;
     }
 
@@ -388,31 +460,34 @@ void RenderBufferBuilder<Cell>::renderTrivialLine(TrivialLineBuffer const& lineB
 
     _output->cells[frontIndex].groupStart = true;
     _output->cells[backIndex].groupEnd = true;
+
+    span.cellsEnd = _output->cells.size();
+    span.linesEnd = _output->lines.size();
+    setLineSpan(lineOffset, span);
 }
 
 template <CellConcept Cell>
 template <typename T>
 void RenderBufferBuilder<Cell>::matchSearchPattern(T const& cellText)
 {
-    if (_highlightSearchMatches == HighlightSearchMatches::No)
+    // Other than literal terms are matched once the line is complete.
+    if (!_searchPattern || _searchPattern->mode() != SearchMode::Literal)
         return;
 
-    auto const& search = _terminal->search();
-    if (search.pattern.empty())
-        return;
+    auto const& pattern = _searchPattern->term();
 
     auto const isFullMatch = [&]() -> bool {
         if constexpr (std::is_same_v<Cell, T>)
         {
-            return !CellUtil::beginsWith(u32string_view(search.pattern.data() + _searchPatternOffset,
-                                                        search.pattern.size() - _searchPatternOffset),
-                                         cellText);
+            return !CellUtil::beginsWith(
+                u32string_view(pattern.data() + _searchPatternOffset, pattern.size() - _searchPatternOffset),
+                cellText);
         }
         else
         {
-            return crispy::beginsWith(u32string_view(search.pattern.data() + _searchPatternOffset,
-                                                     search.pattern.size() - _searchPatternOffset),
-                                      cellText);
+            return crispy::beginsWith(
+                u32string_view(pattern.data() + _searchPatternOffset, pattern.size() - _searchPatternOffset),
+                cellText);
         }
     }();
 
@@ -428,17 +503,59 @@ void RenderBufferBuilder<Cell>::matchSearchPattern(T const& cellText)
     else
         _searchPatternOffset += cellText.size();
 
-    if (_searchPatternOffset < search.pattern.size())
+    if (_searchPatternOffset < pattern.size())
         return; // match incomplete
 
     // match complete
 
-    auto const offsetIntoFront = _output->cells.size() - _searchPatternOffset;
+    highlightSearchMatch(_output->cells.size() - _searchPatternOffset, _output->cells.size());
+    _searchPatternOffset = 0;
+}
+
+template <CellConcept Cell>
+void RenderBufferBuilder<Cell>::matchSearchPatternInLine()
+{
+    if (!_searchPattern || _searchPattern->mode() == SearchMode::Literal)
+        return;
+
+    // Lays out the line's text by column, so that matches can be mapped back to the rendered cells.
+    _lineText.clear();
+    for (auto i = _lineCellsBegin; i < _output->cells.size(); ++i)
+    {
+        auto const& cell = _output->cells[i];
+        auto const column = unbox<size_t>(cell.position.column);
+        if (_lineText.size() <= column)
+            _lineText.resize(column + 1, U' ');
+        if (cell.codepointCount != 0)
+            _lineText[column] = _output->codepoints[cell.codepointsBegin];
+    }
+    auto text = u32string_view(_lineText);
+    while (!text.empty() && text.back() == U' ')
+        text.remove_suffix(1);
+
+    auto first = _lineCellsBegin;
+    _searchPattern->forEachMatch(text, [&](SearchMatch match) {
+        auto const columnOf = [&](size_t i) {
+            return unbox<size_t>(_output->cells[i].position.column);
+        };
+        while (first < _output->cells.size() && columnOf(first) < match.start)
+            ++first;
+        auto last = first;
+        while (last < _output->cells.size() && columnOf(last) < match.start + match.length)
+            ++last;
+        if (first != last)
+            highlightSearchMatch(first, last);
+        first = last;
+    });
+}
 
+template <CellConcept Cell>
+void RenderBufferBuilder<Cell>::highlightSearchMatch(size_t first, size_t last)
+{
     auto const isFocusedMatch =
         CellLocationRange {
-            _output->cells[offsetIntoFront].position,
-            _output->cells.back().position,
+            _output->cells[first].position,
+            _output->cells[last - 1].position,
         }
             .contains(
                 _terminal->viewport().translateGridToScreenCoordinate(_terminal->normalModeCursorPosition()));
@@ -461,7 +578,7 @@ void RenderBufferBuilder<Cell>::matchSearchPattern(T const& cellText)
         }
     }();
 
-    for (size_t i = offsetIntoFront; i < _output->cells.size(); ++i)
+    for (size_t i = first; i < last; ++i)
     {
         auto& cellAttributes = _output->cells[i].attributes;
         auto const actualColors =
@@ -471,13 +588,13 @@ void RenderBufferBuilder<Cell>::matchSearchPattern(T const& cellText)
         cellAttributes.backgroundColor = searchMatchColors.background;
         cellAttributes.foregroundColor = searchMatchColors.foreground;
     }
-    _searchPatternOffset = 0;
 }
 
 template <CellConcept Cell>
 void RenderBufferBuilder<Cell>::startLine(LineOffset line) noexcept
 {
     _lineNr = line;
+    _lineCellsBegin = _output->cells.size();
     _prevWidth = 0;
     _prevHasCursor = false;
 
@@ -494,6 +611,13 @@ bool RenderBufferBuilder<Cell>::isCursorLine(LineOffset line) const noexcept
                          .line;
 }
 
+template <CellConcept Cell>
+bool RenderBufferBuilder<Cell>::isCursorAffectedLine(LineOffset line) const noexcept
+{
+    return gridLineContainsCursor(line) || isCursorLine(line)
+           || (_output->cursor && _output->cursor->position.line == _baseLine + line);
+}
+
 template <CellConcept Cell>
 void RenderBufferBuilder<Cell>::endLine() noexcept
 {
@@ -501,6 +625,22 @@ void RenderBufferBuilder<Cell>::endLine() noexcept
     {
         _output->cells.back().groupEnd = true;
     }
+
+    matchSearchPatternInLine();
+
+    auto const blinkingFlags = CellFlags { CellFlag::Blinking, CellFlag::RapidBlinking };
+    auto span = RenderLineSpan {};
+    span.cellsBegin = _lineCellsBegin;
+    span.cellsEnd = _output->cells.size();
+    span.linesBegin = _output->lines.size();
+    span.linesEnd = _output->lines.size();
+    span.frameID = _output->frameID;
+    span.containsBlinkingCells =
+        std::any_of(next(_output->cells.begin(), static_cast<ptrdiff_t>(span.cellsBegin)),
+                    _output->cells.end(),
+                    [&](RenderCell const& cell) { return (cell.attributes.flags & blinkingFlags).any(); });
+    span.cursorLine = isCursorAffectedLine(_lineNr);
+    setLineSpan(_lineNr, span);
 }
 
 template <CellConcept Cell>
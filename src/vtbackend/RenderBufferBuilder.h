@@ -14,8 +14,21 @@
 namespace vtbackend
 {
 
+/// A previously rendered frame to incrementally update a render buffer from.
+struct PreviousRenderFrame
+{
+    /// Render data of the previous frame. Render data being reused is moved out of it.
+    RenderBuffer* buffer = nullptr;
+
+    /// ID of the frame each page line has last been changed in, indexed by page line.
+    gsl::span<uint64_t const> lineChangeFrameIDs {};
+};
+
 /**
  * RenderBufferBuilder<Cell> renders the current screen state into a RenderBuffer.
+ *
+ * If a previous frame is given, lines that have not changed since are taken over from it
+ * rather than being rendered again.
  */
 template <CellConcept Cell>
 class RenderBufferBuilder
@@ -28,7 +41,16 @@ class RenderBufferBuilder
                         HighlightSearchMatches highlightSearchMatches,
                         InputMethodData inputMethodData,
                         std::optional<CellLocation> theCursorPosition,
-                        bool includeSelection);
+                        bool includeSelection,
+                        PreviousRenderFrame previousFrame = {});
+
+    /// Takes over the render data of the given line from the previous frame, if unchanged since.
+    ///
+    /// This call is guaranteed to be invoked for every line before rendering it.
+    ///
+    /// @retval true  the line has been taken over and must not be rendered again.
+    /// @retval false the line must be rendered.
+    [[nodiscard]] bool reuseLine(LineOffset line);
 
     /// Renders a single grid cell.
     /// This call is guaranteed to be invoked sequencially, from top line
@@ -57,35 +79,44 @@ class RenderBufferBuilder
   private:
     [[nodiscard]] bool isCursorLine(LineOffset line) const noexcept;
 
+    /// Tests if the colors of the given line are affected by either the text cursor or the vi-mode cursor.
+    [[nodiscard]] bool isCursorAffectedLine(LineOffset line) const noexcept;
+
+    /// Records the location of the render data of the given line.
+    void setLineSpan(LineOffset line, RenderLineSpan span);
+
     [[nodiscard]] std::optional<RenderCursor> renderCursor() const;
 
-    [[nodiscard]] static RenderCell makeRenderCellExplicit(ColorPalette const& colorPalette,
-                                                           std::u32string graphemeCluster,
-                                                           ColumnCount width,
-                                                           CellFlags flags,
-                                                           RGBColor fg,
-                                                           RGBColor bg,
-                                                           Color ul,
-                                                           LineOffset line,
-                                                           ColumnOffset column);
-
-    [[nodiscard]] static RenderCell makeRenderCellExplicit(ColorPalette const& colorPalette,
-                                                           char32_t codepoint,
-                                                           CellFlags flags,
-                                                           RGBColor fg,
-                                                           RGBColor bg,
-                                                           Color ul,
-                                                           LineOffset line,
-                                                           ColumnOffset column);
+    // The following functions store the codepoints and images of the constructed RenderCell
+    // in the output buffer.
+
+    [[nodiscard]] RenderCell makeRenderCellExplicit(ColorPalette const& colorPalette,
+                                                    std::u32string_view graphemeCluster,
+                                                    ColumnCount width,
+                                                    CellFlags flags,
+                                                    RGBColor fg,
+                                                    RGBColor bg,
+                                                    Color ul,
+                                                    LineOffset line,
+                                                    ColumnOffset column);
+
+    [[nodiscard]] RenderCell makeRenderCellExplicit(ColorPalette const& colorPalette,
+                                                    char32_t codepoint,
+                                                    CellFlags flags,
+                                                    RGBColor fg,
+                                                    RGBColor bg,
+                                                    Color ul,
+                                                    LineOffset line,
+                                                    ColumnOffset column);
 
     /// Constructs a RenderCell for the given screen Cell.
-    [[nodiscard]] static RenderCell makeRenderCell(ColorPalette const& colorPalette,
-                                                   HyperlinkStorage const& hyperlinks,
-                                                   Cell const& cell,
-                                                   RGBColor fg,
-                                                   RGBColor bg,
-                                                   LineOffset line,
-                                                   ColumnOffset column);
+    [[nodiscard]] RenderCell makeRenderCell(ColorPalette const& colorPalette,
+                                            HyperlinkStorage const& hyperlinks,
+                                            Cell const& cell,
+                                            RGBColor fg,
+                                            RGBColor bg,
+                                            LineOffset line,
+                                            ColumnOffset column);
 
     /// Constructs the final foreground/background colors to be displayed on the screen.
     ///
@@ -111,6 +142,13 @@ class RenderBufferBuilder
     template <typename T>
     void matchSearchPattern(T const& cellText);
 
+    /// Matches the search pattern against the line rendered last, unless it is a literal one,
+    /// which is matched cell by cell in matchSearchPattern().
+    void matchSearchPatternInLine();
+
+    /// Applies the search highlight colors to the given range of rendered cells.
+    void highlightSearchMatch(size_t first, size_t last);
+
     /// Tests if the given screen line offset does contain a cursor (either ANSI cursor or vi cursor, if
     /// shown) and returns false otherwise, which guarantees that no cursor is to be rendered
     /// on the given line offset.
@@ -122,10 +160,10 @@ class RenderBufferBuilder
 
     gsl::not_null<RenderBuffer*> _output;
     gsl::not_null<Terminal const*> _terminal;
+    PreviousRenderFrame _previousFrame;
     std::optional<CellLocation> _cursorPosition;
     LineOffset _baseLine;
     bool _reverseVideo;
-    HighlightSearchMatches _highlightSearchMatches;
     InputMethodData _inputMethodData;
     bool _includeSelection;
     ColumnCount _inputMethodSkipColumns = ColumnCount(0);
@@ -133,10 +171,17 @@ class RenderBufferBuilder
     int _prevWidth = 0;
     bool _prevHasCursor = false;
     LineOffset _lineNr = LineOffset(0);
+    size_t _lineCellsBegin = 0; // Index of the first RenderCell of the current line.
     bool _useCursorlineColoring = false;
 
+    // The search pattern to highlight matches of, if any.
+    SearchPattern const* _searchPattern = nullptr;
+
     // Offset into the search pattern that has been already matched.
     size_t _searchPatternOffset = 0;
+
+    // Text of the line rendered last, by column, for matching non-literal search patterns.
+    std::u32string _lineText;
 };
 
 } // namespace vtbackend
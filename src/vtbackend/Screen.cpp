@@ -28,6 +28,7 @@
 #include <cassert>
 #include <iostream>
 #include <iterator>
+#include <limits>
 #include <sstream>
 #include <string_view>
 #include <tuple>
@@ -1351,11 +1352,10 @@ void Screen<Cell>::deleteCharacters(ColumnCount n)
 template <CellConcept Cell>
 void Screen<Cell>::deleteChars(LineOffset lineOffset, ColumnOffset column, ColumnCount columnsToDelete)
 {
-    auto& line = _grid.lineAt(lineOffset);
-    auto lineBuffer = line.cells();
+    auto& lineBuffer = _grid.lineAt(lineOffset).inflatedBuffer();
 
-    Cell* left = const_cast<Cell*>(lineBuffer.data() + column.as<size_t>());
-    Cell* right = const_cast<Cell*>(lineBuffer.data() + *margin().horizontal.to + 1);
+    Cell* left = lineBuffer.data() + column.as<size_t>();
+    Cell* right = lineBuffer.data() + *margin().horizontal.to + 1;
     long const n = std::min(columnsToDelete.as<long>(), static_cast<long>(std::distance(left, right)));
     Cell* mid = left + n;
 
@@ -1536,6 +1536,9 @@ void Screen<Cell>::captureBuffer(LineCount lineCount, bool logicalLines)
 
     auto capturedBuffer = std::string();
 
+    // Capturing may reach up to the older history lines still being reflowed in the background.
+    _terminal->completeHistoryReflow();
+
     // TODO: when capturing lineCount < screenSize.lines, start at the lowest non-empty line.
     auto const relativeStartLine =
         logicalLines ? _grid.computeLogicalLineNumberFromBottom(LineCount::cast_from(lineCount))
@@ -2242,12 +2245,20 @@ void Screen<Cell>::inspect(std::string const& message, std::ostream& os) const
     os << fmt::format("vertical margins     : {}\n", margin().vertical);
     os << fmt::format("horizontal margins   : {}\n", margin().horizontal);
     os << gridInfoLine(grid());
+    if (auto const stats = grid().historyStats(); stats.coldLines)
+        os << fmt::format("cold scrollback      : {} lines ({} hot), {} bytes compressed, {} bytes saved\n",
+                          stats.coldLines,
+                          stats.hotLines,
+                          stats.compressedBytes,
+                          stats.bytesSaved);
 
     hline();
     os << screenshot([this](LineOffset lineNo) -> string {
         // auto const absoluteLine = _grid.toAbsoluteLine(lineNo);
         return fmt::format("{} {:>4}: {}",
-                           _grid.lineAt(lineNo).isTrivialBuffer() ? "|" : ":",
+                           _grid.lineAt(lineNo).isTrivialBuffer()      ? "|"
+                           : _grid.lineAt(lineNo).isCompressedBuffer() ? "#"
+                                                                       : ":",
                            lineNo.value,
                            _grid.lineAt(lineNo).flags());
     });
@@ -3255,7 +3266,7 @@ void Screen<Cell>::processSequence(Sequence const& seq)
 #if defined(LIBTERMINAL_LOG_TRACE)
     if (vtTraceSequenceLog)
     {
-        if (auto const* fd = seq.functionDefinition(_terminal->activeSequences()))
+        if (auto const* fd = seq.functionDefinition(_terminal->supportedSequences()))
         {
             vtTraceSequenceLog()("[{}] Processing {:<14} {}", _name, fd->documentation.mnemonic, seq.text());
         }
@@ -3268,7 +3279,8 @@ void Screen<Cell>::processSequence(Sequence const& seq)
     //         seq.functionDefinition() ? seq.functionDefinition()->comment : ""sv);
 
     _terminal->incrementInstructionCounter();
-    if (Function const* funcSpec = seq.functionDefinition(_terminal->activeSequences()); funcSpec != nullptr)
+    if (Function const* funcSpec = seq.functionDefinition(_terminal->supportedSequences());
+        funcSpec != nullptr)
         applyAndLog(*funcSpec, seq);
     else if (vtParserLog)
         vtParserLog()("Unknown VT sequence: {}", seq);
@@ -3735,6 +3747,7 @@ ApplyResult Screen<Cell>::apply(Function const& function, Sequence const& seq)
 
         // hooks
         case DECSIXEL: _terminal->hookParser(hookSixel(seq)); break;
+        case IMAGEFILE: _terminal->hookParser(hookImageFile(seq)); break;
         case STP: _terminal->hookParser(hookSTP(seq)); break;
         case DECRQSS: _terminal->hookParser(hookDECRQSS(seq)); break;
         case XTGETTCAP: _terminal->hookParser(hookXTGETTCAP(seq)); break;
@@ -3787,6 +3800,57 @@ unique_ptr<ParserExtension> Screen<Cell>::hookSixel(Sequence const& seq)
     });
 }
 
+template <CellConcept Cell>
+unique_ptr<ParserExtension> Screen<Cell>::hookImageFile(Sequence const& seq)
+{
+    // DCS Pw ; Ph ; Pf ; Pt ! i <base64 encoded path> ST
+    //
+    // Pw, Ph: image size in pixels
+    // Pf:     pixel format, 3 for RGB or 4 for RGBA (default)
+    // Pt:     0 for a regular file (default), 1 for a shared memory object
+    auto const imageSize = ImageSize { seq.param<Width>(0), seq.param<Height>(1) };
+    auto const format = seq.param_or(2, 4) == 3 ? ImageFormat::RGB : ImageFormat::RGBA;
+    auto const transmission =
+        seq.param_or(3, 0) == 1 ? ImageTransmission::SharedMemory : ImageTransmission::File;
+
+    return make_unique<SimpleStringCollector>([=, this](string_view const& data) {
+        auto const maxSize = _terminal->maxImageSize();
+        if (!*imageSize.width || !*imageSize.height || imageSize.width > maxSize.width
+            || imageSize.height > maxSize.height)
+        {
+            terminalLog()("Rejecting image of invalid size {} (maximum {}).", imageSize, maxSize);
+            return;
+        }
+
+        // Reading the path is up to the user's permission.
+        _terminal->requestImageFile(
+            ImageFileRequest { imageSize, format, transmission, crispy::base64::decode(data) });
+    });
+}
+
+template <CellConcept Cell>
+void Screen<Cell>::imageFile(ImageFileRequest const& request)
+{
+    auto const bytesPerPixel = request.format == ImageFormat::RGB ? 3u : 4u;
+    auto pixels = readImageData(request.transmission, request.path, request.size.area() * bytesPerPixel);
+    if (!pixels)
+        return;
+
+    if (request.format == ImageFormat::RGB)
+    {
+        auto rgbaData = Image::Data(request.size.area() * 4);
+        for (size_t i = 0; i < request.size.area(); ++i)
+        {
+            std::copy_n(pixels->data() + i * 3, 3, rgbaData.data() + i * 4);
+            rgbaData[i * 4 + 3] = 0xFF;
+        }
+        pixels->swap(rgbaData);
+    }
+
+    // The image is placed just like a Sixel image.
+    sixelImage(request.size, std::move(*pixels));
+}
+
 template <CellConcept Cell>
 unique_ptr<ParserExtension> Screen<Cell>::hookSTP(Sequence const& /*seq*/)
 {
@@ -3861,8 +3925,6 @@ unique_ptr<ParserExtension> Screen<Cell>::hookDECRQSS(Sequence const& /*seq*/)
 template <CellConcept Cell>
 optional<CellLocation> Screen<Cell>::search(std::u32string_view searchText, CellLocation startPosition)
 {
-    // TODO use LogicalLines to spawn logical lines for improving the search on wrapped lines.
-
     if (searchText.empty())
         return nullopt;
 
@@ -3870,10 +3932,27 @@ optional<CellLocation> Screen<Cell>::search(std::u32string_view searchText, Cell
     if (_grid.lineAt(startPosition.line).matchTextAt(searchText, startPosition.column))
         return startPosition;
 
-    // Search reverse until found or exhausted.
+    auto const candidates = _grid.searchCandidates(searchText);
+    auto const indexBoundary = _grid.searchIndexBoundary();
+
+    // Search forward until found or exhausted.
     auto lines = _grid.logicalLinesFrom(startPosition.line);
     for (auto const& line: lines)
     {
+        if (candidates && line.top > startPosition.line && line.top < indexBoundary)
+        {
+            // Only search the history lines the search index considers, and the main page as usual.
+            for (auto i = std::lower_bound(candidates->begin(), candidates->end(), line.top);
+                 i != candidates->end();
+                 ++i)
+                if (auto const result = _grid.logicalLineAt(*i).search(searchText, ColumnOffset(0)))
+                    return result;
+            for (auto const& pageLine: _grid.logicalLinesFrom(indexBoundary))
+                if (auto const result = pageLine.search(searchText, ColumnOffset(0)))
+                    return result;
+            return nullopt;
+        }
+
         auto const result = line.search(searchText, startPosition.column);
         if (result.has_value())
             return result; // new match found
@@ -3885,8 +3964,6 @@ optional<CellLocation> Screen<Cell>::search(std::u32string_view searchText, Cell
 template <CellConcept Cell>
 optional<CellLocation> Screen<Cell>::searchReverse(std::u32string_view searchText, CellLocation startPosition)
 {
-    // TODO use LogicalLinesReverse to spawn logical lines for improving the search on wrapped lines.
-
     if (searchText.empty())
         return nullopt;
 
@@ -3894,18 +3971,134 @@ optional<CellLocation> Screen<Cell>::searchReverse(std::u32string_view searchTex
     if (_grid.lineAt(startPosition.line).matchTextAt(searchText, startPosition.column))
         return startPosition;
 
+    auto const candidates = _grid.searchCandidates(searchText);
+    auto const indexBoundary = _grid.searchIndexBoundary();
+    auto const rightMostColumn = boxed_cast<ColumnOffset>(pageSize().columns) - 1;
+
     // Search reverse until found or exhausted.
     auto lines = _grid.logicalLinesReverseFrom(startPosition.line);
     for (auto const& line: lines)
     {
+        if (candidates && line.bottom < startPosition.line && line.top < indexBoundary)
+        {
+            // The remaining logical lines are all covered by the search index.
+            auto const end = std::upper_bound(candidates->begin(), candidates->end(), line.top);
+            for (auto i = std::make_reverse_iterator(end); i != candidates->rend(); ++i)
+                if (auto const result = _grid.logicalLineAt(*i).searchReverse(searchText, rightMostColumn))
+                    return result;
+            return nullopt;
+        }
+
         auto const result = line.searchReverse(searchText, startPosition.column);
         if (result.has_value())
             return result; // new match found
-        startPosition.column = boxed_cast<ColumnOffset>(pageSize().columns) - 1;
+        startPosition.column = rightMostColumn;
+    }
+    return nullopt;
+}
+
+template <CellConcept Cell>
+optional<CellLocation> Screen<Cell>::search(SearchPattern const& pattern, CellLocation startPosition)
+{
+    // Search forward until found or exhausted.
+    for (auto const& line: _grid.logicalLinesFrom(startPosition.line))
+    {
+        auto const text = LogicalLineText<Cell>(line);
+        auto const from = line.top <= startPosition.line ? text.indexOf(startPosition) : size_t { 0 };
+        if (auto const match = pattern.find(text, from))
+            return text.locationOf(match->start);
     }
     return nullopt;
 }
 
+template <CellConcept Cell>
+optional<CellLocation> Screen<Cell>::searchReverse(SearchPattern const& pattern, CellLocation startPosition)
+{
+    // Search reverse until found or exhausted.
+    for (auto const& line: _grid.logicalLinesReverseFrom(startPosition.line))
+    {
+        auto const text = LogicalLineText<Cell>(line);
+        auto const last = line.bottom >= startPosition.line ? text.indexOf(startPosition)
+                                                             : std::numeric_limits<size_t>::max();
+        if (auto const match = pattern.findReverse(text, last))
+            return text.locationOf(match->start);
+    }
+    return nullopt;
+}
+
+template <CellConcept Cell>
+std::vector<CellLocation> Screen<Cell>::searchAll(std::u32string_view searchText, size_t maxMatchCount)
+{
+    auto matches = std::vector<CellLocation> {};
+    if (searchText.empty())
+        return matches;
+
+    auto const rightMostColumn = boxed_cast<ColumnOffset>(pageSize().columns) - 1;
+
+    // Collects the matches of the logical line starting at the given line.
+    auto const collect = [&](LineOffset top) -> bool {
+        auto const bottom = _grid.logicalLineAt(top).bottom;
+        auto position = CellLocation { top, ColumnOffset(0) };
+        while (matches.size() < maxMatchCount)
+        {
+            auto const match = _grid.logicalLineAt(position.line).search(searchText, position.column);
+            if (!match || *match < position)
+                break;
+            matches.emplace_back(*match);
+
+            position = *match;
+            if (position.column < rightMostColumn)
+                ++position.column;
+            else if (position.line < bottom)
+            {
+                ++position.line;
+                position.column = ColumnOffset(0);
+            }
+            else
+                break;
+        }
+        return matches.size() < maxMatchCount;
+    };
+
+    // The history is searched through the search index candidates, if the text is long enough.
+    auto const indexBoundary = _grid.searchIndexBoundary();
+    if (auto const candidates = _grid.searchCandidates(searchText))
+    {
+        for (auto const top: *candidates)
+            if (!collect(top))
+                return matches;
+    }
+    else
+    {
+        for (auto const& line: _grid.logicalLinesFrom(-boxed_cast<LineOffset>(historyLineCount())))
+            if (line.top >= indexBoundary || !collect(line.top))
+                break;
+    }
+
+    for (auto const& line: _grid.logicalLinesFrom(indexBoundary))
+        if (!collect(line.top))
+            break;
+
+    return matches;
+}
+
+template <CellConcept Cell>
+std::vector<CellLocation> Screen<Cell>::searchAll(SearchPattern const& pattern, size_t maxMatchCount)
+{
+    auto matches = std::vector<CellLocation> {};
+    for (auto const& line: _grid.logicalLinesFrom(-boxed_cast<LineOffset>(historyLineCount())))
+    {
+        auto const text = LogicalLineText<Cell>(line);
+        pattern.forEachMatch(text, [&](SearchMatch match) {
+            if (matches.size() < maxMatchCount)
+                matches.emplace_back(text.locationOf(match.start));
+        });
+        if (matches.size() >= maxMatchCount)
+            break;
+    }
+    return matches;
+}
+
 template <CellConcept Cell>
 bool Screen<Cell>::isCursorInsideMargins() const noexcept
 {
@@ -288,6 +288,7 @@ class Screen final: public ScreenBase, public capabilities::StaticDatabase
     void requestPixelSize(RequestPixelSize area);
     void requestCharacterSize(RequestPixelSize area);
     void sixelImage(ImageSize pixelSize, Image::Data&& rgbaData);
+    void imageFile(ImageFileRequest const& request);
     void requestStatusString(RequestStatusString value);
     void requestTabStops();
     void resetDynamicColor(DynamicColorName name);
@@ -446,6 +447,14 @@ class Screen final: public ScreenBase, public capabilities::StaticDatabase
                                                      CellLocation startPosition) override;
     [[nodiscard]] std::optional<CellLocation> searchReverse(std::u32string_view searchText,
                                                             CellLocation startPosition) override;
+    [[nodiscard]] std::optional<CellLocation> search(SearchPattern const& pattern,
+                                                     CellLocation startPosition) override;
+    [[nodiscard]] std::optional<CellLocation> searchReverse(SearchPattern const& pattern,
+                                                            CellLocation startPosition) override;
+    [[nodiscard]] std::vector<CellLocation> searchAll(std::u32string_view searchText,
+                                                      size_t maxMatchCount) override;
+    [[nodiscard]] std::vector<CellLocation> searchAll(SearchPattern const& pattern,
+                                                      size_t maxMatchCount) override;
 
     [[nodiscard]] Cell& usePreviousCell() noexcept
     {
@@ -517,20 +526,20 @@ class Screen final: public ScreenBase, public capabilities::StaticDatabase
 
     [[nodiscard]] bool compareCellTextAt(CellLocation position, char32_t codepoint) const noexcept override
     {
-        auto const& cell = _grid.lineAt(position.line).inflatedBuffer().at(position.column.as<size_t>());
-        return CellUtil::compareText(cell, codepoint);
+        auto const cells = _grid.lineAt(position.line).cells();
+        return CellUtil::compareText(cells.at(position.column.as<size_t>()), codepoint);
     }
 
-    // IMPORTANT: Invokig inflatedBuffer() is expensive. This function should be invoked with caution.
+    // IMPORTANT: Invokig cells() is expensive. This function should be invoked with caution.
     [[nodiscard]] std::string cellTextAt(CellLocation position) const noexcept override
     {
-        return _grid.lineAt(position.line).inflatedBuffer().at(position.column.as<size_t>()).toUtf8();
+        return _grid.lineAt(position.line).cells().at(position.column.as<size_t>()).toUtf8();
     }
 
     [[nodiscard]] CellFlags cellFlagsAt(CellLocation position) const noexcept override
     {
         // TODO: This is not efficient. We should have a direct access to the flags.
-        return _grid.lineAt(position.line).inflatedBuffer().at(position.column.as<size_t>()).flags();
+        return _grid.lineAt(position.line).cells().at(position.column.as<size_t>()).flags();
     }
 
     [[nodiscard]] LineFlags lineFlagsAt(LineOffset line) const noexcept override
@@ -636,6 +645,7 @@ class Screen final: public ScreenBase, public capabilities::StaticDatabase
 
     [[nodiscard]] std::unique_ptr<ParserExtension> hookSTP(Sequence const& seq);
     [[nodiscard]] std::unique_ptr<ParserExtension> hookSixel(Sequence const& seq);
+    [[nodiscard]] std::unique_ptr<ParserExtension> hookImageFile(Sequence const& seq);
     [[nodiscard]] std::unique_ptr<ParserExtension> hookDECRQSS(Sequence const& seq);
     [[nodiscard]] std::unique_ptr<ParserExtension> hookXTGETTCAP(Sequence const& seq);
 
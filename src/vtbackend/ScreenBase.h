@@ -5,6 +5,7 @@
 #include <vtbackend/Cursor.h>
 #include <vtbackend/Hyperlink.h>
 #include <vtbackend/Line.h>
+#include <vtbackend/SearchPattern.h>
 #include <vtbackend/Sequence.h>
 
 #include <crispy/algorithm.h>
@@ -15,6 +16,7 @@
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 namespace vtbackend
 {
@@ -62,6 +64,17 @@ class ScreenBase: public SequenceHandler
                                                              CellLocation startPosition) = 0;
     [[nodiscard]] virtual std::optional<CellLocation> searchReverse(std::u32string_view searchText,
                                                                     CellLocation startPosition) = 0;
+    [[nodiscard]] virtual std::optional<CellLocation> search(SearchPattern const& pattern,
+                                                             CellLocation startPosition) = 0;
+    [[nodiscard]] virtual std::optional<CellLocation> searchReverse(SearchPattern const& pattern,
+                                                                    CellLocation startPosition) = 0;
+
+    /// Finds the matches of the given text or pattern in the history and the main page,
+    /// from top to bottom, e.g. for highlighting all of them.
+    [[nodiscard]] virtual std::vector<CellLocation> searchAll(std::u32string_view searchText,
+                                                              size_t maxMatchCount) = 0;
+    [[nodiscard]] virtual std::vector<CellLocation> searchAll(SearchPattern const& pattern,
+                                                              size_t maxMatchCount) = 0;
 
   protected:
     Cursor _cursor {};
@@ -59,7 +59,7 @@ void TextRenderBuilder::startLine(LineOffset lineOffset)
         text.clear();
 }
 
-void TextRenderBuilder::renderCell(CompactCell const& cell, LineOffset, ColumnOffset)
+void TextRenderBuilder::renderCell(PrimaryScreenCell const& cell, LineOffset, ColumnOffset)
 {
     text += cell.toUtf8();
 }
@@ -2999,6 +2999,129 @@ TEST_CASE("searchReverse", "[screen]")
     }
 }
 
+TEST_CASE("searchReverse.history", "[screen]")
+{
+    auto mock = MockTerm { PageSize { LineCount(2), ColumnCount(6) }, LineCount(100) };
+    for (auto const i: ranges::views::iota(0, 30))
+        mock.writeToScreen(fmt::format("L{:02}\r\n", i));
+    mock.writeToScreen("abcdefghij\r\n"); // wraps into the next line
+    for (auto const i: ranges::views::iota(0, 5))
+        mock.writeToScreen(fmt::format("Z{}\r\n", i));
+
+    auto& screen = mock.terminal.primaryScreen();
+
+    // Text wrapped across trivial lines is not matched.
+    for (auto line = -boxed_cast<LineOffset>(screen.historyLineCount()); line < LineOffset(2); ++line)
+        (void) screen.grid().lineAt(line).inflatedBuffer();
+    auto const bottom = CellLocation { LineOffset(1), ColumnOffset(5) };
+
+    auto const l17 = screen.searchReverse(U"L17", bottom);
+    REQUIRE(l17.has_value());
+    CHECK(l17->column == ColumnOffset(0));
+    CHECK(screen.grid().lineText(l17->line).substr(0, 3) == "L17");
+    CHECK(screen.grid().searchIndexStats().lines > 0);
+
+    // Find text that got wrapped in the history.
+    auto const efgh = screen.searchReverse(U"efgh", bottom);
+    REQUIRE(efgh.has_value());
+    CHECK(efgh->column == ColumnOffset(4));
+    CHECK(screen.grid().lineText(efgh->line) == "abcdef");
+
+    CHECK_FALSE(screen.searchReverse(U"L99", bottom).has_value());
+
+    // Search downwards from the top of the history.
+    auto const top = CellLocation { -boxed_cast<LineOffset>(screen.historyLineCount()), ColumnOffset(0) };
+    auto const l03 = screen.search(U"L03", top);
+    REQUIRE(l03.has_value());
+    CHECK(screen.grid().lineText(l03->line).substr(0, 3) == "L03");
+
+    // Lines scrolled into the history after the first search are found, too.
+    mock.writeToScreen("late42\r\nZ\r\nZ\r\n");
+    auto const late = screen.searchReverse(U"late42", bottom);
+    REQUIRE(late.has_value());
+    CHECK(late->line < LineOffset(0));
+    CHECK(screen.grid().lineText(late->line) == "late42");
+}
+
+TEST_CASE("search.pattern", "[screen]")
+{
+    auto mock = MockTerm { PageSize { LineCount(2), ColumnCount(6) }, LineCount(100) };
+    for (auto const i: ranges::views::iota(0, 10))
+        mock.writeToScreen(fmt::format("L{:02}\r\n", i));
+    mock.writeToScreen("ab1234567\r\n"); // wraps into the next line
+    mock.writeToScreen("Z");
+
+    auto& screen = mock.terminal.primaryScreen();
+    auto const top = CellLocation { -boxed_cast<LineOffset>(screen.historyLineCount()), ColumnOffset(0) };
+    auto const bottom = CellLocation { LineOffset(1), ColumnOffset(5) };
+
+    auto const digits = SearchPattern::compile(U"[0-9]{5,}", SearchMode::Regex);
+    REQUIRE(digits.has_value());
+
+    // Matches spanning a wrapped line.
+    auto const number = screen.search(*digits, top);
+    REQUIRE(number.has_value());
+    CHECK(number->column == ColumnOffset(2));
+    CHECK(screen.grid().lineText(number->line) == "ab1234");
+    CHECK(screen.searchReverse(*digits, bottom) == number);
+
+    auto const lines = SearchPattern::compile(U"^L0[5-7]$", SearchMode::Regex);
+    REQUIRE(lines.has_value());
+    auto const l07 = screen.searchReverse(*lines, bottom);
+    REQUIRE(l07.has_value());
+    CHECK(screen.grid().lineText(l07->line).substr(0, 3) == "L07");
+    auto const l06 = screen.searchReverse(*lines, CellLocation { l07->line - 1, ColumnOffset(5) });
+    REQUIRE(l06.has_value());
+    CHECK(l06->line == l07->line - 1);
+    auto const l05 = screen.search(*lines, top);
+    REQUIRE(l05.has_value());
+    CHECK(l05->line == l06->line - 1);
+
+    auto const words = SearchPattern::compile(U"L03 Z", SearchMode::Words);
+    REQUIRE(words.has_value());
+    auto const l03 = screen.search(*words, top);
+    REQUIRE(l03.has_value());
+    CHECK(screen.grid().lineText(l03->line).substr(0, 3) == "L03");
+    auto const z = screen.search(*words, CellLocation { l03->line + 1, ColumnOffset(0) });
+    REQUIRE(z.has_value());
+    CHECK(z->line == LineOffset(1));
+    CHECK(z->column == ColumnOffset(0));
+}
+
+TEST_CASE("searchAll", "[screen]")
+{
+    auto mock = MockTerm { PageSize { LineCount(2), ColumnCount(6) }, LineCount(100) };
+    for (auto const i: ranges::views::iota(0, 30))
+        mock.writeToScreen(fmt::format("L{:02}\r\n", i));
+    mock.writeToScreen("L1xL1y\r\n");
+    mock.writeToScreen("abcdefghij\r\n"); // wraps into the next line
+    mock.writeToScreen("Z\r\nL15");
+
+    auto& screen = mock.terminal.primaryScreen();
+
+    // Text wrapped across trivial lines is not matched.
+    for (auto line = -boxed_cast<LineOffset>(screen.historyLineCount()); line < LineOffset(2); ++line)
+        (void) screen.grid().lineAt(line).inflatedBuffer();
+
+    // All matches are found, from top to bottom, including multiple ones per line.
+    auto const l1 = screen.searchAll(U"L1", 100);
+    REQUIRE(l1.size() == 13);
+    CHECK(screen.grid().lineText(l1.front().line).substr(0, 3) == "L10");
+    CHECK(l1[10].column == ColumnOffset(0));
+    CHECK(l1[11].column == ColumnOffset(3));
+    CHECK(l1[10].line == l1[11].line);
+    CHECK(l1.back() == CellLocation { LineOffset(1), ColumnOffset(0) });
+
+    // Looked up through the search index, also across line wraps.
+    CHECK(screen.searchAll(U"L15", 100).size() == 2);
+    auto const efgh = screen.searchAll(U"efgh", 100);
+    REQUIRE(efgh.size() == 1);
+    CHECK(efgh.front().column == ColumnOffset(4));
+    CHECK(screen.searchAll(U"L99", 100).empty());
+
+    CHECK(screen.searchAll(U"L1", 3).size() == 3);
+}
+
 TEST_CASE("findMarkerDownwards", "[screen]")
 {
     auto mock = MockTerm { PageSize { LineCount(3), ColumnCount(4) }, LineCount(10) };
@@ -0,0 +1,275 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/ScrollbackIndex.h>
+
+#include <algorithm>
+#include <cassert>
+#include <utility>
+
+using std::nullopt;
+using std::optional;
+using std::u32string_view;
+using std::vector;
+
+namespace vtbackend
+{
+
+namespace
+{
+    constexpr uint64_t trigramOf(char32_t a, char32_t b, char32_t c) noexcept
+    {
+        // Unicode codepoints fit into 21 bits.
+        auto constexpr Mask = uint64_t { 0x1FFFFF };
+        return (a & Mask) << 42 | (b & Mask) << 21 | (c & Mask);
+    }
+
+    template <typename F>
+    void forEachTrigram(u32string_view text, F&& f)
+    {
+        for (size_t i = 0; i + 2 < text.size(); ++i)
+            if (text[i] && text[i + 1] && text[i + 2]) // Empty columns never match any text.
+                f(trigramOf(text[i], text[i + 1], text[i + 2]));
+    }
+} // namespace
+
+void ScrollbackIndex::clear(LineNumber nextLine)
+{
+    _postings.clear();
+    _firstLine = nextLine;
+    _nextLine = nextLine;
+    _logicalLineStart = nextLine;
+    _compactedBlock = blockOf(nextLine);
+    _wrapTail.clear();
+}
+
+void ScrollbackIndex::addLine(LineNumber number, u32string_view text, bool wrapped)
+{
+    assert(number >= _nextLine);
+
+    if (!wrapped || number != _nextLine)
+    {
+        _logicalLineStart = number;
+        _wrapTail.clear();
+    }
+
+    auto const block = blockOf(_logicalLineStart);
+
+    if (!_wrapTail.empty())
+    {
+        // The trigrams spanning the wrap from the previous line into this one.
+        auto joined = _wrapTail;
+        joined.append(text.substr(0, 2));
+        addTrigrams(joined, block);
+    }
+
+    addTrigrams(text, block);
+
+    _wrapTail = text.substr(text.size() > 2 ? text.size() - 2 : 0);
+    _nextLine = number + 1;
+}
+
+void ScrollbackIndex::addTrigrams(u32string_view text, BlockNumber block)
+{
+    forEachTrigram(text, [&](uint64_t trigram) {
+        auto& blocks = _postings[trigram];
+        if (blocks.empty() || blocks.back() != block)
+            blocks.push_back(block);
+    });
+}
+
+void ScrollbackIndex::discardLinesBefore(LineNumber number)
+{
+    if (number <= _firstLine)
+        return;
+
+    if (number >= _nextLine)
+    {
+        clear(number);
+        return;
+    }
+
+    _firstLine = number;
+
+    // Erasing the discarded blocks walks all postings, so only do so once at least as many blocks
+    // have been discarded as are still alive, keeping the amortized costs per line constant.
+    auto constexpr MinCompactionBlockCount = BlockNumber { 16 };
+    auto const firstBlock = blockOf(_firstLine);
+    auto const liveBlockCount = blockOf(_nextLine) - firstBlock;
+    if (firstBlock - _compactedBlock < std::max(MinCompactionBlockCount, liveBlockCount))
+        return;
+
+    for (auto i = _postings.begin(); i != _postings.end();)
+    {
+        auto& blocks = i->second;
+        blocks.erase(blocks.begin(), std::lower_bound(blocks.begin(), blocks.end(), firstBlock));
+        if (blocks.empty())
+            i = _postings.erase(i);
+        else
+            ++i;
+    }
+    _compactedBlock = firstBlock;
+}
+
+optional<vector<ScrollbackIndex::BlockNumber>> ScrollbackIndex::candidateBlocks(u32string_view text) const
+{
+    auto trigrams = vector<uint64_t> {};
+    forEachTrigram(text, [&](uint64_t trigram) { trigrams.push_back(trigram); });
+    if (trigrams.empty())
+        return nullopt;
+
+    std::sort(trigrams.begin(), trigrams.end());
+    trigrams.erase(std::unique(trigrams.begin(), trigrams.end()), trigrams.end());
+
+    auto postings = vector<vector<BlockNumber> const*> {};
+    postings.reserve(trigrams.size());
+    for (auto const trigram: trigrams)
+    {
+        auto const i = _postings.find(trigram);
+        if (i == _postings.end())
+            return vector<BlockNumber> {};
+        postings.push_back(&i->second);
+    }
+
+    // Intersect, starting with the rarest trigram.
+    std::sort(postings.begin(), postings.end(), [](auto const* a, auto const* b) {
+        return a->size() < b->size();
+    });
+
+    auto const& rarest = *postings.front();
+    auto result = vector<BlockNumber>(
+        std::lower_bound(rarest.begin(), rarest.end(), blockOf(_firstLine)), rarest.end());
+    for (size_t i = 1; i < postings.size() && !result.empty(); ++i)
+    {
+        auto const& blocks = *postings[i];
+        result.erase(std::remove_if(result.begin(),
+                                    result.end(),
+                                    [&](BlockNumber block) {
+                                        return !std::binary_search(blocks.begin(), blocks.end(), block);
+                                    }),
+                     result.end());
+    }
+    return result;
+}
+
+bool ScrollbackIndex::mayContain(u32string_view text, u32string_view query)
+{
+    auto trigrams = vector<uint64_t> {};
+    forEachTrigram(query, [&](uint64_t trigram) { trigrams.push_back(trigram); });
+
+    auto found = vector<bool>(trigrams.size());
+    auto missingCount = trigrams.size();
+    forEachTrigram(text, [&](uint64_t trigram) {
+        for (size_t i = 0; i < trigrams.size(); ++i)
+            if (!found[i] && trigrams[i] == trigram)
+            {
+                found[i] = true;
+                --missingCount;
+            }
+    });
+    return missingCount == 0;
+}
+
+ScrollbackIndexStats ScrollbackIndex::stats() const noexcept
+{
+    auto stats = ScrollbackIndexStats {};
+    stats.lines = static_cast<size_t>(_nextLine - _firstLine);
+    stats.trigrams = _postings.size();
+    for (auto const& [trigram, blocks]: _postings)
+        stats.postings += blocks.size();
+    return stats;
+}
+
+// {{{ ScrollbackIndexer
+ScrollbackIndexer::ScrollbackIndexer(std::function<void()> idleCallback):
+    _idleCallback { std::move(idleCallback) }
+{
+}
+
+ScrollbackIndexer::~ScrollbackIndexer()
+{
+    {
+        auto const _ = std::lock_guard { _mutex };
+        _stopping = true;
+    }
+    _changed.notify_all();
+    if (_worker.joinable())
+        _worker.join();
+}
+
+void ScrollbackIndexer::enqueue(Batch batch)
+{
+    {
+        auto const _ = std::lock_guard { _mutex };
+        _queue.emplace_back(std::move(batch));
+    }
+    _changed.notify_all();
+
+    if (!_worker.joinable())
+        _worker = std::thread { [this]() { work(); } };
+}
+
+optional<vector<ScrollbackIndexer::BlockNumber>> ScrollbackIndexer::candidateBlocks(u32string_view text)
+{
+    auto lock = std::unique_lock { _mutex };
+    waitForIdle(lock);
+    return _index.candidateBlocks(text);
+}
+
+ScrollbackIndexStats ScrollbackIndexer::stats() const
+{
+    auto lock = std::unique_lock { _mutex };
+    waitForIdle(lock);
+    return _index.stats();
+}
+
+bool ScrollbackIndexer::idle() const
+{
+    auto const lock = std::unique_lock { _mutex, std::try_to_lock };
+    return lock.owns_lock() && _queue.empty() && !_busy;
+}
+
+void ScrollbackIndexer::waitForIdle(std::unique_lock<std::mutex>& lock) const
+{
+    _changed.wait(lock, [this]() { return _queue.empty() && !_busy; });
+}
+
+void ScrollbackIndexer::work()
+{
+    auto lock = std::unique_lock { _mutex };
+    while (true)
+    {
+        _changed.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+        if (_stopping)
+            return;
+
+        auto const batch = std::move(_queue.front());
+        _queue.pop_front();
+        _busy = true;
+
+        // Nobody else accesses the index while busy, so it is updated without holding the lock.
+        lock.unlock();
+        apply(batch);
+        lock.lock();
+
+        _busy = false;
+        _changed.notify_all();
+
+        if (_queue.empty() && _idleCallback)
+        {
+            lock.unlock();
+            _idleCallback();
+            lock.lock();
+        }
+    }
+}
+
+void ScrollbackIndexer::apply(Batch const& batch)
+{
+    if (batch.reset)
+        _index.clear(*batch.reset);
+    _index.discardLinesBefore(batch.firstLine);
+    for (auto const& line: batch.lines)
+        _index.addLine(line.number, line.text, line.wrapped);
+}
+// }}}
+
+} // namespace vtbackend
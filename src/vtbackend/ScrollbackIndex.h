@@ -0,0 +1,158 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vtbackend
+{
+
+/// Memory usage metrics of the scrollback search index.
+struct ScrollbackIndexStats
+{
+    size_t lines = 0;    ///< Number of lines added to the index.
+    size_t trigrams = 0; ///< Number of distinct trigrams.
+    size_t postings = 0; ///< Number of block references over all trigrams.
+};
+
+/// Trigram index over the text of the scrollback history.
+///
+/// History lines are identified by a line number that increases with every line scrolled
+/// into the history. Lines are grouped into blocks of BlockSize lines, and for every trigram of a
+/// logical line's text, the block of the logical line's first line is recorded.
+/// This includes the trigrams spanning the wrap of a line into the next one.
+///
+/// Querying the index yields a superset of the blocks a logical line that contains the
+/// given text starts in, which need to be verified by the caller.
+class ScrollbackIndex
+{
+  public:
+    using LineNumber = uint64_t;
+    using BlockNumber = uint32_t;
+
+    static constexpr LineNumber BlockSize = 64;
+
+    /// Removes all lines from the index and expects @p nextLine to be added next.
+    void clear(LineNumber nextLine = 0);
+
+    /// Number of the line expected to be added next.
+    [[nodiscard]] LineNumber nextLine() const noexcept { return _nextLine; }
+
+    /// Adds a history line to the index.
+    ///
+    /// @param number   line number, not less than nextLine().
+    /// @param text     the line's text, with one codepoint per grid column (0 for empty columns).
+    /// @param wrapped  whether this line continues the logical line of the line before.
+    void addLine(LineNumber number, std::u32string_view text, bool wrapped);
+
+    /// Drops all lines before @p number, i.e. the lines that have been removed from the history.
+    void discardLinesBefore(LineNumber number);
+
+    /// @returns the ascending numbers of the blocks that may contain the beginning of a logical line
+    ///          containing @p text, or std::nullopt if @p text is too short to be looked up.
+    [[nodiscard]] std::optional<std::vector<BlockNumber>> candidateBlocks(std::u32string_view text) const;
+
+    /// Tests if @p text contains all trigrams of @p query.
+    ///
+    /// This is the condition the lines of the blocks returned by candidateBlocks() are selected by,
+    /// which allows to narrow these down to single logical lines.
+    [[nodiscard]] static bool mayContain(std::u32string_view text, std::u32string_view query);
+
+    [[nodiscard]] static constexpr BlockNumber blockOf(LineNumber number) noexcept
+    {
+        return static_cast<BlockNumber>(number / BlockSize);
+    }
+
+    [[nodiscard]] ScrollbackIndexStats stats() const noexcept;
+
+  private:
+    void addTrigrams(std::u32string_view text, BlockNumber block);
+
+    // Ascending block numbers of all indexed logical lines, by trigram.
+    std::unordered_map<uint64_t, std::vector<BlockNumber>> _postings;
+
+    LineNumber _firstLine = 0;        // Lines before this one have been discarded.
+    LineNumber _nextLine = 0;
+    LineNumber _logicalLineStart = 0; // Number of the first line of the logical line added last.
+    BlockNumber _compactedBlock = 0;  // Blocks before this one have been erased from all postings.
+    std::u32string _wrapTail;         // Last two columns of the line added last.
+};
+
+/// Maintains a ScrollbackIndex on a worker thread.
+///
+/// The text of the history lines is captured by the thread owning the grid and handed over
+/// in batches, so that extracting and storing their trigrams does not hold up the VT parser.
+class ScrollbackIndexer
+{
+  public:
+    using LineNumber = ScrollbackIndex::LineNumber;
+    using BlockNumber = ScrollbackIndex::BlockNumber;
+
+    struct Line
+    {
+        LineNumber number;
+        std::u32string text; // see ScrollbackIndex::addLine()
+        bool wrapped;
+    };
+
+    /// Changes to be applied to the index at once.
+    struct Batch
+    {
+        std::optional<LineNumber> reset; // Clears the index before, expecting this line to be added next.
+        LineNumber firstLine = 0;        // Lines before this one have left the history.
+        std::vector<Line> lines;
+    };
+
+    /// @param idleCallback  invoked from the worker thread whenever all queued batches have been applied.
+    explicit ScrollbackIndexer(std::function<void()> idleCallback = {});
+    ScrollbackIndexer(ScrollbackIndexer const&) = delete;
+    ScrollbackIndexer(ScrollbackIndexer&&) = delete;
+    ScrollbackIndexer& operator=(ScrollbackIndexer const&) = delete;
+    ScrollbackIndexer& operator=(ScrollbackIndexer&&) = delete;
+    ~ScrollbackIndexer();
+
+    /// Queues the given batch for being applied to the index in the background.
+    void enqueue(Batch batch);
+
+    /// Waits for all queued batches to be applied, and looks up the given text.
+    ///
+    /// @see ScrollbackIndex::candidateBlocks()
+    [[nodiscard]] std::optional<std::vector<BlockNumber>> candidateBlocks(std::u32string_view text);
+
+    /// Waits for all queued batches to be applied, and returns the index's metrics.
+    [[nodiscard]] ScrollbackIndexStats stats() const;
+
+    /// Tests, without waiting, whether all queued batches have been applied,
+    /// i.e. whether candidateBlocks() would return right away.
+    [[nodiscard]] bool idle() const;
+
+  private:
+    void work();
+    void apply(Batch const& batch);
+
+    // Waits for the worker to be idle. The index must only be accessed while idle and locked.
+    void waitForIdle(std::unique_lock<std::mutex>& lock) const;
+
+    mutable std::mutex _mutex;
+    mutable std::condition_variable _changed;
+    std::deque<Batch> _queue;
+    bool _busy = false; // Whether the worker is applying a batch.
+    bool _stopping = false;
+
+    std::function<void()> _idleCallback;
+
+    ScrollbackIndex _index;
+    std::thread _worker;
+};
+
+} // namespace vtbackend
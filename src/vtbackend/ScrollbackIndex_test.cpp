@@ -0,0 +1,109 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/ScrollbackIndex.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+using namespace vtbackend;
+using namespace std::string_literals;
+
+using BlockNumbers = std::vector<ScrollbackIndex::BlockNumber>;
+
+TEST_CASE("ScrollbackIndex.candidateBlocks", "[ScrollbackIndex]")
+{
+    auto index = ScrollbackIndex {};
+    for (auto number = ScrollbackIndex::LineNumber { 0 }; number < 3 * ScrollbackIndex::BlockSize; ++number)
+        index.addLine(number, number == 70 ? U"the needle" : U"some hay", false);
+
+    CHECK(index.candidateBlocks(U"needle") == BlockNumbers { 1 });
+    CHECK(index.candidateBlocks(U"hay") == BlockNumbers { 0, 1, 2 });
+    CHECK(index.candidateBlocks(U"nothing") == BlockNumbers {});
+
+    // Too short to be looked up.
+    CHECK_FALSE(index.candidateBlocks(U"ha").has_value());
+
+    index.discardLinesBefore(ScrollbackIndex::BlockSize * 2);
+    CHECK(index.candidateBlocks(U"needle") == BlockNumbers {});
+    CHECK(index.candidateBlocks(U"hay") == BlockNumbers { 2 });
+}
+
+TEST_CASE("ScrollbackIndex.wrapped", "[ScrollbackIndex]")
+{
+    auto index = ScrollbackIndex {};
+    for (auto number = ScrollbackIndex::LineNumber { 0 }; number < ScrollbackIndex::BlockSize - 1; ++number)
+        index.addLine(number, U"filler", false);
+
+    // A logical line spanning two blocks is found in the block of its first line,
+    // including the text across the wrap.
+    auto const head = ScrollbackIndex::BlockSize - 1;
+    index.addLine(head, U"abcd", false);
+    index.addLine(head + 1, U"efgh", true);
+    index.addLine(head + 2, U"ijkl", false);
+
+    CHECK(index.candidateBlocks(U"cdef") == BlockNumbers { 0 });
+    CHECK(index.candidateBlocks(U"fgh") == BlockNumbers { 0 });
+    CHECK(index.candidateBlocks(U"ijk") == BlockNumbers { 1 });
+    CHECK(index.candidateBlocks(U"hij") == BlockNumbers {});
+
+    // Empty columns never match.
+    index.addLine(head + 3, U"ab\0cd"s, false);
+    CHECK(index.candidateBlocks(U"b\0c"s) == std::nullopt);
+}
+
+TEST_CASE("ScrollbackIndex.mayContain", "[ScrollbackIndex]")
+{
+    CHECK(ScrollbackIndex::mayContain(U"the needle", U"needle"));
+    CHECK(ScrollbackIndex::mayContain(U"needle in a haystack", U"hay"));
+    CHECK_FALSE(ScrollbackIndex::mayContain(U"some hay", U"needle"));
+    CHECK_FALSE(ScrollbackIndex::mayContain(U"ab\0cd"s, U"abcd"));
+}
+
+TEST_CASE("ScrollbackIndexer", "[ScrollbackIndex]")
+{
+    using Batch = ScrollbackIndexer::Batch;
+    using Line = ScrollbackIndexer::Line;
+
+    auto indexer = ScrollbackIndexer {};
+    CHECK(indexer.stats().lines == 0);
+
+    auto batch = Batch { .reset = 0, .firstLine = 0, .lines = {} };
+    for (auto number = ScrollbackIndex::LineNumber { 0 }; number < 2 * ScrollbackIndex::BlockSize; ++number)
+        batch.lines.emplace_back(Line { number, number == 70 ? U"the needle" : U"some hay", false });
+    indexer.enqueue(std::move(batch));
+
+    // Lookups wait for all batches queued so far to be indexed.
+    CHECK(indexer.candidateBlocks(U"needle") == BlockNumbers { 1 });
+
+    indexer.enqueue(Batch { .reset = std::nullopt,
+                            .firstLine = ScrollbackIndex::BlockSize,
+                            .lines = { Line { 2 * ScrollbackIndex::BlockSize, U"more needles", false } } });
+    CHECK(indexer.candidateBlocks(U"needle") == BlockNumbers { 1, 2 });
+    CHECK(indexer.stats().lines == ScrollbackIndex::BlockSize + 1);
+
+    // Resetting drops all lines indexed so far.
+    indexer.enqueue(Batch { .reset = 1000, .firstLine = 1000, .lines = {} });
+    CHECK(indexer.candidateBlocks(U"needle") == BlockNumbers {});
+    CHECK(indexer.stats().lines == 0);
+}
+
+TEST_CASE("ScrollbackIndexer.idleCallback", "[ScrollbackIndex]")
+{
+    using Batch = ScrollbackIndexer::Batch;
+    using Line = ScrollbackIndexer::Line;
+
+    auto idleCount = std::atomic<int> { 0 };
+    auto indexer = ScrollbackIndexer { [&]() {
+        ++idleCount;
+        idleCount.notify_all();
+    } };
+    CHECK(indexer.idle());
+
+    // Nobody needs to wait for the lines to be indexed to learn that they have been.
+    indexer.enqueue(Batch { .reset = 0, .firstLine = 0, .lines = { Line { 0, U"the needle", false } } });
+    idleCount.wait(0);
+    CHECK(idleCount == 1);
+    CHECK(indexer.candidateBlocks(U"needle") == BlockNumbers { 0 });
+}
@@ -0,0 +1,625 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/SearchPattern.h>
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+
+using std::nullopt;
+using std::optional;
+using std::u32string_view;
+using std::vector;
+
+namespace vtbackend
+{
+
+namespace
+{
+    // Upper bound of DFA states kept per automaton, before they are discarded and constructed anew.
+    constexpr size_t MaxDfaStates = 4096;
+
+    // Upper bounds of the repetition counts of {n,m} quantifiers and of the resulting NFA.
+    constexpr unsigned MaxRepetitions = 1000;
+    constexpr size_t MaxNfaNodes = 100'000;
+    constexpr unsigned Unbounded = std::numeric_limits<unsigned>::max();
+
+    struct RegexNode
+    {
+        enum class Kind : uint8_t
+        {
+            Empty,
+            Char,
+            LineStart,
+            LineEnd,
+            Concat,
+            Alternation,
+            Repeat,
+        };
+
+        Kind kind = Kind::Empty;
+        uint32_t charClass = 0;
+        unsigned min = 0;
+        unsigned max = 0;
+        vector<RegexNode> children {};
+    };
+
+    template <typename CharClass>
+    class RegexParser
+    {
+      public:
+        RegexParser(u32string_view input, vector<CharClass>& classes, bool ignoreCase):
+            _input { input }, _classes { classes }, _ignoreCase { ignoreCase }
+        {
+        }
+
+        optional<RegexNode> parse()
+        {
+            auto node = parseAlternation();
+            if (_failed || _pos != _input.size())
+                return nullopt;
+            return node;
+        }
+
+        RegexNode literal(char32_t codepoint)
+        {
+            return addClass(CharClass { .ranges = { { codepoint, codepoint } } });
+        }
+
+      private:
+        [[nodiscard]] bool atEnd() const noexcept { return _pos >= _input.size(); }
+        [[nodiscard]] char32_t peek() const noexcept { return atEnd() ? 0 : _input[_pos]; }
+
+        bool consume(char32_t codepoint) noexcept
+        {
+            if (atEnd() || _input[_pos] != codepoint)
+                return false;
+            ++_pos;
+            return true;
+        }
+
+        RegexNode fail()
+        {
+            _failed = true;
+            return RegexNode {};
+        }
+
+        RegexNode addClass(CharClass charClass)
+        {
+            if (_ignoreCase)
+            {
+                // The searched text is folded to lower case, so upper case ranges get a lower case twin.
+                auto const count = charClass.ranges.size();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    auto const [first, last] = charClass.ranges[i];
+                    auto const from = std::max(first, U'A');
+                    auto const to = std::min(last, U'Z');
+                    if (from <= to)
+                        charClass.ranges.emplace_back(from + (U'a' - U'A'), to + (U'a' - U'A'));
+                }
+            }
+            _classes.emplace_back(std::move(charClass));
+            return RegexNode { .kind = RegexNode::Kind::Char,
+                               .charClass = static_cast<uint32_t>(_classes.size() - 1) };
+        }
+
+        RegexNode parseAlternation()
+        {
+            auto node = parseConcat();
+            if (peek() != U'|')
+                return node;
+
+            auto alternation = RegexNode { .kind = RegexNode::Kind::Alternation };
+            alternation.children.emplace_back(std::move(node));
+            while (consume(U'|'))
+                alternation.children.emplace_back(parseConcat());
+            return alternation;
+        }
+
+        RegexNode parseConcat()
+        {
+            auto concat = RegexNode { .kind = RegexNode::Kind::Concat };
+            while (!atEnd() && !_failed && peek() != U'|' && peek() != U')')
+                concat.children.emplace_back(parseRepeat());
+            return concat;
+        }
+
+        RegexNode parseRepeat()
+        {
+            auto node = parseAtom();
+            while (!_failed)
+            {
+                auto min = 0u;
+                auto max = Unbounded;
+                if (consume(U'*'))
+                    ;
+                else if (consume(U'+'))
+                    min = 1;
+                else if (consume(U'?'))
+                    max = 1;
+                else if (!parseRepetitionCount(min, max))
+                    break;
+
+                if (node.kind == RegexNode::Kind::Empty)
+                    return fail(); // Nothing to repeat.
+
+                auto repeat = RegexNode { .kind = RegexNode::Kind::Repeat, .min = min, .max = max };
+                repeat.children.emplace_back(std::move(node));
+                node = std::move(repeat);
+            }
+            return node;
+        }
+
+        // Parses a {n}, {n,}, or {n,m} quantifier. Braces not forming one are taken literally.
+        bool parseRepetitionCount(unsigned& min, unsigned& max)
+        {
+            if (peek() != U'{')
+                return false;
+
+            auto pos = _pos + 1;
+            auto const parseNumber = [&]() -> optional<unsigned> {
+                auto const begin = pos;
+                auto value = 0u;
+                while (pos < _input.size() && _input[pos] >= U'0' && _input[pos] <= U'9')
+                {
+                    value = value * 10 + static_cast<unsigned>(_input[pos] - U'0');
+                    if (value > MaxRepetitions)
+                        return nullopt;
+                    ++pos;
+                }
+                return pos != begin ? optional { value } : nullopt;
+            };
+
+            auto const first = parseNumber();
+            if (!first)
+                return false;
+            auto second = first;
+            if (pos < _input.size() && _input[pos] == U',')
+            {
+                ++pos;
+                second = parseNumber();
+                if (!second)
+                    second = Unbounded;
+            }
+            if (pos >= _input.size() || _input[pos] != U'}' || *second < *first)
+                return false;
+
+            _pos = pos + 1;
+            min = *first;
+            max = *second;
+            return true;
+        }
+
+        RegexNode parseAtom()
+        {
+            auto const codepoint = _input[_pos++];
+            switch (codepoint)
+            {
+                case U'(': {
+                    if (consume(U'?') && !consume(U':'))
+                        return fail(); // (?:...) is the only extended group syntax supported.
+                    auto node = parseAlternation();
+                    if (!consume(U')'))
+                        return fail();
+                    return node.kind == RegexNode::Kind::Empty ? RegexNode { .kind = RegexNode::Kind::Concat }
+                                                               : node;
+                }
+                case U'[': return parseBracketExpression();
+                case U'.': return addClass(CharClass { .ranges = {}, .negated = true });
+                case U'^': return RegexNode { .kind = RegexNode::Kind::LineStart };
+                case U'$': return RegexNode { .kind = RegexNode::Kind::LineEnd };
+                case U'*':
+                case U'+':
+                case U'?': return fail(); // Nothing to repeat.
+                case U'\\': {
+                    if (atEnd())
+                        return fail();
+                    auto charClass = CharClass {};
+                    if (parseEscape(_input[_pos++], charClass))
+                        return addClass(std::move(charClass));
+                    return fail();
+                }
+                default: return addClass(CharClass { .ranges = { { codepoint, codepoint } } });
+            }
+        }
+
+        // Adds the codepoints of the escape sequence \<codepoint> to the given class.
+        static bool parseEscape(char32_t codepoint, CharClass& charClass)
+        {
+            auto const add = [&](char32_t first, char32_t last) {
+                charClass.ranges.emplace_back(first, last);
+            };
+            switch (codepoint)
+            {
+                case U'D': charClass.negated = true; [[fallthrough]];
+                case U'd': add(U'0', U'9'); return true;
+                case U'W': charClass.negated = true; [[fallthrough]];
+                case U'w':
+                    add(U'0', U'9');
+                    add(U'A', U'Z');
+                    add(U'_', U'_');
+                    add(U'a', U'z');
+                    return true;
+                case U'S': charClass.negated = true; [[fallthrough]];
+                case U's':
+                    add(U'\t', U'\r');
+                    add(U' ', U' ');
+                    return true;
+                case U't': add(U'\t', U'\t'); return true;
+                case U'n': add(U'\n', U'\n'); return true;
+                case U'r': add(U'\r', U'\r'); return true;
+                default:
+                    if ((codepoint >= U'0' && codepoint <= U'9') || (codepoint >= U'A' && codepoint <= U'Z')
+                        || (codepoint >= U'a' && codepoint <= U'z'))
+                        return false; // Reserved for escape sequences not supported.
+                    add(codepoint, codepoint);
+                    return true;
+            }
+        }
+
+        RegexNode parseBracketExpression()
+        {
+            auto charClass = CharClass { .ranges = {}, .negated = consume(U'^') };
+            auto first = true;
+            while (!atEnd() && (first || peek() != U']'))
+            {
+                first = false;
+                auto codepoint = _input[_pos++];
+                if (codepoint == U'\\')
+                {
+                    if (atEnd())
+                        return fail();
+                    auto escaped = CharClass {};
+                    if (!parseEscape(_input[_pos++], escaped) || escaped.negated)
+                        return fail(); // Negated classes cannot be combined within brackets.
+                    if (escaped.ranges.size() != 1 || escaped.ranges[0].first != escaped.ranges[0].second)
+                    {
+                        charClass.ranges.insert(
+                            charClass.ranges.end(), escaped.ranges.begin(), escaped.ranges.end());
+                        continue;
+                    }
+                    codepoint = escaped.ranges[0].first;
+                }
+
+                auto last = codepoint;
+                if (_pos + 1 < _input.size() && peek() == U'-' && _input[_pos + 1] != U']')
+                {
+                    ++_pos;
+                    last = _input[_pos++];
+                    if (last == U'\\')
+                    {
+                        if (atEnd())
+                            return fail();
+                        last = _input[_pos++];
+                    }
+                    if (last < codepoint)
+                        return fail();
+                }
+                charClass.ranges.emplace_back(codepoint, last);
+            }
+            if (!consume(U']'))
+                return fail();
+            return addClass(std::move(charClass));
+        }
+
+        u32string_view _input;
+        size_t _pos = 0;
+        vector<CharClass>& _classes;
+        bool _ignoreCase;
+        bool _failed = false;
+    };
+} // namespace
+
+bool SearchPattern::CharClass::contains(char32_t codepoint) const noexcept
+{
+    auto const inRange = std::any_of(ranges.begin(), ranges.end(), [codepoint](auto const& range) {
+        return range.first <= codepoint && codepoint <= range.second;
+    });
+    return inRange != negated;
+}
+
+SearchPattern::SearchPattern(u32string_view term, SearchMode mode): _mode { mode }, _term { term }
+{
+}
+
+optional<SearchPattern> SearchPattern::compile(u32string_view term, SearchMode mode)
+{
+    if (term.empty())
+        return nullopt;
+
+    auto pattern = SearchPattern { term, mode };
+    if (mode == SearchMode::Words)
+    {
+        if (!pattern.compileWords())
+            return nullopt;
+        return pattern;
+    }
+
+    auto expression = u32string_view(term);
+    if (mode == SearchMode::Regex && expression.starts_with(U"(?i)"))
+    {
+        pattern._ignoreCase = true;
+        expression.remove_prefix(4);
+    }
+
+    auto parser = RegexParser<CharClass> { expression, pattern._classes, pattern._ignoreCase };
+    auto root = optional<RegexNode> {};
+    if (mode == SearchMode::Regex)
+        root = parser.parse();
+    else
+    {
+        root = RegexNode { .kind = RegexNode::Kind::Concat };
+        for (auto const codepoint: expression)
+            root->children.emplace_back(parser.literal(codepoint));
+    }
+    if (!root)
+        return nullopt;
+
+    // Thompson construction, emitting every node before the nodes leading to it.
+    auto& nfa = pattern._nfa;
+    auto const addNode = [&](NfaNode node) {
+        nfa.emplace_back(node);
+        return static_cast<uint32_t>(nfa.size() - 1);
+    };
+    auto const emit = [&](auto const& self, RegexNode const& node, uint32_t next) -> uint32_t {
+        switch (node.kind)
+        {
+            case RegexNode::Kind::Empty: return next;
+            case RegexNode::Kind::Char:
+                return addNode(
+                    NfaNode { .kind = NfaNode::Kind::Char, .next = next, .charClass = node.charClass });
+            case RegexNode::Kind::LineStart:
+                return addNode(NfaNode { .kind = NfaNode::Kind::LineStart, .next = next });
+            case RegexNode::Kind::LineEnd:
+                return addNode(NfaNode { .kind = NfaNode::Kind::LineEnd, .next = next });
+            case RegexNode::Kind::Concat:
+                for (auto i = node.children.rbegin(); i != node.children.rend(); ++i)
+                    next = self(self, *i, next);
+                return next;
+            case RegexNode::Kind::Alternation: {
+                auto entry = self(self, node.children.back(), next);
+                for (auto i = std::next(node.children.rbegin()); i != node.children.rend(); ++i)
+                    entry = addNode(NfaNode {
+                        .kind = NfaNode::Kind::Split, .next = self(self, *i, next), .alternative = entry });
+                return entry;
+            }
+            case RegexNode::Kind::Repeat: {
+                auto const& body = node.children.front();
+                if (node.max == Unbounded)
+                {
+                    auto const loop = addNode(NfaNode { .kind = NfaNode::Kind::Split, .alternative = next });
+                    auto const bodyEntry = self(self, body, loop);
+                    nfa[loop].next = bodyEntry;
+                    next = loop;
+                }
+                else
+                {
+                    for (auto i = node.min; i < node.max && nfa.size() <= MaxNfaNodes; ++i)
+                    {
+                        auto const bodyEntry = self(self, body, next);
+                        next = addNode(
+                            NfaNode { .kind = NfaNode::Kind::Split, .next = bodyEntry, .alternative = next });
+                    }
+                }
+                for (auto i = 0u; i < node.min && nfa.size() <= MaxNfaNodes; ++i)
+                    next = self(self, body, next);
+                return next;
+            }
+        }
+        return next;
+    };
+
+    auto const match = addNode(NfaNode { .kind = NfaNode::Kind::Match });
+    pattern._entry = emit(emit, *root, match);
+    if (nfa.size() > MaxNfaNodes)
+        return nullopt;
+
+    pattern._scanDfa.unanchored = true;
+    pattern.resetDfa(pattern._dfa);
+    pattern.resetDfa(pattern._scanDfa);
+    return pattern;
+}
+
+bool SearchPattern::compileWords()
+{
+    auto constexpr NoEdge = UnknownState;
+
+    // Builds the trie of all words.
+    _words.emplace_back().asciiTransitions.fill(NoEdge);
+    auto const isSpace = [](char32_t codepoint) {
+        return codepoint == U' ' || codepoint == U'\t';
+    };
+    for (size_t i = 0; i < _term.size();)
+    {
+        if (isSpace(_term[i]))
+        {
+            ++i;
+            continue;
+        }
+        auto state = StateId { 0 };
+        auto length = size_t { 0 };
+        for (; i < _term.size() && !isSpace(_term[i]); ++i, ++length)
+        {
+            auto const codepoint = _term[i];
+            auto next = NoEdge;
+            if (codepoint < 128)
+                next = _words[state].asciiTransitions[codepoint];
+            else if (auto const edge = std::find_if(_words[state].edges.begin(),
+                                                    _words[state].edges.end(),
+                                                    [&](auto const& e) { return e.first == codepoint; });
+                     edge != _words[state].edges.end())
+                next = edge->second;
+
+            if (next == NoEdge)
+            {
+                next = static_cast<StateId>(_words.size());
+                _words.emplace_back().asciiTransitions.fill(NoEdge);
+                if (codepoint < 128)
+                    _words[state].asciiTransitions[codepoint] = next;
+                else
+                    _words[state].edges.emplace_back(codepoint, next);
+            }
+            state = next;
+        }
+        _words[state].matchLength = length;
+    }
+
+    if (_words.size() == 1)
+        return false; // No words at all.
+
+    // Computes failure links breadth-first, completing the ASCII transitions on the way.
+    auto queue = std::deque<StateId> { 0 };
+    while (!queue.empty())
+    {
+        auto const state = queue.front();
+        queue.pop_front();
+        auto const fail = _words[state].fail;
+        auto const addChild = [&](StateId child, char32_t codepoint) {
+            auto const childFail = state == 0 ? StateId { 0 } : nextWordState(fail, codepoint);
+            _words[child].fail = childFail;
+            _words[child].matchLength = std::max(_words[child].matchLength, _words[childFail].matchLength);
+            queue.push_back(child);
+        };
+
+        for (char32_t codepoint = 0; codepoint < 128; ++codepoint)
+        {
+            auto& next = _words[state].asciiTransitions[codepoint];
+            if (next != NoEdge)
+                addChild(next, codepoint);
+            else
+                next = state == 0 ? StateId { 0 } : _words[fail].asciiTransitions[codepoint];
+        }
+
+        std::sort(_words[state].edges.begin(), _words[state].edges.end());
+        for (auto const& [codepoint, child]: _words[state].edges)
+            addChild(child, codepoint);
+    }
+    return true;
+}
+
+SearchPattern::StateId SearchPattern::nextWordState(StateId state, char32_t codepoint) const noexcept
+{
+    if (codepoint < 128)
+        return _words[state].asciiTransitions[codepoint];
+
+    for (;;)
+    {
+        auto const& edges = _words[state].edges;
+        auto const edge = std::lower_bound(
+            edges.begin(), edges.end(), codepoint, [](auto const& e, char32_t c) { return e.first < c; });
+        if (edge != edges.end() && edge->first == codepoint)
+            return edge->second;
+        if (state == 0)
+            return 0;
+        state = _words[state].fail;
+    }
+}
+
+void SearchPattern::resetDfa(Dfa& dfa) const
+{
+    dfa.states.clear();
+    dfa.index.clear();
+    (void) addState(dfa, {}); // DeadState
+    dfa.lineStart = addState(dfa, closure({ _entry }, true, false));
+    dfa.start = addState(dfa, closure({ _entry }, false, false));
+}
+
+vector<uint32_t> SearchPattern::closure(vector<uint32_t> seeds, bool lineStart, bool lineEnd) const
+{
+    auto result = vector<uint32_t> {};
+    auto visited = vector<bool>(_nfa.size(), false);
+    while (!seeds.empty())
+    {
+        auto const id = seeds.back();
+        seeds.pop_back();
+        if (visited[id])
+            continue;
+        visited[id] = true;
+        result.push_back(id);
+
+        auto const& node = _nfa[id];
+        switch (node.kind)
+        {
+            case NfaNode::Kind::Split:
+                seeds.push_back(node.next);
+                seeds.push_back(node.alternative);
+                break;
+            case NfaNode::Kind::LineStart:
+                if (lineStart)
+                    seeds.push_back(node.next);
+                break;
+            case NfaNode::Kind::LineEnd:
+                if (lineEnd)
+                    seeds.push_back(node.next);
+                break;
+            case NfaNode::Kind::Char:
+            case NfaNode::Kind::Match: break;
+        }
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+SearchPattern::StateId SearchPattern::addState(Dfa& dfa, vector<uint32_t> nfaStates) const
+{
+    if (auto const i = dfa.index.find(nfaStates); i != dfa.index.end())
+        return i->second;
+
+    auto const isMatch = [&](uint32_t id) {
+        return _nfa[id].kind == NfaNode::Kind::Match;
+    };
+
+    auto state = DfaState {};
+    state.asciiTransitions.fill(nfaStates.empty() ? DeadState : UnknownState);
+    state.accepting = std::any_of(nfaStates.begin(), nfaStates.end(), isMatch);
+    state.acceptingAtEnd = state.accepting;
+    if (!state.accepting)
+    {
+        auto const atEnd = closure(nfaStates, false, true);
+        state.acceptingAtEnd = std::any_of(atEnd.begin(), atEnd.end(), isMatch);
+    }
+    state.nfaStates = nfaStates;
+
+    auto const id = static_cast<StateId>(dfa.states.size());
+    dfa.states.emplace_back(std::move(state));
+    dfa.index.emplace(std::move(nfaStates), id);
+    return id;
+}
+
+SearchPattern::StateId SearchPattern::computeTransition(Dfa& dfa, StateId state, char32_t codepoint) const
+{
+    if (state == DeadState)
+        return DeadState;
+
+    if (codepoint >= 128)
+    {
+        auto const& transitions = dfa.states[state].transitions;
+        if (auto const i = transitions.find(codepoint); i != transitions.end())
+            return i->second;
+    }
+
+    auto seeds = vector<uint32_t> {};
+    for (auto const id: dfa.states[state].nfaStates)
+        if (_nfa[id].kind == NfaNode::Kind::Char && _classes[_nfa[id].charClass].contains(codepoint))
+            seeds.push_back(_nfa[id].next);
+    if (dfa.unanchored)
+        seeds.push_back(_entry);
+
+    auto nfaStates = closure(std::move(seeds), false, false);
+    if (dfa.states.size() >= MaxDfaStates && !dfa.index.contains(nfaStates))
+    {
+        // Keeps memory bounded for expressions with exceptionally many states, at the cost of
+        // constructing the states needed again.
+        resetDfa(dfa);
+        return addState(dfa, std::move(nfaStates));
+    }
+
+    auto const target = addState(dfa, std::move(nfaStates));
+    if (codepoint < 128)
+        dfa.states[state].asciiTransitions[codepoint] = target;
+    else
+        dfa.states[state].transitions.emplace(codepoint, target);
+    return target;
+}
+
+} // namespace vtbackend
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vtbackend
+{
+
+/// Determines how a search term is interpreted.
+enum class SearchMode : uint8_t
+{
+    /// The term is matched literally.
+    Literal,
+
+    /// The term is a regular expression.
+    Regex,
+
+    /// The term is a whitespace separated list of words, each of which is matched literally.
+    Words,
+};
+
+/// Location of a match within the searched text, in codepoints (i.e. grid columns).
+struct SearchMatch
+{
+    size_t start = 0;
+    size_t length = 0;
+
+    bool operator==(SearchMatch const&) const noexcept = default;
+};
+
+/// A search term compiled for repeatedly matching it against grid text.
+///
+/// Literal terms and regular expressions are compiled into an NFA that is turned into a DFA lazily,
+/// while matching. Word lists are compiled into an Aho-Corasick automaton.
+///
+/// The searched text may be of any type providing size() and operator[], yielding one codepoint per
+/// grid column, so that grid lines can be searched without copying their text.
+///
+/// Supported regular expression syntax: literals, `.`, bracket expressions (`[a-z_]`, `[^0-9]`),
+/// the classes `\d`, `\w`, `\s` and their negations, groups (`(...)`, `(?:...)`), alternation,
+/// the quantifiers `*`, `+`, `?`, `{n}`, `{n,}`, `{n,m}`, and the anchors `^` and `$`, matching at
+/// the beginning and end of the searched text.
+/// A leading `(?i)` makes the expression case-insensitive for ASCII letters.
+///
+/// Regular expression matches are leftmost-longest, word matches are the ones ending first.
+/// Empty matches are never reported.
+///
+/// The DFA is extended while matching, therefore a SearchPattern must not be used concurrently.
+class SearchPattern
+{
+  public:
+    /// Compiles the given search term.
+    ///
+    /// @returns the compiled pattern, or std::nullopt if @p term is empty or not a valid expression.
+    [[nodiscard]] static std::optional<SearchPattern> compile(std::u32string_view term, SearchMode mode);
+
+    [[nodiscard]] SearchMode mode() const noexcept { return _mode; }
+    [[nodiscard]] std::u32string const& term() const noexcept { return _term; }
+
+    /// Finds the leftmost match in @p text starting at or after @p from.
+    template <typename Text>
+    [[nodiscard]] std::optional<SearchMatch> find(Text const& text, size_t from = 0) const;
+
+    /// Finds the rightmost match in @p text starting at or before @p last.
+    template <typename Text>
+    [[nodiscard]] std::optional<SearchMatch> findReverse(Text const& text, size_t last) const;
+
+    /// Invokes @p callback with every non-overlapping match in @p text, from left to right.
+    template <typename Text, typename Callback>
+    void forEachMatch(Text const& text, Callback&& callback) const;
+
+    /// Number of DFA states constructed so far.
+    [[nodiscard]] size_t dfaStateCount() const noexcept
+    {
+        return _dfa.states.size() + _scanDfa.states.size();
+    }
+
+  private:
+    using StateId = uint32_t;
+    static constexpr StateId DeadState = 0;
+    static constexpr StateId UnknownState = ~StateId { 0 };
+
+    struct CharClass
+    {
+        std::vector<std::pair<char32_t, char32_t>> ranges; // inclusive
+        bool negated = false;
+
+        [[nodiscard]] bool contains(char32_t codepoint) const noexcept;
+    };
+
+    struct NfaNode
+    {
+        enum class Kind : uint8_t
+        {
+            Char,
+            Split,
+            LineStart,
+            LineEnd,
+            Match,
+        };
+
+        Kind kind = Kind::Match;
+        uint32_t next = 0;        // Successor of any node but Match.
+        uint32_t alternative = 0; // Second successor of a Split.
+        uint32_t charClass = 0;   // Class of the codepoints a Char node consumes.
+    };
+
+    struct DfaState
+    {
+        std::vector<uint32_t> nfaStates; // Sorted, epsilon-closed.
+        std::array<StateId, 128> asciiTransitions {};
+        std::unordered_map<char32_t, StateId> transitions;
+        bool accepting = false;      // Whether a match ends here.
+        bool acceptingAtEnd = false; // Whether a match ends here, if this is the end of the text.
+    };
+
+    struct Dfa
+    {
+        bool unanchored = false; // Whether a match may start at any position, rather than the first.
+        std::vector<DfaState> states;
+        std::map<std::vector<uint32_t>, StateId> index;
+        StateId lineStart = DeadState; // Start state at the beginning of the text.
+        StateId start = DeadState;     // Start state elsewhere.
+    };
+
+    struct WordNode
+    {
+        std::array<StateId, 128> asciiTransitions {};     // Complete transition function.
+        std::vector<std::pair<char32_t, StateId>> edges; // Trie edges of non-ASCII codepoints, sorted.
+        StateId fail = 0;
+        size_t matchLength = 0; // Length of the longest word ending here, or 0.
+    };
+
+    SearchPattern(std::u32string_view term, SearchMode mode);
+
+    [[nodiscard]] bool compileWords();
+    void resetDfa(Dfa& dfa) const;
+    [[nodiscard]] std::vector<uint32_t> closure(std::vector<uint32_t> seeds,
+                                                bool lineStart,
+                                                bool lineEnd) const;
+    [[nodiscard]] StateId addState(Dfa& dfa, std::vector<uint32_t> nfaStates) const;
+    [[nodiscard]] StateId computeTransition(Dfa& dfa, StateId state, char32_t codepoint) const;
+    [[nodiscard]] StateId nextWordState(StateId state, char32_t codepoint) const noexcept;
+
+    [[nodiscard]] StateId step(Dfa& dfa, StateId state, char32_t codepoint) const
+    {
+        if (_ignoreCase && codepoint >= U'A' && codepoint <= U'Z')
+            codepoint += U'a' - U'A';
+        if (codepoint < 128)
+            if (auto const next = dfa.states[state].asciiTransitions[codepoint]; next != UnknownState)
+                return next;
+        return computeTransition(dfa, state, codepoint);
+    }
+
+    template <typename Text>
+    [[nodiscard]] bool mayMatch(Text const& text, size_t from) const;
+
+    SearchMode _mode;
+    std::u32string _term;
+    bool _ignoreCase = false;
+
+    std::vector<CharClass> _classes;
+    std::vector<NfaNode> _nfa;
+    uint32_t _entry = 0;
+
+    mutable Dfa _dfa;     // Matches anchored at the position matching starts at.
+    mutable Dfa _scanDfa; // Tells whether there is any match.
+
+    std::vector<WordNode> _words;
+};
+
+// {{{ SearchPattern implementation
+template <typename Text>
+bool SearchPattern::mayMatch(Text const& text, size_t from) const
+{
+    auto const size = static_cast<size_t>(text.size());
+    auto state = from == 0 ? _scanDfa.lineStart : _scanDfa.start;
+    for (auto i = from; i < size; ++i)
+    {
+        state = step(_scanDfa, state, static_cast<char32_t>(text[i]));
+        if (_scanDfa.states[state].accepting)
+            return true;
+    }
+    return _scanDfa.states[state].acceptingAtEnd;
+}
+
+template <typename Text>
+std::optional<SearchMatch> SearchPattern::find(Text const& text, size_t from) const
+{
+    auto const size = static_cast<size_t>(text.size());
+    if (from >= size)
+        return std::nullopt;
+
+    if (_mode == SearchMode::Words)
+    {
+        auto state = StateId { 0 };
+        for (auto i = from; i < size; ++i)
+        {
+            state = nextWordState(state, static_cast<char32_t>(text[i]));
+            if (auto const length = _words[state].matchLength)
+                return SearchMatch { .start = i + 1 - length, .length = length };
+        }
+        return std::nullopt;
+    }
+
+    // A single pass of the unanchored automaton rules out texts without any match,
+    // so that only texts containing a match are searched for its start.
+    if (!mayMatch(text, from))
+        return std::nullopt;
+
+    for (auto start = from; start < size; ++start)
+    {
+        auto state = start == 0 ? _dfa.lineStart : _dfa.start;
+        auto matchEnd = size_t { 0 };
+        for (auto i = start; i < size; ++i)
+        {
+            state = step(_dfa, state, static_cast<char32_t>(text[i]));
+            if (state == DeadState)
+                break;
+            if (_dfa.states[state].accepting || (i + 1 == size && _dfa.states[state].acceptingAtEnd))
+                matchEnd = i + 1;
+        }
+        if (matchEnd)
+            return SearchMatch { .start = start, .length = matchEnd - start };
+    }
+    return std::nullopt;
+}
+
+template <typename Text>
+std::optional<SearchMatch> SearchPattern::findReverse(Text const& text, size_t last) const
+{
+    auto result = std::optional<SearchMatch> {};
+    for (auto match = find(text, 0); match && match->start <= last; match = find(text, match->start + 1))
+        result = match;
+    return result;
+}
+
+template <typename Text, typename Callback>
+void SearchPattern::forEachMatch(Text const& text, Callback&& callback) const
+{
+    for (auto match = find(text, 0); match; match = find(text, match->start + match->length))
+        callback(*match);
+}
+// }}}
+
+} // namespace vtbackend
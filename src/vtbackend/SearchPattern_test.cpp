@@ -0,0 +1,130 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/SearchPattern.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <string_view>
+#include <vector>
+
+using namespace vtbackend;
+
+using std::nullopt;
+using std::optional;
+using std::u32string_view;
+
+namespace
+{
+
+optional<SearchMatch> findRegex(u32string_view expression, u32string_view text, size_t from = 0)
+{
+    auto const pattern = SearchPattern::compile(expression, SearchMode::Regex);
+    REQUIRE(pattern.has_value());
+    return pattern->find(text, from);
+}
+
+SearchMatch at(size_t start, size_t length)
+{
+    return SearchMatch { .start = start, .length = length };
+}
+
+} // namespace
+
+TEST_CASE("SearchPattern.Literal", "[SearchPattern]")
+{
+    auto const pattern = SearchPattern::compile(U"a.c", SearchMode::Literal);
+    REQUIRE(pattern.has_value());
+    CHECK(pattern->find(u32string_view(U"abc a.c")) == at(4, 3));
+    CHECK(pattern->find(u32string_view(U"abc a.c"), 5) == nullopt);
+    CHECK(pattern->findReverse(u32string_view(U"a.c a.c"), 3) == at(0, 3));
+    CHECK(pattern->findReverse(u32string_view(U"a.c a.c"), 4) == at(4, 3));
+
+    CHECK_FALSE(SearchPattern::compile(U"", SearchMode::Literal).has_value());
+}
+
+TEST_CASE("SearchPattern.Regex", "[SearchPattern]")
+{
+    CHECK(findRegex(U"a.c", U"xxabcx") == at(2, 3));
+    CHECK(findRegex(U"[0-9]+", U"abc 1234 56") == at(4, 4));
+    CHECK(findRegex(U"[0-9]+", U"abc 1234 56", 5) == at(5, 3));
+    CHECK(findRegex(U"\\d{2,3}", U"1 12345") == at(2, 3));
+    CHECK(findRegex(U"err(or)?|warn", U"a warning") == at(2, 4));
+    CHECK(findRegex(U"err(or)?|warn", U"an error") == at(3, 5));
+    CHECK(findRegex(U"(?:ab)+", U"xababab") == at(1, 6));
+    CHECK(findRegex(U"[^ ]+", U"  word  ") == at(2, 4));
+    CHECK(findRegex(U"\\w+\\s\\w+", U"-- foo bar") == at(3, 7));
+    CHECK(findRegex(U"a\\.b", U"axb a.b") == at(4, 3));
+    CHECK(findRegex(U"x{", U"ax{") == at(1, 2));
+    CHECK(findRegex(U"ü+", U"grüüße") == at(2, 2));
+    CHECK(findRegex(U"(?i)hello", U"Say HeLLo") == at(4, 5));
+    CHECK(findRegex(U"(?i)[a-c]+", U"xxABca") == at(2, 4));
+    CHECK(findRegex(U"hello", U"HELLO") == nullopt);
+
+    // Empty matches are never reported.
+    CHECK(findRegex(U"a*", U"bbb") == nullopt);
+    CHECK(findRegex(U"a*", U"bbaa") == at(2, 2));
+}
+
+TEST_CASE("SearchPattern.Regex.anchors", "[SearchPattern]")
+{
+    CHECK(findRegex(U"^foo", U"foo foo") == at(0, 3));
+    CHECK(findRegex(U"^foo", U"foo foo", 1) == nullopt);
+    CHECK(findRegex(U"foo$", U"foo foo") == at(4, 3));
+    CHECK(findRegex(U"^foo$", U"foo") == at(0, 3));
+    CHECK(findRegex(U"^foo$", U"foo ") == nullopt);
+    CHECK(findRegex(U"o+$", U"foo") == at(1, 2));
+}
+
+TEST_CASE("SearchPattern.Regex.invalid", "[SearchPattern]")
+{
+    for (auto const expression: { U"(", U"a)", U"[abc", U"*a", U"a|*", U"\\", U"[z-a]", U"(?=a)", U"\\q" })
+    {
+        INFO(static_cast<int>(u32string_view(expression).size()));
+        CHECK_FALSE(SearchPattern::compile(expression, SearchMode::Regex).has_value());
+    }
+}
+
+TEST_CASE("SearchPattern.Regex.forEachMatch", "[SearchPattern]")
+{
+    auto const pattern = SearchPattern::compile(U"[a-z]+", SearchMode::Regex);
+    REQUIRE(pattern.has_value());
+
+    auto matches = std::vector<SearchMatch> {};
+    pattern->forEachMatch(u32string_view(U"ab 12 cde f"),
+                          [&](SearchMatch match) { matches.push_back(match); });
+    CHECK(matches == std::vector { at(0, 2), at(6, 3), at(10, 1) });
+}
+
+TEST_CASE("SearchPattern.Regex.stateLimit", "[SearchPattern]")
+{
+    // Requires way more DFA states than kept at once.
+    auto const pattern = SearchPattern::compile(U"a.{12}b", SearchMode::Regex);
+    REQUIRE(pattern.has_value());
+
+    auto text = std::u32string {};
+    for (auto i = 0; i < 20'000; ++i)
+        text.push_back((i * 7919) % 3 ? U'a' : U'c');
+    text += U"a0123456789abb";
+    auto const match = pattern->find(u32string_view(text));
+    REQUIRE(match.has_value());
+    CHECK(match->length == 14);
+    CHECK(text.substr(match->start, match->length).back() == U'b');
+}
+
+TEST_CASE("SearchPattern.Words", "[SearchPattern]")
+{
+    auto const pattern = SearchPattern::compile(U"he she  his hers ü", SearchMode::Words);
+    REQUIRE(pattern.has_value());
+
+    CHECK(pattern->find(u32string_view(U"ushers")) == at(1, 3));
+    CHECK(pattern->find(u32string_view(U"ushers"), 2) == at(2, 2));
+    CHECK(pattern->find(u32string_view(U"ahishe")) == at(1, 3));
+    CHECK(pattern->find(u32string_view(U"xyz")) == nullopt);
+    CHECK(pattern->find(u32string_view(U"grüße")) == at(2, 1));
+
+    auto matches = std::vector<SearchMatch> {};
+    pattern->forEachMatch(u32string_view(U"he said: his"),
+                          [&](SearchMatch match) { matches.push_back(match); });
+    CHECK(matches == std::vector { at(0, 2), at(9, 3) });
+
+    CHECK_FALSE(SearchPattern::compile(U"  ", SearchMode::Words).has_value());
+}
@@ -15,22 +15,12 @@ namespace vtbackend
 namespace // {{{ helper
 {
 
-    tuple<vector<Selection::Range>, CellLocation const, CellLocation const> prepare(
-        Selection const& selection)
+    pair<CellLocation, CellLocation> orderedRange(Selection const& selection) noexcept
     {
-        vector<Selection::Range> result;
-
-        auto const [from, to] = [&]() {
-            if (selection.from() <= selection.to())
-                return pair { selection.from(), selection.to() };
-            else
-                return pair { selection.to(), selection.from() };
-        }();
-
-        auto const numLines = to.line - from.line + 1;
-        result.resize(numLines.as<size_t>());
-
-        return { std::move(result), from, to };
+        if (selection.from() <= selection.to())
+            return pair { selection.from(), selection.to() };
+        else
+            return pair { selection.to(), selection.from() };
     }
 } // namespace
 // }}}
@@ -87,30 +77,30 @@ bool Selection::intersects(Rect area) const noexcept
 
 std::vector<Selection::Range> Selection::ranges() const
 {
-    auto [result, from, to] = prepare(*this);
+    auto const [from, to] = orderedRange(*this);
+    return ranges(from.line, to.line);
+}
 
+std::vector<Selection::Range> Selection::ranges(LineOffset first, LineOffset last) const
+{
+    auto const [from, to] = orderedRange(*this);
     auto const rightMargin = boxed_cast<ColumnOffset>(_helper.pageSize().columns - 1);
 
-    switch (result.size())
-    {
-        case 1: result[0] = Range { from.line, from.column, min(to.column, rightMargin) }; break;
-        case 2:
-            // Render first line partial from selected column to end.
-            result[0] = Range { from.line, from.column, rightMargin };
-            // Render last (second) line partial from beginning to last selected column.
-            result[1] = Range { to.line, ColumnOffset(0), min(to.column, rightMargin) };
-            break;
-        default:
-            // Render first line partial from selected column to end.
-            result[0] = Range { from.line, from.column, rightMargin };
+    first = max(first, from.line);
+    last = min(last, to.line);
 
-            // Render inner full.
-            for (size_t n = 1; n < result.size(); ++n)
-                result[n] = Range { from.line + LineOffset::cast_from(n), ColumnOffset(0), rightMargin };
+    vector<Range> result;
+    if (first > last)
+        return result;
 
-            // Render last (second) line partial from beginning to last selected column.
-            result[result.size() - 1] = Range { to.line, ColumnOffset(0), min(to.column, rightMargin) };
-            break;
+    result.reserve((last - first + 1).as<size_t>());
+    for (auto line = first; line <= last; ++line)
+    {
+        // Render first line partial from selected column to end,
+        // and last line partial from beginning to last selected column.
+        auto const left = line == from.line ? from.column : ColumnOffset(0);
+        auto const right = line == to.line ? min(to.column, rightMargin) : rightMargin;
+        result.emplace_back(Range { line, left, right });
     }
 
     return result;
@@ -248,20 +238,23 @@ bool RectangularSelection::intersects(Rect area) const noexcept
     return area.top.as<LineOffset>() < from.line && to.line < area.bottom.as<LineOffset>();
 }
 
-vector<Selection::Range> RectangularSelection::ranges() const
+vector<Selection::Range> RectangularSelection::ranges(LineOffset first, LineOffset last) const
 {
     auto const [from, to] = orderedPoints(_from, _to);
 
+    first = max(first, from.line);
+    last = min(last, to.line);
+
     vector<Selection::Range> result;
-    auto const numLines = to.line - from.line + 1;
-    result.resize(numLines.as<size_t>());
+    if (first > last)
+        return result;
 
-    for (size_t i = 0; i < result.size(); ++i)
+    result.reserve((last - first + 1).as<size_t>());
+    for (auto line = first; line <= last; ++line)
     {
-        auto const line = from.line + LineOffset::cast_from(i);
         auto const left = from.column;
         auto const right = stretchedColumn(_helper, CellLocation { line, to.column }).column;
-        result[i] = Range { line, left, right };
+        result.emplace_back(Range { line, left, right });
     }
 
     return result;
@@ -100,7 +100,10 @@ class Selection
     [[nodiscard]] virtual bool extend(CellLocation to);
 
     /// Constructs a vector of ranges for this selection.
-    [[nodiscard]] virtual std::vector<Range> ranges() const;
+    [[nodiscard]] std::vector<Range> ranges() const;
+
+    /// Constructs a vector of ranges for the lines of this selection between the given lines (inclusive).
+    [[nodiscard]] virtual std::vector<Range> ranges(LineOffset first, LineOffset last) const;
 
     /// Marks the selection as completed.
     void complete();
@@ -127,7 +130,7 @@ class RectangularSelection: public Selection
                          OnSelectionUpdated onSelectionUpdated);
     [[nodiscard]] bool contains(CellLocation coord) const noexcept override;
     [[nodiscard]] bool intersects(Rect area) const noexcept override;
-    [[nodiscard]] std::vector<Range> ranges() const override;
+    [[nodiscard]] std::vector<Range> ranges(LineOffset first, LineOffset last) const override;
 };
 
 class LinearSelection final: public Selection
@@ -161,6 +164,10 @@ class FullLineSelection final: public Selection
 template <typename Renderer>
 void renderSelection(Selection const& selection, Renderer&& render);
 
+/// Renders the selected cells on the lines between the given lines (inclusive) only.
+template <typename Renderer>
+void renderSelection(Selection const& selection, LineOffset first, LineOffset last, Renderer&& render);
+
 // {{{ impl
 inline void Selection::applyScroll(LineOffset value, LineCount historyLineCount)
 {
@@ -177,6 +184,14 @@ void renderSelection(Selection const& selection, Renderer&& render)
         for (auto const col: crispy::times(*range.fromColumn, *range.length()))
             std::forward<Renderer>(render)(CellLocation { range.line, ColumnOffset::cast_from(col) });
 }
+
+template <typename Renderer>
+void renderSelection(Selection const& selection, LineOffset first, LineOffset last, Renderer&& render)
+{
+    for (Selection::Range const& range: selection.ranges(first, last))
+        for (auto const col: crispy::times(*range.fromColumn, *range.length()))
+            std::forward<Renderer>(render)(CellLocation { range.line, ColumnOffset::cast_from(col) });
+}
 // }}}
 
 } // namespace vtbackend
@@ -157,6 +157,14 @@ TEST_CASE("Selector.Linear", "[selector]")
         auto selectedText = TextSelection { screen };
         renderSelection(selector, selectedText);
         CHECK(selectedText.text == "b,cdefg,hi\n1234");
+
+        // Ranges of a subset of the lines only.
+        vector<Selection::Range> const lastLine = selector.ranges(LineOffset(2), LineOffset(5));
+        REQUIRE(lastLine.size() == 1);
+        CHECK(lastLine[0].line == LineOffset(2));
+        CHECK(lastLine[0].fromColumn == ColumnOffset(0));
+        CHECK(lastLine[0].toColumn == ColumnOffset(3));
+        CHECK(selector.ranges(LineOffset(3), LineOffset(5)).empty());
     }
 
     SECTION("multiple lines fully in history")
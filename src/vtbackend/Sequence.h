@@ -210,6 +210,13 @@ class Sequence
     DataString _dataString;
 
   public:
+    Sequence()
+    {
+        // The OSC payload is collected into the intermediate characters and is bounded by MaxOscLength.
+        // Reserving it upfront keeps the (reused) sequence from ever reallocating while parsing.
+        _intermediateCharacters.reserve(MaxOscLength);
+    }
+
     // parameter accessors
     //
 
@@ -259,6 +266,11 @@ class Sequence
         return select(selector(), availableDefinitions);
     }
 
+    [[nodiscard]] Function const* functionDefinition(SupportedSequences const& sequences) const noexcept
+    {
+        return sequences.select(selector());
+    }
+
     /// Converts a FunctionSpinto a FunctionSelector, applicable for finding the corresponding
     /// FunctionDefinition.
     [[nodiscard]] FunctionSelector selector() const noexcept
@@ -97,6 +97,19 @@ class SequenceBuilder
         }
     }
 
+    void param(std::string_view chars) noexcept
+    {
+        for (auto const ch: chars)
+        {
+            if (ch == ';')
+                paramSeparator();
+            else if (ch == ':')
+                paramSubSeparator();
+            else
+                paramDigit(ch);
+        }
+    }
+
     void paramDigit(char ch) noexcept
     {
         _parameterBuilder.multiplyBy10AndAdd(static_cast<uint8_t>(ch - '0'));
@@ -149,6 +162,11 @@ class SequenceBuilder
         if (_hookedParser)
             _hookedParser->pass(ch);
     }
+    void put(std::string_view chars)
+    {
+        if (_hookedParser)
+            _hookedParser->pass(chars);
+    }
     void unhook()
     {
         if (_hookedParser)
@@ -39,8 +39,12 @@ struct Settings
     PageSize pageSize = PageSize { LineCount(25), ColumnCount(80) };
 
     MaxHistoryLineCount maxHistoryLineCount;
+    // Number of scrollback history pages to keep uncompressed, or 0 to never compress history lines.
+    unsigned hotHistoryPageCount = 0;
     ImageSize maxImageSize { Width(800), Height(600) };
     unsigned maxImageRegisterCount = 256;
+    // Maximum number of bytes of image data kept for reuse when the same image is displayed again.
+    size_t imageCacheSize = 64 * 1024 * 1024;
     StatusDisplayType statusDisplayType = StatusDisplayType::None;
     StatusDisplayPosition statusDisplayPosition = StatusDisplayPosition::Bottom;
     struct
@@ -49,6 +53,10 @@ struct Settings
                            "{TraceMode:Bold,Color=#FFFF00,Left= │ }{ProtectedMode:Bold,Left= │ }" };
         std::string middle { "{Title:Left= « ,Right= » ,Color=#20c0c0}" };
         std::string right { "{HistoryLineCount:Faint,Color=#c0c0c0} │ {Clock:Bold} " };
+        // Minimum time between two runs of the same Command segment's program.
+        std::chrono::milliseconds commandRefreshInterval { 5000 };
+        // Time after which a Command segment's program is killed.
+        std::chrono::milliseconds commandTimeout { 5000 };
     } indicatorStatusLine;
     bool syncWindowTitleWithHostWritableStatusDisplay = true;
     CursorDisplay cursorDisplay = CursorDisplay::Steady;
@@ -72,6 +80,12 @@ struct Settings
     //
     // This value must be integer-devisable by 16.
     size_t ptyReadBufferSize = 4096;
+    // Reads from the PTY on a dedicated thread that hands the read data over to the
+    // parsing thread through a lock-free queue, rather than reading and parsing on one thread.
+    bool pipelinedPtyInput = false;
+    // Maximum number of read chunks queued between the PTY reader and the parser
+    // before the reader blocks. Only used with pipelinedPtyInput.
+    size_t ptyInputQueueCapacity = 64;
     std::u32string wordDelimiters;
     std::u32string extendedWordDelimiters;
     Modifiers mouseProtocolBypassModifiers = Modifier::Shift;
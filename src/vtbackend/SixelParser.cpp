@@ -1,8 +1,13 @@
 // SPDX-License-Identifier: Apache-2.0
 #include <vtbackend/SixelParser.h>
 
+#include <vtparser/ByteScanner.h>
+
 #include <algorithm>
 #include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
 
 using std::clamp;
 using std::fill;
@@ -82,6 +87,18 @@ namespace
         }
     }
 
+    // Fills @p count pixels with the given RGBA value. Written to be auto-vectorized.
+    void fillPixels(uint8_t* target, size_t count, std::array<uint8_t, 4> const& pixel) noexcept
+    {
+        for (size_t i = 0; i < count; ++i)
+            std::memcpy(target + i * 4, pixel.data(), pixel.size());
+    }
+
+    std::array<uint8_t, 4> toPixel(RGBAColor color) noexcept
+    {
+        return { color.red(), color.green(), color.blue(), color.alpha() };
+    }
+
 } // namespace
 
 // VT 340 default color palette (https://www.vt100.net/docs/vt3xx-gp/chapter2.html#S2.4)
@@ -147,6 +164,22 @@ SixelParser::SixelParser(Events& events, OnFinalize finalizer):
 {
 }
 
+void SixelParser::parseFragment(iterator begin, iterator end)
+{
+    auto const* input = begin;
+    while (input != end)
+    {
+        if (_state == State::Ground && isSixel(*input))
+        {
+            auto const* const sixelsEnd = vtparser::findFirstNotInRange<'?', '~'>(input, end);
+            _events.renderSixels(std::string_view(input, static_cast<size_t>(sixelsEnd - input)));
+            input = sixelsEnd;
+        }
+        else
+            parse(*input++);
+    }
+}
+
 void SixelParser::parse(char value)
 {
     switch (_state)
@@ -159,9 +192,7 @@ void SixelParser::parse(char value)
                 paramShiftAndAddDigit(toDigit(value));
             else if (isSixel(value))
             {
-                auto const sixel = toSixel(value);
-                for (unsigned i = 0; i < _params[0]; ++i)
-                    _events.render(sixel);
+                _events.renderRepeated(toSixel(value), _params[0]);
                 transitionTo(State::Ground);
             }
             else
@@ -342,6 +373,11 @@ void SixelParser::pass(char ch)
     parse(ch);
 }
 
+void SixelParser::pass(std::string_view chars)
+{
+    parseFragment(chars);
+}
+
 void SixelParser::finalize()
 {
     done();
@@ -357,7 +393,7 @@ SixelImageBuilder::SixelImageBuilder(ImageSize maxSize,
     _maxSize { maxSize },
     _colors { std::move(colorPalette) },
     _size { ImageSize { Width { 1 }, Height { 1 } } },
-    _buffer(_maxSize.area() * 4),
+    _backgroundColor { backgroundColor },
     _sixelCursor {},
     _aspectRatio(static_cast<unsigned int>(
         std::ceil(static_cast<float>(aspectVertical) / static_cast<float>(aspectHorizontal)))),
@@ -369,16 +405,8 @@ SixelImageBuilder::SixelImageBuilder(ImageSize maxSize,
 void SixelImageBuilder::clear(RGBAColor fillColor)
 {
     _sixelCursor = {};
-
-    auto* p = _buffer.data();
-    auto* const e = p + _maxSize.area() * 4;
-    while (p != e)
-    {
-        *p++ = fillColor.red();
-        *p++ = fillColor.green();
-        *p++ = fillColor.blue();
-        *p++ = fillColor.alpha();
-    }
+    _backgroundColor = fillColor;
+    fillPixels(_buffer.data(), _buffer.size() / 4, toPixel(fillColor));
 }
 
 RGBAColor SixelImageBuilder::at(CellLocation coord) const noexcept
@@ -386,34 +414,29 @@ RGBAColor SixelImageBuilder::at(CellLocation coord) const noexcept
     auto const line = unbox(coord.line) % unbox(_size.height);
     auto const col = unbox(coord.column) % unbox(_size.width);
     auto const base = line * unbox(_size.width) * 4 + col * 4;
+    if (base + 4 > _buffer.size())
+        return _backgroundColor; // Not painted (and thus not allocated) yet.
     const auto* const color = &_buffer[base];
     return RGBAColor { color[0], color[1], color[2], color[3] };
 }
 
-void SixelImageBuilder::write(CellLocation const& coord, RGBColor const& value) noexcept
+void SixelImageBuilder::reserveRows(unsigned rowCount)
 {
-    if (unbox(coord.line) >= 0 && unbox(coord.line) < unbox<int>(_maxSize.height) && unbox(coord.column) >= 0
-        && unbox(coord.column) < unbox<int>(_maxSize.width))
-    {
-        if (!_explicitSize)
-        {
-            if (unbox(coord.line) >= unbox<int>(_size.height))
-                _size.height = Height::cast_from(coord.line.as<unsigned int>() + _aspectRatio);
-            if (unbox(coord.column) >= unbox<int>(_size.width))
-                _size.width = Width::cast_from(coord.column + 1);
-        }
+    auto const rowSize = static_cast<size_t>(bufferWidth()) * 4;
+    if (rowSize == 0)
+        return;
 
-        for (unsigned int i = 0; i < _aspectRatio; ++i)
-        {
-            auto const base = (coord.line.as<unsigned int>() + i)
-                                  * unbox((_explicitSize ? _size.width : _maxSize.width)) * 4u
-                              + unbox<unsigned int>(coord.column) * 4u;
-            _buffer[base + 0] = value.red;
-            _buffer[base + 1] = value.green;
-            _buffer[base + 2] = value.blue;
-            _buffer[base + 3] = 0xFF;
-        }
-    }
+    auto const allocatedRows = _buffer.size() / rowSize;
+    if (rowCount <= allocatedRows)
+        return;
+
+    // Sixel images are painted top to bottom, one band at a time, so that growing geometrically
+    // keeps the number of reallocations (and copies) logarithmic in the image height.
+    auto const newRowCount = min(max(static_cast<size_t>(rowCount), allocatedRows * 2),
+                                 max(static_cast<size_t>(bufferHeight()), static_cast<size_t>(rowCount)));
+    auto const oldSize = _buffer.size();
+    _buffer.resize(newRowCount * rowSize);
+    fillPixels(_buffer.data() + oldSize, (_buffer.size() - oldSize) / 4, toPixel(_backgroundColor));
 }
 
 void SixelImageBuilder::setColor(unsigned index, RGBColor const& color)
@@ -434,8 +457,7 @@ void SixelImageBuilder::rewind()
 void SixelImageBuilder::newline()
 {
     _sixelCursor.column = {};
-    if (unbox<unsigned int>(_sixelCursor.line) + _sixelBandHeight
-        < unbox(_explicitSize ? _size.height : _maxSize.height))
+    if (unbox<unsigned int>(_sixelCursor.line) + _sixelBandHeight < bufferHeight())
         _sixelCursor.line = LineOffset::cast_from(_sixelCursor.line.as<unsigned int>() + _sixelBandHeight);
 }
 
@@ -450,53 +472,131 @@ void SixelImageBuilder::setRaster(unsigned int pan, unsigned int pad, optional<I
         imageSize->height = Height::cast_from(imageSize->height.value * _aspectRatio);
         _size.width = clamp(imageSize->width, Width(0), _maxSize.width);
         _size.height = clamp(imageSize->height, Height(0), _maxSize.height);
-        _buffer.resize(_size.area() * 4);
         _explicitSize = true;
+        _buffer.resize(_size.area() * 4);
+        fillPixels(_buffer.data(), _buffer.size() / 4, toPixel(_backgroundColor));
     }
 }
 
-void SixelImageBuilder::render(int8_t sixel)
+auto SixelImageBuilder::beginBand() -> Pixel
 {
-    // TODO: respect aspect ratio!
-    auto const x = _sixelCursor.column;
-    if (unbox(x) < unbox<int>((_explicitSize ? _size.width : _maxSize.width)))
+    reserveRows(min(unbox<unsigned int>(_sixelCursor.line) + _sixelBandHeight, bufferHeight()));
+
+    auto const color = currentColor();
+    return Pixel { color.red, color.green, color.blue, 0xFF };
+}
+
+void SixelImageBuilder::paint(unsigned x, unsigned count, int8_t sixel, Pixel const& pixel) noexcept
+{
+    auto const top = unbox<unsigned int>(_sixelCursor.line);
+    auto const width = bufferWidth();
+    auto const height = bufferHeight();
+
+    for (unsigned int i = 0; i < 6; ++i)
     {
-        for (unsigned int i = 0; i < 6; ++i)
+        if (!(sixel & (1 << i)))
+            continue;
+
+        for (unsigned int k = 0; k < _aspectRatio; ++k)
         {
-            auto const y = _sixelCursor.line + static_cast<int>(i * _aspectRatio);
-            auto const pos = CellLocation { y, x };
-            auto const pin = 1 << i;
-            auto const pinned = (sixel & pin) != 0;
-            if (pinned)
-                write(pos, currentColor());
+            auto const row = top + i * _aspectRatio + k;
+            if (row >= height)
+                return;
+            fillPixels(_buffer.data() + (static_cast<size_t>(row) * width + x) * 4, count, pixel);
         }
-        _sixelCursor.column++;
     }
 }
 
+void SixelImageBuilder::extendSize(unsigned columnEnd, int8_t sixels) noexcept
+{
+    if (_explicitSize || !sixels)
+        return;
+
+    auto const topmostPinned = static_cast<unsigned int>(std::bit_width(static_cast<unsigned>(sixels))) - 1;
+    auto const rowEnd =
+        min(unbox<unsigned int>(_sixelCursor.line) + (topmostPinned + 1) * _aspectRatio, bufferHeight());
+
+    _size.height = Height(max(unbox<unsigned int>(_size.height), rowEnd));
+    _size.width = Width(max(unbox<unsigned int>(_size.width), columnEnd));
+}
+
+void SixelImageBuilder::render(int8_t sixel)
+{
+    renderRepeated(sixel, 1);
+}
+
+void SixelImageBuilder::renderRepeated(int8_t sixel, unsigned count)
+{
+    // TODO: respect aspect ratio!
+    auto const x = unbox<unsigned int>(_sixelCursor.column);
+    if (x >= bufferWidth())
+        return;
+
+    count = min(count, bufferWidth() - x);
+    if (sixel)
+    {
+        auto const pixel = beginBand();
+        paint(x, count, sixel, pixel);
+        extendSize(x + count, sixel);
+    }
+    _sixelCursor.column += ColumnOffset::cast_from(count);
+}
+
+void SixelImageBuilder::renderSixels(std::string_view sixels)
+{
+    auto const x = unbox<unsigned int>(_sixelCursor.column);
+    if (x >= bufferWidth())
+        return;
+
+    auto const count = min(static_cast<unsigned int>(sixels.size()), bufferWidth() - x);
+    auto const pixel = beginBand();
+
+    auto pinned = int8_t { 0 };
+    auto columnEnd = 0u;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        auto const sixel = static_cast<int8_t>(sixels[i] - '?');
+        if (!sixel)
+            continue;
+
+        paint(x + i, 1, sixel, pixel);
+        pinned |= sixel;
+        columnEnd = x + i + 1;
+    }
+
+    extendSize(columnEnd, pinned);
+    _sixelCursor.column += ColumnOffset::cast_from(count);
+}
+
 void SixelImageBuilder::finalize()
 {
     if (unbox(_size.height) == 1)
-    {
         _size.height = Height::cast_from(_sixelCursor.line.as<unsigned int>() * _aspectRatio);
-        _buffer.resize(_size.area() * 4);
+    else if (_explicitSize)
         return;
-    }
-    if (!_explicitSize)
+
+    if (_explicitSize)
     {
-        Buffer tempBuffer(static_cast<size_t>(_size.height.value * _size.width.value) * 4);
-        for (auto i = 0u; i < unbox(_size.height); ++i)
-        {
-            for (auto j = 0u; j < unbox(_size.width); ++j)
-            {
-                std::copy_n(_buffer.begin() + i * unbox<long>(_maxSize.width) * 4,
-                            _size.width.value * 4,
-                            tempBuffer.begin() + i * unbox<long>(_size.width) * 4);
-            }
-        }
-        _buffer.swap(tempBuffer);
-        _explicitSize = false;
+        reserveRows(unbox<unsigned int>(_size.height));
+        _buffer.resize(_size.area() * 4);
+        return;
     }
+
+    // Compacts the rows from the maximum image width down to the actual image width.
+    auto const width = unbox<size_t>(_size.width);
+    auto const height = unbox<size_t>(_size.height);
+    auto const rowSize = static_cast<size_t>(bufferWidth()) * 4;
+    auto const paintedRows = rowSize ? min(height, _buffer.size() / rowSize) : 0;
+
+    Buffer tempBuffer(width * height * 4);
+    for (size_t row = 0; row < paintedRows; ++row)
+        std::copy_n(_buffer.begin() + static_cast<long>(row * rowSize),
+                    width * 4,
+                    tempBuffer.begin() + static_cast<long>(row * width * 4));
+    fillPixels(tempBuffer.data() + paintedRows * width * 4,
+               (height - paintedRows) * width,
+               toPixel(_backgroundColor));
+    _buffer.swap(tempBuffer);
 }
 
 } // namespace vtbackend
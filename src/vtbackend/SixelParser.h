@@ -6,8 +6,8 @@
 
 #include <vtparser/ParserExtension.h>
 
-#include <crispy/range.h>
-
+#include <array>
+#include <functional>
 #include <memory>
 #include <optional>
 #include <string_view>
@@ -65,6 +65,21 @@ class SixelParser: public ParserExtension
         /// renders a given sixel at the current sixel-cursor position.
         virtual void render(int8_t sixel) = 0;
 
+        /// renders a given sixel @p count times, starting at the current sixel-cursor position.
+        virtual void renderRepeated(int8_t sixel, unsigned count)
+        {
+            for (unsigned i = 0; i < count; ++i)
+                render(sixel);
+        }
+
+        /// renders the given sixel data characters ('?' to '~') one after another,
+        /// starting at the current sixel-cursor position.
+        virtual void renderSixels(std::string_view sixels)
+        {
+            for (auto const ch: sixels)
+                render(static_cast<int8_t>(ch - '?'));
+        }
+
         /// Finalizes the image by optimizing the underlying storage to its minimal dimension in storage.
         virtual void finalize() = 0;
     };
@@ -74,11 +89,10 @@ class SixelParser: public ParserExtension
 
     using iterator = char const*;
 
-    void parseFragment(iterator begin, iterator end)
-    {
-        for (auto const ch: crispy::range(begin, end))
-            parse(ch);
-    }
+    /// Parses the given chunk of the sixel stream.
+    ///
+    /// Runs of sixel data characters are passed on in bulk rather than one sixel at a time.
+    void parseFragment(iterator begin, iterator end);
 
     void parseFragment(std::string_view range) { parseFragment(range.data(), range.data() + range.size()); }
 
@@ -94,6 +108,7 @@ class SixelParser: public ParserExtension
 
     // ParserExtension overrides
     void pass(char ch) override;
+    void pass(std::string_view chars) override;
     void finalize() override;
 
   private:
@@ -164,18 +179,47 @@ class SixelImageBuilder: public SixelParser::Events
     void newline() override;
     void setRaster(unsigned int pan, unsigned int pad, std::optional<ImageSize> imageSize) override;
     void render(int8_t sixel) override;
+    void renderRepeated(int8_t sixel, unsigned count) override;
+    void renderSixels(std::string_view sixels) override;
     void finalize() override;
 
     [[nodiscard]] CellLocation const& sixelCursor() const noexcept { return _sixelCursor; }
 
   private:
-    void write(CellLocation const& coord, RGBColor const& value) noexcept;
+    using Pixel = std::array<uint8_t, 4>;
+
+    /// Width of the image in the buffer, i.e. the number of pixels per buffer row.
+    [[nodiscard]] unsigned bufferWidth() const noexcept
+    {
+        return unbox(_explicitSize ? _size.width : _maxSize.width);
+    }
+
+    /// Height limit of the image in the buffer.
+    [[nodiscard]] unsigned bufferHeight() const noexcept
+    {
+        return unbox(_explicitSize ? _size.height : _maxSize.height);
+    }
+
+    /// Prepares painting the current sixel band in the current color.
+    ///
+    /// @returns the color to paint with.
+    Pixel beginBand();
+
+    /// Paints the given sixel into @p count columns of the current sixel band, starting at column @p x.
+    void paint(unsigned x, unsigned count, int8_t sixel, Pixel const& pixel) noexcept;
+
+    /// Extends the image size (unless explicitly set) to include the given painted area.
+    void extendSize(unsigned columnEnd, int8_t sixels) noexcept;
+
+    /// Ensures the buffer contains at least the given number of rows, growing it geometrically.
+    void reserveRows(unsigned rowCount);
 
   private:
     ImageSize const _maxSize;
     std::shared_ptr<SixelColorPalette> _colors;
     ImageSize _size;
-    Buffer _buffer; /// RGBA buffer
+    Buffer _buffer; /// RGBA buffer, allocated (and filled with the background color) as rows are painted.
+    RGBAColor _backgroundColor;
     CellLocation _sixelCursor {};
     unsigned _currentColor = 0;
     bool _explicitSize = false;
@@ -367,3 +367,35 @@ TEST_CASE("SixelParser.vertical_cursor_advance", "[sixel]")
     REQUIRE(ib.size() == vtbackend::ImageSize { Width(1), Height(24) });
     REQUIRE(ib.sixelCursor() == CellLocation { LineOffset(24), ColumnOffset { 0 } });
 }
+
+TEST_CASE("SixelParser.bulk_implicit_size", "[sixel]")
+{
+    auto constexpr DefaultColor = RGBAColor { 0, 0, 0, 0xFF };
+    auto constexpr PinColor = RGBColor { 0x10, 0x20, 0x30 };
+    SixelImageBuilder ib(
+        { Width(64), Height(64) }, 1, 1, DefaultColor, std::make_shared<SixelColorPalette>(16, 256));
+    auto sp = SixelParser { ib };
+
+    ib.setColor(0, PinColor);
+
+    // A run of sixels, a repeat, and a second band that is only partially painted.
+    sp.parseFragment("~~~!5~-??~");
+    sp.done();
+
+    REQUIRE(ib.size() == vtbackend::ImageSize { Width(8), Height(12) });
+    REQUIRE(ib.data().size() == 8 * 12 * 4);
+
+    for (int x = 0; x < 8; ++x)
+    {
+        for (int y = 0; y < 12; ++y)
+        {
+            auto const& actualColor = ib.at(CellLocation { LineOffset(y), ColumnOffset(x) });
+            auto const pinned = y < 6 || x == 2;
+            INFO(fmt::format("x={}, y={}, {}", x, y, pinned ? "pinned" : ""));
+            if (pinned)
+                CHECK(actualColor.rgb() == PinColor);
+            else
+                CHECK(actualColor == DefaultColor);
+        }
+    }
+}
@@ -15,15 +15,8 @@
 #include <range/v3/view/join.hpp>
 #include <range/v3/view/transform.hpp>
 
-#include <cstdio>
-
 using namespace std::string_view_literals;
 
-#if defined(_WIN32)
-    #define popen  _popen
-    #define pclose _pclose
-#endif
-
 namespace vtbackend
 {
 
@@ -370,34 +363,31 @@ struct VTSerializer
 
     std::string visit(StatusLineDefinitions::SearchPrompt const&)
     {
-        if (vt.inputHandler().isEditingSearch())
-            return fmt::format("Search: {}█",
-                               unicode::convert_to<char>(std::u32string_view(vt.search().pattern)));
+        if (!vt.inputHandler().isEditingSearch())
+            return {};
 
-        return {};
+        auto const pattern = unicode::convert_to<char>(std::u32string_view(vt.search().pattern));
+        auto const prompt = [&]() -> std::string_view {
+            switch (vt.search().mode)
+            {
+                case SearchMode::Literal: return "Search";
+                case SearchMode::Regex: return "Search (regex)";
+                case SearchMode::Words: return "Search (words)";
+            }
+            crispy::unreachable();
+        }();
+        if (auto const count = vt.searchMatchCount())
+            return fmt::format("{}: {}█ ({}{} matches)",
+                               prompt,
+                               pattern,
+                               *count,
+                               *count >= Terminal::MaxSearchMatchCount ? "+" : "");
+        return fmt::format("{}: {}█", prompt, pattern);
     }
 
     std::string visit(StatusLineDefinitions::Command const& item)
     {
-        crispy::ignore_unused(this);
-
-        std::string result;
-        if (FILE* fp = popen(item.command.c_str(), "r"); fp)
-        {
-            char buffer[256] {};
-            while (fgets(buffer, sizeof(buffer), fp) != nullptr)
-            {
-                result += buffer;
-            }
-            pclose(fp);
-
-            // Only keep first line
-            if (auto const pos = result.find('\n'); pos != std::string::npos)
-                result.erase(pos);
-        }
-        else
-            result = std::strerror(errno);
-        return result;
+        return vt.statusLineCommandOutput(item.command);
     }
 
     std::string visit(StatusLineDefinitions::Text const& item)
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/StatusLineCommandRunner.h>
+#include <vtbackend/logging.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if !defined(_WIN32)
+    #include <sys/wait.h>
+
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <signal.h>
+    #include <spawn.h>
+    #include <unistd.h>
+
+extern char** environ; // NOLINT(readability-redundant-declaration)
+#endif
+
+using std::nullopt;
+using std::optional;
+using std::scoped_lock;
+using std::string;
+using std::unique_lock;
+using std::chrono::milliseconds;
+
+namespace vtbackend
+{
+
+namespace
+{
+    // Only the first line is shown, so there is no point in keeping more of a program's output.
+    constexpr size_t MaxOutputSize = 4096;
+
+#if !defined(_WIN32)
+    // Interval in which a running program is checked for being interrupted.
+    constexpr auto PollInterval = milliseconds(100);
+#endif
+} // namespace
+
+StatusLineCommandRunner::StatusLineCommandRunner(milliseconds refreshInterval,
+                                                 milliseconds timeout,
+                                                 OutputChanged outputChanged):
+    _refreshInterval { refreshInterval }, _timeout { timeout }, _outputChanged { std::move(outputChanged) }
+{
+}
+
+StatusLineCommandRunner::~StatusLineCommandRunner()
+{
+    {
+        auto const _ = scoped_lock { _mutex };
+        _stopping = true;
+    }
+    _commandQueued.notify_all();
+
+    if (_worker.joinable())
+        _worker.join();
+}
+
+string StatusLineCommandRunner::output(string const& command, Clock::time_point now)
+{
+    auto const _ = scoped_lock { _mutex };
+
+    auto& entry = _entries[command];
+    if (!entry.queued && (!entry.lastScheduled || now - *entry.lastScheduled >= _refreshInterval))
+    {
+        entry.queued = true;
+        entry.lastScheduled = now;
+        _queue.emplace_back(command);
+
+        if (!_worker.joinable())
+            _worker = std::thread([this]() { work(); });
+        _commandQueued.notify_one();
+    }
+
+    return entry.output;
+}
+
+void StatusLineCommandRunner::work()
+{
+    auto lock = unique_lock { _mutex };
+    while (true)
+    {
+        _commandQueued.wait(lock, [this]() { return _stopping || !_queue.empty(); });
+        if (_stopping)
+            return;
+
+        auto const command = std::move(_queue.front());
+        _queue.pop_front();
+
+        lock.unlock();
+        auto result = run(command, _timeout, &_stopping);
+        if (!result && !_stopping)
+            terminalLog()("Status line command timed out after {}ms: {}", _timeout.count(), command);
+        lock.lock();
+
+        auto& entry = _entries[command];
+        entry.queued = false;
+        if (!result || *result == entry.output)
+            continue;
+
+        entry.output = std::move(*result);
+        lock.unlock();
+        _outputChanged();
+        lock.lock();
+    }
+}
+
+#if defined(_WIN32)
+optional<string> StatusLineCommandRunner::run(string const& command,
+                                              milliseconds /*timeout*/,
+                                              std::atomic<bool> const* /*interrupted*/)
+{
+    auto output = string {};
+    FILE* fp = _popen(command.c_str(), "r");
+    if (!fp)
+        return std::strerror(errno);
+
+    char buffer[256] {};
+    while (fgets(buffer, sizeof(buffer), fp) != nullptr)
+        if (output.size() < MaxOutputSize)
+            output += buffer;
+    _pclose(fp);
+
+    if (auto const pos = output.find('\n'); pos != string::npos)
+        output.erase(pos);
+    return output;
+}
+#else
+optional<string> StatusLineCommandRunner::run(string const& command,
+                                              milliseconds timeout,
+                                              std::atomic<bool> const* interrupted)
+{
+    // The pipe is created close-on-exec atomically, so that processes spawned concurrently
+    // (such as the shell of another terminal) do not inherit it.
+    int fds[2] {};
+#if defined(__APPLE__)
+    // macOS has no pipe2().
+    if (::pipe(fds) != 0)
+        return std::strerror(errno);
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+#else
+    if (::pipe2(fds, O_CLOEXEC) != 0)
+        return std::strerror(errno);
+#endif
+
+    posix_spawn_file_actions_t actions {};
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+
+    // The program is run in a process group of its own, so that its children are killed along with it.
+    posix_spawnattr_t attributes {};
+    posix_spawnattr_init(&attributes);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+    posix_spawnattr_setpgroup(&attributes, 0);
+
+    char const* argv[] = { "/bin/sh", "-c", command.c_str(), nullptr };
+    pid_t pid = -1;
+    auto const error =
+        posix_spawn(&pid, argv[0], &actions, &attributes, const_cast<char* const*>(argv), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    ::close(fds[1]);
+
+    if (error != 0)
+    {
+        ::close(fds[0]);
+        return std::strerror(error);
+    }
+
+    auto output = string {};
+    auto finished = false;
+    auto const deadline = Clock::now() + timeout;
+    while (!interrupted || !*interrupted)
+    {
+        auto const remaining = std::chrono::duration_cast<milliseconds>(deadline - Clock::now());
+        if (remaining.count() <= 0)
+            break;
+
+        auto pfd = pollfd { fds[0], POLLIN, 0 };
+        auto const rv = ::poll(&pfd, 1, static_cast<int>(std::min(remaining, PollInterval).count()));
+        if (rv < 0 && errno != EINTR)
+            break;
+        if (rv <= 0)
+            continue;
+
+        char buffer[256] {};
+        auto const n = ::read(fds[0], buffer, sizeof(buffer));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            finished = true;
+            break;
+        }
+        if (output.size() < MaxOutputSize)
+            output.append(buffer, static_cast<size_t>(n));
+    }
+    ::close(fds[0]);
+
+    if (!finished)
+        ::kill(-pid, SIGKILL);
+    while (::waitpid(pid, nullptr, 0) < 0 && errno == EINTR)
+        ;
+
+    if (!finished)
+        return nullopt;
+
+    if (auto const pos = output.find('\n'); pos != string::npos)
+        output.erase(pos);
+    return output;
+}
+#endif
+
+} // namespace vtbackend
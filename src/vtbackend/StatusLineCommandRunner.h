@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace vtbackend
+{
+
+/// Runs the programs of the status line's Command segments in the background.
+///
+/// The status line is serialized on the terminal thread, several times per update,
+/// and must therefore not wait for any program. It rather renders the most recent output
+/// of each program, while the program is being run again on a worker thread once its
+/// output is older than the refresh interval.
+///
+/// Programs are run one at a time, and are killed when running longer than the timeout
+/// (except on Windows, where they are always waited for).
+class StatusLineCommandRunner
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Invoked on the worker thread whenever the output of a program has changed.
+    using OutputChanged = std::function<void()>;
+
+    StatusLineCommandRunner(std::chrono::milliseconds refreshInterval,
+                            std::chrono::milliseconds timeout,
+                            OutputChanged outputChanged);
+    ~StatusLineCommandRunner();
+
+    StatusLineCommandRunner(StatusLineCommandRunner const&) = delete;
+    StatusLineCommandRunner(StatusLineCommandRunner&&) = delete;
+    StatusLineCommandRunner& operator=(StatusLineCommandRunner const&) = delete;
+    StatusLineCommandRunner& operator=(StatusLineCommandRunner&&) = delete;
+
+    /// @returns the first line of the most recent output of the given program,
+    ///          which is empty until the program has been run for the first time.
+    ///
+    /// The program is scheduled to be run (again), if it has not been run since
+    /// the refresh interval before @p now.
+    [[nodiscard]] std::string output(std::string const& command, Clock::time_point now);
+
+    /// Runs the given program synchronously.
+    ///
+    /// @returns the first line of the program's output, or std::nullopt if the program
+    ///          has not finished within the timeout or before @p interrupted has been set.
+    [[nodiscard]] static std::optional<std::string> run(std::string const& command,
+                                                        std::chrono::milliseconds timeout,
+                                                        std::atomic<bool> const* interrupted = nullptr);
+
+  private:
+    struct Entry
+    {
+        std::string output;
+        std::optional<Clock::time_point> lastScheduled;
+        bool queued = false;
+    };
+
+    void work();
+
+    std::chrono::milliseconds _refreshInterval;
+    std::chrono::milliseconds _timeout;
+    OutputChanged _outputChanged;
+
+    std::mutex _mutex;
+    std::condition_variable _commandQueued;
+    std::unordered_map<std::string, Entry> _entries;
+    std::deque<std::string> _queue;
+    std::atomic<bool> _stopping = false;
+    std::thread _worker; // Started once the first program is to be run.
+};
+
+} // namespace vtbackend
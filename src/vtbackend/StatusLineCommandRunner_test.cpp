@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/StatusLineCommandRunner.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+using namespace std::chrono_literals;
+using vtbackend::StatusLineCommandRunner;
+
+#if !defined(_WIN32)
+
+TEST_CASE("StatusLineCommandRunner.run", "[StatusLineCommandRunner]")
+{
+    CHECK(StatusLineCommandRunner::run("echo hello; echo world", 5s) == "hello");
+    CHECK(StatusLineCommandRunner::run("true", 5s) == "");
+}
+
+TEST_CASE("StatusLineCommandRunner.run.timeout", "[StatusLineCommandRunner]")
+{
+    auto const start = StatusLineCommandRunner::Clock::now();
+    CHECK_FALSE(StatusLineCommandRunner::run("sleep 10; echo late", 100ms).has_value());
+    CHECK(StatusLineCommandRunner::Clock::now() - start < 5s);
+}
+
+TEST_CASE("StatusLineCommandRunner.output", "[StatusLineCommandRunner]")
+{
+    auto mutex = std::mutex {};
+    auto changed = std::condition_variable {};
+    auto changeCount = 0;
+
+    auto runner = StatusLineCommandRunner(1h, 5s, [&]() {
+        auto const _ = std::scoped_lock { mutex };
+        ++changeCount;
+        changed.notify_all();
+    });
+
+    auto const now = StatusLineCommandRunner::Clock::now();
+
+    // The output is not waited for.
+    CHECK(runner.output("sleep 0.1; echo hello", now).empty());
+
+    {
+        auto lock = std::unique_lock { mutex };
+        REQUIRE(changed.wait_for(lock, 5s, [&]() { return changeCount == 1; }));
+    }
+    CHECK(runner.output("sleep 0.1; echo hello", now) == "hello");
+}
+
+#endif
@@ -25,8 +25,10 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstdlib>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <utility>
@@ -152,14 +154,15 @@ Terminal::Terminal(Events& eventListener,
     _effectiveImageCanvasSize { _settings.maxImageSize },
     _sixelColorPalette { std::make_shared<SixelColorPalette>(_maxSixelColorRegisters,
                                                              _maxSixelColorRegisters) },
-    _imagePool { [this](Image const* image) {
-        discardImage(*image);
-    } },
+    _imagePool { [this](Image const* image) { discardImage(*image); }, ImageId(1), _settings.imageCacheSize },
     _hyperlinks { HyperlinkCache { 1024 } },
     _sequenceBuilder { ModeDependantSequenceHandler { *this }, TerminalInstructionCounter { *this } },
     _parser { std::ref(_sequenceBuilder) },
     _viCommands { *this },
-    _inputHandler { _viCommands, ViMode::Insert }
+    _inputHandler { _viCommands, ViMode::Insert },
+    _statusLineCommands { _settings.indicatorStatusLine.commandRefreshInterval,
+                          _settings.indicatorStatusLine.commandTimeout,
+                          [this]() { breakLoopAndRefreshRenderBuffer(); } }
 {
     _savedColorPalettes.reserve(MaxColorPaletteSaveStackSize);
 
@@ -173,6 +176,28 @@ Terminal::Terminal(Events& eventListener,
 
     for (auto const& [mode, frozen]: _settings.frozenModes)
         freezeMode(mode, frozen);
+
+    setHotHistoryPageCount(_settings.hotHistoryPageCount);
+    _primaryScreen.grid().setReflowReadyCallback([this]() { breakLoopAndRefreshRenderBuffer(); });
+    auto const searchIndexIdle = [this]() {
+        if (_searchMatchCountPending.exchange(false))
+            breakLoopAndRefreshRenderBuffer();
+    };
+    _primaryScreen.grid().setSearchIndexIdleCallback(searchIndexIdle);
+    _alternateScreen.grid().setSearchIndexIdleCallback(searchIndexIdle);
+    _pty->setWriteDrainedCallback([this]() {
+        streamPaste();
+        if (!isPasting() && hasInput())
+            _eventListener.requestFlushInput();
+    });
+
+    if (_settings.pipelinedPtyInput)
+        _ptyInputPipeline =
+            std::make_unique<vtpty::PtyInputPipeline>(*_pty,
+                                                      _ptyBufferPool,
+                                                      _ptyReadBufferSize,
+                                                      unbox<size_t>(_settings.pageSize.columns),
+                                                      _settings.ptyInputQueueCapacity);
 }
 
 void Terminal::onViewportChanged()
@@ -195,17 +220,31 @@ void Terminal::setLastMarkRangeOffset(LineOffset value) noexcept
     _settings.copyLastMarkRangeOffset = value;
 }
 
-std::optional<vtpty::Pty::ReadResult> Terminal::readFromPty()
+std::optional<vtpty::Pty::ReadResult> Terminal::readFromPty(bool waitForInput)
 {
     auto const timeout =
 #if defined(LIBTERMINAL_PASSIVE_RENDER_BUFFER_UPDATE)
-        (_renderBuffer.state == RenderBufferState::WaitingForRefresh && !_screenDirty)
+        (waitForInput && _renderBuffer.state == RenderBufferState::WaitingForRefresh && !_screenDirty)
             ? std::optional { _refreshInterval.value }
             : std::chrono::milliseconds(0);
 #else
-        std::optional<std::chrono::milliseconds> { std::nullopt };
+        waitForInput ? std::optional<std::chrono::milliseconds> { std::nullopt }
+                     : std::optional { std::chrono::milliseconds(0) };
 #endif
 
+    if (_ptyInputPipeline)
+    {
+        auto chunk = _ptyInputPipeline->pop(timeout);
+        if (!chunk)
+        {
+            errno = EAGAIN;
+            return std::nullopt;
+        }
+        _pipelinedPtyBuffer = std::move(chunk->buffer);
+        return vtpty::Pty::ReadResult { .data = chunk->data,
+                                        .fromStdoutFastPipe = chunk->fromStdoutFastPipe };
+    }
+
     // Request a new Buffer Object if the current one cannot sufficiently
     // store a single text line.
     if (_currentPtyBuffer->bytesAvailable() < unbox<size_t>(_settings.pageSize.columns))
@@ -219,15 +258,39 @@ std::optional<vtpty::Pty::ReadResult> Terminal::readFromPty()
     return _pty->read(*_currentPtyBuffer, timeout, _ptyReadBufferSize);
 }
 
+bool Terminal::readPtyInputOnce()
+{
+    assert(_ptyInputPipeline);
+    return _ptyInputPipeline->readOnce();
+}
+
+void Terminal::wakeupInputProcessing()
+{
+    if (_ptyInputPipeline)
+        _ptyInputPipeline->wakeupConsumer();
+    else
+        _pty->wakeupReader();
+}
+
 void Terminal::setExecutionMode(ExecutionMode mode)
 {
     auto _ = std::unique_lock(_breakMutex);
     _executionMode = mode;
     _breakCondition.notify_one();
-    _pty->wakeupReader();
+    wakeupInputProcessing();
 }
 
 bool Terminal::processInputOnce()
+{
+    return processInput(true);
+}
+
+bool Terminal::processReadyInput()
+{
+    return processInput(false);
+}
+
+bool Terminal::processInput(bool waitForInput)
 {
     // clang-format off
     switch (_executionMode.load())
@@ -261,7 +324,7 @@ bool Terminal::processInputOnce()
     }
     // clang-format on
 
-    auto const readResult = readFromPty();
+    auto const readResult = readFromPty(waitForInput);
 
     if (!readResult)
     {
@@ -282,10 +345,22 @@ bool Terminal::processInputOnce()
         return false;
     }
 
+    if (_pipelinedPtyBuffer)
+    {
+        // The grid may reference the parsed text in place, so the buffer object the PTY reader
+        // thread has read it into must be the current one while parsing. Our own buffer object is
+        // restored afterwards, as the reader thread keeps on writing into the pipelined one.
+        auto const _ = std::lock_guard { *this };
+        auto localPtyBuffer = std::exchange(_currentPtyBuffer, std::move(_pipelinedPtyBuffer));
+        _parser.parseFragment(buf);
+        _currentPtyBuffer = std::move(localPtyBuffer);
+    }
+    else
     {
         auto const _ = std::lock_guard { *this };
         _parser.parseFragment(buf);
     }
+    _processedInputBytes.fetch_add(buf.size(), std::memory_order_release);
 
     if (!_modes.enabled(DECMode::BatchedRendering))
         screenUpdated();
@@ -307,7 +382,7 @@ void Terminal::breakLoopAndRefreshRenderBuffer()
     // if (this_thread::get_id() == _mainLoopThreadID)
     //     return;
 
-    _pty->wakeupReader();
+    wakeupInputProcessing();
 }
 
 bool Terminal::refreshRenderBuffer(bool locked)
@@ -431,10 +506,61 @@ void Terminal::fillRenderBuffer(RenderBuffer& output, bool includeSelection)
     fillRenderBufferInternal(output, includeSelection);
 }
 
+RenderBufferContext Terminal::makeRenderBufferContext(LineOffset mainPageBaseLine,
+                                                      bool includeSelection) const
+{
+    auto context = RenderBufferContext {};
+    context.pageSize = pageSize();
+    context.mainPageBaseLine = mainPageBaseLine;
+    context.primaryScreen = isPrimaryScreen();
+    context.reverseVideo = isModeEnabled(DECMode::ReverseVideo);
+    context.hoveringHyperlink = _hoveringHyperlinkId.load();
+    context.colorPaletteGeneration = _colorPaletteGeneration;
+    context.overlays = (includeSelection && _selection) || _highlightRange.has_value()
+                       || !_search.pattern.empty() || !_inputMethodData.preeditString.empty();
+    return context;
+}
+
+void Terminal::updateLineChangeFrameIDs()
+{
+    _lineChangeFrameIDs.resize(unbox<size_t>(pageSize().lines), 0);
+
+    auto const frameID = _lastFrameID.load();
+    auto const markChanged = [&](LineOffset line) {
+        _lineChangeFrameIDs[unbox<size_t>(line)] = frameID;
+    };
+
+    if (isPrimaryScreen())
+        _primaryScreen.grid().collectDamagedLines(_viewport.scrollOffset(), markChanged);
+    else
+        _alternateScreen.grid().collectDamagedLines(_viewport.scrollOffset(), markChanged);
+}
+
 void Terminal::fillRenderBufferInternal(RenderBuffer& output, bool includeSelection)
 {
     verifyState();
 
+    // Older history lines reflowed in the background since are prepended to the history.
+    _primaryScreen.grid().tryCompleteReflow();
+
+    // Lines scrolled into the history since are handed over to the search index (once searched),
+    // a limited number per frame. Searching catches up with the remaining ones.
+    auto constexpr SearchIndexLinesPerFrame = size_t { 4096 };
+    _primaryScreen.grid().updateSearchIndex(SearchIndexLinesPerFrame);
+    updateSearchMatchCount();
+
+    // Displayed and selected history lines are not to be compressed.
+    auto retainedTop = -boxed_cast<LineOffset>(_viewport.scrollOffset());
+    auto retainedBottom = retainedTop + boxed_cast<LineOffset>(pageSize().lines) - 1;
+    if (_selection)
+    {
+        retainedTop = std::min({ retainedTop, _selection->from().line, _selection->to().line });
+        retainedBottom = std::max({ retainedBottom, _selection->from().line, _selection->to().line });
+    }
+    _primaryScreen.grid().retainHistoryLines(retainedTop, retainedBottom);
+
+    // Keep the previous contents of this buffer, to take over the lines that have not changed since.
+    std::swap(output, _previousRenderBuffer);
     output.clear();
 
     _changes.store(0);
@@ -451,6 +577,15 @@ void Terminal::fillRenderBufferInternal(RenderBuffer& output, bool includeSelect
     if (_settings.statusDisplayPosition == StatusDisplayPosition::Top)
         baseLine += fillRenderBufferStatusLine(output, includeSelection, baseLine).as<LineOffset>();
 
+    updateLineChangeFrameIDs();
+    output.context = makeRenderBufferContext(baseLine, includeSelection);
+    output.blinkState = blinkState();
+    output.rapidBlinkState = rapidBlinkState();
+    output.pageTopLine = _scrolledLineCount - unbox<int64_t>(_viewport.scrollOffset());
+    auto const previousFrame = _previousRenderBuffer.context == output.context && !output.context.overlays
+                                   ? PreviousRenderFrame { &_previousRenderBuffer, _lineChangeFrameIDs }
+                                   : PreviousRenderFrame {};
+
     auto const hoveringHyperlinkGuard = ScopedHyperlinkHover { *this, *_currentScreen };
     auto const mainDisplayReverseVideo = isModeEnabled(vtbackend::DECMode::ReverseVideo);
     auto const highlightSearchMatches =
@@ -475,7 +610,8 @@ void Terminal::fillRenderBufferInternal(RenderBuffer& output, bool includeSelect
                                                                            HighlightSearchMatches::Yes,
                                                                            _inputMethodData,
                                                                            theCursorPosition,
-                                                                           includeSelection },
+                                                                           includeSelection,
+                                                                           previousFrame },
                                   _viewport.scrollOffset(),
                                   highlightSearchMatches);
     else
@@ -487,10 +623,15 @@ void Terminal::fillRenderBufferInternal(RenderBuffer& output, bool includeSelect
                                                                                HighlightSearchMatches::Yes,
                                                                                _inputMethodData,
                                                                                theCursorPosition,
-                                                                               includeSelection },
+                                                                               includeSelection,
+                                                                               previousFrame },
                                     _viewport.scrollOffset(),
                                     highlightSearchMatches);
 
+    // Lines taken over from the previous frame have not been visited by the render pass.
+    _lastRenderPassHints.containsBlinkingCells =
+        _lastRenderPassHints.containsBlinkingCells || output.containsBlinkingCells();
+
     if (_settings.statusDisplayPosition == StatusDisplayPosition::Bottom)
     {
         baseLine += pageSize().lines.as<LineOffset>();
@@ -542,17 +683,17 @@ void Terminal::updateIndicatorStatusLine()
     auto const colors = [&]() {
         if (!_focused)
         {
-            return colorPalette().indicatorStatusLineInactive;
+            return _colorPalette.indicatorStatusLineInactive;
         }
         else
         {
             switch (_inputHandler.mode())
             {
-                case ViMode::Insert: return colorPalette().indicatorStatusLineInsertMode;
-                case ViMode::Normal: return colorPalette().indicatorStatusLineNormalMode;
+                case ViMode::Insert: return _colorPalette.indicatorStatusLineInsertMode;
+                case ViMode::Normal: return _colorPalette.indicatorStatusLineNormalMode;
                 case ViMode::Visual:
                 case ViMode::VisualLine:
-                case ViMode::VisualBlock: return colorPalette().indicatorStatusLineVisualMode;
+                case ViMode::VisualBlock: return _colorPalette.indicatorStatusLineVisualMode;
             }
         }
         crispy::unreachable();
@@ -978,8 +1119,79 @@ void Terminal::sendPaste(string_view text)
         return;
     }
 
-    _inputGenerator.generatePaste(text);
+    if (text.size() <= PasteChunkSize && !isPasting())
+    {
+        _inputGenerator.generatePaste(text);
+        flushInput();
+        return;
+    }
+
+    if (text.empty())
+        return;
+
+    // Large pastes are written in chunks, so that the PTY's write queue does not grow unbounded
+    // and the paste can still be cancelled.
+    inputLog()("Streaming paste of {} bytes.", text.size());
     flushInput();
+    {
+        auto const _ = std::scoped_lock { _pasteMutex };
+        _pendingPastes.emplace_back(
+            PendingPaste { .text = std::string(text), .bracketed = _inputGenerator.bracketedPaste() });
+    }
+    streamPaste();
+}
+
+bool Terminal::isPasting() const
+{
+    auto const _ = std::scoped_lock { _pasteMutex };
+    return !_pendingPastes.empty();
+}
+
+void Terminal::cancelPaste()
+{
+    auto const _ = std::scoped_lock { _pasteMutex };
+    if (_pendingPastes.empty())
+        return;
+
+    auto const& paste = _pendingPastes.front();
+    inputLog()("Cancelling paste after {} of {} bytes.", paste.offset, paste.text.size());
+
+    // Terminate the bracketed paste that has been started already.
+    if (paste.bracketed && paste.offset != 0)
+        (void) _pty->write("\033[201~"sv);
+
+    _pendingPastes.clear();
+}
+
+void Terminal::streamPaste()
+{
+    auto const _ = std::scoped_lock { _pasteMutex };
+    while (!_pendingPastes.empty() && _pty->pendingWriteBytes() < PasteChunkSize)
+    {
+        auto& paste = _pendingPastes.front();
+        auto chunk = std::string {};
+        if (paste.bracketed && paste.offset == 0)
+            chunk += "\033[200~"sv;
+        auto const count = std::min(PasteChunkSize, paste.text.size() - paste.offset);
+        chunk += std::string_view(paste.text).substr(paste.offset, count);
+        paste.offset += count;
+        auto const done = paste.offset == paste.text.size();
+        if (paste.bracketed && done)
+            chunk += "\033[201~"sv;
+
+        // Only pastes are written while pasting, and the PTY's write queue is short here,
+        // so the chunk is accepted as a whole.
+        if (_pty->write(chunk) < 0)
+        {
+            errorLog()("Discarding paste. Writing to the PTY failed. {}", strerror(errno));
+            _pendingPastes.clear();
+            return;
+        }
+
+        _eventListener.pasteProgress(paste.offset, paste.text.size());
+        if (done)
+            _pendingPastes.pop_front();
+    }
 }
 
 void Terminal::sendRawInput(string_view text)
@@ -1010,6 +1222,11 @@ void Terminal::flushInput()
     if (_inputGenerator.peek().empty())
         return;
 
+    // Input is held back while a paste is being streamed, so that it does not end up in the middle
+    // of the paste. It is flushed upon Events::requestFlushInput() once the paste has been sent.
+    if (isPasting())
+        return;
+
     // XXX Should be the only location that does write to the PTY's stdin to avoid race conditions.
     auto const input = _inputGenerator.peek();
     auto const rv = _pty->write(input);
@@ -1294,20 +1511,21 @@ void Terminal::setExtendedWordDelimiters(string const& wordDelimiters)
 
 namespace
 {
-    template <CellConcept Cell>
     struct SelectionRenderer
     {
         gsl::not_null<Terminal const*> term;
         ColumnOffset rightPage {};
         ColumnOffset lastColumn {};
+        bool started = false;
         string text {};
         string currentLine {};
 
         SelectionRenderer(Terminal const& term, ColumnOffset rightPage): term(&term), rightPage(rightPage) {}
 
+        template <CellConcept Cell>
         void operator()(CellLocation pos, Cell const& cell)
         {
-            auto const isNewLine = pos.column < lastColumn || (pos.column == lastColumn && !text.empty());
+            auto const isNewLine = pos.column < lastColumn || (pos.column == lastColumn && started);
             bool const touchesRightPage = term->isSelected({ pos.line, rightPage });
             if (isNewLine && (!term->isLineWrapped(pos.line) || !touchesRightPage))
             {
@@ -1322,8 +1540,25 @@ namespace
             else
                 currentLine += cell.toUtf8();
             lastColumn = pos.column;
+            started = true;
         }
 
+        /// Renders the selected cells between the given lines (inclusive).
+        void render(Selection const& selection, LineOffset first, LineOffset last)
+        {
+            if (term->isPrimaryScreen())
+                renderSelection(selection, first, last, [&](CellLocation pos) {
+                    (*this)(pos, term->primaryScreen().at(pos));
+                });
+            else
+                renderSelection(selection, first, last, [&](CellLocation pos) {
+                    (*this)(pos, term->alternateScreen().at(pos));
+                });
+        }
+
+        /// Moves out the text of the lines completed so far.
+        std::string takeText() { return std::exchange(text, {}); }
+
         std::string finish()
         {
             trimSpaceRight(currentLine);
@@ -1333,6 +1568,14 @@ namespace
             return std::move(text);
         }
     };
+
+    /// Returns the top and bottom line of the given selection.
+    std::pair<LineOffset, LineOffset> selectedLines(Selection const& selection) noexcept
+    {
+        auto const from = selection.from().line;
+        auto const to = selection.to().line;
+        return { std::min(from, to), std::max(from, to) };
+    }
 } // namespace
 
 string Terminal::extractSelectionText() const
@@ -1340,17 +1583,53 @@ string Terminal::extractSelectionText() const
     if (!_selection || _selection->state() == Selection::State::Waiting)
         return "";
 
-    if (isPrimaryScreen())
-    {
-        auto se = SelectionRenderer<PrimaryScreenCell> { *this, pageSize().columns.as<ColumnOffset>() - 1 };
-        vtbackend::renderSelection(*_selection, [&](CellLocation pos) { se(pos, _primaryScreen.at(pos)); });
-        return se.finish();
-    }
-    else
+    auto renderer = SelectionRenderer { *this, pageSize().columns.as<ColumnOffset>() - 1 };
+    auto const [top, bottom] = selectedLines(*_selection);
+    renderer.render(*_selection, top, bottom);
+    return renderer.finish();
+}
+
+bool Terminal::extractSelectionText(SelectionTextSink const& sink, LineCount linesPerChunk)
+{
+    auto const chunkLineCount = std::max(linesPerChunk, LineCount(1)).as<LineOffset>();
+    auto renderer = std::optional<SelectionRenderer> {};
+    auto const* selection = static_cast<Selection const*>(nullptr);
+
+    // Number of lines from the top of the selection that have been extracted already.
+    // The selection's lines are adjusted when scrolling, so this keeps referring to the same text.
+    auto linesDone = LineOffset(0);
+
+    while (true)
     {
-        auto se = SelectionRenderer<AlternateScreenCell> { *this, pageSize().columns.as<ColumnOffset>() - 1 };
-        vtbackend::renderSelection(*_selection, [&](CellLocation pos) { se(pos, _alternateScreen.at(pos)); });
-        return se.finish();
+        auto chunk = string {};
+        auto done = false;
+        {
+            auto const _ = std::lock_guard { *this };
+            if (!_selection || _selection->state() == Selection::State::Waiting)
+                return false;
+
+            if (!renderer)
+            {
+                selection = _selection.get();
+                renderer.emplace(*this, pageSize().columns.as<ColumnOffset>() - 1);
+            }
+            else if (_selection.get() != selection)
+                return false;
+
+            auto const [top, bottom] = selectedLines(*_selection);
+            auto const first = top + linesDone;
+            auto const last = std::min(first + chunkLineCount - LineOffset(1), bottom);
+            renderer->render(*_selection, first, last);
+            linesDone += last - first + LineOffset(1);
+            done = last >= bottom;
+            chunk = done ? renderer->finish() : renderer->takeText();
+        }
+
+        if (!chunk.empty())
+            sink(chunk);
+
+        if (done)
+            return true;
     }
 }
 
@@ -1392,6 +1671,19 @@ void Terminal::requestShowHostWritableStatusLine()
     _eventListener.requestShowHostWritableStatusLine();
 }
 
+void Terminal::requestImageFile(ImageFileRequest request)
+{
+    _eventListener.requestImageFile(std::move(request));
+}
+
+void Terminal::imageFile(ImageFileRequest const& request)
+{
+    if (isPrimaryScreen())
+        _primaryScreen.imageFile(request);
+    else
+        _alternateScreen.imageFile(request);
+}
+
 void Terminal::bell()
 {
     _eventListener.bell();
@@ -2048,6 +2340,8 @@ void Terminal::synchronizedOutput(bool enabled)
 
 void Terminal::onBufferScrolled(LineCount n) noexcept
 {
+    _scrolledLineCount += unbox<int64_t>(n);
+
     // Adjust Normal-mode's cursor accordingly to make it fixed at the scroll-offset as if nothing has
     // happened.
     _viCommands.cursorPosition.line -= n;
@@ -2077,6 +2371,16 @@ LineCount Terminal::maxHistoryLineCount() const noexcept
     return _primaryScreen.grid().maxHistoryLineCount();
 }
 
+void Terminal::setHotHistoryPageCount(unsigned pageCount) noexcept
+{
+    _primaryScreen.grid().setHotHistoryPageCount(pageCount);
+}
+
+void Terminal::completeHistoryReflow()
+{
+    _primaryScreen.grid().completeReflow();
+}
+
 void Terminal::setTerminalId(VTType id) noexcept
 {
     _terminalId = id;
@@ -2154,20 +2458,86 @@ void Terminal::setAllowInput(bool enabled)
     setMode(AnsiMode::KeyboardAction, !enabled);
 }
 
-bool Terminal::setNewSearchTerm(std::u32string text, bool initiatedByDoubleClick)
+bool Terminal::setNewSearchTerm(std::u32string text, bool initiatedByDoubleClick, SearchMode mode)
 {
     _search.initiatedByDoubleClick = initiatedByDoubleClick;
 
-    if (_search.pattern == text)
+    if (_search.pattern == text && _search.mode == mode)
         return false;
 
     _search.pattern = std::move(text);
+    _search.mode = mode;
     return true;
 }
 
-optional<CellLocation> Terminal::searchReverse(u32string text, CellLocation searchPosition)
+SearchPattern const* Terminal::searchPattern() const
+{
+    if (_searchPatternTerm != _search.pattern || _searchPatternMode != _search.mode)
+    {
+        _searchPatternTerm = _search.pattern;
+        _searchPatternMode = _search.mode;
+        _searchPattern = SearchPattern::compile(_search.pattern, _search.mode);
+    }
+    return _searchPattern ? &*_searchPattern : nullptr;
+}
+
+std::vector<CellLocation> Terminal::searchAll(size_t maxMatchCount)
 {
-    if (!setNewSearchTerm(std::move(text), false))
+    auto const* pattern = searchPattern();
+    if (!pattern)
+        return {};
+
+    completeHistoryReflow();
+
+    // Literal terms are searched for as is, making use of the scrollback search index.
+    return pattern->mode() == SearchMode::Literal ? currentScreen().searchAll(pattern->term(), maxMatchCount)
+                                                  : currentScreen().searchAll(*pattern, maxMatchCount);
+}
+
+void Terminal::updateSearchMatchCount()
+{
+    // Only literal terms are counted, which are looked up in the search index,
+    // rather than matching every history line on every refresh.
+    auto const* pattern = _inputHandler.isEditingSearch() ? searchPattern() : nullptr;
+    if (!pattern || pattern->mode() != SearchMode::Literal)
+    {
+        _searchMatchCount = {};
+        return;
+    }
+
+    // Counting runs on the render path, so it must not wait for the history to be reflowed or indexed.
+    // It is retried with the refresh requested once either is done (see the constructor).
+    auto const searchIndexReady = [](auto& grid) {
+        return !grid.reflowPending() && grid.searchIndexReady();
+    };
+    _searchMatchCountPending = true;
+    auto const ready = isPrimaryScreen() ? searchIndexReady(_primaryScreen.grid())
+                                         : searchIndexReady(_alternateScreen.grid());
+    if (!ready)
+    {
+        if (_searchMatchCount.term != _search.pattern)
+            _searchMatchCount.count.reset();
+        return;
+    }
+
+    _searchMatchCountPending = false;
+
+    auto const processedInputBytes = _processedInputBytes.load(std::memory_order_acquire);
+    if (_searchMatchCount.count && _searchMatchCount.term == _search.pattern
+        && _searchMatchCount.processedInputBytes == processedInputBytes
+        && _searchMatchCount.pageSize == pageSize() && _searchMatchCount.screenType == _currentScreenType)
+        return;
+
+    _searchMatchCount.term = _search.pattern;
+    _searchMatchCount.processedInputBytes = processedInputBytes;
+    _searchMatchCount.pageSize = pageSize();
+    _searchMatchCount.screenType = _currentScreenType;
+    _searchMatchCount.count = searchAll(MaxSearchMatchCount).size();
+}
+
+optional<CellLocation> Terminal::searchReverse(u32string text, CellLocation searchPosition, SearchMode mode)
+{
+    if (!setNewSearchTerm(std::move(text), false, mode))
         return searchPosition;
 
     return searchReverse(searchPosition);
@@ -2185,8 +2555,16 @@ optional<CellLocation> Terminal::search(std::u32string text,
 
 optional<CellLocation> Terminal::search(CellLocation searchPosition)
 {
-    auto const searchText = u32string_view(_search.pattern);
-    auto const matchLocation = currentScreen().search(searchText, searchPosition);
+    auto const* pattern = searchPattern();
+    if (!pattern)
+        return nullopt;
+
+    completeHistoryReflow();
+
+    // Literal terms are searched for as is, making use of the scrollback search index.
+    auto const matchLocation = pattern->mode() == SearchMode::Literal
+                                   ? currentScreen().search(pattern->term(), searchPosition)
+                                   : currentScreen().search(*pattern, searchPosition);
 
     if (matchLocation)
         viewport().makeVisibleWithinSafeArea(matchLocation.value().line);
@@ -2264,8 +2642,15 @@ std::tuple<std::u32string, CellLocationRange> Terminal::extractWordUnderCursor(
 
 optional<CellLocation> Terminal::searchReverse(CellLocation searchPosition)
 {
-    auto const searchText = u32string_view(_search.pattern);
-    auto const matchLocation = currentScreen().searchReverse(searchText, searchPosition);
+    auto const* pattern = searchPattern();
+    if (!pattern)
+        return nullopt;
+
+    completeHistoryReflow();
+
+    auto const matchLocation = pattern->mode() == SearchMode::Literal
+                                   ? currentScreen().searchReverse(pattern->term(), searchPosition)
+                                   : currentScreen().searchReverse(*pattern, searchPosition);
 
     if (matchLocation)
         viewport().makeVisibleWithinSafeArea(matchLocation.value().line);
@@ -2345,11 +2730,13 @@ constexpr auto MagicStackTopId = size_t { 0 };
 void Terminal::setColorPalette(ColorPalette const& palette) noexcept
 {
     _colorPalette = palette;
+    ++_colorPaletteGeneration;
 }
 
 void Terminal::resetColorPalette(ColorPalette const& colors)
 {
     _colorPalette = colors;
+    ++_colorPaletteGeneration;
     _defaultColorPalette = colors;
     _settings.colorPalette = colors;
     _factorySettings.colorPalette = colors;
@@ -2452,7 +2839,7 @@ void TraceHandler::flushOne(PendingSequence const& pendingSequence)
 {
     if (auto const* seq = std::get_if<Sequence>(&pendingSequence))
     {
-        if (auto const* functionDefinition = seq->functionDefinition(_terminal->activeSequences()))
+        if (auto const* functionDefinition = seq->functionDefinition(_terminal->supportedSequences()))
             fmt::print("\t{:<20} ; {:<18} ; {}\n",
                        seq->text(),
                        functionDefinition->documentation.mnemonic,
@@ -8,11 +8,13 @@
 #include <vtbackend/InputGenerator.h>
 #include <vtbackend/InputHandler.h>
 #include <vtbackend/RenderBuffer.h>
+#include <vtbackend/SearchPattern.h>
 #include <vtbackend/Selector.h>
 #include <vtbackend/Sequence.h>
 #include <vtbackend/SequenceBuilder.h>
 #include <vtbackend/Settings.h>
 #include <vtbackend/StatusLineBuilder.h>
+#include <vtbackend/StatusLineCommandRunner.h>
 #include <vtbackend/ViCommands.h>
 #include <vtbackend/ViInputHandler.h>
 #include <vtbackend/Viewport.h>
@@ -24,6 +26,7 @@
 #include <vtparser/Parser.h>
 
 #include <vtpty/Pty.h>
+#include <vtpty/PtyInputPipeline.h>
 
 #include <crispy/BufferObject.h>
 #include <crispy/assert.h>
@@ -43,6 +46,7 @@
 #include <mutex>
 #include <stack>
 #include <string_view>
+#include <vector>
 
 namespace vtbackend
 {
@@ -139,7 +143,9 @@ class Modes
 
 struct Search
 {
+    /// The search term, interpreted according to the search mode.
     std::u32string pattern;
+    SearchMode mode = SearchMode::Literal;
     ScrollOffset initialScrollOffset {};
     bool initiatedByDoubleClick = false;
 };
@@ -240,6 +246,7 @@ class Terminal
         virtual void requestWindowResize(LineCount, ColumnCount) {}
         virtual void requestWindowResize(Width, Height) {}
         virtual void requestShowHostWritableStatusLine() {}
+        virtual void requestImageFile(ImageFileRequest /*request*/) {}
         virtual void setWindowTitle(std::string_view /*title*/) {}
         virtual void setTerminalProfile(std::string const& /*configProfileName*/) {}
         virtual void discardImage(Image const&) {}
@@ -248,6 +255,10 @@ class Terminal
         virtual void playSound(Sequence::Parameters const&) {}
         virtual void cursorPositionChanged() {}
         virtual void onScrollOffsetChanged(ScrollOffset) {}
+        virtual void pasteProgress(size_t /*sentBytes*/, size_t /*totalBytes*/) {}
+        /// Invoked from within the PTY reading thread once input that has been held back can be
+        /// flushed, i.e. the PTY's write queue has been drained and no paste is being streamed.
+        virtual void requestFlushInput() {}
     };
 
     class NullEvents: public Events
@@ -270,6 +281,7 @@ class Terminal
         void requestWindowResize(LineCount, ColumnCount) override {}
         void requestWindowResize(Width, Height) override {}
         void requestShowHostWritableStatusLine() override {}
+        void requestImageFile(ImageFileRequest /*request*/) override {}
         void setWindowTitle(std::string_view /*title*/) override {}
         void setTerminalProfile(std::string const& /*configProfileName*/) override {}
         void discardImage(Image const&) override {}
@@ -278,6 +290,8 @@ class Terminal
         void playSound(Sequence::Parameters const&) override {}
         void cursorPositionChanged() override {}
         void onScrollOffsetChanged(ScrollOffset) override {}
+        void pasteProgress(size_t /*sentBytes*/, size_t /*totalBytes*/) override {}
+        void requestFlushInput() override {}
     };
 
     Terminal(Events& eventListener,
@@ -294,6 +308,15 @@ class Terminal
     void setMaxHistoryLineCount(MaxHistoryLineCount maxHistoryLineCount);
     LineCount maxHistoryLineCount() const noexcept;
 
+    /// Sets the number of pages of the primary screen's scrollback history to keep uncompressed.
+    /// @see Grid::setHotHistoryPageCount()
+    void setHotHistoryPageCount(unsigned pageCount) noexcept;
+
+    /// Prepends the primary screen's history lines still being reflowed in the background
+    /// to its history, waiting for them if needed, e.g. before scrolling to or searching them.
+    /// @see Grid::completeReflow()
+    void completeHistoryReflow();
+
     void setTerminalId(VTType id) noexcept;
     VTType terminalId() const noexcept { return _terminalId; }
 
@@ -434,6 +457,12 @@ class Terminal
     }
     void sendRawInput(std::string_view text);
 
+    /// Tests if a large paste is still being streamed to the application.
+    [[nodiscard]] bool isPasting() const;
+
+    /// Discards what has not been sent yet of the pastes being streamed to the application.
+    void cancelPaste();
+
     void inputModeChanged(ViMode mode) { _eventListener.inputModeChanged(mode); }
     void updateHighlights() { _eventListener.updateHighlights(); }
     void playSound(vtbackend::Sequence::Parameters const& params) { _eventListener.playSound(params); }
@@ -530,7 +559,12 @@ class Terminal
     void unlock() const { _stateMutex.unlock(); }
 
     [[nodiscard]] ColorPalette const& colorPalette() const noexcept { return _colorPalette; }
-    [[nodiscard]] ColorPalette& colorPalette() noexcept { return _colorPalette; }
+    [[nodiscard]] ColorPalette& colorPalette() noexcept
+    {
+        // Any mutable access may change the palette, invalidating all previously rendered lines.
+        ++_colorPaletteGeneration;
+        return _colorPalette;
+    }
     [[nodiscard]] ColorPalette& defaultColorPalette() noexcept { return _defaultColorPalette; }
 
     [[nodiscard]] std::vector<ColorPalette> const& savedColorPalettes() const noexcept
@@ -718,7 +752,23 @@ class Terminal
     void setVisualizeSelectedWord(bool enabled) noexcept { _settings.visualizeSelectedWord = enabled; }
     // }}}
 
+    /// Receives the text of the selection chunk by chunk.
+    using SelectionTextSink = std::function<void(std::string_view)>;
+
     [[nodiscard]] std::string extractSelectionText() const;
+
+    /// Extracts the text of the current selection into the given sink, in chunks of up to
+    /// @p linesPerChunk lines.
+    ///
+    /// The terminal lock is acquired for extracting each chunk and released before passing it
+    /// to the sink, so that the application's output keeps being processed while extracting
+    /// huge selections. Therefore, this function must not be called with the terminal lock held.
+    ///
+    /// @retval true  the complete selection has been extracted.
+    /// @retval false there is no selection, or it has been cleared or replaced before being
+    ///               extracted completely.
+    bool extractSelectionText(SelectionTextSink const& sink, LineCount linesPerChunk = LineCount(1000));
+
     [[nodiscard]] std::string extractLastMarkRange() const;
 
     HyperlinkStorage& hyperlinks() noexcept { return _hyperlinks; }
@@ -744,14 +794,44 @@ class Terminal
 
     bool processInputOnce();
 
+    /// Processes input like processInputOnce(), but without waiting for the PTY to become ready.
+    ///
+    /// This is meant to be called by a vtpty::PtyReactor once the PTY's poll handle is ready.
+    /// It still waits while execution is paused for tracing.
+    bool processReadyInput();
+
+    /// Reads once from the PTY into the PTY input pipeline, to be consumed by processInputOnce().
+    ///
+    /// This must only be called from the dedicated PTY reader thread,
+    /// and only if pipelined PTY input has been enabled via Settings::pipelinedPtyInput.
+    ///
+    /// @retval true  more data may be read.
+    /// @retval false the PTY has been closed or the pipeline has been shut down.
+    bool readPtyInputOnce();
+
+    /// @returns the PTY input pipeline if pipelined PTY input is enabled, nullptr otherwise.
+    [[nodiscard]] vtpty::PtyInputPipeline* ptyInputPipeline() noexcept { return _ptyInputPipeline.get(); }
+
+    /// @returns the total number of bytes read from the PTY that have been fully processed by the VT parser.
+    ///
+    /// This may be read from any thread, e.g. to wait for output to have been processed.
+    [[nodiscard]] uint64_t processedInputBytes() const noexcept
+    {
+        return _processedInputBytes.load(std::memory_order_acquire);
+    }
+
     void markScreenDirty() noexcept { _screenDirty = true; }
 
     [[nodiscard]] uint64_t lastFrameID() const noexcept { return _lastFrameID.load(); }
 
+    /// Displays the image of a request passed to Events::requestImageFile() at the cursor position.
+    void imageFile(ImageFileRequest const& request);
+
     // Screen's EventListener implementation
     //
     void requestCaptureBuffer(LineCount lines, bool logical);
     void requestShowHostWritableStatusLine();
+    void requestImageFile(ImageFileRequest request);
     void bell();
     void bufferChanged(ScreenType);
     void scrollbackBufferCleared();
@@ -859,7 +939,9 @@ class Terminal
     // Sets the current search term to the given text and
     // moves the viewport accordingly to make sure the given text is visible,
     // or it will not move at all if the input text was not found.
-    [[nodiscard]] std::optional<CellLocation> searchReverse(std::u32string text, CellLocation searchPosition);
+    [[nodiscard]] std::optional<CellLocation> searchReverse(std::u32string text,
+                                                            CellLocation searchPosition,
+                                                            SearchMode mode = SearchMode::Literal);
     [[nodiscard]] std::optional<CellLocation> searchReverse(CellLocation searchPosition);
 
     // Searches from current position the next item downwards.
@@ -871,9 +953,27 @@ class Terminal
     [[nodiscard]] std::optional<CellLocation> searchNextMatch(CellLocation cursorPosition);
     [[nodiscard]] std::optional<CellLocation> searchPrevMatch(CellLocation cursorPosition);
 
-    bool setNewSearchTerm(std::u32string text, bool initiatedByDoubleClick);
+    bool setNewSearchTerm(std::u32string text,
+                          bool initiatedByDoubleClick,
+                          SearchMode mode = SearchMode::Literal);
     void clearSearch();
 
+    /// @returns the current search term, compiled upon first use after it has changed,
+    ///          or nullptr if there is no valid search term.
+    [[nodiscard]] SearchPattern const* searchPattern() const;
+
+    /// Finds up to @p maxMatchCount matches of the current search term,
+    /// from the top of the history downwards.
+    [[nodiscard]] std::vector<CellLocation> searchAll(size_t maxMatchCount);
+
+    /// Maximum number of matches counted by searchMatchCount().
+    static constexpr size_t MaxSearchMatchCount = 10'000;
+
+    /// @returns the number of matches of the literal search term being edited, up to MaxSearchMatchCount,
+    ///          as of the last render buffer refresh, or std::nullopt if not counted (yet).
+    ///          Counting is deferred while the history is still being reflowed or indexed.
+    [[nodiscard]] std::optional<size_t> searchMatchCount() const noexcept { return _searchMatchCount.count; }
+
     // Tests if the grid cell at the given location does contain a word delimiter.
     [[nodiscard]] bool wordDelimited(CellLocation position) const noexcept;
     [[nodiscard]] bool wordDelimited(CellLocation position,
@@ -898,6 +998,11 @@ class Terminal
         return _supportedVTSequences.activeSequences();
     }
 
+    [[nodiscard]] SupportedSequences const& supportedSequences() const noexcept
+    {
+        return _supportedVTSequences;
+    }
+
     // {{{ VT parser related
 
     [[nodiscard]] size_t maxBulkTextSequenceWidth() const noexcept;
@@ -957,9 +1062,22 @@ class Terminal
     void setStatusLineDefinition(StatusLineDefinition&& definition);
     void resetStatusLineDefinition();
 
+    /// @returns the most recent output of the given status line Command segment's program,
+    ///          which is run in the background.
+    [[nodiscard]] std::string statusLineCommandOutput(std::string const& command) const
+    {
+        return _statusLineCommands.output(command, _currentTime);
+    }
+
   private:
     void mainLoop();
     void fillRenderBufferInternal(RenderBuffer& output, bool includeSelection);
+
+    // Recounts the matches of the search term being edited, if it or the screen contents have changed.
+    void updateSearchMatchCount();
+    [[nodiscard]] RenderBufferContext makeRenderBufferContext(LineOffset mainPageBaseLine,
+                                                              bool includeSelection) const;
+    void updateLineChangeFrameIDs();
     LineCount fillRenderBufferStatusLine(RenderBuffer& output, bool includeSelection, LineOffset base);
     void updateIndicatorStatusLine();
     void updateCursorVisibilityState() const noexcept;
@@ -1009,8 +1127,13 @@ class Terminal
         return { !blinker.state, _currentTime };
     }
 
-    // Reads from PTY.
-    [[nodiscard]] std::optional<vtpty::Pty::ReadResult> readFromPty();
+    bool processInput(bool waitForInput);
+
+    // Reads from PTY, or from the PTY input pipeline if enabled.
+    [[nodiscard]] std::optional<vtpty::Pty::ReadResult> readFromPty(bool waitForInput);
+
+    // Interrupts the blocking read of processInputOnce().
+    void wakeupInputProcessing();
 
     // Writes partially or all input data to the PTY buffer object and returns a string view to it.
     [[nodiscard]] std::string_view lockedWriteToPtyBuffer(std::string_view data);
@@ -1035,6 +1158,9 @@ class Terminal
     crispy::buffer_object_ptr<char> _currentPtyBuffer;
     size_t _ptyReadBufferSize;
     std::unique_ptr<vtpty::Pty> _pty;
+    std::unique_ptr<vtpty::PtyInputPipeline> _ptyInputPipeline;
+    // Buffer object holding the data most recently dequeued from the PTY input pipeline.
+    crispy::buffer_object_ptr<char> _pipelinedPtyBuffer;
     // }}}
 
     // {{{ mouse related state (helpers for detecting double/tripple clicks)
@@ -1084,6 +1210,18 @@ class Terminal
     RenderDoubleBuffer _renderBuffer {};
     std::atomic<uint64_t> _lastFrameID = 0;
     RenderPassHints _lastRenderPassHints {};
+
+    // Holds the previous contents of the render buffer being refilled, to take over unchanged lines from.
+    RenderBuffer _previousRenderBuffer {};
+
+    // ID of the frame each main page line has last been changed in, indexed by page line.
+    std::vector<uint64_t> _lineChangeFrameIDs {};
+
+    // Incremented on every (potential) change to the color palette.
+    uint64_t _colorPaletteGeneration = 0;
+
+    // Total number of lines the screen contents have been scrolled up by.
+    int64_t _scrolledLineCount = 0;
     // }}}
 
     InputMethodData _inputMethodData {};
@@ -1134,6 +1272,21 @@ class Terminal
     ActiveStatusDisplay _activeStatusDisplay = ActiveStatusDisplay::Main;
 
     Search _search;
+    mutable std::optional<SearchPattern> _searchPattern; // Compiled from the following term and mode.
+    mutable std::u32string _searchPatternTerm;
+    mutable SearchMode _searchPatternMode = SearchMode::Literal;
+
+    // Number of matches of the search term being edited, and what it has been counted for.
+    struct SearchMatchCount
+    {
+        std::u32string term;
+        uint64_t processedInputBytes = 0;
+        PageSize pageSize {};
+        ScreenType screenType = ScreenType::Primary;
+        std::optional<size_t> count;
+    };
+    SearchMatchCount _searchMatchCount;
+    std::atomic<bool> _searchMatchCountPending = false; // Whether to refresh once the search index is idle.
 
     CursorDisplay _cursorDisplay = CursorDisplay::Steady;
     CursorShape _cursorShape = CursorShape::Block;
@@ -1187,11 +1340,32 @@ class Terminal
     StandardSequenceBuilder _sequenceBuilder;
     vtparser::Parser<StandardSequenceBuilder, false> _parser;
     uint64_t _instructionCounter = 0;
+    std::atomic<uint64_t> _processedInputBytes = 0;
 
     InputGenerator _inputGenerator {};
 
+    /// Pastes larger than this are streamed to the application in chunks of this size,
+    /// each one written once the PTY has accepted most of the previous one.
+    static constexpr size_t PasteChunkSize = 64 * 1024;
+
+    struct PendingPaste
+    {
+        std::string text;
+        size_t offset = 0; // number of bytes of text already sent
+        bool bracketed = false;
+    };
+
+    /// Writes the next chunks of the pending pastes, as long as the PTY's write queue is short.
+    void streamPaste();
+
+    mutable std::mutex _pasteMutex;
+    std::deque<PendingPaste> _pendingPastes; // guarded by _pasteMutex
+
     ViCommands _viCommands;
     ViInputHandler _inputHandler;
+
+    // Declared last, so that its worker thread is stopped before anything it notifies is destroyed.
+    mutable StatusLineCommandRunner _statusLineCommands;
 };
 
 } // namespace vtbackend
@@ -225,6 +225,105 @@ TEST_CASE("Terminal.SynchronizedOutput", "[terminal]")
     CHECK("Hello  World" == trimmedTextScreenshot(mc));
 }
 
+TEST_CASE("Terminal.IncrementalRenderBuffer", "[terminal]")
+{
+    using namespace vtbackend;
+
+    auto mc = MockTerm { ColumnCount(10), LineCount(4) };
+    auto constexpr ClockBase = chrono::steady_clock::time_point();
+    auto refresh = [&, i = 0]() mutable {
+        mc.terminal.tick(ClockBase + chrono::seconds(++i));
+        mc.terminal.ensureFreshRenderBuffer();
+        return mc.terminal.renderBuffer().get().frameID;
+    };
+
+    mc.writeToScreen("AAA\r\nBBB\r\nCCC\r\nDDD");
+
+    // The first two frames are filled into either of the (empty) double buffers.
+    refresh();
+    auto const frameID = refresh();
+    CHECK("AAA\nBBB\nCCC\nDDD" == trimmedTextScreenshot(mc));
+
+    // Only modify the first line, and move the cursor there (away from the last line).
+    mc.writeToScreen("\033[1;1HX");
+    refresh();
+    CHECK("XAA\nBBB\nCCC\nDDD" == trimmedTextScreenshot(mc));
+
+    // Unchanged lines are taken over from the previous frame, and thus not reported as damaged.
+    auto const damage = mc.terminal.renderBuffer().get().damageSince(frameID);
+    REQUIRE(damage.size() == 2);
+    CHECK(damage[0].top == Top(0));
+    CHECK(damage[0].bottom == Bottom(0));
+    CHECK(damage[0].right == Right(9));
+    CHECK(damage[1].top == Top(3));
+    CHECK(damage[1].bottom == Bottom(3));
+
+    // Scrolling damages all lines.
+    mc.writeToScreen("\033[4;1H\r\nEEE");
+    auto const scrolledFrameID = refresh();
+    CHECK("BBB\nCCC\nDDD\nEEE" == trimmedTextScreenshot(mc));
+    auto const scrollDamage = mc.terminal.renderBuffer().get().damageSince(scrolledFrameID - 1);
+    REQUIRE(scrollDamage.size() == 1);
+    CHECK(scrollDamage[0].top == Top(0));
+    CHECK(scrollDamage[0].bottom == Bottom(3));
+}
+
+TEST_CASE("Terminal.RenderBufferCodepoints", "[terminal]")
+{
+    using namespace vtbackend;
+
+    auto mc = MockTerm { ColumnCount(10), LineCount(3) };
+    auto constexpr ClockBase = chrono::steady_clock::time_point();
+    auto refresh = [&, i = 0]() mutable {
+        mc.terminal.tick(ClockBase + chrono::seconds(++i));
+        mc.terminal.ensureFreshRenderBuffer();
+    };
+
+    // Combining characters keep the lines from being rendered as trivial lines.
+    mc.writeToScreen("A\u0301B\r\nC\u0308D\r\nE");
+    refresh();
+    refresh();
+    CHECK("A\u0301B\nC\u0308D\nE" == trimmedTextScreenshot(mc));
+
+    // The unchanged first two lines are taken over from the previous frame, along with their codepoints.
+    mc.writeToScreen("F");
+    refresh();
+    CHECK("A\u0301B\nC\u0308D\nEF" == trimmedTextScreenshot(mc));
+
+    auto const renderBuffer = mc.terminal.renderBuffer();
+    auto const& buffer = renderBuffer.get();
+    auto codepointCount = size_t { 0 };
+    for (RenderCell const& cell: buffer.cells)
+        codepointCount += cell.codepointCount;
+    CHECK(codepointCount == buffer.codepoints.size());
+}
+
+TEST_CASE("Terminal.RenderBufferPageTopLine", "[terminal]")
+{
+    using namespace vtbackend;
+
+    auto mc = MockTerm { ColumnCount(10), LineCount(4) };
+    auto constexpr ClockBase = chrono::steady_clock::time_point();
+    auto refresh = [&, i = 0]() mutable {
+        mc.terminal.tick(ClockBase + chrono::seconds(++i));
+        mc.terminal.ensureFreshRenderBuffer();
+        return mc.terminal.renderBuffer().get().pageTopLine;
+    };
+
+    mc.writeToScreen("AAA\r\nBBB\r\nCCC\r\nDDD");
+    refresh();
+    auto const pageTopLine = refresh();
+
+    // Writing without scrolling keeps the displayed contents in place.
+    mc.writeToScreen("\033[1;1HX\033[4;4H");
+    CHECK(refresh() == pageTopLine);
+
+    // The contents moving up by two lines is reflected in the top line of the page.
+    mc.writeToScreen("\r\nEEE\r\nFFF");
+    CHECK(refresh() == pageTopLine + 2);
+    CHECK("CCC\nDDD\nEEE\nFFF" == trimmedTextScreenshot(mc));
+}
+
 TEST_CASE("Terminal.XTPUSHCOLORS_and_XTPOPCOLORS", "[terminal]")
 {
     using namespace vtbackend;
@@ -424,4 +523,86 @@ TEST_CASE("Terminal.TextSelection", "[terminal]")
     CHECK(mock.terminal.extractSelectionText().empty());
 }
 
+TEST_CASE("Terminal.ExtractSelectionTextInChunks", "[terminal]")
+{
+    auto mock = MockTerm { ColumnCount(5), LineCount(5) };
+    mock.writeToScreen("12345\r\n"
+                       "67890\r\n"
+                       "ABCDE\r\n"
+                       "abcde\r\n"
+                       "fghij");
+
+    auto& terminal = mock.terminal;
+    terminal.setSelector(std::make_unique<vtbackend::LinearSelection>(
+        terminal.selectionHelper(), vtbackend::CellLocation { LineOffset(0), ColumnOffset(1) }, []() {}));
+    REQUIRE(terminal.selector()->extend(vtbackend::CellLocation { LineOffset(4), ColumnOffset(2) }));
+    auto const expectedText = terminal.extractSelectionText();
+    CHECK(expectedText == "2345\n67890\nABCDE\nabcde\nfgh");
+
+    auto chunks = std::vector<std::string> {};
+    CHECK(terminal.extractSelectionText([&](std::string_view chunk) { chunks.emplace_back(chunk); },
+                                        LineCount(2)));
+    CHECK(chunks.size() == 3);
+    auto joinedText = std::string {};
+    for (auto const& chunk: chunks)
+        joinedText += chunk;
+    CHECK(joinedText == expectedText);
+
+    // Nothing is extracted without a selection.
+    terminal.clearSelection();
+    CHECK_FALSE(terminal.extractSelectionText([](std::string_view) { FAIL(); }));
+}
+
+TEST_CASE("Terminal.LargeBracketedPaste", "[terminal]")
+{
+    auto mock = MockTerm { ColumnCount(10), LineCount(3) };
+    mock.writeToScreen("\033[?2004h");
+
+    // Larger than a single paste chunk, so that it is streamed.
+    auto const text = std::string(200 * 1024, 'x');
+    mock.terminal.sendPaste(text);
+
+    CHECK_FALSE(mock.terminal.isPasting());
+    CHECK(mock.replyData() == "\033[200~" + text + "\033[201~");
+
+    // A paste that fits into one chunk is sent directly.
+    mock.resetReplyData();
+    mock.terminal.sendPaste("abc");
+    CHECK(mock.replyData() == "\033[200~abc\033[201~");
+}
+
+TEST_CASE("Terminal.LargeBracketedPaste.Backpressure", "[terminal]")
+{
+    auto mock = MockTerm { ColumnCount(10), LineCount(3) };
+    mock.writeToScreen("\033[?2004h");
+
+    // The application does not read its input until being drained.
+    mock.mockPty().setInputBlocked(true);
+    auto const text = std::string(200 * 1024, 'x');
+    mock.terminal.sendPaste(text);
+
+    // Only a single chunk is queued at a time.
+    CHECK(mock.terminal.isPasting());
+    CHECK(mock.mockPty().pendingWriteBytes() == 6 + 64 * 1024);
+
+    // Typing is held back instead of ending up in the middle of the paste.
+    mock.sendCharSequence("a");
+    CHECK(mock.terminal.hasInput());
+    CHECK(mock.mockPty().pendingWriteBytes() == 6 + 64 * 1024);
+
+    auto drainCount = 0;
+    while (mock.terminal.isPasting() && drainCount < 10)
+    {
+        mock.mockPty().drainInput();
+        ++drainCount;
+    }
+    CHECK(drainCount == 3);
+
+    mock.mockPty().setInputBlocked(false);
+    mock.mockPty().drainInput();
+    mock.terminal.flushInput();
+    CHECK_FALSE(mock.terminal.hasInput());
+    CHECK(mock.replyData() == "\033[200~" + text + "\033[201~a");
+}
+
 // NOLINTEND(misc-const-correctness)
@@ -203,7 +203,7 @@ void VTWriter::write(Line<Cell> const& line)
     }
     else
     {
-        for (Cell const& cell: line.inflatedBuffer())
+        for (Cell const& cell: line.cells())
         {
             if (cell.flags() & CellFlag::Bold)
                 sgrAdd(GraphicsRendition::Bold);
@@ -214,9 +214,9 @@ bool ViCommands::jumpToPreviousMatch(unsigned count)
     return true;
 }
 
-void ViCommands::updateSearchTerm(std::u32string const& text)
+void ViCommands::updateSearchTerm(std::u32string const& text, SearchMode mode)
 {
-    if (auto const newLocation = _terminal->searchReverse(text, cursorPosition))
+    if (auto const newLocation = _terminal->searchReverse(text, cursorPosition, mode))
         moveCursorTo(newLocation.value());
 }
 
@@ -282,7 +282,7 @@ void ViCommands::reverseSearchCurrentWord()
     assert(range.contains(cursorPosition));
     cursorPosition = range.first;
 
-    updateSearchTerm(wordUnderCursor);
+    updateSearchTerm(wordUnderCursor, SearchMode::Literal);
     jumpToPreviousMatch(1);
 }
 
@@ -298,7 +298,7 @@ void ViCommands::searchCurrentWord()
     auto const [wordUnderCursor, range] = _terminal->extractWordUnderCursor(cursorPosition);
     assert(range.contains(cursorPosition));
     cursorPosition = range.second;
-    updateSearchTerm(wordUnderCursor);
+    updateSearchTerm(wordUnderCursor, SearchMode::Literal);
     jumpToNextMatch(1);
 }
 
@@ -605,7 +605,7 @@ CellLocationRange ViCommands::expandMatchingPair(TextObjectScope scope, char lef
 CellLocationRange ViCommands::translateToCellRange(TextObjectScope scope,
                                                    TextObject textObject) const noexcept
 {
-    auto const gridTop = -_terminal->currentScreen().historyLineCount().as<LineOffset>();
+    auto const gridTop = historyTop();
     auto const gridBottom = _terminal->pageSize().lines.as<LineOffset>() - 1;
     auto const rightMargin = _terminal->pageSize().columns.as<ColumnOffset>() - 1;
     auto a = cursorPosition;
@@ -727,6 +727,13 @@ CellLocation ViCommands::snapToCellRight(CellLocation location) const noexcept
     return location;
 }
 
+LineOffset ViCommands::historyTop() const
+{
+    // Older history lines may still be reflowed in the background after a resize.
+    _terminal->completeHistoryReflow();
+    return -_terminal->currentScreen().historyLineCount().as<LineOffset>();
+}
+
 bool ViCommands::compareCellTextAt(CellLocation position, char32_t codepoint) const noexcept
 {
     return _terminal->currentScreen().compareCellTextAt(position, codepoint);
@@ -734,7 +741,7 @@ bool ViCommands::compareCellTextAt(CellLocation position, char32_t codepoint) co
 
 CellLocation ViCommands::globalCharUp(CellLocation location, char ch, unsigned count) const noexcept
 {
-    auto const pageTop = -_terminal->currentScreen().historyLineCount().as<LineOffset>();
+    auto const pageTop = historyTop();
     auto result = CellLocation { location.line, ColumnOffset(0) };
     while (count > 0)
     {
@@ -801,9 +808,7 @@ CellLocation ViCommands::translateToCellLocation(ViMotion motion, unsigned count
                                 min(ColumnOffset::cast_from(count - 1),
                                     _terminal->pageSize().columns.as<ColumnOffset>() - 1) });
         case ViMotion::FileBegin: // gg
-            return snapToCell(
-                { LineOffset::cast_from(-_terminal->currentScreen().historyLineCount().as<int>()),
-                  ColumnOffset(0) });
+            return snapToCell({ historyTop(), ColumnOffset(0) });
         case ViMotion::FileEnd: // G
             return snapToCell({ _terminal->pageSize().lines.as<LineOffset>() - 1, ColumnOffset(0) });
         case ViMotion::PageTop: // <S-H>
@@ -851,7 +856,7 @@ CellLocation ViCommands::translateToCellLocation(ViMotion motion, unsigned count
                    - min(cursorPosition.line, LineOffset::cast_from(_terminal->pageSize().lines) / 2);
         case ViMotion::ParagraphBackward: // {
         {
-            auto const pageTop = -_terminal->currentScreen().historyLineCount().as<LineOffset>();
+            auto const pageTop = historyTop();
             auto prev = CellLocation { cursorPosition.line, ColumnOffset(0) };
             if (prev.line.value > 0)
                 prev.line--;
@@ -875,7 +880,7 @@ CellLocation ViCommands::translateToCellLocation(ViMotion motion, unsigned count
             return globalCharDown(cursorPosition, '}', count);
         case ViMotion::LineMarkUp: // [m
         {
-            auto const gridTop = -_terminal->currentScreen().historyLineCount().as<LineOffset>();
+            auto const gridTop = historyTop();
             auto result = CellLocation { cursorPosition.line, ColumnOffset(0) };
             while (count > 0)
             {
@@ -42,7 +42,7 @@ class ViCommands: public ViInputHandler::Executor
     void searchStart() override;
     void searchDone() override;
     void searchCancel() override;
-    void updateSearchTerm(std::u32string const& text) override;
+    void updateSearchTerm(std::u32string const& text, SearchMode mode) override;
     bool jumpToNextMatch(unsigned count);
     bool jumpToPreviousMatch(unsigned count);
 
@@ -89,6 +89,10 @@ class ViCommands: public ViInputHandler::Executor
 
     [[nodiscard]] bool compareCellTextAt(CellLocation position, char32_t codepoint) const noexcept;
 
+    /// @returns the top line of the history, with all of the history reflowed
+    ///          for motions reaching up to it.
+    [[nodiscard]] LineOffset historyTop() const;
+
     // Cursor offset into the grid.
     CellLocation cursorPosition {};
 
@@ -207,4 +207,28 @@ TEST_CASE("ViCommands:modeChanged", "[vi]")
         REQUIRE(mock.terminal.search().pattern.empty());
     }
 }
+
+TEST_CASE("ViCommands:searchMode", "[vi]")
+{
+    auto mock = setupMockTerminal("Hello, World\r\n");
+    auto const toggleSearchMode = [&]() {
+        mock.sendCharEvent('R', vtbackend::Modifier::Control, std::chrono::steady_clock::now());
+    };
+
+    mock.sendCharSequence("/W.r");
+    CHECK(mock.terminal.search().pattern == U"W.r");
+    CHECK(mock.terminal.search().mode == vtbackend::SearchMode::Literal);
+    CHECK(mock.terminal.searchPattern()->mode() == vtbackend::SearchMode::Literal);
+
+    toggleSearchMode();
+    CHECK(mock.terminal.search().pattern == U"W.r");
+    CHECK(mock.terminal.search().mode == vtbackend::SearchMode::Regex);
+    CHECK(mock.terminal.searchPattern()->mode() == vtbackend::SearchMode::Regex);
+
+    toggleSearchMode();
+    CHECK(mock.terminal.search().mode == vtbackend::SearchMode::Words);
+
+    toggleSearchMode();
+    CHECK(mock.terminal.search().mode == vtbackend::SearchMode::Literal);
+}
 // NOLINTEND(misc-const-correctness)
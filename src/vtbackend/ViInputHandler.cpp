@@ -454,12 +454,22 @@ Handled ViInputHandler::handleSearchEditor(char32_t ch, Modifiers modifiers)
         case '\x7F'_key:
             if (!_searchTerm.empty())
                 _searchTerm.resize(_searchTerm.size() - 1);
-            _executor->updateSearchTerm(_searchTerm);
+            _executor->updateSearchTerm(_searchTerm, _searchMode);
             break;
         case Modifier::Control | 'L':
         case Modifier::Control | 'U':
             _searchTerm.clear();
-            _executor->updateSearchTerm(_searchTerm);
+            _executor->updateSearchTerm(_searchTerm, _searchMode);
+            break;
+        case Modifier::Control | 'R':
+            // Cycles through literal, regular expression, and word list search.
+            switch (_searchMode)
+            {
+                case SearchMode::Literal: _searchMode = SearchMode::Regex; break;
+                case SearchMode::Regex: _searchMode = SearchMode::Words; break;
+                case SearchMode::Words: _searchMode = SearchMode::Literal; break;
+            }
+            _executor->updateSearchTerm(_searchTerm, _searchMode);
             break;
         case Modifier::Control | 'A': // TODO: move cursor to BOL
         case Modifier::Control | 'E': // TODO: move cursor to EOL
@@ -467,7 +477,7 @@ Handled ViInputHandler::handleSearchEditor(char32_t ch, Modifiers modifiers)
             if (ch >= 0x20 && modifiers.without(Modifier::Shift).none())
             {
                 _searchTerm += ch;
-                _executor->updateSearchTerm(_searchTerm);
+                _executor->updateSearchTerm(_searchTerm, _searchMode);
             }
             else
                 errorLog()("ViInputHandler: Receiving control code {}+0x{:02X} in search mode. Ignoring.",
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <vtbackend/InputHandler.h>
+#include <vtbackend/SearchPattern.h>
 #include <vtbackend/Selector.h>
 #include <vtbackend/Settings.h>
 #include <vtbackend/primitives.h>
@@ -171,7 +172,7 @@ class ViInputHandler: public InputHandler
         virtual void searchStart() = 0;
         virtual void searchDone() = 0;
         virtual void searchCancel() = 0;
-        virtual void updateSearchTerm(std::u32string const& text) = 0;
+        virtual void updateSearchTerm(std::u32string const& text, SearchMode mode) = 0;
 
         virtual void scrollViewport(ScrollOffset delta) = 0;
 
@@ -253,6 +254,7 @@ class ViInputHandler: public InputHandler
     SearchEditMode _searchEditMode = SearchEditMode::Disabled;
     bool _searchExternallyActivated = false;
     std::u32string _searchTerm;
+    SearchMode _searchMode = SearchMode::Literal;
 
     std::string _pendingInput;
     CommandHandlerMap _normalMode;
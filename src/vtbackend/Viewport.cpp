@@ -13,6 +13,8 @@ namespace vtbackend
 bool Viewport::scrollUp(LineCount numLines)
 {
     viewportLog()("scrollUp");
+    if (_scrollOffset + numLines.as<ScrollOffset>() > boxed_cast<ScrollOffset>(historyLineCount()))
+        _terminal->completeHistoryReflow();
     auto offset =
         std::min(_scrollOffset + numLines.as<ScrollOffset>(), boxed_cast<ScrollOffset>(historyLineCount()));
     return scrollTo(offset);
@@ -28,6 +30,7 @@ bool Viewport::scrollDown(LineCount numLines)
 bool Viewport::scrollToTop()
 {
     viewportLog()("scrollToTop");
+    _terminal->completeHistoryReflow();
     return scrollTo(boxed_cast<ScrollOffset>(historyLineCount()));
 }
 
@@ -97,6 +100,9 @@ bool Viewport::scrollTo(ScrollOffset offset)
     if (scrollingDisabled() && offset != ScrollOffset(0))
         return false;
 
+    if (offset > boxed_cast<ScrollOffset>(historyLineCount()))
+        _terminal->completeHistoryReflow();
+
     if (offset == _scrollOffset)
         return false;
 
@@ -118,6 +124,7 @@ bool Viewport::scrollMarkUp()
     if (scrollingDisabled())
         return false;
 
+    _terminal->completeHistoryReflow();
     auto const newScrollOffset =
         _terminal->primaryScreen().findMarkerUpwards(-boxed_cast<LineOffset>(_scrollOffset));
     if (newScrollOffset.has_value())
@@ -11,20 +11,72 @@
 #include <crispy/App.h>
 #include <crispy/BufferObject.h>
 #include <crispy/CLI.h>
+#include <crispy/times.h>
 #include <crispy/utils.h>
 
+#include <libunicode/convert.h>
+
 #include <fmt/format.h>
 
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <new>
 #include <optional>
 #include <thread>
 
+#if defined(_WIN32)
+    #include <Windows.h>
+    #include <psapi.h>
+#else
+    #include <vtpty/UnixPty.h>
+
+    #include <sys/resource.h>
+    #include <termios.h>
+#endif
+
 #include <libtermbench/termbench.h>
 
 using namespace std;
 
 using namespace contour;
 
+// {{{ allocation counting
+namespace
+{
+std::atomic<uint64_t> allocationCount = 0;  // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+std::atomic<uint64_t> allocatedBytes = 0;   // NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+} // namespace
+
+#if !defined(CONTOUR_BUILD_WITH_MIMALLOC)
+// Counts all (non-aligned) heap allocations, in order to report them per benchmark test.
+// The array and nothrow variants forward to these by default.
+void* operator new(size_t size)
+{
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, size_t /*size*/) noexcept
+{
+    std::free(p);
+}
+#endif
+// }}}
+
 namespace
 {
 
@@ -40,6 +92,382 @@ std::string createText(size_t bytes)
     return text;
 }
 
+/// Returns the peak resident set size of this process in bytes, or 0 if unknown.
+uint64_t peakResidentSetSize()
+{
+#if defined(_WIN32)
+    auto counters = PROCESS_MEMORY_COUNTERS {};
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<uint64_t>(counters.PeakWorkingSetSize);
+    return 0;
+#else
+    auto usage = rusage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    #if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss); // bytes
+    #else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // kilobytes
+    #endif
+#endif
+}
+
+/// Disables the PTY's output processing (such as LF to CR-LF translation),
+/// so that the terminal reads exactly the bytes that have been written to the PTY slave.
+///
+/// @returns true if bytes written to the slave are read unchanged from the master.
+bool disableOutputProcessing([[maybe_unused]] vtpty::PtySlave& slave)
+{
+#if defined(_WIN32)
+    // ConPTY re-renders the output rather than passing it through.
+    return false;
+#else
+    auto* unixSlave = dynamic_cast<vtpty::UnixPty::Slave*>(&slave);
+    if (!unixSlave)
+        return false;
+    auto const fd = unbox<int>(unixSlave->handle());
+    auto tio = termios {};
+    if (tcgetattr(fd, &tio) != 0)
+        return false;
+    tio.c_oflag &= ~static_cast<tcflag_t>(OPOST);
+    return tcsetattr(fd, TCSANOW, &tio) == 0;
+#endif
+}
+
+/// Allocation-free latency histogram with log-linear buckets (16 sub-buckets per power of two),
+/// so that recording samples does not disturb the allocation counters.
+class LatencyHistogram
+{
+  public:
+    void record(uint64_t value) noexcept { ++_buckets[bucketOf(value)]; }
+
+    /// Returns the lower bound of the bucket containing the given percentile (0..100).
+    [[nodiscard]] uint64_t percentile(double p) const noexcept
+    {
+        auto total = uint64_t { 0 };
+        for (auto const count: _buckets)
+            total += count;
+        if (!total)
+            return 0;
+
+        auto const threshold = static_cast<uint64_t>(std::ceil(static_cast<double>(total) * p / 100.0));
+        auto seen = uint64_t { 0 };
+        for (size_t i = 0; i < _buckets.size(); ++i)
+        {
+            seen += _buckets[i];
+            if (seen >= threshold)
+                return lowerBoundOf(i);
+        }
+        return lowerBoundOf(_buckets.size() - 1);
+    }
+
+  private:
+    static size_t bucketOf(uint64_t value) noexcept
+    {
+        if (value < 16)
+            return static_cast<size_t>(value);
+        auto const shift = static_cast<size_t>(63 - std::countl_zero(value) - 4);
+        return ((shift + 1) * 16) + static_cast<size_t>((value >> shift) & 15);
+    }
+
+    static uint64_t lowerBoundOf(size_t bucket) noexcept
+    {
+        if (bucket < 16)
+            return bucket;
+        auto const shift = (bucket / 16) - 1;
+        return (16 + (bucket % 16)) << shift;
+    }
+
+    std::array<uint64_t, 1024> _buckets {};
+};
+
+/// Measurements of a single benchmark test.
+struct BenchResult
+{
+    std::string target;
+    std::string test;
+    uint64_t bytes = 0;       // Number of bytes processed (0 for tests not processing a byte stream).
+    uint64_t chunks = 0;      // Number of processed chunks, or operations.
+    std::chrono::nanoseconds time {};
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t peakRSSDelta = 0; // Growth of the process' peak resident set size during the test, in bytes.
+    uint64_t p50ChunkTime = 0; // in nanoseconds
+    uint64_t p99ChunkTime = 0; // in nanoseconds
+
+    [[nodiscard]] double nsPerByte() const noexcept
+    {
+        return bytes ? static_cast<double>(time.count()) / static_cast<double>(bytes) : 0.0;
+    }
+
+    [[nodiscard]] double mbPerSecond() const noexcept
+    {
+        auto const seconds = std::chrono::duration<double>(time).count();
+        return seconds > 0 ? static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds : 0.0;
+    }
+};
+
+/// Records per-chunk latencies, allocations and memory usage of the currently running test.
+class BenchRecorder
+{
+  public:
+    explicit BenchRecorder(std::string target): _target { std::move(target) } {}
+
+    void begin(std::string_view test)
+    {
+        finish();
+        _current = BenchResult { .target = _target, .test = std::string(test) };
+        _histogram = {};
+        _allocationsAtStart = allocationCount.load(std::memory_order_relaxed);
+        _allocatedBytesAtStart = allocatedBytes.load(std::memory_order_relaxed);
+        _peakRSSAtStart = peakResidentSetSize();
+    }
+
+    void record(size_t bytes, std::chrono::nanoseconds elapsed) noexcept
+    {
+        if (!_current)
+            return;
+        _current->bytes += bytes;
+        _current->chunks++;
+        _current->time += elapsed;
+        _histogram.record(static_cast<uint64_t>(elapsed.count()));
+    }
+
+    /// Measures the time it takes to invoke the given callable, and records it as one chunk.
+    template <typename F>
+    auto measure(size_t bytes, F&& f)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        auto const recordOnExit = crispy::finally { [&]() {
+            record(bytes, std::chrono::steady_clock::now() - start);
+        } };
+        return f();
+    }
+
+    void finish()
+    {
+        if (!_current)
+            return;
+        _current->allocations = allocationCount.load(std::memory_order_relaxed) - _allocationsAtStart;
+        _current->allocatedBytes = allocatedBytes.load(std::memory_order_relaxed) - _allocatedBytesAtStart;
+        // The peak is process-wide and only ever grows, so only its growth is attributed to this test.
+        auto const peakRSS = peakResidentSetSize();
+        _current->peakRSSDelta = peakRSS > _peakRSSAtStart ? peakRSS - _peakRSSAtStart : 0;
+        _current->p50ChunkTime = _histogram.percentile(50);
+        _current->p99ChunkTime = _histogram.percentile(99);
+        _results.emplace_back(std::move(*_current));
+        _current.reset();
+    }
+
+    [[nodiscard]] std::vector<BenchResult> const& results() const noexcept { return _results; }
+
+  private:
+    std::string _target;
+    std::optional<BenchResult> _current;
+    LatencyHistogram _histogram;
+    uint64_t _allocationsAtStart = 0;
+    uint64_t _allocatedBytesAtStart = 0;
+    uint64_t _peakRSSAtStart = 0;
+    std::vector<BenchResult> _results;
+};
+
+enum class ReportFormat
+{
+    Text,
+    Json,
+    Csv,
+};
+
+std::string jsonEscape(std::string_view text)
+{
+    auto result = std::string {};
+    result.reserve(text.size());
+    for (char const ch: text)
+    {
+        if (ch == '"' || ch == '\\')
+            result += '\\';
+        if (static_cast<unsigned char>(ch) < 0x20)
+            result += fmt::format("\\u{:04x}", static_cast<unsigned>(ch));
+        else
+            result += ch;
+    }
+    return result;
+}
+
+void writeReport(std::ostream& output, ReportFormat format, std::vector<BenchResult> const& results)
+{
+    switch (format)
+    {
+        case ReportFormat::Text:
+            output << fmt::format("{:<24} {:>10} {:>10} {:>12} {:>12} {:>12} {:>12} {:>12}\n",
+                                  "test",
+                                  "ns/byte",
+                                  "MB/s",
+                                  "allocations",
+                                  "peak RSS +",
+                                  "p50 chunk",
+                                  "p99 chunk",
+                                  "chunks");
+            for (auto const& result: results)
+                output << fmt::format("{:<24} {:>10.3f} {:>10.2f} {:>12} {:>12} {:>9} ns {:>9} ns {:>12}\n",
+                                      result.test,
+                                      result.nsPerByte(),
+                                      result.mbPerSecond(),
+                                      result.allocations,
+                                      crispy::humanReadableBytes(result.peakRSSDelta),
+                                      result.p50ChunkTime,
+                                      result.p99ChunkTime,
+                                      result.chunks);
+            output << '\n';
+            break;
+        case ReportFormat::Json:
+            output << "{\n";
+            output << fmt::format("  \"version\": \"{}\",\n", CONTOUR_VERSION_STRING);
+            output << "  \"results\": [\n";
+            for (size_t i = 0; i < results.size(); ++i)
+            {
+                auto const& result = results[i];
+                output << "    {";
+                output << fmt::format("\"target\": \"{}\", ", jsonEscape(result.target));
+                output << fmt::format("\"test\": \"{}\", ", jsonEscape(result.test));
+                output << fmt::format("\"bytes\": {}, ", result.bytes);
+                output << fmt::format("\"chunks\": {}, ", result.chunks);
+                output << fmt::format("\"time_ns\": {}, ", result.time.count());
+                output << fmt::format("\"ns_per_byte\": {:.4f}, ", result.nsPerByte());
+                output << fmt::format("\"mb_per_second\": {:.3f}, ", result.mbPerSecond());
+                output << fmt::format("\"allocations\": {}, ", result.allocations);
+                output << fmt::format("\"allocated_bytes\": {}, ", result.allocatedBytes);
+                output << fmt::format("\"peak_rss_delta_bytes\": {}, ", result.peakRSSDelta);
+                output << fmt::format("\"p50_chunk_ns\": {}, ", result.p50ChunkTime);
+                output << fmt::format("\"p99_chunk_ns\": {}", result.p99ChunkTime);
+                output << (i + 1 < results.size() ? "},\n" : "}\n");
+            }
+            output << "  ]\n";
+            output << "}\n";
+            break;
+        case ReportFormat::Csv:
+            output << "target,test,bytes,chunks,time_ns,ns_per_byte,mb_per_second,"
+                      "allocations,allocated_bytes,peak_rss_delta_bytes,p50_chunk_ns,p99_chunk_ns\n";
+            for (auto const& result: results)
+                output << fmt::format("{},{},{},{},{},{:.4f},{:.3f},{},{},{},{},{}\n",
+                                      result.target,
+                                      result.test,
+                                      result.bytes,
+                                      result.chunks,
+                                      result.time.count(),
+                                      result.nsPerByte(),
+                                      result.mbPerSecond(),
+                                      result.allocations,
+                                      result.allocatedBytes,
+                                      result.peakRSSDelta,
+                                      result.p50ChunkTime,
+                                      result.p99ChunkTime);
+            break;
+    }
+}
+
+// {{{ workloads
+// All workloads are deterministic, so that the numbers can be compared between runs.
+
+/// CJK text, emoji (including ZWJ sequences and modifiers) and combining characters.
+std::string graphemeWorkload()
+{
+    auto constexpr Segments = std::array<std::string_view, 8> {
+        "漢字テスト", "かなカナ", "한국어", "👍🏽",
+        "👨‍👩‍👧‍👦", "🏳️‍🌈", "e\u0301a\u0308", "中文字符",
+    };
+    auto text = std::string {};
+    for (size_t line = 0; line < 64; ++line)
+    {
+        for (size_t i = 0; i < 10; ++i)
+        {
+            text += Segments[(line + i * 3) % Segments.size()];
+            text += ' ';
+        }
+        text += "\r\n";
+    }
+    return text;
+}
+
+/// Full screen redraws using absolute cursor positioning, as done by TUIs like vim or htop.
+std::string tuiWorkload(vtbackend::PageSize pageSize)
+{
+    auto const lines = unbox<int>(pageSize.lines);
+    auto const columns = unbox<size_t>(pageSize.columns);
+    auto text = std::string {};
+    for (int frame = 0; frame < 16; ++frame)
+    {
+        text += "\033[H";
+        for (int line = 1; line < lines; ++line)
+        {
+            auto const row = fmt::format("{:>6} user {:>5.1f} {:>5.1f} {:>8} /usr/bin/process-{}",
+                                         (line * 97 + frame * 13) % 100000,
+                                         double((line * 7 + frame) % 1000) / 10.0,
+                                         double((line * 3 + frame * 5) % 1000) / 10.0,
+                                         (line * 4096 + frame) % 10000000,
+                                         line);
+            text += fmt::format("\033[{};1H\033[{};{}m{}\033[m\033[K",
+                                line,
+                                30 + (line % 8),
+                                40 + ((line + frame) % 8),
+                                row.substr(0, columns));
+        }
+        text += fmt::format("\033[{};1H\033[7m{:<{}}\033[m", lines, fmt::format(" frame {}", frame), columns);
+    }
+    return text;
+}
+
+/// Scrolling within a scroll region (DECSTBM), including line insertions and deletions.
+std::string scrollRegionWorkload(vtbackend::PageSize pageSize)
+{
+    auto const lines = unbox<int>(pageSize.lines);
+    auto const bottom = std::max(2, lines - 2);
+    auto text = fmt::format("\033[3;{}r", bottom);
+    for (int i = 0; i < 256; ++i)
+    {
+        text += fmt::format("\033[{};1H", bottom);
+        text += fmt::format("\n\033[3{}mscrolling line {} within region\033[m", i % 8, i);
+        if (i % 16 == 0)
+            text += "\033[5;1H\033[2L\033[8;1H\033[1M";
+    }
+    text += "\033[r";
+    return text;
+}
+
+/// Small Sixel images with a few colors.
+std::string sixelWorkload()
+{
+    auto text = std::string {};
+    for (int image = 0; image < 8; ++image)
+    {
+        text += "\033Pq\"1;1;64;48";
+        text += fmt::format("#0;2;{};0;0#1;2;0;{};0#2;2;0;0;{}", image * 10, 100 - image * 10, 50);
+        for (int band = 0; band < 8; ++band)
+            text += fmt::format(
+                "#{}!32~#{}!32{}-", band % 3, (band + 1) % 3, char('?' + ((band + image) % 63)));
+        text += "\033\\\r\n";
+    }
+    return text;
+}
+
+/// Text with OSC 8 hyperlinks.
+std::string hyperlinkWorkload()
+{
+    auto text = std::string {};
+    for (int line = 0; line < 64; ++line)
+    {
+        for (int i = 0; i < 4; ++i)
+        {
+            auto const id = line * 4 + i;
+            text += fmt::format(
+                "\033]8;id={};https://example.com/path/{}\033\\link {}\033]8;;\033\\ ", id, id, id);
+        }
+        text += "\r\n";
+    }
+    return text;
+}
+// }}}
+
 } // namespace
 
 struct BenchOptions
@@ -49,14 +477,58 @@ struct BenchOptions
     bool longLines = false;
     bool sgr = false;
     bool binary = false;
+    bool graphemes = false;
+    bool tui = false;
+    bool scrollRegion = false;
+    bool sixel = false;
+    bool hyperlinks = false;
+    bool reflow = false; // grid only
+    bool search = false; // grid only
+    ReportFormat format = ReportFormat::Text;
+    std::string outputFile;
+
+    [[nodiscard]] bool hasStreamTests() const noexcept
+    {
+        return manyLines || longLines || sgr || binary || graphemes || tui || scrollRegion || sixel
+               || hyperlinks;
+    }
+
+    /// Human-readable progress goes to stderr if the machine-readable report is written to stdout.
+    [[nodiscard]] std::ostream& log() const
+    {
+        return format != ReportFormat::Text && outputFile.empty() ? std::cerr : std::cout;
+    }
 };
 
+/// Feeds the given workload through the writer in fixed-size chunks until testSizeMB have been written.
+template <typename Writer>
+void runStreamWorkload(Writer& writer,
+                       BenchRecorder& recorder,
+                       BenchOptions const& options,
+                       std::string_view data)
+{
+    auto constexpr ChunkSize = size_t { 4096 };
+    auto const totalBytes = size_t { options.testSizeMB } * 1024 * 1024;
+    auto written = size_t { 0 };
+    auto offset = size_t { 0 };
+    while (written < totalBytes)
+    {
+        auto const n = std::min({ ChunkSize, data.size() - offset, totalBytes - written });
+        if (!recorder.measure(n, [&]() { return writer(data.data() + offset, n); }))
+            break;
+        written += n;
+        offset = (offset + n) % data.size();
+    }
+}
+
 template <typename Writer>
-int baseBenchmark(Writer&& writer, BenchOptions options, string_view title)
+int baseBenchmark(Writer&& writer, BenchOptions options, string_view title, BenchRecorder& recorder)
 {
-    if (!(options.binary || options.longLines || options.manyLines || options.sgr))
+    auto& out = options.log();
+
+    if (!options.hasStreamTests() && !options.reflow && !options.search)
     {
-        cout << "No test cases specified. Defaulting to: cat, long, sgr.\n";
+        out << "No test cases specified. Defaulting to: cat, long, sgr.\n";
         options.manyLines = true;
         options.longLines = true;
         options.sgr = true;
@@ -64,14 +536,19 @@ int baseBenchmark(Writer&& writer, BenchOptions options, string_view title)
 
     auto const titleText = fmt::format("Running benchmark: {} (test size: {} MB)", title, options.testSizeMB);
 
-    cout << titleText << '\n' << string(titleText.size(), '=') << '\n';
+    out << titleText << '\n' << string(titleText.size(), '=') << '\n';
+
+    auto measuredWriter = [&](char const* a, size_t b) -> bool {
+        return recorder.measure(b, [&]() { return writer(a, b); });
+    };
 
-    auto tbp = contour::termbench::Benchmark { std::forward<Writer>(writer),
+    auto tbp = contour::termbench::Benchmark { measuredWriter,
                                                options.testSizeMB,
                                                80,
                                                24,
                                                [&](contour::termbench::Test const& test) {
-                                                   cout << fmt::format("Running test {} ...\n", test.name);
+                                                   out << fmt::format("Running test {} ...\n", test.name);
+                                                   recorder.begin(test.name);
                                                } };
 
     if (options.manyLines)
@@ -90,13 +567,60 @@ int baseBenchmark(Writer&& writer, BenchOptions options, string_view title)
         tbp.add(termbench::tests::binary());
 
     tbp.runAll();
+    recorder.finish();
+
+    out << '\n';
+    out << "Results\n";
+    out << "-------\n";
+    tbp.summarize(out);
+    out << '\n';
+
+    struct StreamWorkload
+    {
+        bool enabled;
+        std::string_view name;
+        std::function<std::string()> generate;
+    };
 
-    cout << '\n';
-    cout << "Results\n";
-    cout << "-------\n";
-    tbp.summarize(cout);
-    cout << '\n';
+    auto const pageSize = vtbackend::PageSize { vtbackend::LineCount(24), vtbackend::ColumnCount(80) };
+    auto const streamWorkloads = std::array {
+        StreamWorkload { options.graphemes, "graphemes", graphemeWorkload },
+        StreamWorkload { options.tui, "tui", [&]() { return tuiWorkload(pageSize); } },
+        StreamWorkload {
+            options.scrollRegion, "scroll_region", [&]() { return scrollRegionWorkload(pageSize); } },
+        StreamWorkload { options.sixel, "sixel", sixelWorkload },
+        StreamWorkload { options.hyperlinks, "hyperlinks", hyperlinkWorkload },
+    };
+    for (auto const& workload: streamWorkloads)
+    {
+        if (!workload.enabled)
+            continue;
+        out << fmt::format("Running test {} ...\n", workload.name);
+        auto const data = workload.generate();
+        recorder.begin(workload.name);
+        runStreamWorkload(writer, recorder, options, data);
+        recorder.finish();
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/// Writes the collected measurements in the requested format, to stdout or the requested file.
+int reportBenchmark(BenchRecorder const& recorder, BenchOptions const& options)
+{
+    if (options.outputFile.empty())
+    {
+        writeReport(std::cout, options.format, recorder.results());
+        return EXIT_SUCCESS;
+    }
 
+    auto file = std::ofstream { options.outputFile };
+    if (!file)
+    {
+        std::cerr << fmt::format("Could not open {} for writing.\n", options.outputFile);
+        return EXIT_FAILURE;
+    }
+    writeReport(file, options.format, recorder.results());
     return EXIT_SUCCESS;
 }
 
@@ -119,7 +643,8 @@ class ContourHeadlessBench: public crispy::app
             Project { "fmt", "MIT", "https://github.com/fmtlib/fmt" });
         link("bench-headless.parser", bind(&ContourHeadlessBench::benchParserOnly, this));
         link("bench-headless.grid", bind(&ContourHeadlessBench::benchGrid, this));
-        link("bench-headless.pty", bind(&ContourHeadlessBench::benchPTY));
+        link("bench-headless.pty", bind(&ContourHeadlessBench::benchPTY, this));
+        link("bench-headless.pty+grid", bind(&ContourHeadlessBench::benchPtyGrid, this));
         link("bench-headless.meta", bind(&ContourHeadlessBench::showMetaInfo));
 
         char const* logFilterString = getenv("LOG");
@@ -138,8 +663,55 @@ class ContourHeadlessBench: public crispy::app
             CLI::option { "long", CLI::value { false }, "Enable long-line ASCII stream test." },
             CLI::option { "sgr", CLI::value { false }, "Enable SGR stream test." },
             CLI::option { "binary", CLI::value { false }, "Enable binary stream test." },
+            CLI::option {
+                "graphemes", CLI::value { false }, "Enable CJK/emoji grapheme cluster stream test." },
+            CLI::option { "tui", CLI::value { false }, "Enable cursor-addressed full-screen redraw test." },
+            CLI::option { "scroll-region",
+                          CLI::value { false },
+                          "Enable scrolling within a scroll region (DECSTBM) test." },
+            CLI::option { "sixel", CLI::value { false }, "Enable Sixel image stream test." },
+            CLI::option { "hyperlinks", CLI::value { false }, "Enable OSC 8 hyperlink stream test." },
+            CLI::option { "all", CLI::value { false }, "Enable all tests." },
+            CLI::option { "format",
+                          CLI::value { "text"s },
+                          "Format of the result report, one of: text, json, csv.",
+                          "FORMAT" },
+            CLI::option { "output",
+                          CLI::value { ""s },
+                          "File to write the result report to, instead of stdout.",
+                          "PATH" },
+        };
+
+        auto const reportOptions = CLI::option_list {
+            CLI::option { "format",
+                          CLI::value { "text"s },
+                          "Format of the result report, one of: text, json, csv.",
+                          "FORMAT" },
+            CLI::option { "output",
+                          CLI::value { ""s },
+                          "File to write the result report to, instead of stdout.",
+                          "PATH" },
         };
 
+        auto gridOptions = perfOptions;
+        gridOptions.emplace_back(CLI::option {
+            "reflow", CLI::value { false }, "Enable test resizing the screen with a full history." });
+        gridOptions.emplace_back(
+            CLI::option { "search", CLI::value { false }, "Enable test searching through a full history." });
+        gridOptions.emplace_back(CLI::option {
+            "history", CLI::value { 4000u }, "Number of scrollback history lines.", "LINES" });
+        gridOptions.emplace_back(CLI::option { "hot-pages",
+                                               CLI::value { 0u },
+                                               "Number of history pages to keep uncompressed (0 disables "
+                                               "compressing cold history lines).",
+                                               "PAGES" });
+
+        auto ptyGridOptions = perfOptions;
+        ptyGridOptions.emplace_back(
+            CLI::option { "pipelined",
+                          CLI::value { false },
+                          "Reads the PTY on a dedicated thread, decoupled from the VT parser." });
+
         return CLI::command {
             "bench-headless",
             "Contour Terminal Emulator " CONTOUR_VERSION_STRING
@@ -153,12 +725,18 @@ class ContourHeadlessBench: public crispy::app
                                "Shows the license, and project URL of the used projects and Contour." },
                 CLI::command { "grid",
                                "Performs performance tests utilizing the full grid including VT parser.",
-                               perfOptions },
+                               gridOptions },
                 CLI::command {
                     "parser", "Performs performance tests utilizing the VT parser only.", perfOptions },
                 CLI::command {
                     "pty",
-                    "Performs performance tests utilizing the underlying operating system's PTY only." },
+                    "Performs performance tests utilizing the underlying operating system's PTY only.",
+                    reportOptions },
+                CLI::command {
+                    "pty+grid",
+                    "Performs end-to-end performance tests writing into a real PTY and processing its output "
+                    "by the full grid including VT parser.",
+                    ptyGridOptions },
             }
         };
     }
@@ -174,28 +752,80 @@ class ContourHeadlessBench: public crispy::app
         return EXIT_SUCCESS;
     }
 
+    static constexpr size_t ReflowIterations = 20;
+    static constexpr size_t SearchIterations = 20;
+
     BenchOptions benchOptionsFor(string_view kind)
     {
         auto const prefix = fmt::format("bench-headless.{}.", kind);
         auto opts = BenchOptions {};
+        opts.outputFile = parameters().str(prefix + "output");
+        opts.format = reportFormatFor(kind);
+        if (kind == "pty")
+            return opts;
+
         opts.testSizeMB = parameters().uint(prefix + "size");
         opts.manyLines = parameters().boolean(prefix + "cat");
         opts.longLines = parameters().boolean(prefix + "long");
         opts.sgr = parameters().boolean(prefix + "sgr");
         opts.binary = parameters().boolean(prefix + "binary");
+        opts.graphemes = parameters().boolean(prefix + "graphemes");
+        opts.tui = parameters().boolean(prefix + "tui");
+        opts.scrollRegion = parameters().boolean(prefix + "scroll-region");
+        opts.sixel = parameters().boolean(prefix + "sixel");
+        opts.hyperlinks = parameters().boolean(prefix + "hyperlinks");
+        if (kind == "grid")
+        {
+            opts.reflow = parameters().boolean(prefix + "reflow");
+            opts.search = parameters().boolean(prefix + "search");
+        }
+
+        if (parameters().boolean(prefix + "all"))
+        {
+            opts.manyLines = true;
+            opts.longLines = true;
+            opts.sgr = true;
+            opts.binary = true;
+            opts.graphemes = true;
+            opts.tui = true;
+            opts.scrollRegion = true;
+            opts.sixel = true;
+            opts.hyperlinks = true;
+            opts.reflow = kind == "grid";
+            opts.search = kind == "grid";
+        }
+
         return opts;
     }
 
+    ReportFormat reportFormatFor(string_view kind)
+    {
+        auto const format = parameters().str(fmt::format("bench-headless.{}.format", kind));
+        if (format == "json")
+            return ReportFormat::Json;
+        else if (format == "csv")
+            return ReportFormat::Csv;
+        else if (format != "text")
+            std::cerr << fmt::format("Unknown report format: {}. Defaulting to text.\n", format);
+        return ReportFormat::Text;
+    }
+
     int benchGrid()
     {
         auto pageSize = vtbackend::PageSize { vtbackend::LineCount(25), vtbackend::ColumnCount(80) };
         size_t const ptyReadBufferSize = 1'000'000;
-        auto maxHistoryLineCount = vtbackend::LineCount(4000);
+        auto maxHistoryLineCount =
+            vtbackend::LineCount::cast_from(parameters().uint("bench-headless.grid.history"));
         auto vt = vtbackend::MockTerm<vtpty::MockViewPty>(pageSize, maxHistoryLineCount, ptyReadBufferSize);
         auto* pty = dynamic_cast<vtpty::MockViewPty*>(&vt.terminal.device());
         vt.terminal.setMode(vtbackend::DECMode::AutoWrap, true);
+        vt.terminal.setHotHistoryPageCount(parameters().uint("bench-headless.grid.hot-pages"));
 
-        auto const rv = baseBenchmark(
+        auto const options = benchOptionsFor("grid");
+        auto recorder = BenchRecorder { "grid" };
+        auto& out = options.log();
+
+        auto rv = baseBenchmark(
             [&](char const* a, size_t b) -> bool {
                 if (pty->isClosed())
                     return false;
@@ -207,14 +837,197 @@ class ContourHeadlessBench: public crispy::app
                 // clang-format on
                 return true;
             },
-            benchOptionsFor("grid"),
-            "terminal with screen buffer");
+            options,
+            "terminal with screen buffer",
+            recorder);
+
+        if (options.reflow)
+        {
+            out << "Running test reflow ...\n";
+            fillHistory(vt);
+            recorder.begin("reflow");
+            for (auto const i: crispy::times(ReflowIterations))
+            {
+                auto const newPageSize =
+                    vtbackend::PageSize { pageSize.lines, vtbackend::ColumnCount(i % 2 ? 80 : 132) };
+                recorder.measure(0, [&]() { vt.terminal.resizeScreen(newPageSize); });
+            }
+            recorder.finish();
+            vt.terminal.resizeScreen(pageSize);
+        }
+
+        if (options.search)
+        {
+            out << "Running test search ...\n";
+            fillHistory(vt);
+            auto const bottom = vtbackend::CellLocation {
+                vtbackend::LineOffset(unbox<int>(pageSize.lines) - 1),
+                vtbackend::ColumnOffset(0),
+            };
+
+            // The first search builds the scrollback search index, that subsequent searches use.
+            recorder.begin("search_index");
+            recorder.measure(0, [&]() { (void) vt.terminal.searchReverse(U"no such text", bottom); });
+            recorder.finish();
+
+            recorder.begin("search");
+            for ([[maybe_unused]] auto const _: crispy::times(SearchIterations))
+                recorder.measure(0, [&]() { (void) vt.terminal.searchReverse(U"no such text", bottom); });
+            recorder.finish();
+
+            recorder.begin("search_match");
+            for (auto const i: crispy::times(SearchIterations))
+            {
+                auto const term = unicode::convert_to<char32_t>(fmt::format("word{} word{}", i, i + 1));
+                recorder.measure(0, [&]() { (void) vt.terminal.searchReverse(term, bottom); });
+            }
+            recorder.finish();
+
+            // Finds all matches, e.g. for highlighting them.
+            auto constexpr MaxMatchCount = vtbackend::Terminal::MaxSearchMatchCount;
+            recorder.begin("search_all");
+            for (auto const i: crispy::times(SearchIterations))
+            {
+                auto const term = unicode::convert_to<char32_t>(fmt::format("word{}", i));
+                (void) vt.terminal.setNewSearchTerm(term, false);
+                recorder.measure(0, [&]() { (void) vt.terminal.searchAll(MaxMatchCount); });
+            }
+            recorder.finish();
+            vt.terminal.clearSearch();
+
+            auto const indexStats = vt.terminal.primaryScreen().grid().searchIndexStats();
+            out << fmt::format("{:>12}: {} lines, {} trigrams, {} postings\n",
+                               "search index",
+                               indexStats.lines,
+                               indexStats.trigrams,
+                               indexStats.postings);
+        }
+
+        if (rv == EXIT_SUCCESS)
+        {
+            out << fmt::format("{:>12}: {}\n", "history size", *vt.terminal.maxHistoryLineCount());
+            auto const stats = vt.terminal.primaryScreen().grid().historyStats();
+            out << fmt::format("{:>12}: {} hot, {} cold\n", "history", stats.hotLines, stats.coldLines);
+            out << fmt::format("{:>12}: {} bytes ({} bytes saved)\n\n",
+                               "compressed",
+                               stats.compressedBytes,
+                               stats.bytesSaved);
+            rv = reportBenchmark(recorder, options);
+        }
+        return rv;
+    }
+
+    /// Fills the whole history with long, wrapped lines, so that reflow and search have work to do.
+    static void fillHistory(vtbackend::MockTerm<vtpty::MockViewPty>& vt)
+    {
+        auto const lineCount = unbox<size_t>(vt.terminal.maxHistoryLineCount())
+                               + unbox<size_t>(vt.terminal.pageSize().lines);
+        auto text = std::string {};
+        for (auto const i: crispy::times(lineCount / 2))
+        {
+            text += fmt::format("{:06} ", i);
+            for (auto const k: crispy::times(size_t { 20 }))
+                text += fmt::format("word{} ", (i + k) % 97);
+            text += "\r\n";
+        }
+        vt.writeToScreen(text);
+    }
+
+    int benchPtyGrid()
+    {
+        using std::chrono::steady_clock;
+
+        auto const pipelined = parameters().boolean("bench-headless.pty+grid.pipelined");
+
+        auto settings = vtbackend::Settings {};
+        settings.pageSize = vtbackend::PageSize { vtbackend::LineCount(25), vtbackend::ColumnCount(80) };
+        settings.maxHistoryLineCount = vtbackend::LineCount(4000);
+        settings.pipelinedPtyInput = pipelined;
+
+        auto ptyObject = vtpty::createPty(settings.pageSize, std::nullopt);
+        auto& ptySlave = ptyObject->slave();
+        (void) ptySlave.configure();
+        auto const bytesMatch = disableOutputProcessing(ptySlave);
+
+        auto events = vtbackend::Terminal::NullEvents {};
+        auto terminal = vtbackend::Terminal { events, std::move(ptyObject), settings, steady_clock::now() };
+        terminal.setMode(vtbackend::DECMode::AutoWrap, true);
+
+        auto readerThread = std::thread {};
+        if (pipelined)
+            readerThread = std::thread { [&]() {
+                while (terminal.readPtyInputOnce())
+                    ;
+            } };
+        auto parserThread = std::thread { [&]() {
+            while (terminal.processInputOnce())
+                ;
+        } };
+        auto cleanup = crispy::finally { [&]() {
+            terminal.device().close();
+            parserThread.join();
+            if (readerThread.joinable())
+                readerThread.join();
+        } };
+
+        auto const options = benchOptionsFor("pty+grid");
+        auto recorder = BenchRecorder { "pty+grid" };
+        auto& out = options.log();
+
+        if (!bytesMatch)
+            out << "Warning: Bytes read from the PTY may differ from the ones written. "
+                   "Only the time of writing to the PTY is measured.\n";
+
+        // Each chunk is measured until the VT parser has processed it, not only until it has been written.
+        auto bytesWritten = uint64_t { 0 };
+        auto rv = baseBenchmark(
+            [&](char const* a, size_t b) -> bool {
+                auto data = string_view(a, b);
+                while (!data.empty())
+                {
+                    auto const n = ptySlave.write(data);
+                    if (n < 0)
+                        return false;
+                    data.remove_prefix(static_cast<size_t>(n));
+                }
+                bytesWritten += b;
+                while (bytesMatch && terminal.processedInputBytes() < bytesWritten)
+                {
+                    if (terminal.device().isClosed())
+                        return false;
+                    std::this_thread::yield();
+                }
+                return true;
+            },
+            options,
+            pipelined ? "PTY and terminal with screen buffer (pipelined)"
+                      : "PTY and terminal with screen buffer",
+            recorder);
+
+        cleanup.run();
+
+        if (auto const* pipeline = terminal.ptyInputPipeline(); pipeline && rv == EXIT_SUCCESS)
+        {
+            auto const stats = pipeline->stats();
+            auto const stallTime =
+                std::chrono::duration_cast<std::chrono::milliseconds>(stats.producerStallTime);
+            out << "PTY input pipeline\n";
+            out << "------------------\n";
+            out << fmt::format("{:>16}: {}\n", "reads", stats.readCount);
+            out << fmt::format("{:>16}: {}\n", "bytes read", crispy::humanReadableBytes(stats.bytesRead));
+            out << fmt::format("{:>16}: {}\n", "producer stalls", stats.producerStalls);
+            out << fmt::format("{:>16}: {} ms\n", "stall time", stallTime.count());
+            out << fmt::format("{:>16}: {}\n", "consumer waits", stats.consumerWaits);
+            out << fmt::format("{:>16}: {} chunks\n\n", "high watermark", stats.highWatermark);
+        }
+
         if (rv == EXIT_SUCCESS)
-            cout << fmt::format("{:>12}: {}\n\n", "history size", *vt.terminal.maxHistoryLineCount());
+            rv = reportBenchmark(recorder, options);
+
         return rv;
     }
 
-    static int benchPTY()
+    int benchPTY()
     {
         using std::chrono::steady_clock;
         using vtpty::ColumnCount;
@@ -230,6 +1043,10 @@ class ContourHeadlessBench: public crispy::app
         auto constexpr PtyReadSize = 4096;
         auto const benchTime = chrono::seconds(10);
 
+        auto const options = benchOptionsFor("pty");
+        auto recorder = BenchRecorder { "pty" };
+        auto& out = options.log();
+
         // Setup benchmark
         std::string const text = createText(PtyWriteSize);
         unique_ptr<Pty> ptyObject = createPty(PageSize { LineCount(25), ColumnCount(80) }, std::nullopt);
@@ -261,15 +1078,17 @@ class ContourHeadlessBench: public crispy::app
         } };
 
         // Perform benchmark
-        fmt::print("Running PTY benchmark ...\n");
+        out << "Running PTY benchmark ...\n";
+        recorder.begin("pty_write");
         auto const startTime = steady_clock::now();
         auto stopTime = startTime;
         while (stopTime - startTime < benchTime)
         {
             for (int i = 0; i < WritesPerLoop; ++i)
-                (void) ptySlave.write(text);
+                recorder.measure(text.size(), [&]() { return ptySlave.write(text); });
             stopTime = steady_clock::now();
         }
+        recorder.finish();
 
         cleanupReader.run();
 
@@ -280,36 +1099,43 @@ class ContourHeadlessBench: public crispy::app
         auto const mbPerSecs =
             static_cast<long double>(bytesTransferred) / static_cast<long double>(secs.count());
 
-        fmt::print("\n");
-        fmt::print("PTY stdout throughput bandwidth test\n");
-        fmt::print("====================================\n\n");
-        fmt::print("Writes per loop        : {}\n", WritesPerLoop);
-        fmt::print("PTY write size         : {}\n", PtyWriteSize);
-        fmt::print("PTY read size          : {}\n", PtyReadSize);
-        fmt::print("Test time              : {}.{:03} seconds\n", msecs.count() / 1000, msecs.count() % 1000);
-        fmt::print("Data transferred       : {}\n", crispy::humanReadableBytes(bytesTransferred));
-        fmt::print("Reader loop iterations : {}\n", loopIterations);
-        fmt::print(
+        out << "\n";
+        out << "PTY stdout throughput bandwidth test\n";
+        out << "====================================\n\n";
+        out << fmt::format("Writes per loop        : {}\n", WritesPerLoop);
+        out << fmt::format("PTY write size         : {}\n", PtyWriteSize);
+        out << fmt::format("PTY read size          : {}\n", PtyReadSize);
+        out << fmt::format(
+            "Test time              : {}.{:03} seconds\n", msecs.count() / 1000, msecs.count() % 1000);
+        out << fmt::format("Data transferred       : {}\n", crispy::humanReadableBytes(bytesTransferred));
+        out << fmt::format("Reader loop iterations : {}\n", loopIterations);
+        out << fmt::format(
             "Average size per read  : {}\n",
             crispy::humanReadableBytes(static_cast<uint64_t>(static_cast<long double>(bytesTransferred)
                                                              / static_cast<long double>(loopIterations))));
-        fmt::print("Transfer speed         : {} per second\n",
-                   crispy::humanReadableBytes(static_cast<uint64_t>(mbPerSecs)));
+        out << fmt::format("Transfer speed         : {} per second\n\n",
+                           crispy::humanReadableBytes(static_cast<uint64_t>(mbPerSecs)));
 
-        return EXIT_SUCCESS;
+        return reportBenchmark(recorder, options);
     }
 
     int benchParserOnly()
     {
         auto po = vtparser::NullParserEvents {};
         auto parser = vtparser::Parser<vtparser::ParserEvents> { po };
-        return baseBenchmark(
+        auto const options = benchOptionsFor("parser");
+        auto recorder = BenchRecorder { "parser" };
+        auto const rv = baseBenchmark(
             [&](char const* a, size_t b) -> bool {
                 parser.parseFragment(string_view(a, b));
                 return true;
             },
-            benchOptionsFor("parser"),
-            "Parser only");
+            options,
+            "Parser only",
+            recorder);
+        if (rv != EXIT_SUCCESS)
+            return rv;
+        return reportBenchmark(recorder, options);
     }
 };
 
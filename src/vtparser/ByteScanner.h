@@ -0,0 +1,111 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <bit>
+#include <cstdint>
+
+#if defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+    #include <arm_neon.h>
+#endif
+
+namespace vtparser
+{
+
+namespace detail
+{
+    template <uint8_t First, uint8_t Last>
+    constexpr bool isInRange(uint8_t value) noexcept
+    {
+        return static_cast<uint8_t>(value - First) <= static_cast<uint8_t>(Last - First);
+    }
+
+    template <uint8_t First, uint8_t Last>
+    inline char const* findFirstNotInRangeScalar(char const* begin, char const* end) noexcept
+    {
+        while (begin != end && isInRange<First, Last>(static_cast<uint8_t>(*begin)))
+            ++begin;
+        return begin;
+    }
+} // namespace detail
+
+/// Finds the first byte in [begin, end) that is not within the (inclusive) byte range [First, Last].
+///
+/// The range test is done as one unsigned compare of (value - First) against (Last - First),
+/// which maps well onto SIMD lanes. Up to 32 (AVX2) or 16 (SSE2, NEON) bytes are tested at once,
+/// with the remaining tail being tested bytewise.
+///
+/// @returns pointer to the first byte outside the range, or @p end if there is none.
+template <uint8_t First, uint8_t Last>
+char const* findFirstNotInRange(char const* begin, char const* end) noexcept
+{
+    static_assert(First <= Last);
+
+    auto* input = begin;
+
+#if defined(__AVX2__)
+    auto const first = _mm256_set1_epi8(static_cast<char>(First));
+    auto const span = _mm256_set1_epi8(static_cast<char>(Last - First));
+    while (end - input >= 32)
+    {
+        auto const bytes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(input));
+        auto const offset = _mm256_sub_epi8(bytes, first);
+        auto const inRange = _mm256_cmpeq_epi8(_mm256_min_epu8(offset, span), offset);
+        auto const mask = static_cast<uint32_t>(_mm256_movemask_epi8(inRange));
+        if (mask != 0xFFFFFFFFu)
+            return input + std::countr_one(mask);
+        input += 32;
+    }
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+    auto const first128 = _mm_set1_epi8(static_cast<char>(First));
+    auto const span128 = _mm_set1_epi8(static_cast<char>(Last - First));
+    while (end - input >= 16)
+    {
+        auto const bytes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(input));
+        auto const offset = _mm_sub_epi8(bytes, first128);
+        auto const inRange = _mm_cmpeq_epi8(_mm_min_epu8(offset, span128), offset);
+        auto const mask = static_cast<uint32_t>(_mm_movemask_epi8(inRange));
+        if (mask != 0xFFFFu)
+            return input + std::countr_one(mask);
+        input += 16;
+    }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+    auto const first128 = vdupq_n_u8(First);
+    auto const span128 = vdupq_n_u8(Last - First);
+    while (end - input >= 16)
+    {
+        auto const bytes = vld1q_u8(reinterpret_cast<uint8_t const*>(input));
+        auto const inRange = vcleq_u8(vsubq_u8(bytes, first128), span128);
+        // Narrow each 8-bit lane into a 4-bit nibble, so that the result fits into 64 bits.
+        auto const nibbles = vshrn_n_u16(vreinterpretq_u16_u8(inRange), 4);
+        auto const mask = vget_lane_u64(vreinterpret_u64_u8(nibbles), 0);
+        if (mask != ~uint64_t { 0 })
+            return input + (std::countr_one(mask) / 4);
+        input += 16;
+    }
+#endif
+
+    return detail::findFirstNotInRangeScalar<First, Last>(input, end);
+}
+
+/// Finds the end of a run of printable 7-bit US-ASCII characters (SP to '~').
+///
+/// The returned pointer therefore points to either a C0 control code (including ESC),
+/// DEL, the first byte of an UTF-8 sequence, or @p end.
+inline char const* findEndOfPrintableAscii(char const* begin, char const* end) noexcept
+{
+    return findFirstNotInRange<0x20, 0x7E>(begin, end);
+}
+
+/// Finds the end of a run of CSI parameter bytes, that is, digits and the separators ':' and ';'.
+inline char const* findEndOfParameters(char const* begin, char const* end) noexcept
+{
+    return findFirstNotInRange<0x30, 0x3B>(begin, end);
+}
+
+} // namespace vtparser
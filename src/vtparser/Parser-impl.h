@@ -1,5 +1,6 @@
 // SPDX-License-Identifier: Apache-2.0
 #pragma once
+#include <vtparser/ByteScanner.h>
 #include <vtparser/Parser.h>
 
 #include <libunicode/utf8.h>
@@ -326,6 +327,19 @@ void Parser<EventListener, TraceStateChanges>::parseFragment(gsl::span<char cons
 
     while (input != end)
     {
+        if (_state == State::CSI_Param)
+        {
+            input = parseBulkParameters(input, end);
+            if (input == end)
+                break;
+        }
+        else if (_state == State::DCS_PassThrough)
+        {
+            input = parseBulkPassThrough(input, end);
+            if (input == end)
+                break;
+        }
+
         auto const [processKind, processedByteCount] = parseBulkText(input, end);
         switch (processKind)
         {
@@ -361,6 +375,64 @@ void Parser<EventListener, TraceStateChanges>::processOnceViaStateMachine(uint8_
         _eventListener.error("Parser error: Unknown action for state/input pair.");
 }
 
+template <ParserEventsConcept EventListener, bool TraceStateChanges>
+char const* Parser<EventListener, TraceStateChanges>::parseBulkParameters(char const* begin,
+                                                                          char const* end) noexcept
+{
+    // In CSI_Param state, all bytes in 0x30..0x3B are parameter bytes (digits, ':' and ';')
+    // that neither cause a state transition nor anything else than building up the parameter list.
+    auto const* const paramEnd = findEndOfParameters(begin, end);
+    if (paramEnd != begin)
+        _eventListener.param(std::string_view(begin, static_cast<size_t>(std::distance(begin, paramEnd))));
+    return paramEnd;
+}
+
+template <ParserEventsConcept EventListener, bool TraceStateChanges>
+char const* Parser<EventListener, TraceStateChanges>::parseBulkPassThrough(char const* begin,
+                                                                           char const* end) noexcept
+{
+    // In DCS_PassThrough state, all printable characters are put to the hooked handler as they are,
+    // which makes up all of the data string of e.g. Sixel images.
+    auto const* const dataEnd = findEndOfPrintableAscii(begin, end);
+    if (dataEnd != begin)
+        _eventListener.put(std::string_view(begin, static_cast<size_t>(std::distance(begin, dataEnd))));
+    return dataEnd;
+}
+
+template <ParserEventsConcept EventListener, bool TraceStateChanges>
+auto Parser<EventListener, TraceStateChanges>::parseBulkAscii(char const* begin,
+                                                              char const* end,
+                                                              size_t maxCharCount) noexcept -> size_t
+{
+    auto const* input = begin;
+    auto const* asciiEnd = findEndOfPrintableAscii(input, end);
+    if (asciiEnd == input)
+        return 0;
+
+    if (static_cast<size_t>(std::distance(input, asciiEnd)) > maxCharCount)
+        asciiEnd = input + maxCharCount;
+    else if (asciiEnd != end && static_cast<uint8_t>(*asciiEnd) >= 0x80)
+    {
+        // The last US-ASCII character may be the base of a grapheme cluster that continues with the
+        // following non-ASCII codepoint (e.g. a combining mark), so leave it to the grapheme segmenter.
+        --asciiEnd;
+        if (asciiEnd == input)
+            return 0;
+    }
+
+    // Each printable US-ASCII character occupies exactly one grid cell.
+    auto const text = std::string_view(input, static_cast<size_t>(std::distance(input, asciiEnd)));
+    _eventListener.print(text, text.size());
+    _scanState.lastCodepointHint = static_cast<char32_t>(text.back());
+    input = asciiEnd;
+
+    // See parseBulkText() for the `(TEXT LF+)+`-case.
+    if (input != end && *input == '\n')
+        _eventListener.execute(*input++);
+
+    return static_cast<size_t>(std::distance(begin, input));
+}
+
 template <ParserEventsConcept EventListener, bool TraceStateChanges>
 auto Parser<EventListener, TraceStateChanges>::parseBulkText(char const* begin, char const* end) noexcept
     -> std::tuple<ProcessKind, size_t>
@@ -373,6 +445,12 @@ auto Parser<EventListener, TraceStateChanges>::parseBulkText(char const* begin,
     if (!maxCharCount)
         return { ProcessKind::FallbackToFSM, 0 };
 
+    // Fast path for pure 7-bit US-ASCII runs, which do not need any grapheme cluster segmentation,
+    // as long as we are not in the middle of an UTF-8 sequence or following a non-ASCII codepoint.
+    if (_scanState.utf8.expectedLength == 0 && _scanState.lastCodepointHint < 0x80)
+        if (auto const count = parseBulkAscii(input, end, maxCharCount); count != 0)
+            return { ProcessKind::ContinueBulk, count };
+
     _scanState.next = nullptr;
     auto const chunk = std::string_view(input, static_cast<size_t>(std::distance(input, end)));
     auto const [cellCount, subStart, subEnd] = unicode::scan_text(_scanState, chunk, maxCharCount);
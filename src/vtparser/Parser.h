@@ -580,6 +580,12 @@ concept ParserEventsConcept = requires(T& handler, T const& immutable) {
      * extra parameters are silently ignored.
      */
     { handler.param(char {}) } -> std::same_as<void>;
+
+    /**
+     * Bulk variant of param(char), passing a run of parameter characters (digits 0-9 and the
+     * separators ':' and ';') at once.
+     */
+    { handler.param(std::string_view {}) } -> std::same_as<void>;
     { handler.paramDigit(char {}) } -> std::same_as<void>;
     { handler.paramSeparator() } -> std::same_as<void>;
     { handler.paramSubSeparator() } -> std::same_as<void>;
@@ -642,6 +648,12 @@ concept ParserEventsConcept = requires(T& handler, T const& immutable) {
      */
     { handler.put(char {}) } -> std::same_as<void>;
 
+    /**
+     * Bulk variant of put(char), passing a run of printable characters (SP to '~') of the
+     * data string at once.
+     */
+    { handler.put(std::string_view {}) } -> std::same_as<void>;
+
     /**
      * When a device control string is terminated by ST, CAN, SUB or ESC, this
      * action calls the previously selected handler function with an “end of data”
@@ -706,6 +718,9 @@ class Parser
     };
 
     std::tuple<ProcessKind, size_t> parseBulkText(char const* begin, char const* end) noexcept;
+    size_t parseBulkAscii(char const* begin, char const* end, size_t maxCharCount) noexcept;
+    char const* parseBulkParameters(char const* begin, char const* end) noexcept;
+    char const* parseBulkPassThrough(char const* begin, char const* end) noexcept;
     void processOnceViaStateMachine(uint8_t ch);
 
     void handle(ActionClass actionClass, Action action, uint8_t codepoint);
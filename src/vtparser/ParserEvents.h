@@ -88,6 +88,16 @@ class ParserEvents
      */
     virtual void param(char value) = 0;
 
+    /**
+     * Bulk variant of param(char), passing a run of parameter characters (digits 0-9 and the
+     * separators ':' and ';') at once.
+     */
+    virtual void param(std::string_view values)
+    {
+        for (auto const value: values)
+            param(value);
+    }
+
     virtual void paramDigit(char /*_char*/) = 0;
     virtual void paramSeparator() = 0;
     virtual void paramSubSeparator() = 0;
@@ -146,6 +156,16 @@ class ParserEvents
      */
     virtual void put(char value) = 0;
 
+    /**
+     * Bulk variant of put(char), passing a run of printable characters (SP to '~') of the
+     * data string at once.
+     */
+    virtual void put(std::string_view values)
+    {
+        for (auto const value: values)
+            put(value);
+    }
+
     /**
      * When a device control string is terminated by ST, CAN, SUB or ESC, this action calls the
      * previously selected handler function with an “end of data” parameter. This allows the
@@ -177,6 +197,7 @@ class NullParserEvents: public ParserEvents
     void collect(char) override {}
     void collectLeader(char) override {}
     void param(char) override {}
+    void param(std::string_view) override {}
     void paramDigit(char /*_char*/) override {}
     void paramSeparator() override {}
     void paramSubSeparator() override {}
@@ -187,6 +208,7 @@ class NullParserEvents: public ParserEvents
     void dispatchOSC() override {}
     void hook(char) override {}
     void put(char) override {}
+    void put(std::string_view) override {}
     void unhook() override {}
     void startAPC() override {}
     void putAPC(char) override {}
@@ -14,6 +14,10 @@ class MockParserEvents final: public vtparser::NullParserEvents
     std::string text;
     std::string apc;
     std::string pm;
+    std::string params;
+    std::string executed;
+    std::string dcs;
+    size_t dcsBulkCount = 0;
     size_t maxCharCount = 80;
 
     void error(string_view const& msg) override { INFO(fmt::format("Parser error received. {}", msg)); }
@@ -24,6 +28,18 @@ class MockParserEvents final: public vtparser::NullParserEvents
         return maxCharCount -= cellCount;
     }
 
+    void execute(char ch) override { executed += ch; }
+    void param(char ch) override { params += ch; }
+    void param(std::string_view chars) override { params += chars; }
+    void paramDigit(char ch) override { params += ch; }
+    void paramSeparator() override { params += ';'; }
+    void paramSubSeparator() override { params += ':'; }
+    void dispatchCSI(char ch) override
+    {
+        params += ch;
+        params += '|';
+    }
+
     void startAPC() override { apc += "{"; }
     void putAPC(char ch) override { apc += ch; }
     void dispatchAPC() override { apc += "}"; }
@@ -31,6 +47,19 @@ class MockParserEvents final: public vtparser::NullParserEvents
     void startPM() override { pm += "{"; }
     void putPM(char ch) override { pm += ch; }
     void dispatchPM() override { pm += "}"; }
+
+    void hook(char ch) override
+    {
+        dcs += ch;
+        dcs += '{';
+    }
+    void put(char ch) override { dcs += ch; }
+    void put(std::string_view chars) override
+    {
+        dcs += chars;
+        ++dcsBulkCount;
+    }
+    void unhook() override { dcs += '}'; }
 };
 
 TEST_CASE("Parser.utf8_single", "[Parser]")
@@ -65,3 +94,43 @@ TEST_CASE("Parser.APC")
     REQUIRE(listener.apc == "{Gi=1,a=q;}");
     REQUIRE(listener.text == "ABCDEF");
 }
+
+TEST_CASE("Parser.bulk_ascii")
+{
+    MockParserEvents listener;
+    auto p = vtparser::Parser<vtparser::ParserEvents>(listener);
+    p.parseFragment(std::string(100, 'a') + "\r\n");
+    CHECK(p.state() == vtparser::State::Ground);
+    CHECK(listener.text == std::string(100, 'a'));
+    CHECK(listener.executed == "\r\n");
+}
+
+TEST_CASE("Parser.bulk_ascii_followed_by_combining_mark")
+{
+    MockParserEvents listener;
+    auto p = vtparser::Parser<vtparser::ParserEvents>(listener);
+    p.parseFragment("abcde\xCC\x81" "f"sv); // e + U+0301 (combining acute accent)
+    CHECK(p.state() == vtparser::State::Ground);
+    CHECK(listener.text == "abcde\xCC\x81" "f");
+}
+
+TEST_CASE("Parser.bulk_parameters")
+{
+    MockParserEvents listener;
+    auto p = vtparser::Parser<vtparser::ParserEvents>(listener);
+    p.parseFragment("A\033[1;38:2::255:128:0mB\033[12;34HC"sv);
+    CHECK(p.state() == vtparser::State::Ground);
+    CHECK(listener.text == "ABC");
+    CHECK(listener.params == "1;38:2::255:128:0m|12;34H|");
+}
+
+TEST_CASE("Parser.bulk_pass_through")
+{
+    MockParserEvents listener;
+    auto p = vtparser::Parser<vtparser::ParserEvents>(listener);
+    p.parseFragment("A\033Pq#0;2;0;0;0#0!20~-\r\n~~@@\033\\B"sv);
+    CHECK(p.state() == vtparser::State::Ground);
+    CHECK(listener.text == "AB");
+    CHECK(listener.dcs == "q{#0;2;0;0;0#0!20~-\r\n~~@@}");
+    CHECK(listener.dcsBulkCount == 2);
+}
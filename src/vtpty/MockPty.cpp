@@ -38,10 +38,26 @@ void MockPty::wakeupReader()
 int MockPty::write(std::string_view data)
 {
     // Writing into stdin.
-    _inputBuffer += std::string_view(data.data(), data.size());
+    if (_inputBlocked || !_pendingInput.empty())
+        _pendingInput += data;
+    else
+        _inputBuffer += data;
     return static_cast<int>(data.size());
 }
 
+void MockPty::setWriteDrainedCallback(std::function<void()> callback)
+{
+    _writeDrained = std::move(callback);
+}
+
+void MockPty::drainInput()
+{
+    _inputBuffer += _pendingInput;
+    _pendingInput.clear();
+    if (_writeDrained)
+        _writeDrained();
+}
+
 PageSize MockPty::pageSize() const noexcept
 {
     return _pageSize;
@@ -5,6 +5,7 @@
 
 #include <crispy/BufferObject.h>
 
+#include <functional>
 #include <string>
 
 namespace vtpty
@@ -23,6 +24,8 @@ class MockPty: public Pty
                                                  size_t size) override;
     void wakeupReader() override;
     int write(std::string_view data) override;
+    [[nodiscard]] size_t pendingWriteBytes() const noexcept override { return _pendingInput.size(); }
+    void setWriteDrainedCallback(std::function<void()> callback) override;
     [[nodiscard]] PageSize pageSize() const noexcept override;
     void resizeScreen(PageSize cells, std::optional<ImageSize> pixels = std::nullopt) override;
 
@@ -34,6 +37,12 @@ class MockPty: public Pty
     [[nodiscard]] std::string& stdinBuffer() noexcept { return _inputBuffer; }
     [[nodiscard]] std::string const& stdinBuffer() const noexcept { return _inputBuffer; }
 
+    /// Simulates the application not reading its input, so that written data is queued instead.
+    void setInputBlocked(bool blocked) noexcept { _inputBlocked = blocked; }
+
+    /// Lets the application read the queued data, invoking the write-drained callback.
+    void drainInput();
+
     [[nodiscard]] bool isStdoutDataAvailable() const noexcept
     {
         return _outputReadOffset < _outputBuffer.size();
@@ -56,6 +65,9 @@ class MockPty: public Pty
     PageSize _pageSize;
     std::optional<ImageSize> _pixelSize;
     std::string _inputBuffer;
+    std::string _pendingInput; // written while the input is blocked
+    bool _inputBlocked = false;
+    std::function<void()> _writeDrained;
     std::string _outputBuffer;
     std::size_t _outputReadOffset = 0;
     bool _closed = false;
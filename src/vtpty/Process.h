@@ -98,6 +98,12 @@ class [[nodiscard]] Process: public Pty
     [[nodiscard]] std::optional<ReadResult> read(crispy::buffer_object<char>& storage, std::optional<std::chrono::milliseconds> timeout, size_t n) override { return pty().read(storage, timeout, n); }
     void wakeupReader() override { pty().wakeupReader(); }
     [[nodiscard]] int write(std::string_view data) override { return pty().write(data); }
+    [[nodiscard]] std::optional<int> pollHandle() const noexcept override { return pty().pollHandle(); }
+    [[nodiscard]] size_t pendingWriteBytes() const noexcept override { return pty().pendingWriteBytes(); }
+    void setWriteDrainedCallback(std::function<void()> callback) override
+    {
+        pty().setWriteDrainedCallback(std::move(callback));
+    }
     [[nodiscard]] PageSize pageSize() const noexcept override { return pty().pageSize(); }
     void resizeScreen(PageSize cells, std::optional<ImageSize> pixels = std::nullopt) override { pty().resizeScreen(cells, pixels); }
     // clang-format on
@@ -8,6 +8,7 @@
 #include <crispy/logstore.h>
 
 #include <chrono>
+#include <functional>
 #include <optional>
 #include <string_view>
 
@@ -100,11 +101,30 @@ class Pty
 
     /// Writes to the PTY device, so the other end can read from it.
     ///
+    /// Implementations may queue the data that the PTY device does not accept without blocking.
+    /// Queued data is then written from within read(), as soon as the PTY device accepts it.
+    /// Once the queue is full, only part of the data may be accepted, and the caller is expected
+    /// to write the rest again after the queue has been drained.
+    ///
     /// @param buf      Buffer of data to be written.
     ///
-    /// @returns Number of bytes written or -1 on error.
+    /// @returns Number of bytes written (or queued) or -1 on error.
     [[nodiscard]] virtual int write(std::string_view buf) = 0;
 
+    /// Returns a native handle that is readable whenever read() would not block, if supported.
+    ///
+    /// This allows waiting for many PTYs on a single thread (see PtyReactor),
+    /// each one then being read from with a zero timeout.
+    [[nodiscard]] virtual std::optional<int> pollHandle() const noexcept { return std::nullopt; }
+
+    /// Returns the number of bytes accepted by write() that have not yet been written to the PTY device.
+    [[nodiscard]] virtual size_t pendingWriteBytes() const noexcept { return 0; }
+
+    /// Sets the callback to be invoked once all data queued by write() has been written to the PTY device.
+    ///
+    /// The callback is invoked from within the thread calling read().
+    virtual void setWriteDrainedCallback(std::function<void()> /*callback*/) {}
+
     /// @returns current underlying window size in characters width and height.
     [[nodiscard]] virtual PageSize pageSize() const noexcept = 0;
 
@@ -0,0 +1,190 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtpty/PtyInputPipeline.h>
+
+#include <cerrno>
+#include <cstring>
+
+using std::chrono::steady_clock;
+
+namespace vtpty
+{
+
+PtyInputPipeline::PtyInputPipeline(Pty& pty,
+                                   crispy::buffer_object_pool<char>& bufferPool,
+                                   size_t readBufferSize,
+                                   size_t minimumBufferSpace,
+                                   size_t queueCapacity):
+    _pty { pty },
+    _bufferPool { bufferPool },
+    _readBufferSize { readBufferSize },
+    _minimumBufferSpace { minimumBufferSpace },
+    _queue { queueCapacity }
+{
+}
+
+bool PtyInputPipeline::readOnce()
+{
+    if (_closed)
+        return false;
+
+    // Request a new Buffer Object if the current one cannot sufficiently
+    // store a single text line.
+    if (!_buffer || _buffer->bytesAvailable() < _minimumBufferSpace)
+    {
+        if (ptyInLog)
+            ptyInLog()("Allocating new buffer object from pool for the PTY input pipeline.");
+        _buffer = _bufferPool.allocateBufferObject();
+    }
+
+    auto const readResult = _pty.read(*_buffer, std::nullopt, _readBufferSize);
+    if (!readResult)
+    {
+        if (errno == EINTR || errno == EAGAIN)
+            return !_closed;
+
+        ptyLog()("PTY read failed. {}", strerror(errno));
+        close();
+        return false;
+    }
+
+    if (readResult->data.empty())
+    {
+        ptyLog()("PTY read returned with zero bytes. Closing PTY input pipeline.");
+        close();
+        return false;
+    }
+
+    // Unlike the direct read path, the data must not be overwritten by the next read
+    // while the parser is still working on it, so we claim it right away.
+    _buffer->advance(readResult->data.size());
+
+    _readCount.fetch_add(1, std::memory_order_relaxed);
+    _bytesRead.fetch_add(readResult->data.size(), std::memory_order_relaxed);
+
+    auto chunk = PtyInputChunk { _buffer, readResult->data, readResult->fromStdoutFastPipe };
+    return push(chunk);
+}
+
+bool PtyInputPipeline::push(PtyInputChunk& chunk)
+{
+    if (!_queue.try_push(chunk))
+    {
+        // Backpressure: the parser cannot keep up, so wait for it to make room.
+        _producerStalls.fetch_add(1, std::memory_order_relaxed);
+        auto const stallStart = steady_clock::now();
+
+        auto enqueued = false;
+        auto lock = std::unique_lock { _mutex };
+        _producerWaiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while (!_closed && !(enqueued = _queue.try_push(chunk)))
+            _queueNotFull.wait(lock, [this]() { return _closed || _queue.size() < _queue.capacity(); });
+        _producerWaiting = false;
+        lock.unlock();
+
+        _producerStallTime.fetch_add(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(steady_clock::now() - stallStart).count(),
+            std::memory_order_relaxed);
+
+        if (!enqueued)
+            return false; // The pipeline has been closed while waiting.
+    }
+
+    auto const queued = static_cast<uint64_t>(_queue.size());
+    if (queued > _highWatermark.load(std::memory_order_relaxed))
+        _highWatermark.store(queued, std::memory_order_relaxed);
+
+    notifyConsumer();
+    return true;
+}
+
+std::optional<PtyInputChunk> PtyInputPipeline::pop(std::optional<std::chrono::milliseconds> timeout)
+{
+    if (auto chunk = _queue.try_pop(); chunk.has_value())
+    {
+        notifyProducer();
+        return chunk;
+    }
+
+    _consumerWaits.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        auto lock = std::unique_lock { _mutex };
+        _consumerWaiting = true;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto const ready = [this]() { return _wakeupRequested || _closed || !_queue.empty(); };
+        if (timeout.has_value())
+            _queueNotEmpty.wait_for(lock, *timeout, ready);
+        else
+            _queueNotEmpty.wait(lock, ready);
+        _consumerWaiting = false;
+        _wakeupRequested = false;
+    }
+
+    if (auto chunk = _queue.try_pop(); chunk.has_value())
+    {
+        notifyProducer();
+        return chunk;
+    }
+
+    if (_closed)
+        return PtyInputChunk {}; // End of input.
+
+    return std::nullopt;
+}
+
+void PtyInputPipeline::wakeupConsumer()
+{
+    {
+        auto const _ = std::lock_guard { _mutex };
+        _wakeupRequested = true;
+    }
+    _queueNotEmpty.notify_one();
+}
+
+void PtyInputPipeline::close()
+{
+    {
+        auto const _ = std::lock_guard { _mutex };
+        _closed = true;
+    }
+    _queueNotEmpty.notify_all();
+    _queueNotFull.notify_all();
+    _pty.wakeupReader();
+}
+
+void PtyInputPipeline::notifyConsumer()
+{
+    // Pairs with the fence in pop(), so that either we see the consumer waiting,
+    // or the consumer sees the chunk we have just enqueued.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_consumerWaiting)
+    {
+        auto const _ = std::lock_guard { _mutex };
+        _queueNotEmpty.notify_one();
+    }
+}
+
+void PtyInputPipeline::notifyProducer()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (_producerWaiting)
+    {
+        auto const _ = std::lock_guard { _mutex };
+        _queueNotFull.notify_one();
+    }
+}
+
+PtyInputPipelineStats PtyInputPipeline::stats() const noexcept
+{
+    return PtyInputPipelineStats {
+        .readCount = _readCount.load(std::memory_order_relaxed),
+        .bytesRead = _bytesRead.load(std::memory_order_relaxed),
+        .producerStalls = _producerStalls.load(std::memory_order_relaxed),
+        .consumerWaits = _consumerWaits.load(std::memory_order_relaxed),
+        .highWatermark = _highWatermark.load(std::memory_order_relaxed),
+        .producerStallTime = std::chrono::nanoseconds(_producerStallTime.load(std::memory_order_relaxed)),
+    };
+}
+
+} // namespace vtpty
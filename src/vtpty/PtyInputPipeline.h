@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <vtpty/Pty.h>
+
+#include <crispy/BufferObject.h>
+#include <crispy/spsc_ring.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string_view>
+
+namespace vtpty
+{
+
+/// A chunk of data that has been read from the PTY by the PTY reader thread.
+struct PtyInputChunk
+{
+    /// The buffer object the data has been read into. It keeps the data alive while being parsed.
+    crispy::buffer_object_ptr<char> buffer {};
+    std::string_view data {};
+    bool fromStdoutFastPipe = false;
+};
+
+/// Snapshot of the counters of a PtyInputPipeline.
+struct PtyInputPipelineStats
+{
+    uint64_t readCount = 0;        ///< Number of non-empty reads from the PTY.
+    uint64_t bytesRead = 0;        ///< Total number of bytes read from the PTY.
+    uint64_t producerStalls = 0;   ///< Number of times the reader had to wait for the parser (queue full).
+    uint64_t consumerWaits = 0;    ///< Number of times the parser had to wait for the reader (queue empty).
+    uint64_t highWatermark = 0;    ///< Maximum number of chunks that have been queued at once.
+    std::chrono::nanoseconds producerStallTime {}; ///< Total time the reader has been blocked by the parser.
+};
+
+/**
+ * Decouples reading from the PTY from parsing the read data.
+ *
+ * A dedicated reader thread repeatedly calls readOnce(), which does nothing but drain the PTY
+ * into buffer objects and enqueue the read chunks into a lock-free single-producer/single-consumer
+ * ring. The parsing thread dequeues them via pop().
+ *
+ * This way the kernel's PTY buffer keeps being drained while the parser is held up, e.g. by the
+ * terminal lock being held for GUI snapshotting.
+ *
+ * Either side only blocks if the ring is full (backpressure onto the reader, and thus onto the
+ * client application) or empty, respectively.
+ */
+class PtyInputPipeline
+{
+  public:
+    /// @param pty                Source PTY to read from.
+    /// @param bufferPool         Pool to allocate buffer objects from. Must be safe to use across threads.
+    /// @param readBufferSize     Maximum number of bytes to read from the PTY at once.
+    /// @param minimumBufferSpace Minimum number of free bytes a buffer object must have to be read into.
+    /// @param queueCapacity      Maximum number of chunks that can be queued before the reader blocks.
+    PtyInputPipeline(Pty& pty,
+                     crispy::buffer_object_pool<char>& bufferPool,
+                     size_t readBufferSize,
+                     size_t minimumBufferSpace,
+                     size_t queueCapacity);
+
+    /// Reads once from the PTY and enqueues the read data.
+    ///
+    /// This must only be called from the PTY reader thread.
+    /// It blocks until data is available on the PTY and, if the queue is full, until space is available.
+    ///
+    /// @retval true  more data may be read.
+    /// @retval false the PTY has been closed or the pipeline has been shut down.
+    bool readOnce();
+
+    /// Dequeues the next chunk, waiting for up to the given timeout if none is available yet.
+    ///
+    /// This must only be called from the parsing thread.
+    ///
+    /// @returns the next chunk, or a chunk with empty data if the pipeline is closed and drained,
+    ///          or std::nullopt if the timeout has passed or wakeupConsumer() has been called.
+    [[nodiscard]] std::optional<PtyInputChunk> pop(std::optional<std::chrono::milliseconds> timeout);
+
+    /// Interrupts a pop() call that is currently waiting, or else the next one.
+    void wakeupConsumer();
+
+    /// Shuts down the pipeline, waking up both, the reader and the parsing thread.
+    void close();
+
+    [[nodiscard]] bool isClosed() const noexcept { return _closed.load(); }
+
+    /// Returns the number of chunks currently queued.
+    [[nodiscard]] size_t size() const noexcept { return _queue.size(); }
+
+    [[nodiscard]] PtyInputPipelineStats stats() const noexcept;
+
+  private:
+    bool push(PtyInputChunk& chunk);
+    void notifyConsumer();
+    void notifyProducer();
+
+    Pty& _pty;
+    crispy::buffer_object_pool<char>& _bufferPool;
+    crispy::buffer_object_ptr<char> _buffer; // Buffer object the reader thread currently reads into.
+    size_t _readBufferSize;
+    size_t _minimumBufferSpace;
+    crispy::spsc_ring<PtyInputChunk> _queue;
+
+    // Only used to put either side to sleep, never on the fast path.
+    std::mutex _mutex;
+    std::condition_variable _queueNotEmpty;
+    std::condition_variable _queueNotFull;
+    std::atomic<bool> _consumerWaiting = false;
+    std::atomic<bool> _producerWaiting = false;
+    bool _wakeupRequested = false; // guarded by _mutex
+    std::atomic<bool> _closed = false;
+
+    std::atomic<uint64_t> _readCount = 0;
+    std::atomic<uint64_t> _bytesRead = 0;
+    std::atomic<uint64_t> _producerStalls = 0;
+    std::atomic<uint64_t> _consumerWaits = 0;
+    std::atomic<uint64_t> _highWatermark = 0;
+    std::atomic<int64_t> _producerStallTime = 0; // in nanoseconds
+};
+
+} // namespace vtpty
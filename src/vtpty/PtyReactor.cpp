@@ -0,0 +1,192 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtpty/Pty.h>
+#include <vtpty/PtyReactor.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include <pthread.h>
+
+namespace vtpty
+{
+
+namespace
+{
+    void setThreadName(char const* name)
+    {
+#if defined(__APPLE__)
+        pthread_setname_np(name);
+#else
+        pthread_setname_np(pthread_self(), name);
+#endif
+    }
+} // namespace
+
+PtyReactor::PtyReactor(size_t workerCount)
+{
+    _dispatcher = std::thread([this]() { dispatcherLoop(); });
+    for (size_t i = 0; i < std::max(workerCount, size_t { 1 }); ++i)
+        _workers.emplace_back([this]() { workerLoop(); });
+}
+
+PtyReactor::~PtyReactor()
+{
+    {
+        auto const _ = std::scoped_lock { _mutex };
+        _stopping = true;
+    }
+    _jobAvailable.notify_all();
+    _selector.wakeup();
+
+    _dispatcher.join();
+    for (auto& worker: _workers)
+        worker.join();
+}
+
+void PtyReactor::add(int pollHandle, Handler handler)
+{
+    auto entry = std::make_shared<Entry>();
+    entry->pollHandle = pollHandle;
+    entry->handler = std::move(handler);
+
+    auto const _ = std::scoped_lock { _mutex };
+    assert(!_entries.contains(pollHandle));
+    _entries[pollHandle] = entry;
+    _waitRequests.emplace_back(std::move(entry));
+    _selector.wakeup();
+}
+
+void PtyReactor::remove(int pollHandle)
+{
+    auto lock = std::unique_lock { _mutex };
+    auto const i = _entries.find(pollHandle);
+    if (i == _entries.end())
+        return;
+
+    auto const entry = i->second;
+    _entries.erase(i);
+    entry->removed = true;
+    _jobs.erase(std::remove(_jobs.begin(), _jobs.end(), entry), _jobs.end());
+    if (entry->waitedFor)
+    {
+        _cancelRequests.emplace_back(entry);
+        _selector.wakeup();
+    }
+
+    // Waiting for the handler to return from within that very handler would never return.
+    if (entry->running && entry->runningThread == std::this_thread::get_id())
+    {
+        ptyLog()("PTY reactor: removed poll handle {} from within its handler.", pollHandle);
+        return;
+    }
+
+    _entryIdle.wait(lock, [&]() { return !entry->running && !entry->waitedFor; });
+    ptyLog()("PTY reactor: removed poll handle {}.", pollHandle);
+}
+
+PtyReactorStats PtyReactor::stats() const
+{
+    auto const _ = std::scoped_lock { _mutex };
+    return PtyReactorStats { .ptyCount = _entries.size(),
+                             .workerCount = _workers.size(),
+                             .wakeupCount = _wakeupCount.load(),
+                             .dispatchCount = _dispatchCount.load() };
+}
+
+void PtyReactor::applySelectorChanges()
+{
+    // Cancellations go first, as a poll handle may have been reused by a newly added PTY meanwhile.
+    for (auto const& entry: _cancelRequests)
+    {
+        if (!entry->waitedFor)
+            continue;
+        _selector.cancel_read(entry->pollHandle);
+        entry->waitedFor = false;
+    }
+    if (!_cancelRequests.empty())
+        _entryIdle.notify_all();
+    _cancelRequests.clear();
+
+    for (auto const& entry: _waitRequests)
+    {
+        if (entry->removed || entry->waitedFor)
+            continue;
+        _selector.want_read(entry->pollHandle);
+        entry->waitedFor = true;
+    }
+    _waitRequests.clear();
+}
+
+void PtyReactor::dispatcherLoop()
+{
+    setThreadName("PtyReactor");
+
+    while (true)
+    {
+        {
+            auto const _ = std::scoped_lock { _mutex };
+            if (_stopping)
+                return;
+            applySelectorChanges();
+        }
+
+        auto const pollHandle = _selector.wait_one();
+        _wakeupCount.fetch_add(1, std::memory_order_relaxed);
+        if (!pollHandle.has_value())
+            continue;
+
+        auto const _ = std::scoped_lock { _mutex };
+        auto const i = _entries.find(*pollHandle);
+        if (i == _entries.end() || !i->second->waitedFor)
+            continue; // Removed (and cancelled on the next iteration) or already being processed.
+
+        // Stop waiting for the PTY while it is being processed, as the poll handle stays ready
+        // until its input has been processed.
+        auto const& entry = i->second;
+        _selector.cancel_read(entry->pollHandle);
+        entry->waitedFor = false;
+        _jobs.emplace_back(entry);
+        _dispatchCount.fetch_add(1, std::memory_order_relaxed);
+        _jobAvailable.notify_one();
+    }
+}
+
+void PtyReactor::workerLoop()
+{
+    setThreadName("PtyReactor.Work");
+
+    while (true)
+    {
+        auto entry = EntryPtr {};
+        {
+            auto lock = std::unique_lock { _mutex };
+            _jobAvailable.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+            if (_stopping)
+                return;
+            entry = std::move(_jobs.front());
+            _jobs.pop_front();
+            entry->running = true;
+            entry->runningThread = std::this_thread::get_id();
+        }
+
+        auto const keepWaiting = entry->handler();
+
+        auto const _ = std::scoped_lock { _mutex };
+        entry->running = false;
+        if (entry->removed)
+            _entryIdle.notify_all();
+        else if (!keepWaiting)
+        {
+            ptyLog()("PTY reactor: poll handle {} has been closed.", entry->pollHandle);
+            entry->removed = true;
+            _entries.erase(entry->pollHandle);
+        }
+        else
+        {
+            _waitRequests.emplace_back(std::move(entry));
+            _selector.wakeup();
+        }
+    }
+}
+
+} // namespace vtpty
@@ -0,0 +1,106 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <crispy/read_selector.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vtpty
+{
+
+/// Snapshot of the counters of a PtyReactor.
+struct PtyReactorStats
+{
+    size_t ptyCount = 0;        ///< Number of currently registered PTYs.
+    size_t workerCount = 0;     ///< Number of worker threads.
+    uint64_t wakeupCount = 0;   ///< Number of times the dispatcher thread has woken up.
+    uint64_t dispatchCount = 0; ///< Number of times a ready PTY has been handed over to a worker thread.
+};
+
+/**
+ * Waits for many PTYs on a single thread and processes the ready ones on a small pool of worker threads.
+ *
+ * This replaces a dedicated, mostly sleeping, input processing thread per terminal session.
+ * Each PTY is registered with its poll handle (see Pty::pollHandle()) and a handler that processes
+ * its input without blocking.
+ *
+ * The dispatcher thread waits for the poll handles using crispy::read_selector, i.e. epoll on Linux.
+ * A PTY is not waited for while being processed, so that its handler never runs concurrently with itself.
+ */
+class PtyReactor
+{
+  public:
+    /// Processes the input of a ready PTY without blocking.
+    ///
+    /// @retval true  the PTY is to be waited for again.
+    /// @retval false the PTY has been closed, and is unregistered.
+    using Handler = std::function<bool()>;
+
+    explicit PtyReactor(size_t workerCount);
+    ~PtyReactor();
+
+    PtyReactor(PtyReactor const&) = delete;
+    PtyReactor(PtyReactor&&) = delete;
+    PtyReactor& operator=(PtyReactor const&) = delete;
+    PtyReactor& operator=(PtyReactor&&) = delete;
+
+    /// Registers the poll handle of a PTY along with the handler to process it once ready.
+    void add(int pollHandle, Handler handler);
+
+    /// Unregisters the given poll handle, waiting for its handler to return if currently running.
+    ///
+    /// When called from within the handler of that very poll handle, it does not wait,
+    /// and the handler is not invoked anymore once it has returned.
+    void remove(int pollHandle);
+
+    [[nodiscard]] PtyReactorStats stats() const;
+
+  private:
+    struct Entry
+    {
+        int pollHandle = -1;
+        Handler handler;
+        bool waitedFor = false; // Whether or not the poll handle is in the selector.
+        bool running = false;
+        std::thread::id runningThread {}; // The worker thread running the handler, if running.
+        bool removed = false;
+    };
+    using EntryPtr = std::shared_ptr<Entry>;
+
+    void dispatcherLoop();
+    void workerLoop();
+
+    /// Applies the requested changes to the set of poll handles waited for.
+    ///
+    /// This must only be called from the dispatcher thread, with _mutex held.
+    void applySelectorChanges();
+
+    // Only accessed from the dispatcher thread, except for wakeup().
+    crispy::read_selector _selector;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _jobAvailable;
+    std::condition_variable _entryIdle;
+    std::unordered_map<int, EntryPtr> _entries; // guarded by _mutex
+    std::vector<EntryPtr> _waitRequests;        // guarded by _mutex
+    std::vector<EntryPtr> _cancelRequests;      // guarded by _mutex
+    std::deque<EntryPtr> _jobs;                 // guarded by _mutex
+    bool _stopping = false;                     // guarded by _mutex
+
+    std::atomic<uint64_t> _wakeupCount = 0;
+    std::atomic<uint64_t> _dispatchCount = 0;
+
+    std::thread _dispatcher;
+    std::vector<std::thread> _workers;
+};
+
+} // namespace vtpty
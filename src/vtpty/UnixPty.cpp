@@ -302,18 +302,37 @@ std::optional<Pty::ReadResult> UnixPty::read(crispy::buffer_object<char>& storag
 {
     assert(_readSelector.size() > 0);
 
-    if (auto const fd = _readSelector.wait_one(timeout); fd.has_value())
+    // Also wait for the PTY device to become writable, as long as there is queued data to write.
+    // Closing the PTY device has already stopped waiting for it altogether.
+    if (_masterFd.is_closed())
+        _waitingForWritable = false;
+    else if (auto const wantWritable = _pendingWriteBytes.load() != 0; wantWritable != _waitingForWritable)
+    {
+        if (wantWritable)
+            _readSelector.want_write(_masterFd);
+        else
+            _readSelector.cancel_write(_masterFd);
+        _waitingForWritable = wantWritable;
+    }
+
+    auto const fd = _readSelector.wait_one(timeout);
+    auto const savedErrno = errno;
+
+    if (_waitingForWritable && _readSelector.consume_writable(_masterFd))
+        flushPendingWrites();
+
+    if (fd.has_value())
     {
         auto const l = scoped_lock { storage };
         if (auto x = readSome(*fd, storage.hotEnd(), std::min(size, storage.bytesAvailable())))
             return ReadResult { .data = x.value(), .fromStdoutFastPipe = *fd == _stdoutFastPipe.reader() };
     }
     else
-        errno = EAGAIN;
+        errno = savedErrno == EINTR ? EINTR : EAGAIN;
     return std::nullopt;
 }
 
-int UnixPty::write(std::string_view data)
+ssize_t UnixPty::writeSome(std::string_view data) noexcept
 {
     auto const* buf = data.data();
     auto const size = data.size();
@@ -335,20 +354,98 @@ int UnixPty::write(std::string_view data)
         // clang-format on
     }
 
-    if (0 <= rv && static_cast<size_t>(rv) < size)
+    return rv;
+}
+
+int UnixPty::write(std::string_view data)
+{
+    auto const _ = scoped_lock { _writeMutex };
+
+    // Data must not overtake the data queued earlier.
+    auto written = size_t { 0 };
+    if (_pendingWriteBytes.load() == 0)
+    {
+        auto const rv = writeSome(data);
+        if (rv < 0 && errno != EAGAIN && errno != EINTR)
+            return -1;
+        written = static_cast<size_t>(std::max(rv, ssize_t { 0 }));
+    }
+
+    // The rest is written from within read(), once the PTY device accepts more data.
+    // Beyond the high-water mark, it is left to the caller to write it again later on.
+    auto const pendingBytes = _pendingWriteBytes.load();
+    auto const freeBytes = MaxPendingWriteBytes - std::min(pendingBytes, MaxPendingWriteBytes);
+    auto const queued = std::min(data.size() - written, freeBytes);
+    if (queued != 0)
     {
-        util::setFileBlocking(_masterFd, true);
-        auto const rv2 = ::write(_masterFd, buf + rv, size - rv);
-        util::setFileBlocking(_masterFd, false);
-        if (rv2 >= 0)
+        _pendingWrites.append(data.substr(written, queued));
+        _pendingWriteBytes = _pendingWrites.size() - _pendingWritesOffset;
+        wakeupReader();
+    }
+
+    if (written + queued < data.size())
+        ptyOutLog()("Write queue full. {} of {} bytes accepted.", written + queued, data.size());
+
+    return static_cast<int>(written + queued);
+}
+
+void UnixPty::flushPendingWrites()
+{
+    auto drained = std::function<void()> {};
+    {
+        auto const _ = scoped_lock { _writeMutex };
+        auto const rv = writeSome(std::string_view(_pendingWrites).substr(_pendingWritesOffset));
+        if (rv < 0 && (errno == EAGAIN || errno == EINTR))
+            return;
+
+        if (rv < 0)
+        {
+            // The data cannot be delivered anymore, e.g. because the other end has been closed.
+            errorLog()("Discarding {} bytes that could not be written to the PTY. {}",
+                       _pendingWriteBytes.load(),
+                       strerror(errno));
+            _pendingWritesOffset = _pendingWrites.size();
+        }
+        else
+            _pendingWritesOffset += static_cast<size_t>(rv);
+
+        if (_pendingWritesOffset == _pendingWrites.size())
         {
-            if (ptyOutLog)
-                ptyOutLog()("Sending bytes: \"{}\"", crispy::escape(buf + rv, buf + rv + rv2));
-            return static_cast<int>(rv + rv2);
+            _pendingWrites.clear();
+            _pendingWritesOffset = 0;
+            drained = _writeDrained;
         }
+        else if (_pendingWritesOffset >= _pendingWrites.size() / 2)
+        {
+            _pendingWrites.erase(0, _pendingWritesOffset);
+            _pendingWritesOffset = 0;
+        }
+        _pendingWriteBytes = _pendingWrites.size() - _pendingWritesOffset;
     }
 
-    return static_cast<int>(rv);
+    if (drained)
+        drained();
+}
+
+std::optional<int> UnixPty::pollHandle() const noexcept
+{
+#if defined(__linux__)
+    // The epoll file descriptor also covers the stdout fast pipe, wakeups, and pending writes.
+    return _readSelector.native_handle();
+#else
+    return std::nullopt;
+#endif
+}
+
+size_t UnixPty::pendingWriteBytes() const noexcept
+{
+    return _pendingWriteBytes.load();
+}
+
+void UnixPty::setWriteDrainedCallback(std::function<void()> callback)
+{
+    auto const _ = scoped_lock { _writeMutex };
+    _writeDrained = std::move(callback);
 }
 
 PageSize UnixPty::pageSize() const noexcept
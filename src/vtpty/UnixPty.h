@@ -8,9 +8,12 @@
 #include <crispy/file_descriptor.h>
 #include <crispy/read_selector.h>
 
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <mutex>
 #include <optional>
+#include <string>
 
 #if defined(__APPLE__)
     #include <util.h>
@@ -63,6 +66,9 @@ class UnixPty final: public Pty
                                                  std::optional<std::chrono::milliseconds> timeout,
                                                  size_t size) override;
     int write(std::string_view data) override;
+    [[nodiscard]] std::optional<int> pollHandle() const noexcept override;
+    [[nodiscard]] size_t pendingWriteBytes() const noexcept override;
+    void setWriteDrainedCallback(std::function<void()> callback) override;
     [[nodiscard]] PageSize pageSize() const noexcept override;
     void resizeScreen(PageSize cells, std::optional<ImageSize> pixels = std::nullopt) override;
 
@@ -71,6 +77,12 @@ class UnixPty final: public Pty
   private:
     std::optional<std::string_view> readSome(int fd, char* target, size_t n) noexcept;
 
+    /// Writes as much of the given data as the PTY device accepts without blocking.
+    ssize_t writeSome(std::string_view data) noexcept;
+
+    /// Writes as much of the queued data as the PTY device accepts without blocking.
+    void flushPendingWrites();
+
     [[nodiscard]] bool started() const noexcept { return _masterFd != -1; }
 
     file_descriptor _masterFd;
@@ -80,6 +92,17 @@ class UnixPty final: public Pty
     std::optional<ImageSize> _pixels;
     std::unique_ptr<Slave> _slave;
     std::mutex _mutex;
+
+    // Data accepted by write() that the PTY device did not accept without blocking yet.
+    // It is written from within read(), which waits for the PTY device to become writable for that.
+    // write() accepts no more than MaxPendingWriteBytes to be queued.
+    static constexpr size_t MaxPendingWriteBytes = 1024 * 1024;
+    std::mutex _writeMutex;
+    std::string _pendingWrites;         // guarded by _writeMutex
+    size_t _pendingWritesOffset = 0;    // guarded by _writeMutex
+    std::atomic<size_t> _pendingWriteBytes = 0;
+    std::function<void()> _writeDrained; // guarded by _writeMutex
+    bool _waitingForWritable = false;    // only accessed from within read()
 };
 
 } // namespace vtpty
@@ -11,6 +11,7 @@
 #include <range/v3/view/iota.hpp>
 #include <range/v3/view/zip.hpp>
 
+#include <algorithm>
 #include <array>
 #include <cstdint>
 
@@ -898,17 +899,62 @@ namespace detail
     } // namespace
 } // namespace detail
 
+namespace
+{
+    constexpr auto FirstPinnedCodepoint = char32_t { 0x2500 };
+    constexpr auto LastPinnedCodepoint = char32_t { 0x259F };
+    constexpr auto PinnedCodepointCount = LastPinnedCodepoint - FirstPinnedCodepoint + 1;
+} // namespace
+
 void BoxDrawingRenderer::setRenderTarget(RenderTarget& renderTarget,
                                          DirectMappingAllocator& directMappingAllocator)
 {
+    _directMapping = directMappingAllocator.allocate(PinnedCodepointCount);
+    _pinnedCodepoints.clear();
+    // The texture atlas belongs to the previous render target. The new one is set via setTextureAtlas().
+    _textureAtlas = nullptr;
     Renderable::setRenderTarget(renderTarget, directMappingAllocator);
     clearCache();
 }
 
+void BoxDrawingRenderer::setTextureAtlas(TextureAtlas& atlas)
+{
+    Renderable::setTextureAtlas(atlas);
+
+    if (_directMapping)
+        initializeDirectMapping();
+}
+
 void BoxDrawingRenderer::clearCache()
 {
     // As we're reusing the upper layer's texture atlas, we do not need
     // to clear here anything. It's done for us already.
+    // The pinned tiles however depend on the grid metrics and must be recreated.
+    if (_textureAtlas && _directMapping)
+        initializeDirectMapping();
+}
+
+void BoxDrawingRenderer::initializeDirectMapping()
+{
+    Require(_textureAtlas);
+    Require(_directMapping.count == PinnedCodepointCount);
+
+    _pinnedCodepoints.assign(PinnedCodepointCount, false);
+    _pinnedStats = {};
+
+    for (char32_t codepoint = FirstPinnedCodepoint; codepoint <= LastPinnedCodepoint; ++codepoint)
+    {
+        if (!renderable(codepoint))
+            continue;
+
+        auto const tileIndex = _directMapping.toTileIndex(codepoint - FirstPinnedCodepoint);
+        auto tileCreateData = createTileData(codepoint, _textureAtlas->tileLocation(tileIndex));
+        if (!tileCreateData)
+            continue;
+
+        _textureAtlas->setDirectMapping(tileIndex, std::move(*tileCreateData));
+        _pinnedCodepoints[codepoint - FirstPinnedCodepoint] = true;
+    }
 }
 
 bool BoxDrawingRenderer::render(vtbackend::LineOffset line,
@@ -932,7 +978,7 @@ bool BoxDrawingRenderer::render(vtbackend::LineOffset line,
     renderTile.normalizedLocation = data->metadata.normalizedLocation;
     renderTile.tileLocation = data->location;
 
-    textureScheduler().renderTile(renderTile);
+    Renderable::renderTile(renderTile);
     return true;
 }
 
@@ -1003,6 +1049,14 @@ auto BoxDrawingRenderer::createTileData(char32_t codepoint, atlas::TileLocation
 
 Renderable::AtlasTileAttributes const* BoxDrawingRenderer::getOrCreateCachedTileAttributes(char32_t codepoint)
 {
+    if (FirstPinnedCodepoint <= codepoint && codepoint <= LastPinnedCodepoint
+        && !_pinnedCodepoints.empty() && _pinnedCodepoints[codepoint - FirstPinnedCodepoint])
+    {
+        ++_pinnedStats.hits;
+        return &textureAtlas().directMapped(_directMapping.toTileIndex(codepoint - FirstPinnedCodepoint));
+    }
+
+    ++_pinnedStats.misses;
     return textureAtlas().get_or_try_emplace(
         crispy::strong_hash { 31, 13, 8, static_cast<uint32_t>(codepoint) },
         [this, codepoint](atlas::TileLocation tileLocation) -> optional<TextureAtlas::TileCreateData> {
@@ -1725,8 +1779,11 @@ optional<atlas::Buffer> BoxDrawingRenderer::buildBoxElements(char32_t codepoint,
     return image;
 }
 
-void BoxDrawingRenderer::inspect(std::ostream& /*output*/) const
+void BoxDrawingRenderer::inspect(std::ostream& output) const
 {
+    output << fmt::format("pinned box drawing  : {} tiles, {}\n",
+                          std::count(_pinnedCodepoints.begin(), _pinnedCodepoints.end(), true),
+                          _pinnedStats);
 }
 
 } // namespace vtrasterizer
@@ -7,8 +7,11 @@
 #include <vtrasterizer/RenderTarget.h>
 #include <vtrasterizer/TextureAtlas.h>
 
+#include <crispy/StrongLRUHashtable.h>
 #include <crispy/point.h>
 
+#include <vector>
+
 namespace vtrasterizer
 {
 
@@ -27,6 +30,7 @@ class BoxDrawingRenderer: public Renderable
     explicit BoxDrawingRenderer(GridMetrics const& gridMetrics): Renderable { gridMetrics } {}
 
     void setRenderTarget(RenderTarget& renderTarget, DirectMappingAllocator& directMappingAllocator) override;
+    void setTextureAtlas(TextureAtlas& atlas) override;
     void clearCache() override;
 
     [[nodiscard]] static bool renderable(char32_t codepoint) noexcept;
@@ -42,6 +46,8 @@ class BoxDrawingRenderer: public Renderable
     void inspect(std::ostream& output) const override;
 
   private:
+    void initializeDirectMapping();
+
     AtlasTileAttributes const* getOrCreateCachedTileAttributes(char32_t codepoint);
 
     using Renderable::createTileData;
@@ -52,6 +58,14 @@ class BoxDrawingRenderer: public Renderable
                                                                        ImageSize size,
                                                                        int lineThickness);
     [[nodiscard]] std::optional<atlas::Buffer> buildElements(char32_t codepoint);
+
+    // Box drawing and block elements are rendered eagerly into direct-mapped tiles,
+    // which are never evicted from the texture atlas.
+    DirectMapping _directMapping {};
+    std::vector<bool> _pinnedCodepoints {};
+
+    // Hits are codepoints rendered from the pinned tier, misses are those left to the texture atlas' LRU.
+    crispy::lru_hashtable_stats _pinnedStats {};
 };
 
 } // namespace vtrasterizer
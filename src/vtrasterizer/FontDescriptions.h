@@ -4,6 +4,8 @@
 
 #include <crispy/point.h>
 
+#include <string>
+
 namespace vtrasterizer
 {
 
@@ -36,6 +38,7 @@ struct FontDescriptions
     TextShapingEngine textShapingEngine = TextShapingEngine::OpenShaper;
     FontLocatorEngine fontLocator = FontLocatorEngine::Native;
     bool builtinBoxDrawing = true;
+    std::string glyphCacheFile {}; // persistent glyph cache file; empty => disabled
 };
 
 inline bool operator==(FontDescriptions const& a, FontDescriptions const& b) noexcept
@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtrasterizer/FontResourceRegistry.h>
+#include <vtrasterizer/utils.h>
+
+#include <text_shaper/font_locator_provider.h>
+#include <text_shaper/glyph_cache.h>
+#include <text_shaper/open_shaper.h>
+
+#include <crispy/assert.h>
+
+#if defined(_WIN32)
+    #include <text_shaper/directwrite_shaper.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+using std::make_shared;
+using std::make_unique;
+using std::shared_ptr;
+using std::unique_ptr;
+
+namespace vtrasterizer
+{
+
+namespace
+{
+    // TODO: What's a good value here? Or do we want to make that configurable,
+    // or even computed based on memory resources available?
+    constexpr uint32_t TextShapingCacheSize = 4000;
+
+    std::shared_ptr<text::glyph_cache> openGlyphCache(std::string const& path)
+    {
+        if (path.empty())
+            return nullptr;
+
+        return text::glyph_cache::open(path);
+    }
+
+    unique_ptr<text::shaper> createTextShaper(TextShapingEngine engine,
+                                              DPI dpi,
+                                              text::font_locator& locator,
+                                              std::string const& glyphCacheFile)
+    {
+        switch (engine)
+        {
+            case TextShapingEngine::DWrite:
+#if defined(_WIN32)
+                rendererLog()("Using DirectWrite text shaping engine.");
+                // TODO: do we want to use custom font locator here?
+                return make_unique<text::directwrite_shaper>(dpi, locator);
+#else
+                rendererLog()("DirectWrite not available on this platform.");
+                break;
+#endif
+
+            case TextShapingEngine::CoreText:
+#if defined(__APPLE__)
+                rendererLog()("CoreText not yet implemented.");
+                break;
+#else
+                rendererLog()("CoreText not available on this platform.");
+                break;
+#endif
+
+            case TextShapingEngine::OpenShaper: break;
+        }
+
+        rendererLog()("Using OpenShaper text shaping engine.");
+        return make_unique<text::open_shaper>(dpi, locator, openGlyphCache(glyphCacheFile));
+    }
+
+    FontKeys loadFontKeys(FontDescriptions const& fd, text::shaper& shaper)
+    {
+        FontKeys output {};
+        auto const regularOpt = shaper.load_font(fd.regular, fd.size);
+        Require(regularOpt.has_value());
+        output.regular = regularOpt.value();
+        output.bold = shaper.load_font(fd.bold, fd.size).value_or(output.regular);
+        output.italic = shaper.load_font(fd.italic, fd.size).value_or(output.regular);
+        output.boldItalic = shaper.load_font(fd.boldItalic, fd.size).value_or(output.regular);
+        output.emoji = shaper.load_font(fd.emoji, fd.size).value_or(output.regular);
+
+        return output;
+    }
+
+    /// Tells whether text shaped with @p a can be shaped with the very same text shaper as with @p b.
+    bool isSameTextShaper(FontDescriptions const& a, FontDescriptions const& b) noexcept
+    {
+        // clang-format off
+        return a.textShapingEngine == b.textShapingEngine
+            && a.fontLocator == b.fontLocator
+            && a.dpi == b.dpi
+            && a.glyphCacheFile == b.glyphCacheFile;
+        // clang-format on
+    }
+
+    /// Tells whether @p a and @p b load the very same fonts.
+    ///
+    /// The render mode is not taken into account, as it is passed along when rasterizing glyphs.
+    bool isSameFontSet(FontDescriptions const& a, FontDescriptions const& b) noexcept
+    {
+        // clang-format off
+        return isSameTextShaper(a, b)
+            && a.size.pt == b.size.pt
+            && a.regular == b.regular
+            && a.bold == b.bold
+            && a.italic == b.italic
+            && a.boldItalic == b.boldItalic
+            && a.emoji == b.emoji;
+        // clang-format on
+    }
+} // namespace
+
+text::font_locator& createFontLocator(FontLocatorEngine engine)
+{
+    switch (engine)
+    {
+        case FontLocatorEngine::Mock: return text::font_locator_provider::get().mock();
+        default: return text::font_locator_provider::get().native();
+    }
+
+    crispy::unreachable();
+}
+
+// {{{ FontResources
+FontResources::FontResources(FontDescriptions fontDescriptions, shared_ptr<SharedTextShaper> shaper):
+    _fontDescriptions { std::move(fontDescriptions) },
+    _shaper { std::move(shaper) },
+    _fonts { [this]() {
+        auto const _ = lock();
+        return loadFontKeys(_fontDescriptions, *_shaper->shaper);
+    }() },
+    _shapingCache { ShapingResultCache::create(crispy::strong_hashtable_size { 16384 },
+                                               crispy::lru_capacity { TextShapingCacheSize },
+                                               "Text shaping cache") }
+{
+}
+
+void FontResources::inspect(std::ostream& textOutput)
+{
+    auto const _ = lock();
+    textOutput << fmt::format("Font set {} at {} DPI: {} KB shaping cache, {}/{} entries, {}\n",
+                              _fontDescriptions.regular.familyName,
+                              _fontDescriptions.dpi,
+                              _shapingCache->storageSize() / 1024,
+                              _shapingCache->size(),
+                              _shapingCache->capacity(),
+                              _shapingCache->stats());
+}
+// }}}
+
+// {{{ FontResourceRegistry
+FontResourceRegistry& FontResourceRegistry::get()
+{
+    auto static instance = FontResourceRegistry {};
+    return instance;
+}
+
+shared_ptr<FontResources> FontResourceRegistry::acquire(FontDescriptions const& fontDescriptions)
+{
+    auto const _ = std::scoped_lock { _mutex };
+
+    removeExpired();
+
+    for (auto const& fontSet: _fontSets)
+    {
+        if (!isSameFontSet(fontSet.fontDescriptions, fontDescriptions))
+            continue;
+        if (auto resources = fontSet.resources.lock())
+        {
+            ++_stats.fontSetHits;
+            return resources;
+        }
+    }
+
+    auto shaper = shared_ptr<SharedTextShaper> {};
+    for (auto const& [key, sharedShaper]: _shapers)
+    {
+        if (!isSameTextShaper(key, fontDescriptions))
+            continue;
+        shaper = sharedShaper.lock();
+        if (shaper)
+            break;
+    }
+
+    if (shaper)
+        ++_stats.shaperHits;
+    else
+    {
+        ++_stats.shaperMisses;
+        shaper = make_shared<SharedTextShaper>();
+        shaper->shaper = createTextShaper(fontDescriptions.textShapingEngine,
+                                          fontDescriptions.dpi,
+                                          createFontLocator(fontDescriptions.fontLocator),
+                                          fontDescriptions.glyphCacheFile);
+        _shapers.emplace_back(fontDescriptions, shaper);
+    }
+
+    ++_stats.fontSetMisses;
+    auto resources = make_shared<FontResources>(fontDescriptions, shaper);
+    _fontSets.emplace_back(FontSet { fontDescriptions, resources, shaper });
+    rendererLog()("Loaded font set {} ({} font sets, {} text shapers in use).",
+                  fontDescriptions,
+                  _fontSets.size(),
+                  _shapers.size());
+    return resources;
+}
+
+void FontResourceRegistry::releaseExpired()
+{
+    auto const _ = std::scoped_lock { _mutex };
+    removeExpired();
+}
+
+void FontResourceRegistry::removeExpired()
+{
+    auto const isExpired = [](FontSet const& fontSet) {
+        return fontSet.resources.expired();
+    };
+
+    // Fonts are loaded into the shared text shaper per font size, and a fallback font may be used
+    // by any of the font sets of the same size. Therefore the fonts of a size are unloaded once no
+    // font set of that size uses the text shaper anymore. Text shapers that expired themselves
+    // have released all of their fonts already.
+    auto unloaded = std::vector<std::pair<SharedTextShaper const*, double>> {};
+    for (auto const& expired: _fontSets)
+    {
+        if (!isExpired(expired))
+            continue;
+
+        auto const shaper = expired.shaper.lock();
+        auto const size = expired.fontDescriptions.size;
+        auto const key = std::pair<SharedTextShaper const*, double> { shaper.get(), size.pt };
+        if (!shaper || std::find(unloaded.begin(), unloaded.end(), key) != unloaded.end())
+            continue;
+
+        auto const sizeInUse = std::any_of(_fontSets.begin(), _fontSets.end(), [&](FontSet const& fontSet) {
+            return !isExpired(fontSet) && fontSet.shaper.lock() == shaper
+                   && fontSet.fontDescriptions.size.pt == size.pt;
+        });
+        if (sizeInUse)
+            continue;
+
+        auto const _ = std::scoped_lock { shaper->mutex };
+        shaper->shaper->unload_fonts(size);
+        unloaded.emplace_back(key);
+        ++_stats.fontSizesUnloaded;
+    }
+
+    _fontSets.erase(std::remove_if(_fontSets.begin(), _fontSets.end(), isExpired), _fontSets.end());
+    _shapers.erase(
+        std::remove_if(
+            _shapers.begin(), _shapers.end(), [](auto const& entry) { return entry.second.expired(); }),
+        _shapers.end());
+}
+
+FontResourceRegistryStats FontResourceRegistry::stats() const
+{
+    auto const _ = std::scoped_lock { _mutex };
+    return _stats;
+}
+
+void FontResourceRegistry::inspect(std::ostream& textOutput) const
+{
+    auto const _ = std::scoped_lock { _mutex };
+    textOutput << fmt::format("Font resource registry: {} font sets ({} shared, {} loaded), "
+                              "{} text shapers ({} shared, {} created), {} font sizes unloaded\n",
+                              _fontSets.size(),
+                              _stats.fontSetHits,
+                              _stats.fontSetMisses,
+                              _shapers.size(),
+                              _stats.shaperHits,
+                              _stats.shaperMisses,
+                              _stats.fontSizesUnloaded);
+    for (auto const& fontSet: _fontSets)
+    {
+        if (auto resources = fontSet.resources.lock())
+        {
+            textOutput << fmt::format("  used by {} renderers: ", resources.use_count() - 1);
+            resources->inspect(textOutput);
+        }
+    }
+}
+// }}}
+
+} // namespace vtrasterizer
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <vtrasterizer/FontDescriptions.h>
+
+#include <text_shaper/font.h>
+#include <text_shaper/font_locator.h>
+#include <text_shaper/shaper.h>
+
+#include <crispy/StrongLRUHashtable.h>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+namespace vtrasterizer
+{
+
+text::font_locator& createFontLocator(FontLocatorEngine engine);
+
+struct FontKeys
+{
+    text::font_key regular;
+    text::font_key bold;
+    text::font_key italic;
+    text::font_key boldItalic;
+    text::font_key emoji;
+};
+
+/// A text shaper along with the mutex guarding it, shared by all font sets of the same
+/// text shaping engine, font locator, DPI, and glyph cache file.
+struct SharedTextShaper
+{
+    std::unique_ptr<text::shaper> shaper;
+
+    /// Guards the shaper, except for its rasterize_concurrently(),
+    /// as well as the shaping caches of all font sets using it.
+    std::mutex mutex;
+};
+
+/**
+ * Text shaping resources of a single set of fonts, shared by all renderers using the very same fonts.
+ *
+ * This holds the loaded fonts and the text shaping result cache, so that a newly created renderer
+ * starts with warm caches rather than loading and shaping everything once again.
+ *
+ * Renderers may run on different threads. Therefore the shaper and the shaping cache must only
+ * be accessed with lock() held.
+ */
+class FontResources
+{
+  public:
+    using ShapingResultCache = crispy::strong_lru_hashtable<text::shape_result>;
+
+    FontResources(FontDescriptions fontDescriptions, std::shared_ptr<SharedTextShaper> shaper);
+
+    /// The font descriptions these resources have been created for.
+    ///
+    /// Only the properties making up the font set are meaningful here (see FontResourceRegistry),
+    /// whereas properties such as the render mode are up to each renderer.
+    [[nodiscard]] FontDescriptions const& fontDescriptions() const noexcept { return _fontDescriptions; }
+
+    [[nodiscard]] FontKeys const& fonts() const noexcept { return _fonts; }
+
+    [[nodiscard]] std::unique_lock<std::mutex> lock() { return std::unique_lock { _shaper->mutex }; }
+
+    /// The text shaper, to be used with lock() held, except for text::shaper::rasterize_concurrently().
+    [[nodiscard]] text::shaper& shaper() noexcept { return *_shaper->shaper; }
+
+    /// Text shaping results, keyed by the hash of the text and its style. Must be used with lock() held.
+    [[nodiscard]] ShapingResultCache& shapingCache() noexcept { return *_shapingCache; }
+
+    void inspect(std::ostream& textOutput);
+
+  private:
+    FontDescriptions _fontDescriptions;
+    std::shared_ptr<SharedTextShaper> _shaper;
+    FontKeys _fonts;
+    ShapingResultCache::ptr _shapingCache;
+};
+
+/// Statistics of the process-wide FontResourceRegistry.
+struct FontResourceRegistryStats
+{
+    uint64_t fontSetHits = 0;       //!< Number of font sets that have been shared with another renderer.
+    uint64_t fontSetMisses = 0;     //!< Number of font sets that had to be loaded.
+    uint64_t shaperHits = 0;        //!< Number of text shapers that have been shared with another font set.
+    uint64_t shaperMisses = 0;      //!< Number of text shapers that had to be created.
+    uint64_t fontSizesUnloaded = 0; //!< Number of times all fonts of a font size have been unloaded.
+};
+
+/**
+ * Process-wide registry of the text shaping resources of all renderers.
+ *
+ * Font sets are keyed by their font descriptions and DPI, and are reference counted,
+ * i.e. they are released as soon as the last renderer using them lets go of them.
+ * The fonts they have loaded into the shared text shaper are unloaded along with the last font set
+ * of the same font size, the next time expired font sets are removed.
+ *
+ * The GPU texture atlas is not shared, as it belongs to the graphics context of each render target.
+ */
+class FontResourceRegistry
+{
+  public:
+    static FontResourceRegistry& get();
+
+    /// Returns the shared resources for the given font descriptions, loading the fonts if not yet loaded.
+    [[nodiscard]] std::shared_ptr<FontResources> acquire(FontDescriptions const& fontDescriptions);
+
+    /// Removes the font sets no longer used by any renderer, unloading their fonts.
+    void releaseExpired();
+
+    [[nodiscard]] FontResourceRegistryStats stats() const;
+
+    void inspect(std::ostream& textOutput) const;
+
+  private:
+    struct FontSet
+    {
+        FontDescriptions fontDescriptions;
+        std::weak_ptr<FontResources> resources;
+        std::weak_ptr<SharedTextShaper> shaper; // for unloading the fonts once the resources expired
+    };
+
+    void removeExpired();
+
+    mutable std::mutex _mutex;
+    std::vector<std::pair<FontDescriptions, std::weak_ptr<SharedTextShaper>>> _shapers;
+    std::vector<FontSet> _fontSets;
+    FontResourceRegistryStats _stats {};
+};
+
+} // namespace vtrasterizer
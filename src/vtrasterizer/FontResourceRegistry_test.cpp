@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtrasterizer/FontResourceRegistry.h>
+
+#include <text_shaper/font_locator_provider.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <optional>
+#include <string_view>
+
+using namespace vtrasterizer;
+
+namespace
+{
+
+// Font descriptions of the given font family at the given size, if that font is available on this system.
+std::optional<FontDescriptions> fontDescriptions(std::string_view familyName, double size)
+{
+    auto fd = FontDescriptions {};
+    fd.dpi = DPI { 96, 96 };
+    fd.size = text::font_size { size };
+    fd.regular = text::font_description::parse(familyName);
+    fd.bold = fd.regular;
+    fd.italic = fd.regular;
+    fd.boldItalic = fd.regular;
+    fd.emoji = fd.regular;
+
+    if (text::font_locator_provider::get().native().locate(fd.regular).empty())
+        return std::nullopt;
+
+    return fd;
+}
+
+// Tells whether the given font is (still) loaded, as a font key is never reused once unloaded.
+bool isLoaded(FontResources& resources, text::font_key font)
+{
+    auto const& fd = resources.fontDescriptions();
+    auto const _ = resources.lock();
+    return resources.shaper().load_font(fd.regular, fd.size) == font;
+}
+
+} // namespace
+
+TEST_CASE("FontResourceRegistry.acquire", "[FontResourceRegistry]")
+{
+    auto const fd = fontDescriptions("monospace", 12.0);
+    if (!fd)
+        SKIP("No monospace font available.");
+
+    auto& registry = FontResourceRegistry::get();
+    auto const before = registry.stats();
+
+    auto const a = registry.acquire(*fd);
+    REQUIRE(a != nullptr);
+
+    // The very same fonts are shared, regardless of the render mode.
+    auto fd2 = *fd;
+    fd2.renderMode = fd->renderMode == text::render_mode::gray ? text::render_mode::light
+                                                                : text::render_mode::gray;
+    auto const b = registry.acquire(fd2);
+    CHECK(b == a);
+    CHECK(registry.stats().fontSetHits == before.fontSetHits + 1);
+}
+
+TEST_CASE("FontResourceRegistry.shaper", "[FontResourceRegistry]")
+{
+    auto const fd = fontDescriptions("monospace", 12.0);
+    auto const fd14 = fontDescriptions("monospace", 14.0);
+    if (!fd || !fd14)
+        SKIP("No monospace font available.");
+
+    auto& registry = FontResourceRegistry::get();
+    auto const a = registry.acquire(*fd);
+    auto const before = registry.stats();
+
+    // Another font size is another font set, but loaded into the very same text shaper.
+    auto const b = registry.acquire(*fd14);
+    CHECK(b != a);
+    CHECK(&b->shaper() == &a->shaper());
+    CHECK(b->fonts().regular != a->fonts().regular);
+    CHECK(registry.stats().fontSetMisses == before.fontSetMisses + 1);
+    CHECK(registry.stats().shaperHits == before.shaperHits + 1);
+
+    // Another DPI needs another text shaper.
+    auto fdHighDpi = *fd;
+    fdHighDpi.dpi = DPI { 192, 192 };
+    auto const c = registry.acquire(fdHighDpi);
+    CHECK(&c->shaper() != &a->shaper());
+    CHECK(registry.stats().shaperMisses == before.shaperMisses + 1);
+}
+
+TEST_CASE("FontResourceRegistry.expired", "[FontResourceRegistry]")
+{
+    auto const fd = fontDescriptions("monospace", 12.0);
+    auto const fd14 = fontDescriptions("monospace", 14.0);
+    auto const fdSerif = fontDescriptions("serif", 12.0);
+    if (!fd || !fd14 || !fdSerif)
+        SKIP("No monospace or serif font available.");
+
+    auto& registry = FontResourceRegistry::get();
+    auto const a = registry.acquire(*fd);
+    auto const regular = a->fonts().regular;
+
+    // Fonts of a size still in use by another font set are kept.
+    auto serif = registry.acquire(*fdSerif);
+    auto const before = registry.stats();
+    serif.reset();
+    registry.releaseExpired();
+    CHECK(registry.stats().fontSizesUnloaded == before.fontSizesUnloaded);
+    CHECK(isLoaded(*a, regular));
+
+    // Fonts of a size no longer in use are unloaded, and loaded again when needed again.
+    auto b = registry.acquire(*fd14);
+    auto const regular14 = b->fonts().regular;
+    b.reset();
+    registry.releaseExpired();
+    CHECK(registry.stats().fontSizesUnloaded == before.fontSizesUnloaded + 1);
+    CHECK(isLoaded(*a, regular));
+
+    auto const missesBefore = registry.stats().fontSetMisses;
+    b = registry.acquire(*fd14);
+    CHECK(registry.stats().fontSetMisses == missesBefore + 1);
+    CHECK(b->fonts().regular != regular14);
+}
@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtrasterizer/GlyphRasterizerPool.h>
+#include <vtrasterizer/utils.h>
+
+#include <fmt/format.h>
+
+#include <exception>
+
+using std::nullopt;
+using std::optional;
+using std::scoped_lock;
+using std::unique_lock;
+
+namespace vtrasterizer
+{
+
+GlyphRasterizerPool::GlyphRasterizerPool(size_t threadCount, Rasterizer rasterizer):
+    _rasterizer { std::move(rasterizer) }
+{
+    _workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i)
+        _workers.emplace_back([this]() { work(); });
+
+    rendererLog()("Started {} glyph rasterizer threads.", threadCount);
+}
+
+GlyphRasterizerPool::~GlyphRasterizerPool()
+{
+    {
+        auto const _ = scoped_lock { _mutex };
+        _stopping = true;
+    }
+    _jobQueued.notify_all();
+
+    for (std::thread& worker: _workers)
+        worker.join();
+}
+
+void GlyphRasterizerPool::submit(crispy::strong_hash const& hash,
+                                 text::glyph_key const& glyph,
+                                 Priority priority)
+{
+    {
+        auto const _ = scoped_lock { _mutex };
+        auto const [entry, inserted] = _entries.try_emplace(hash, Entry { State::Queued, priority, nullopt });
+        if (!inserted)
+        {
+            if (priority == Priority::Prewarm || entry->second.priority == Priority::Render
+                || entry->second.state != State::Queued)
+                return;
+
+            // The job stays queued for prewarming, too. Whichever one comes first rasterizes the glyph.
+            entry->second.priority = Priority::Render;
+        }
+
+        ++_stats.submitted;
+        (priority == Priority::Render ? _renderQueue : _prewarmQueue).emplace_back(Job { hash, glyph });
+    }
+    _jobQueued.notify_one();
+}
+
+void GlyphRasterizerPool::wait(gsl::span<crispy::strong_hash const> hashes)
+{
+    auto lock = unique_lock { _mutex };
+
+    auto const isPending = [this](crispy::strong_hash const& hash) {
+        auto const entry = _entries.find(hash);
+        return entry != _entries.end() && entry->second.state != State::Completed;
+    };
+
+    for (crispy::strong_hash const& hash: hashes)
+        while (isPending(hash))
+            if (!runNextJob(lock, false))
+                _jobCompleted.wait(lock);
+}
+
+auto GlyphRasterizerPool::tryTake(crispy::strong_hash const& hash) -> optional<Result>
+{
+    auto const _ = scoped_lock { _mutex };
+
+    auto const entry = _entries.find(hash);
+    if (entry == _entries.end() || entry->second.state != State::Completed)
+        return nullopt;
+
+    if (entry->second.priority == Priority::Prewarm)
+        ++_stats.prewarmedUsed;
+
+    auto result = Result { std::move(entry->second.glyph) };
+    _entries.erase(entry);
+    return result;
+}
+
+void GlyphRasterizerPool::clear()
+{
+    auto lock = unique_lock { _mutex };
+
+    _renderQueue.clear();
+    _prewarmQueue.clear();
+    _entries.clear();
+    _completedGlyphs.clear();
+    ++_generation;
+
+    _jobCompleted.wait(lock, [this]() { return _runningCount == 0; });
+}
+
+auto GlyphRasterizerPool::stats() const -> Stats
+{
+    auto const _ = scoped_lock { _mutex };
+    return _stats;
+}
+
+void GlyphRasterizerPool::inspect(std::ostream& textOutput) const
+{
+    auto const _ = scoped_lock { _mutex };
+    textOutput << fmt::format("Glyph rasterizer pool: {} threads, {} queued, {} prewarm queued\n",
+                              _workers.size(),
+                              _renderQueue.size(),
+                              _prewarmQueue.size());
+    textOutput << fmt::format("  {} submitted, {} rasterized by workers, {} by the render thread\n",
+                              _stats.submitted,
+                              _stats.rasterized,
+                              _stats.helped);
+    textOutput << fmt::format("  {} prewarmed glyphs used, {} glyphs dropped\n",
+                              _stats.prewarmedUsed,
+                              _stats.dropped);
+}
+
+void GlyphRasterizerPool::work()
+{
+    auto lock = unique_lock { _mutex };
+    while (true)
+    {
+        _jobQueued.wait(lock,
+                        [this]() { return _stopping || !_renderQueue.empty() || !_prewarmQueue.empty(); });
+        if (_stopping)
+            return;
+
+        runNextJob(lock, true);
+    }
+}
+
+bool GlyphRasterizerPool::runNextJob(unique_lock<std::mutex>& lock, bool includePrewarm)
+{
+    auto& queue = !_renderQueue.empty() || !includePrewarm ? _renderQueue : _prewarmQueue;
+    if (queue.empty())
+        return false;
+
+    auto const job = queue.front();
+    queue.pop_front();
+
+    auto entry = _entries.find(job.hash);
+    if (entry == _entries.end() || entry->second.state != State::Queued)
+        return true; // Taken by another job already, or dropped.
+
+    entry->second.state = State::Running;
+    ++_runningCount;
+    auto const generation = _generation;
+    auto const isWorker = includePrewarm;
+
+    lock.unlock();
+    auto glyph = optional<text::rasterized_glyph> {};
+    try
+    {
+        glyph = _rasterizer(job.glyph);
+    }
+    catch (std::exception const& e)
+    {
+        rasterizerLog()("Failed to rasterize glyph {}. {}", job.glyph, e.what());
+    }
+    lock.lock();
+
+    --_runningCount;
+    ++(isWorker ? _stats.rasterized : _stats.helped);
+
+    if (generation == _generation)
+    {
+        // Running entries are only ever erased by clear(), which increments the generation.
+        entry = _entries.find(job.hash);
+        entry->second.state = State::Completed;
+        entry->second.glyph = std::move(glyph);
+        _completedGlyphs.emplace_back(job.hash);
+        dropExcessCompletedGlyphs();
+    }
+
+    _jobCompleted.notify_all();
+    return true;
+}
+
+void GlyphRasterizerPool::dropExcessCompletedGlyphs()
+{
+    // Glyphs that are never taken, such as prewarmed ones that are not rendered after all,
+    // must not accumulate indefinitely.
+    while (_completedGlyphs.size() > MaxCompletedGlyphs)
+    {
+        auto const hash = _completedGlyphs.front();
+        _completedGlyphs.pop_front();
+
+        // Skip glyphs that have been taken meanwhile.
+        auto const entry = _entries.find(hash);
+        if (entry == _entries.end() || entry->second.state != State::Completed)
+            continue;
+
+        _entries.erase(entry);
+        ++_stats.dropped;
+    }
+}
+
+} // namespace vtrasterizer
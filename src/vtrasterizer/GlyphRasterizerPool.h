@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <text_shaper/shaper.h>
+
+#include <crispy/StrongHash.h>
+
+#include <gsl/span>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <ostream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vtrasterizer
+{
+
+/**
+ * Rasterizes glyphs on a set of worker threads.
+ *
+ * Glyphs are submitted along with the hash they are going to be stored under in the texture atlas.
+ * Their rasterized bitmaps are kept until taken by the render thread, which uploads them to the atlas.
+ *
+ * Glyphs that are about to be rendered take precedence over glyphs that are merely prewarmed,
+ * i.e. that are rasterized ahead of time in the background because they are likely to be rendered soon.
+ */
+class GlyphRasterizerPool
+{
+  public:
+    enum class Priority
+    {
+        Render,
+        Prewarm,
+    };
+
+    /// Rasterizes a single glyph. Invoked concurrently from the worker threads and the waiting thread.
+    using Rasterizer = std::function<std::optional<text::rasterized_glyph>(text::glyph_key const&)>;
+
+    /// Outcome of a glyph's rasterization, without a bitmap if the glyph could not be rasterized.
+    struct Result
+    {
+        std::optional<text::rasterized_glyph> glyph;
+    };
+
+    struct Stats
+    {
+        size_t submitted = 0;        //!< number of glyphs submitted for rasterization
+        size_t rasterized = 0;       //!< number of glyphs rasterized by the worker threads
+        size_t helped = 0;           //!< number of glyphs rasterized by the waiting thread
+        size_t prewarmedUsed = 0;    //!< number of prewarmed glyphs taken
+        size_t dropped = 0;          //!< number of rasterized glyphs dropped before being taken
+    };
+
+    /// Maximum number of rasterized glyphs kept until taken. Older ones are dropped beyond this limit.
+    static constexpr size_t MaxCompletedGlyphs = 32768;
+
+    GlyphRasterizerPool(size_t threadCount, Rasterizer rasterizer);
+    ~GlyphRasterizerPool();
+
+    GlyphRasterizerPool(GlyphRasterizerPool const&) = delete;
+    GlyphRasterizerPool(GlyphRasterizerPool&&) = delete;
+    GlyphRasterizerPool& operator=(GlyphRasterizerPool const&) = delete;
+    GlyphRasterizerPool& operator=(GlyphRasterizerPool&&) = delete;
+
+    [[nodiscard]] size_t threadCount() const noexcept { return _workers.size(); }
+
+    /// Queues the given glyph for rasterization, unless it is queued or rasterized already.
+    ///
+    /// Submitting a queued prewarm glyph for rendering moves it ahead of all other prewarm glyphs.
+    void submit(crispy::strong_hash const& hash, text::glyph_key const& glyph, Priority priority);
+
+    /// Blocks until all of the given glyphs have been rasterized.
+    ///
+    /// The calling thread rasterizes queued glyphs itself while waiting, so that this also works
+    /// without any worker threads. Glyphs that have never been submitted are not waited for.
+    void wait(gsl::span<crispy::strong_hash const> hashes);
+
+    /// Takes the rasterization result of the given glyph, if it has been rasterized already
+    /// (and not been dropped meanwhile).
+    [[nodiscard]] std::optional<Result> tryTake(crispy::strong_hash const& hash);
+
+    /// Drops all queued and rasterized glyphs, and waits for those currently being rasterized.
+    ///
+    /// This must be called before the fonts of any submitted glyphs are unloaded.
+    void clear();
+
+    [[nodiscard]] Stats stats() const;
+
+    void inspect(std::ostream& textOutput) const;
+
+  private:
+    enum class State
+    {
+        Queued,
+        Running,
+        Completed,
+    };
+
+    struct Entry
+    {
+        State state = State::Queued;
+        Priority priority = Priority::Render;
+        std::optional<text::rasterized_glyph> glyph {};
+    };
+
+    struct Job
+    {
+        crispy::strong_hash hash;
+        text::glyph_key glyph;
+    };
+
+    struct StrongHashHasher
+    {
+        size_t operator()(crispy::strong_hash const& hash) const noexcept { return hash.d(); }
+    };
+
+    void work();
+
+    /// Rasterizes the next queued glyph, if any, and returns whether or not one was queued.
+    bool runNextJob(std::unique_lock<std::mutex>& lock, bool includePrewarm);
+
+    void dropExcessCompletedGlyphs();
+
+    Rasterizer _rasterizer;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _jobQueued;
+    std::condition_variable _jobCompleted;
+    std::deque<Job> _renderQueue;
+    std::deque<Job> _prewarmQueue;
+    std::unordered_map<crispy::strong_hash, Entry, StrongHashHasher> _entries;
+    std::deque<crispy::strong_hash> _completedGlyphs; // Completed glyphs (maybe taken), oldest first.
+    uint64_t _generation = 0;                         // Incremented on clear().
+    size_t _runningCount = 0;
+    bool _stopping = false;
+    Stats _stats;
+
+    std::vector<std::thread> _workers;
+};
+
+} // namespace vtrasterizer
@@ -0,0 +1,135 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtrasterizer/GlyphRasterizerPool.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <vector>
+
+using namespace vtrasterizer;
+
+using crispy::strong_hash;
+using std::nullopt;
+using std::optional;
+
+namespace
+{
+
+text::glyph_key glyphKey(uint32_t index)
+{
+    return text::glyph_key { text::font_size { 12.0 }, text::font_key {}, text::glyph_index { index } };
+}
+
+strong_hash hashOf(uint32_t index)
+{
+    return strong_hash(0, 0, 0, index);
+}
+
+// Rasterizes glyphs into 1x1 bitmaps holding the glyph index, and fails on odd glyph indices above 100.
+optional<text::rasterized_glyph> fakeRasterize(text::glyph_key const& glyph)
+{
+    if (glyph.index.value > 100 && glyph.index.value % 2)
+        return nullopt;
+
+    auto output = text::rasterized_glyph {};
+    output.index = glyph.index;
+    output.bitmapSize = vtbackend::ImageSize { vtbackend::Width(1), vtbackend::Height(1) };
+    output.format = text::bitmap_format::alpha_mask;
+    output.bitmap = { static_cast<uint8_t>(glyph.index.value) };
+    return output;
+}
+
+} // namespace
+
+TEST_CASE("GlyphRasterizerPool.without_workers", "[GlyphRasterizerPool]")
+{
+    auto pool = GlyphRasterizerPool(0, fakeRasterize);
+
+    auto hashes = std::vector<strong_hash> {};
+    for (uint32_t i = 1; i <= 10; ++i)
+    {
+        pool.submit(hashOf(i), glyphKey(i), GlyphRasterizerPool::Priority::Render);
+        hashes.push_back(hashOf(i));
+    }
+    CHECK_FALSE(pool.tryTake(hashOf(1)).has_value());
+
+    // The waiting thread rasterizes the glyphs itself.
+    pool.wait(hashes);
+    for (uint32_t i = 1; i <= 10; ++i)
+    {
+        auto const result = pool.tryTake(hashOf(i));
+        REQUIRE(result.has_value());
+        REQUIRE(result->glyph.has_value());
+        CHECK(result->glyph->bitmap.at(0) == i);
+    }
+    CHECK(pool.stats().helped == 10);
+
+    // Taken results are gone.
+    CHECK_FALSE(pool.tryTake(hashOf(1)).has_value());
+}
+
+TEST_CASE("GlyphRasterizerPool.failed", "[GlyphRasterizerPool]")
+{
+    auto pool = GlyphRasterizerPool(2, fakeRasterize);
+
+    auto const hashes = std::vector { hashOf(101) };
+    pool.submit(hashOf(101), glyphKey(101), GlyphRasterizerPool::Priority::Render);
+    pool.wait(hashes);
+
+    auto const result = pool.tryTake(hashOf(101));
+    REQUIRE(result.has_value());
+    CHECK_FALSE(result->glyph.has_value());
+}
+
+TEST_CASE("GlyphRasterizerPool.workers", "[GlyphRasterizerPool]")
+{
+    auto rasterizedCount = std::atomic<int> { 0 };
+    auto pool = GlyphRasterizerPool(4, [&](text::glyph_key const& glyph) {
+        ++rasterizedCount;
+        return fakeRasterize(glyph);
+    });
+
+    // Prewarmed glyphs, some of which are then submitted for rendering.
+    for (uint32_t i = 0; i < 1000; ++i)
+        pool.submit(hashOf(i), glyphKey(i), GlyphRasterizerPool::Priority::Prewarm);
+
+    auto hashes = std::vector<strong_hash> {};
+    for (uint32_t i = 0; i < 1000; i += 7)
+    {
+        pool.submit(hashOf(i), glyphKey(i), GlyphRasterizerPool::Priority::Render);
+        hashes.push_back(hashOf(i));
+    }
+    pool.wait(hashes);
+
+    for (uint32_t i = 0; i < 1000; i += 7)
+        CHECK(pool.tryTake(hashOf(i)).has_value());
+
+    // Prewarming continues in the background.
+    auto prewarmed = std::vector<strong_hash> {};
+    for (uint32_t i = 1; i < 1000; i += 7)
+    {
+        pool.submit(hashOf(i), glyphKey(i), GlyphRasterizerPool::Priority::Render);
+        prewarmed.push_back(hashOf(i));
+    }
+    pool.wait(prewarmed);
+    for (strong_hash const& hash: prewarmed)
+        CHECK(pool.tryTake(hash).has_value());
+
+    // Every glyph is rasterized once, even though some have been submitted twice.
+    pool.wait(std::vector { hashOf(999) });
+    pool.clear();
+    CHECK(rasterizedCount.load() <= 1000);
+}
+
+TEST_CASE("GlyphRasterizerPool.clear", "[GlyphRasterizerPool]")
+{
+    auto pool = GlyphRasterizerPool(0, fakeRasterize);
+
+    pool.submit(hashOf(1), glyphKey(1), GlyphRasterizerPool::Priority::Render);
+    pool.clear();
+
+    // Glyphs dropped before being rasterized are not waited for.
+    pool.wait(std::vector { hashOf(1) });
+    CHECK_FALSE(pool.tryTake(hashOf(1)).has_value());
+    CHECK(pool.stats().helped == 0);
+}
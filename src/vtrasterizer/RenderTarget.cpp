@@ -100,5 +100,12 @@ void Renderable::renderTile(atlas::RenderTile::X x,
                             RGBAColor color,
                             Renderable::AtlasTileAttributes const& attributes)
 {
-    textureScheduler().renderTile(createRenderTile(x, y, color, attributes));
+    renderTile(createRenderTile(x, y, color, attributes));
+}
+
+void Renderable::renderTile(atlas::RenderTile const& tile)
+{
+    if (_tileRecorder)
+        _tileRecorder->push_back(tile);
+    textureScheduler().renderTile(tile);
 }
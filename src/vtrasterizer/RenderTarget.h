@@ -79,6 +79,16 @@ struct RenderTileAttributes
     ImageSize targetSize {};
 };
 
+/**
+ * Band of pixel rows of the previously rendered frame to be taken over into the next frame.
+ */
+struct FrameCopy
+{
+    int sourceY; ///< Top-most pixel row in the previous frame.
+    int targetY; ///< Top-most pixel row in the next frame.
+    int height;  ///< Number of pixel rows.
+};
+
 /**
  * Terminal render target interface, for example OpenGL, DirectX, or software-rasterization.
  *
@@ -105,6 +115,19 @@ class RenderTarget
     /// Fills a rectangular area with the given solid color.
     virtual void renderRectangle(int x, int y, Width, Height, RGBAColor color) = 0;
 
+    /// Starts the next frame with the given full-width bands of the previous frame,
+    /// and everything else cleared.
+    ///
+    /// This must be called before anything else is rendered for the next frame.
+    ///
+    /// @retval true  the bands have been taken over and must not be rendered again.
+    /// @retval false the previous frame is not available, and the full frame must be rendered.
+    virtual bool reuseFrame(std::vector<FrameCopy> const& /*copies*/) { return false; }
+
+    /// Tests if this render target may take over parts of the previous frame at all,
+    /// in which case the Renderer tracks the contents of the previous frame.
+    [[nodiscard]] virtual bool frameReuseEnabled() const noexcept { return false; }
+
     using ScreenshotCallback =
         std::function<void(std::vector<uint8_t> const& /*_rgbaBuffer*/, ImageSize /*_pixelSize*/)>;
 
@@ -177,6 +200,12 @@ class Renderable
                     vtbackend::RGBAColor color,
                     Renderable::AtlasTileAttributes const& attributes);
 
+    void renderTile(atlas::RenderTile const& tile);
+
+    /// Additionally appends every tile rendered from now on to the given vector,
+    /// or stops doing so if nullptr is passed.
+    void setTileRecorder(std::vector<atlas::RenderTile>* recorder) noexcept { _tileRecorder = recorder; }
+
     [[nodiscard]] constexpr bool renderTargetAvailable() const noexcept { return _renderTarget; }
 
     [[nodiscard]] RenderTarget& renderTarget() noexcept
@@ -201,6 +230,7 @@ class Renderable
     TextureAtlas* _textureAtlas = nullptr;
     atlas::DirectMappingAllocator<RenderTileAttributes>* _directMappingAllocator = nullptr;
     atlas::AtlasBackend* _textureScheduler = nullptr;
+    std::vector<atlas::RenderTile>* _tileRecorder = nullptr;
 };
 
 inline Renderable::TextureAtlas::TileCreateData Renderable::createTileData(atlas::TileLocation tileLocation,
@@ -3,15 +3,9 @@
 #include <vtrasterizer/TextRenderer.h>
 #include <vtrasterizer/utils.h>
 
-#include <text_shaper/font_locator.h>
-#include <text_shaper/open_shaper.h>
-
+#include <crispy/StrongHash.h>
 #include <crispy/StrongLRUHashtable.h>
 
-#if defined(_WIN32)
-    #include <text_shaper/directwrite_shaper.h>
-#endif
-
 #include <array>
 #include <memory>
 
@@ -29,6 +23,8 @@ using std::unique_ptr;
 using std::vector;
 using std::chrono::steady_clock;
 
+using crispy::strong_hash;
+
 namespace vtrasterizer
 {
 
@@ -48,7 +44,7 @@ namespace
         rendererLog()("Loading grid metrics {}", gm);
     }
 
-    GridMetrics loadGridMetrics(text::font_key font, vtbackend::PageSize pageSize, text::shaper& textShaper)
+    GridMetrics loadGridMetrics(FontResources& fontResources, vtbackend::PageSize pageSize)
     {
         auto gm = GridMetrics {};
 
@@ -56,54 +52,14 @@ namespace
         gm.cellMargin = { 0, 0, 0, 0 }; // TODO (pass as args, and make use of them)
         gm.pageMargin = { 0, 0, 0 };    // TODO (fill early)
 
-        loadGridMetricsFromFont(font, gm, textShaper);
+        auto const _ = fontResources.lock();
+        loadGridMetricsFromFont(fontResources.fonts().regular, gm, fontResources.shaper());
 
         return gm;
     }
 
-    FontKeys loadFontKeys(FontDescriptions const& fd, text::shaper& shaper)
-    {
-        FontKeys output {};
-        auto const regularOpt = shaper.load_font(fd.regular, fd.size);
-        Require(regularOpt.has_value());
-        output.regular = regularOpt.value();
-        output.bold = shaper.load_font(fd.bold, fd.size).value_or(output.regular);
-        output.italic = shaper.load_font(fd.italic, fd.size).value_or(output.regular);
-        output.boldItalic = shaper.load_font(fd.boldItalic, fd.size).value_or(output.regular);
-        output.emoji = shaper.load_font(fd.emoji, fd.size).value_or(output.regular);
-
-        return output;
-    }
-
-    unique_ptr<text::shaper> createTextShaper(TextShapingEngine engine, DPI dpi, text::font_locator& locator)
-    {
-        switch (engine)
-        {
-            case TextShapingEngine::DWrite:
-#if defined(_WIN32)
-                rendererLog()("Using DirectWrite text shaping engine.");
-                // TODO: do we want to use custom font locator here?
-                return make_unique<text::directwrite_shaper>(dpi, locator);
-#else
-                rendererLog()("DirectWrite not available on this platform.");
-                break;
-#endif
-
-            case TextShapingEngine::CoreText:
-#if defined(__APPLE__)
-                rendererLog()("CoreText not yet implemented.");
-                break;
-#else
-                rendererLog()("CoreText not available on this platform.");
-                break;
-#endif
-
-            case TextShapingEngine::OpenShaper: break;
-        }
-
-        rendererLog()("Using OpenShaper text shaping engine.");
-        return make_unique<text::open_shaper>(dpi, locator);
-    }
+    // Line hash of screen lines that must not be taken over by the next frame.
+    strong_hash const IncompleteLineHash { 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu, 0xFFFFFFFFu };
 
 } // namespace
 
@@ -123,16 +79,13 @@ Renderer::Renderer(vtbackend::PageSize pageSize,
     _atlasDirectMapping { atlasDirectMapping },
     //.
     _fontDescriptions { std::move(fontDescriptions) },
-    _textShaper { createTextShaper(_fontDescriptions.textShapingEngine,
-                                   _fontDescriptions.dpi,
-                                   createFontLocator(_fontDescriptions.fontLocator)) },
-    _fonts { loadFontKeys(_fontDescriptions, *_textShaper) },
-    _gridMetrics { loadGridMetrics(_fonts.regular, pageSize, *_textShaper) },
+    _fontResources { FontResourceRegistry::get().acquire(_fontDescriptions) },
+    _gridMetrics { loadGridMetrics(*_fontResources, pageSize) },
     //.
     _colorPalette { colorPalette },
     _backgroundRenderer { _gridMetrics, colorPalette.defaultBackground },
     _imageRenderer { _gridMetrics, cellSize() },
-    _textRenderer { _gridMetrics, *_textShaper, _fontDescriptions, _fonts, _imageRenderer },
+    _textRenderer { _gridMetrics, _fontResources, _fontDescriptions, _imageRenderer },
     _decorationRenderer { _gridMetrics, hyperlinkNormal, hyperlinkHover },
     _cursorRenderer { _gridMetrics, vtbackend::CursorShape::Block }
 {
@@ -153,6 +106,8 @@ Renderer::Renderer(vtbackend::PageSize pageSize,
 void Renderer::setRenderTarget(RenderTarget& renderTarget)
 {
     _renderTarget = &renderTarget;
+    _lastRenderedFrameID = 0;
+    _lastFrame.valid = false;
 
     // Reset DirectMappingAllocator (also skipping zero-tile).
     _directMappingAllocator = atlas::DirectMappingAllocator<RenderTileAttributes> { 1 };
@@ -217,6 +172,9 @@ void Renderer::executeImageDiscards()
 
 void Renderer::clearCache()
 {
+    _lastRenderedFrameID = 0;
+    _lastFrame.valid = false;
+
     if (!_renderTarget)
         return;
 
@@ -230,20 +188,11 @@ void Renderer::clearCache()
 
 void Renderer::setFonts(FontDescriptions fontDescriptions)
 {
-    if (_fontDescriptions.textShapingEngine == fontDescriptions.textShapingEngine)
-    {
-        _textShaper->clear_cache();
-        _textShaper->set_dpi(fontDescriptions.dpi);
-        if (_fontDescriptions.fontLocator != fontDescriptions.fontLocator)
-            _textShaper->set_locator(createFontLocator(fontDescriptions.fontLocator));
-    }
-    else
-        _textShaper = createTextShaper(fontDescriptions.textShapingEngine,
-                                       fontDescriptions.dpi,
-                                       createFontLocator(fontDescriptions.fontLocator));
+    _textRenderer.discardPendingRasterization();
 
     _fontDescriptions = std::move(fontDescriptions);
-    _fonts = loadFontKeys(_fontDescriptions, *_textShaper);
+    _fontResources = FontResourceRegistry::get().acquire(_fontDescriptions);
+    FontResourceRegistry::get().releaseExpired();
     updateFontMetrics();
 }
 
@@ -255,8 +204,11 @@ bool Renderer::setFontSize(text::font_size fontSize)
     if (fontSize.pt > 200.)
         return false;
 
+    _textRenderer.discardPendingRasterization();
+
     _fontDescriptions.size = fontSize;
-    _fonts = loadFontKeys(_fontDescriptions, *_textShaper);
+    _fontResources = FontResourceRegistry::get().acquire(_fontDescriptions);
+    FontResourceRegistry::get().releaseExpired();
     updateFontMetrics();
 
     return true;
@@ -266,7 +218,7 @@ void Renderer::updateFontMetrics()
 {
     rendererLog()("Updating grid metrics: {}", _gridMetrics);
 
-    _gridMetrics = loadGridMetrics(_fonts.regular, _gridMetrics.pageSize, *_textShaper);
+    _gridMetrics = loadGridMetrics(*_fontResources, _gridMetrics.pageSize);
 
     if (_renderTarget)
         configureTextureAtlas();
@@ -297,13 +249,21 @@ void Renderer::render(vtbackend::Terminal& terminal, bool pressure)
     _textRenderer.setPressure(pressure && terminal.isPrimaryScreen());
     {
         vtbackend::RenderBufferRef const renderBuffer = terminal.renderBuffer();
+        _frameDamage = renderBuffer.get().damageSince(_lastRenderedFrameID);
+        _lastRenderedFrameID = renderBuffer.get().frameID;
         cursorOpt = renderBuffer.get().cursor;
-        renderCells(renderBuffer.get().cells);
+        reusePreviousFrame(renderBuffer.get(), pressure && terminal.isPrimaryScreen());
+        renderCells(renderBuffer.get());
         renderLines(renderBuffer.get().lines);
     }
     _textRenderer.endFrame();
     _imageRenderer.endFrame();
 
+    // Lines lacking glyphs that are still being rasterized are rendered once more in the next frame.
+    for (vtbackend::LineOffset const line: _textRenderer.linesWithDeferredGlyphs())
+        if (0 <= *line && unbox<size_t>(line) < _lastFrame.lineHashes.size())
+            _lastFrame.lineHashes[unbox<size_t>(line)] = IncompleteLineHash;
+
     if (cursorOpt && cursorOpt.value().shape != vtbackend::CursorShape::Block)
     {
         // Note. Block cursor is implicitly rendered via standard grid cell rendering.
@@ -323,15 +283,31 @@ void Renderer::render(vtbackend::Terminal& terminal, bool pressure)
     _renderTarget->execute(terminal.currentTime());
 }
 
-void Renderer::renderCells(vector<vtbackend::RenderCell> const& renderableCells)
+void Renderer::renderCells(vtbackend::RenderBuffer const& buffer)
 {
-    for (vtbackend::RenderCell const& cell: renderableCells)
+    auto const cells = gsl::span(buffer.cells);
+    auto lineBegin = size_t { 0 };
+    while (lineBegin < cells.size())
     {
-        _backgroundRenderer.renderCell(cell);
-        _decorationRenderer.renderCell(cell);
-        _textRenderer.renderCell(cell);
-        if (cell.image)
-            _imageRenderer.renderImage(_gridMetrics.map(cell.position), *cell.image);
+        auto lineEnd = lineBegin + 1;
+        while (lineEnd < cells.size() && cells[lineEnd].position.line == cells[lineBegin].position.line)
+            ++lineEnd;
+        auto const lineCells = cells.subspan(lineBegin, lineEnd - lineBegin);
+        lineBegin = lineEnd;
+
+        if (isLineReused(lineCells.front().position.line))
+            continue;
+
+        for (vtbackend::RenderCell const& cell: lineCells)
+        {
+            _backgroundRenderer.renderCell(cell);
+            _decorationRenderer.renderCell(cell);
+            if (auto const* image = buffer.imageFragmentOf(cell))
+                _imageRenderer.renderImage(_gridMetrics.map(cell.position), *image);
+        }
+
+        // Text is rendered line by line, so that the tiles of unchanged lines can be replayed.
+        _textRenderer.renderLineCells(buffer, lineCells);
     }
 }
 
@@ -339,17 +315,169 @@ void Renderer::renderLines(vector<vtbackend::RenderLine> const& renderableLines)
 {
     for (vtbackend::RenderLine const& line: renderableLines)
     {
+        if (isLineReused(line.lineOffset))
+            continue;
+
         _backgroundRenderer.renderLine(line);
         _decorationRenderer.renderLine(line);
         _textRenderer.renderLine(line);
     }
 }
 
+void Renderer::hashLines(vtbackend::RenderBuffer const& buffer)
+{
+    _lineHashes.assign(unbox<size_t>(_gridMetrics.pageSize.lines), strong_hash { 0, 0, 0, 0 });
+
+    auto const addToLine = [&](vtbackend::LineOffset line, strong_hash const& hash) {
+        if (0 <= *line && unbox<size_t>(line) < _lineHashes.size())
+            _lineHashes[unbox<size_t>(line)] = _lineHashes[unbox<size_t>(line)] * hash;
+    };
+
+    auto const hashInput = [&]() {
+        return strong_hash::compute(_lineHashInput.data(), _lineHashInput.size() * sizeof(uint32_t));
+    };
+
+    auto const addAttributes = [&](vtbackend::RenderAttributes const& attributes) {
+        _lineHashInput.push_back(attributes.foregroundColor.value());
+        _lineHashInput.push_back(attributes.backgroundColor.value());
+        _lineHashInput.push_back(attributes.decorationColor.value());
+        _lineHashInput.push_back(static_cast<uint32_t>(attributes.flags.value()));
+    };
+
+    auto const cells = gsl::span(buffer.cells);
+    auto i = size_t { 0 };
+    while (i < cells.size())
+    {
+        auto const line = cells[i].position.line;
+        _lineHashInput.clear();
+        for (; i < cells.size() && cells[i].position.line == line; ++i)
+        {
+            vtbackend::RenderCell const& cell = cells[i];
+            _lineHashInput.push_back(unbox<uint32_t>(cell.position.column));
+            addAttributes(cell.attributes);
+            _lineHashInput.push_back(cell.width | (cell.groupStart ? 0x100u : 0u)
+                                     | (cell.groupEnd ? 0x200u : 0u)
+                                     | (cell.codepointCount << 16));
+            auto const codepoints = buffer.codepointsOf(cell);
+            _lineHashInput.insert(_lineHashInput.end(), codepoints.begin(), codepoints.end());
+            if (auto const* image = buffer.imageFragmentOf(cell))
+            {
+                _lineHashInput.push_back(unbox<uint32_t>(image->rasterizedImage().image().id()));
+                _lineHashInput.push_back(unbox<uint32_t>(image->offset().line));
+                _lineHashInput.push_back(unbox<uint32_t>(image->offset().column));
+            }
+        }
+        addToLine(line, hashInput());
+    }
+
+    for (vtbackend::RenderLine const& line: buffer.lines)
+    {
+        _lineHashInput.clear();
+        _lineHashInput.push_back(unbox<uint32_t>(line.usedColumns));
+        _lineHashInput.push_back(unbox<uint32_t>(line.displayWidth));
+        addAttributes(line.textAttributes);
+        addAttributes(line.fillAttributes);
+        addToLine(line.lineOffset, strong_hash::compute(line.text) * hashInput());
+    }
+}
+
+void Renderer::reusePreviousFrame(vtbackend::RenderBuffer const& buffer, bool pressure)
+{
+    if (!_renderTarget->frameReuseEnabled())
+    {
+        // Nothing can be taken over, so there is no point in tracking the frame contents either.
+        _reusedLines.clear();
+        _reusedLineCount = 0;
+        _lastFrame.valid = false;
+        return;
+    }
+
+    hashLines(buffer);
+
+    auto const key = strong_hash(pressure ? 1u : 0u,
+                                 _colorPalette.defaultBackground.value(),
+                                 unbox<uint32_t>(buffer.context.pageSize.columns),
+                                 unbox<uint32_t>(buffer.context.pageSize.lines))
+                     * static_cast<uint32_t>(unbox<int>(buffer.context.mainPageBaseLine));
+    auto const cursorLine =
+        buffer.cursor ? optional<vtbackend::LineOffset> { buffer.cursor->position.line } : nullopt;
+
+    _reusedLines.assign(_lineHashes.size(), false);
+    _reusedLineCount = 0;
+
+    if (_lastFrame.valid && _lastFrame.key == key && _lastFrame.lineHashes.size() == _lineHashes.size())
+    {
+        auto const mainPageBegin = unbox<int64_t>(buffer.context.mainPageBaseLine);
+        auto const mainPageEnd = mainPageBegin + unbox<int64_t>(buffer.context.pageSize.lines);
+        auto const scrolledLines = buffer.pageTopLine - _lastFrame.pageTopLine;
+        auto const lineHeight = unbox<int>(_gridMetrics.cellSize.height);
+        auto const isCursorLine = [](optional<vtbackend::LineOffset> cursor, int64_t line) {
+            return cursor && unbox<int64_t>(*cursor) == line;
+        };
+
+        // Every screen line whose render data equals the one it has been scrolled from is taken over.
+        // Status lines are never scrolled. The lines of the (non-block) text cursor are always rendered,
+        // as the cursor is not part of the render data.
+        auto copies = vector<FrameCopy> {};
+        for (auto line = int64_t { 0 }; line < static_cast<int64_t>(_lineHashes.size()); ++line)
+        {
+            auto const inMainPage = mainPageBegin <= line && line < mainPageEnd;
+            auto const source = inMainPage ? line + scrolledLines : line;
+            if (inMainPage && !(mainPageBegin <= source && source < mainPageEnd))
+                continue;
+            if (isCursorLine(cursorLine, line) || isCursorLine(_lastFrame.cursorLine, source))
+                continue;
+            if (_lastFrame.lineHashes[static_cast<size_t>(source)] != _lineHashes[static_cast<size_t>(line)])
+                continue;
+
+            _reusedLines[static_cast<size_t>(line)] = true;
+            ++_reusedLineCount;
+
+            auto const column = vtbackend::ColumnOffset(0);
+            auto const sourceY = _gridMetrics.mapTopLeft(vtbackend::LineOffset::cast_from(source), column).y;
+            auto const targetY = _gridMetrics.mapTopLeft(vtbackend::LineOffset::cast_from(line), column).y;
+            if (!copies.empty() && copies.back().sourceY + copies.back().height == sourceY
+                && copies.back().targetY + copies.back().height == targetY)
+                copies.back().height += lineHeight;
+            else
+                copies.emplace_back(
+                    FrameCopy { .sourceY = sourceY, .targetY = targetY, .height = lineHeight });
+        }
+
+        if (copies.empty() || !_renderTarget->reuseFrame(copies))
+        {
+            _reusedLines.assign(_reusedLines.size(), false);
+            _reusedLineCount = 0;
+        }
+    }
+
+    std::swap(_lastFrame.lineHashes, _lineHashes);
+    _lastFrame.pageTopLine = buffer.pageTopLine;
+    _lastFrame.cursorLine = cursorLine;
+    _lastFrame.key = key;
+    _lastFrame.valid = true;
+}
+
+bool Renderer::isLineReused(vtbackend::LineOffset line) const noexcept
+{
+    return 0 <= *line && unbox<size_t>(line) < _reusedLines.size() && _reusedLines[unbox<size_t>(line)];
+}
+
 void Renderer::inspect(std::ostream& textOutput) const
 {
+    auto damagedLines = 0;
+    for (vtbackend::Rect const& area: _frameDamage)
+        damagedLines += *area.bottom - *area.top + 1;
+    textOutput << fmt::format("Last frame: ID {}, {} damaged lines in {} areas, {} lines reused\n",
+                              _lastRenderedFrameID,
+                              damagedLines,
+                              _frameDamage.size(),
+                              _reusedLineCount);
+
     _textureAtlas->inspect(textOutput);
     for (auto const& renderable: renderables())
         renderable->inspect(textOutput);
+    FontResourceRegistry::get().inspect(textOutput);
 }
 
 } // namespace vtrasterizer
@@ -14,6 +14,7 @@
 #include <vtrasterizer/RenderTarget.h>
 #include <vtrasterizer/TextRenderer.h>
 
+#include <crispy/StrongHash.h>
 #include <crispy/StrongLRUHashtable.h>
 #include <crispy/size.h>
 
@@ -22,6 +23,7 @@
 #include <gsl/pointers>
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 namespace vtrasterizer
@@ -76,6 +78,25 @@ class Renderer
     [[nodiscard]] FontDescriptions const& fontDescriptions() const noexcept { return _fontDescriptions; }
     void setFonts(FontDescriptions fontDescriptions);
 
+    /// Rasterizes glyphs on the given number of worker threads rather than the render thread only.
+    ///
+    /// @p deferGlyphs  Indicates whether glyphs that are not rasterized yet are left out of the frame
+    ///                 and rendered in a later one (see hasDeferredGlyphs()), rather than waited for.
+    void configureGlyphRasterizer(size_t threadCount, bool deferGlyphs)
+    {
+        _textRenderer.configureRasterizerPool(threadCount, deferGlyphs);
+    }
+
+    /// Rasterizes the glyphs of the given codepoint range in the background (see configureGlyphRasterizer()).
+    void prewarmGlyphs(char32_t first, char32_t last) { _textRenderer.prewarmGlyphs(first, last); }
+
+    /// Tells whether the most recently rendered frame lacks glyphs that are still being rasterized.
+    /// Another frame should then be rendered soon.
+    [[nodiscard]] bool hasDeferredGlyphs() const noexcept
+    {
+        return !_textRenderer.linesWithDeferredGlyphs().empty();
+    }
+
     [[nodiscard]] GridMetrics const& gridMetrics() const noexcept { return _gridMetrics; }
 
     void setHyperlinkDecoration(Decorator normal, Decorator hover)
@@ -90,6 +111,8 @@ class Renderer
         if (_renderTarget)
             _renderTarget->setMargin(margin);
         _gridMetrics.pageMargin = margin;
+        _lastRenderedFrameID = 0;
+        _lastFrame.valid = false;
     }
 
     /**
@@ -105,6 +128,10 @@ class Renderer
      */
     void render(vtbackend::Terminal& terminal, bool pressureHint);
 
+    /// Screen areas that have changed in the most recently rendered frame since the frame rendered before,
+    /// in grid cell coordinates.
+    [[nodiscard]] std::vector<vtbackend::Rect> const& frameDamage() const noexcept { return _frameDamage; }
+
     void discardImage(vtbackend::Image const& image);
 
     void clearCache();
@@ -127,10 +154,24 @@ class Renderer
 
   private:
     void configureTextureAtlas();
-    void renderCells(std::vector<vtbackend::RenderCell> const& renderableCells);
+    void renderCells(vtbackend::RenderBuffer const& buffer);
     void renderLines(std::vector<vtbackend::RenderLine> const& renderableLines);
     void executeImageDiscards();
 
+    void hashLines(vtbackend::RenderBuffer const& buffer);
+    void reusePreviousFrame(vtbackend::RenderBuffer const& buffer, bool pressure);
+    [[nodiscard]] bool isLineReused(vtbackend::LineOffset line) const noexcept;
+
+    /// Render state of the most recently rendered frame, that screen lines can be taken over from.
+    struct RenderedFrame
+    {
+        std::vector<crispy::strong_hash> lineHashes {}; //!< Hash of the render data, indexed by screen line.
+        int64_t pageTopLine = 0;
+        std::optional<vtbackend::LineOffset> cursorLine {};
+        crispy::strong_hash key { 0, 0, 0, 0 }; //!< Hash of the settings the frame has been rendered with.
+        bool valid = false;
+    };
+
     crispy::strong_hashtable_size _atlasHashtableSlotCount;
     crispy::lru_capacity _atlasTileCount;
     bool _atlasDirectMapping;
@@ -141,8 +182,7 @@ class Renderer
     std::unique_ptr<Renderable::TextureAtlas> _textureAtlas;
 
     FontDescriptions _fontDescriptions;
-    std::unique_ptr<text::shaper> _textShaper;
-    FontKeys _fonts;
+    std::shared_ptr<FontResources> _fontResources; //!< Shared with all renderers of the same fonts.
 
     GridMetrics _gridMetrics;
 
@@ -151,6 +191,15 @@ class Renderer
     std::mutex _imageDiscardLock;                       //!< Lock guard for accessing _discardImageQueue.
     std::vector<vtbackend::ImageId> _discardImageQueue; //!< List of images to be discarded.
 
+    uint64_t _lastRenderedFrameID = 0;         //!< ID of the last rendered frame, or 0 to repaint all.
+    std::vector<vtbackend::Rect> _frameDamage; //!< Damaged screen areas of the last rendered frame.
+
+    RenderedFrame _lastFrame;
+    std::vector<crispy::strong_hash> _lineHashes; //!< Line hashes of the frame currently being rendered.
+    std::vector<uint32_t> _lineHashInput;
+    std::vector<bool> _reusedLines; //!< Screen lines taken over from the previous frame.
+    size_t _reusedLineCount = 0;
+
     BackgroundRenderer _backgroundRenderer;
     ImageRenderer _imageRenderer;
     TextRenderer _textRenderer;
@@ -0,0 +1,390 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtrasterizer/SoftwareRenderer.h>
+#include <vtrasterizer/shared_defines.h>
+#include <vtrasterizer/utils.h>
+
+#include <crispy/assert.h>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <cstring>
+
+using std::max;
+using std::min;
+using std::optional;
+using std::vector;
+
+namespace vtrasterizer
+{
+
+namespace
+{
+    constexpr uint8_t div255(uint32_t value) noexcept
+    {
+        value += 128;
+        return static_cast<uint8_t>((value + (value >> 8)) >> 8);
+    }
+
+    constexpr uint8_t toByte(float value) noexcept
+    {
+        return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+
+    // Blends the given RGBA source pixels onto the RGBA target pixels, the same way the OpenGL renderer
+    // does, i.e. color = src * srcAlpha + dst * (1 - srcAlpha), and alpha = srcAlpha + dstAlpha.
+    //
+    // This is the hot loop of the software renderer. It is kept free of branches and function calls,
+    // so that the compiler can vectorize it.
+    void blendRow(uint8_t* target, uint8_t const* source, size_t pixelCount) noexcept
+    {
+        for (size_t i = 0; i < pixelCount * 4; i += 4)
+        {
+            auto const alpha = static_cast<uint32_t>(source[i + 3]);
+            auto const inverseAlpha = 255u - alpha;
+            target[i + 0] = div255(source[i + 0] * alpha + target[i + 0] * inverseAlpha);
+            target[i + 1] = div255(source[i + 1] * alpha + target[i + 1] * inverseAlpha);
+            target[i + 2] = div255(source[i + 2] * alpha + target[i + 2] * inverseAlpha);
+            target[i + 3] = static_cast<uint8_t>(min(255u, alpha + target[i + 3]));
+        }
+    }
+
+    // Blends a solid color onto the RGBA target pixels with a separate coverage per color channel,
+    // as done for LCD subpixel antialiased glyphs, i.e. dst_c = color_c * cov_c + dst_c * (1 - cov_c).
+    //
+    // The coverage values are given as RGB triplets at the position of the RGBA pixel they apply to,
+    // with the tile's alpha already applied.
+    void blendRowPerChannel(uint8_t* target,
+                            uint8_t const* coverage,
+                            vtbackend::RGBColor color,
+                            size_t pixelCount) noexcept
+    {
+        for (size_t i = 0; i < pixelCount * 4; i += 4)
+        {
+            auto const r = static_cast<uint32_t>(coverage[i + 0]);
+            auto const g = static_cast<uint32_t>(coverage[i + 1]);
+            auto const b = static_cast<uint32_t>(coverage[i + 2]);
+            target[i + 0] = div255(color.red * r + target[i + 0] * (255u - r));
+            target[i + 1] = div255(color.green * g + target[i + 1] * (255u - g));
+            target[i + 2] = div255(color.blue * b + target[i + 2] * (255u - b));
+            target[i + 3] = static_cast<uint8_t>(min(255u, max({ r, g, b }) + target[i + 3]));
+        }
+    }
+
+    void fillRow(uint8_t* target, vtbackend::RGBAColor color, size_t pixelCount) noexcept
+    {
+        for (size_t i = 0; i < pixelCount * 4; i += 4)
+        {
+            target[i + 0] = color.red();
+            target[i + 1] = color.green();
+            target[i + 2] = color.blue();
+            target[i + 3] = color.alpha();
+        }
+    }
+} // namespace
+
+SoftwareRenderer::SoftwareRenderer(ImageSize renderSize)
+{
+    setRenderSize(renderSize);
+}
+
+// {{{ AtlasBackend impl
+void SoftwareRenderer::configureAtlas(atlas::ConfigureAtlas atlas)
+{
+    _configureAtlas.emplace(atlas);
+    _atlasSize = atlas.size;
+}
+
+void SoftwareRenderer::uploadTile(atlas::UploadTile tile)
+{
+    _uploadTiles.emplace_back(std::move(tile));
+}
+
+void SoftwareRenderer::renderTile(atlas::RenderTile tile)
+{
+    _renderTiles.emplace_back(tile);
+}
+// }}}
+
+// {{{ RenderTarget impl
+void SoftwareRenderer::setRenderSize(ImageSize size)
+{
+    if (_renderSize == size && !_frame.empty())
+        return;
+
+    _renderSize = size;
+    _frame.assign(size.area() * 4, 0);
+    _previousFrame.assign(size.area() * 4, 0);
+    _previousFrameValid = false;
+}
+
+void SoftwareRenderer::renderRectangle(int x, int y, Width width, Height height, RGBAColor color)
+{
+    _rectangles.emplace_back(Rectangle { x, y, unbox<int>(width), unbox<int>(height), color });
+}
+
+void SoftwareRenderer::setFrameReuse(bool enabled) noexcept
+{
+    _frameReuseEnabled = enabled;
+    _previousFrameValid = false;
+}
+
+bool SoftwareRenderer::reuseFrame(vector<FrameCopy> const& copies)
+{
+    if (!_frameReuseEnabled || !_previousFrameValid)
+        return false;
+
+    _frameCopies = copies;
+    return true;
+}
+
+void SoftwareRenderer::scheduleScreenshot(ScreenshotCallback callback)
+{
+    _pendingScreenshotCallback = std::move(callback);
+}
+
+void SoftwareRenderer::execute(std::chrono::steady_clock::time_point /*now*/)
+{
+    beginFrame();
+
+    for (Rectangle const& rect: _rectangles)
+        executeRenderRectangle(rect);
+
+    if (_configureAtlas)
+        executeConfigureAtlas(*_configureAtlas);
+
+    for (atlas::UploadTile const& tile: _uploadTiles)
+        executeUploadTile(tile);
+
+    for (atlas::RenderTile const& tile: _renderTiles)
+        executeRenderTile(tile);
+
+    _stats.rectangles += _rectangles.size();
+    _stats.uploads += _uploadTiles.size();
+    _stats.tiles += _renderTiles.size();
+    ++_stats.frames;
+
+    _configureAtlas.reset();
+    _uploadTiles.clear();
+    _rectangles.clear();
+    _renderTiles.clear();
+    _previousFrameValid = _frameReuseEnabled;
+
+    if (_pendingScreenshotCallback)
+    {
+        _pendingScreenshotCallback.value()(_frame, _renderSize);
+        _pendingScreenshotCallback.reset();
+    }
+}
+
+void SoftwareRenderer::clearCache()
+{
+    _previousFrameValid = false;
+}
+
+optional<AtlasTextureScreenshot> SoftwareRenderer::readAtlas()
+{
+    return AtlasTextureScreenshot {
+        .atlasInstanceId = 0,
+        .size = _atlasSize,
+        .format = atlas::Format::RGBA,
+        .buffer = _atlas,
+    };
+}
+
+void SoftwareRenderer::inspect(std::ostream& output) const
+{
+    output << fmt::format("Software renderer: {} frames ({} reused), {} rectangles, {} tiles, {} uploads\n",
+                          _stats.frames,
+                          _stats.reusedFrames,
+                          _stats.rectangles,
+                          _stats.tiles,
+                          _stats.uploads);
+}
+// }}}
+
+// {{{ executor impl
+void SoftwareRenderer::beginFrame()
+{
+    auto const width = unbox<int>(_renderSize.width);
+    auto const height = unbox<int>(_renderSize.height);
+    auto const pitch = static_cast<size_t>(width) * 4;
+
+    if (_frameReuseEnabled)
+        std::swap(_frame, _previousFrame);
+
+    for (auto y = 0; y < height; ++y)
+        fillRow(_frame.data() + static_cast<size_t>(y) * pitch, _clearColor, static_cast<size_t>(width));
+
+    if (_frameCopies.empty())
+        return;
+
+    for (FrameCopy const& copy: _frameCopies)
+    {
+        auto const clipped = max({ 0, -copy.sourceY, -copy.targetY });
+        auto const sourceY = copy.sourceY + clipped;
+        auto const targetY = copy.targetY + clipped;
+        auto const rows = min({ copy.height - clipped, height - sourceY, height - targetY });
+        if (rows > 0)
+            std::memcpy(_frame.data() + static_cast<size_t>(targetY) * pitch,
+                        _previousFrame.data() + static_cast<size_t>(sourceY) * pitch,
+                        static_cast<size_t>(rows) * pitch);
+    }
+    _frameCopies.clear();
+    ++_stats.reusedFrames;
+}
+
+void SoftwareRenderer::executeConfigureAtlas(atlas::ConfigureAtlas const& param)
+{
+    Require(param.properties.format == atlas::Format::RGBA);
+
+    _atlas.assign(param.size.area() * 4, 0);
+
+    rendererLog()("Software renderer: configure atlas: {} {}", param.size, param.properties.format);
+}
+
+void SoftwareRenderer::executeUploadTile(atlas::UploadTile const& param)
+{
+    if (_atlas.empty())
+        return;
+
+    auto const atlasWidth = unbox<size_t>(_atlasSize.width);
+    auto const atlasHeight = unbox<size_t>(_atlasSize.height);
+    auto const x = static_cast<size_t>(param.location.x.value);
+    auto const y = static_cast<size_t>(param.location.y.value);
+    auto const width = min(unbox<size_t>(param.bitmapSize.width), atlasWidth - min(x, atlasWidth));
+    auto const height = min(unbox<size_t>(param.bitmapSize.height), atlasHeight - min(y, atlasHeight));
+    auto const components = atlas::element_count(param.bitmapFormat);
+    auto const sourcePitch = unbox<size_t>(param.bitmapSize.width) * components;
+
+    // Convert to RGBA, the same way the OpenGL renderer does.
+    for (size_t row = 0; row < height; ++row)
+    {
+        uint8_t const* source = param.bitmap.data() + row * sourcePitch;
+        uint8_t* target = _atlas.data() + ((y + row) * atlasWidth + x) * 4;
+        for (size_t column = 0; column < width; ++column, source += components, target += 4)
+        {
+            switch (param.bitmapFormat)
+            {
+                case atlas::Format::Red:
+                    target[0] = source[0];
+                    target[1] = 0x00;
+                    target[2] = 0x00;
+                    target[3] = 0xFF;
+                    break;
+                case atlas::Format::RGB:
+                    target[0] = source[0];
+                    target[1] = source[1];
+                    target[2] = source[2];
+                    target[3] = 0xFF;
+                    break;
+                case atlas::Format::RGBA: std::memcpy(target, source, 4); break;
+            }
+        }
+    }
+}
+
+void SoftwareRenderer::executeRenderRectangle(Rectangle const& rect)
+{
+    auto const left = max(rect.x, 0);
+    auto const top = max(rect.y, 0);
+    auto const right = min(rect.x + rect.width, unbox<int>(_renderSize.width));
+    auto const bottom = min(rect.y + rect.height, unbox<int>(_renderSize.height));
+    if (left >= right || top >= bottom)
+        return;
+
+    auto const pixelCount = static_cast<size_t>(right - left);
+    auto const pitch = unbox<size_t>(_renderSize.width) * 4;
+    auto const opaque = rect.color.alpha() == 0xFF;
+
+    auto const perChannel = tile.fragmentShaderSelector == FRAGMENT_SELECTOR_GLYPH_LCD_SIMPLE
+                            || tile.fragmentShaderSelector == FRAGMENT_SELECTOR_GLYPH_LCD;
+
+    _rowBuffer.resize(pixelCount * 4);
+    fillRow(_rowBuffer.data(), rect.color, pixelCount);
+
+    for (auto y = top; y < bottom; ++y)
+    {
+        auto* target = _frame.data() + static_cast<size_t>(y) * pitch + static_cast<size_t>(left) * 4;
+        if (opaque)
+            std::memcpy(target, _rowBuffer.data(), pixelCount * 4);
+        else
+            blendRow(target, _rowBuffer.data(), pixelCount);
+    }
+}
+
+void SoftwareRenderer::executeRenderTile(atlas::RenderTile const& tile)
+{
+    auto const bitmapWidth = unbox<int>(tile.bitmapSize.width);
+    auto const bitmapHeight = unbox<int>(tile.bitmapSize.height);
+    auto const targetWidth =
+        unbox<int>(tile.targetSize.width) ? unbox<int>(tile.targetSize.width) : bitmapWidth;
+    auto const targetHeight =
+        unbox<int>(tile.targetSize.height) ? unbox<int>(tile.targetSize.height) : bitmapHeight;
+    if (bitmapWidth <= 0 || bitmapHeight <= 0 || _atlas.empty())
+        return;
+
+    auto const left = max(tile.x.value, 0);
+    auto const top = max(tile.y.value, 0);
+    auto const right = min(tile.x.value + targetWidth, unbox<int>(_renderSize.width));
+    auto const bottom = min(tile.y.value + targetHeight, unbox<int>(_renderSize.height));
+    if (left >= right || top >= bottom)
+        return;
+
+    auto const atlasWidth = unbox<size_t>(_atlasSize.width);
+    auto const pixelCount = static_cast<size_t>(right - left);
+    auto const pitch = unbox<size_t>(_renderSize.width) * 4;
+    auto const red = toByte(tile.color[0]);
+    auto const green = toByte(tile.color[1]);
+    auto const blue = toByte(tile.color[2]);
+    auto const alpha = toByte(tile.color[3]);
+
+    _rowBuffer.resize(pixelCount * 4);
+
+    for (auto y = top; y < bottom; ++y)
+    {
+        // Nearest-neighbor sampling, in case the tile is rendered at a different size.
+        auto const sourceY = static_cast<size_t>((y - tile.y.value) * bitmapHeight / targetHeight);
+        auto const* sourceRow =
+            _atlas.data() + (size_t { tile.tileLocation.y.value } + sourceY) * atlasWidth * 4;
+        auto* row = _rowBuffer.data();
+
+        // Computes the source pixels the same way the text shader does.
+        for (auto x = left; x < right; ++x, row += 4)
+        {
+            auto const sourceX = static_cast<size_t>((x - tile.x.value) * bitmapWidth / targetWidth);
+            auto const* pixel = sourceRow + (size_t { tile.tileLocation.x.value } + sourceX) * 4;
+            switch (tile.fragmentShaderSelector)
+            {
+                case FRAGMENT_SELECTOR_IMAGE_BGRA: std::memcpy(row, pixel, 4); break;
+                case FRAGMENT_SELECTOR_GLYPH_LCD_SIMPLE:
+                case FRAGMENT_SELECTOR_GLYPH_LCD:
+                    // Per-subpixel coverage, blended channel by channel below.
+                    // Subpixel positioning is not applied here, as glyphs are always rendered at
+                    // full pixel offsets.
+                    row[0] = div255(pixel[0] * uint32_t { alpha });
+                    row[1] = div255(pixel[1] * uint32_t { alpha });
+                    row[2] = div255(pixel[2] * uint32_t { alpha });
+                    row[3] = 0;
+                    break;
+                case FRAGMENT_SELECTOR_GLYPH_ALPHA:
+                default:
+                    row[0] = red;
+                    row[1] = green;
+                    row[2] = blue;
+                    row[3] = div255(pixel[0] * uint32_t { alpha });
+                    break;
+            }
+        }
+
+        auto* target = _frame.data() + static_cast<size_t>(y) * pitch + static_cast<size_t>(left) * 4;
+        if (perChannel)
+            blendRowPerChannel(
+                target, _rowBuffer.data(), vtbackend::RGBColor { red, green, blue }, pixelCount);
+        else
+            blendRow(target, _rowBuffer.data(), pixelCount);
+    }
+}
+// }}}
+
+} // namespace vtrasterizer
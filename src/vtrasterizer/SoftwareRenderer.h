@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: Apache-2.0
+#pragma once
+
+#include <vtbackend/Color.h>
+#include <vtbackend/primitives.h>
+
+#include <vtrasterizer/RenderTarget.h>
+#include <vtrasterizer/TextureAtlas.h>
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <vector>
+
+namespace vtrasterizer
+{
+
+/**
+ * Render target that rasterizes into an RGBA frame buffer in system memory, using the CPU only.
+ *
+ * Render commands are executed the same way the OpenGL renderer does,
+ * i.e. all filled rectangles first, then all texture tiles, using the same blending.
+ *
+ * This allows running the full render pipeline without a GPU, e.g. for benchmarks and tests.
+ *
+ * @see OpenGLRenderer
+ */
+class SoftwareRenderer final: public RenderTarget, public atlas::AtlasBackend
+{
+  public:
+    struct Stats
+    {
+        uint64_t frames = 0;       ///< Number of executed frames.
+        uint64_t reusedFrames = 0; ///< Number of frames that started with parts of the previous one.
+        uint64_t rectangles = 0;   ///< Number of filled rectangles.
+        uint64_t tiles = 0;        ///< Number of rendered texture tiles.
+        uint64_t uploads = 0;      ///< Number of tiles uploaded to the texture atlas.
+    };
+
+    explicit SoftwareRenderer(ImageSize renderSize);
+
+    // AtlasBackend implementation
+    [[nodiscard]] ImageSize atlasSize() const noexcept override { return _atlasSize; }
+    void configureAtlas(atlas::ConfigureAtlas atlas) override;
+    void uploadTile(atlas::UploadTile tile) override;
+    void renderTile(atlas::RenderTile tile) override;
+
+    // RenderTarget implementation
+    void setRenderSize(ImageSize size) override;
+    void setMargin(PageMargin /*margin*/) override {}
+    atlas::AtlasBackend& textureScheduler() override { return *this; }
+    void renderRectangle(int x, int y, Width width, Height height, RGBAColor color) override;
+    bool reuseFrame(std::vector<FrameCopy> const& copies) override;
+    void scheduleScreenshot(ScreenshotCallback callback) override;
+    void execute(std::chrono::steady_clock::time_point now) override;
+    void clearCache() override;
+    std::optional<AtlasTextureScreenshot> readAtlas() override;
+    void inspect(std::ostream& output) const override;
+
+    /// Sets the color every frame is initially filled with, i.e. the window's background.
+    void setClearColor(RGBAColor color) noexcept { _clearColor = color; }
+
+    /// Enables/disables taking over parts of the previous frame, as requested by the Renderer.
+    void setFrameReuse(bool enabled) noexcept;
+    [[nodiscard]] bool frameReuseEnabled() const noexcept override { return _frameReuseEnabled; }
+
+    [[nodiscard]] ImageSize renderSize() const noexcept { return _renderSize; }
+
+    /// Returns the RGBA pixels of the most recently executed frame, top-most row first.
+    [[nodiscard]] atlas::Buffer const& frame() const noexcept { return _frame; }
+
+    [[nodiscard]] Stats const& stats() const noexcept { return _stats; }
+
+  private:
+    struct Rectangle
+    {
+        int x;
+        int y;
+        int width;
+        int height;
+        RGBAColor color;
+    };
+
+    void executeConfigureAtlas(atlas::ConfigureAtlas const& param);
+    void executeUploadTile(atlas::UploadTile const& param);
+    void executeRenderRectangle(Rectangle const& rect);
+    void executeRenderTile(atlas::RenderTile const& tile);
+    void beginFrame();
+
+    ImageSize _renderSize;
+    atlas::Buffer _frame;         // RGBA, top-most row first.
+    atlas::Buffer _previousFrame; // The frame before, if frame reuse is enabled.
+    RGBAColor _clearColor { 0x000000FF };
+
+    ImageSize _atlasSize {};
+    atlas::Buffer _atlas; // RGBA, top-most row first.
+
+    // Scheduled render commands, executed in execute().
+    std::optional<atlas::ConfigureAtlas> _configureAtlas;
+    std::vector<atlas::UploadTile> _uploadTiles;
+    std::vector<Rectangle> _rectangles;
+    std::vector<atlas::RenderTile> _renderTiles;
+
+    bool _frameReuseEnabled = false;
+    bool _previousFrameValid = false;
+    std::vector<FrameCopy> _frameCopies;
+
+    std::vector<uint8_t> _rowBuffer; // Source pixels of the row currently being blended.
+
+    std::optional<ScreenshotCallback> _pendingScreenshotCallback;
+
+    Stats _stats;
+};
+
+} // namespace vtrasterizer
@@ -0,0 +1,168 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtrasterizer/SoftwareRenderer.h>
+#include <vtrasterizer/shared_defines.h>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <array>
+#include <chrono>
+
+using namespace vtbackend;
+using namespace vtrasterizer;
+
+using std::array;
+
+namespace
+{
+
+ImageSize makeSize(unsigned width, unsigned height)
+{
+    return ImageSize { Width(width), Height(height) };
+}
+
+array<uint8_t, 4> pixelAt(SoftwareRenderer const& renderer, int x, int y)
+{
+    auto const offset =
+        (static_cast<size_t>(y) * unbox<size_t>(renderer.renderSize().width) + static_cast<size_t>(x)) * 4;
+    auto const& frame = renderer.frame();
+    return { frame[offset + 0], frame[offset + 1], frame[offset + 2], frame[offset + 3] };
+}
+
+void execute(SoftwareRenderer& renderer)
+{
+    renderer.execute(std::chrono::steady_clock::now());
+}
+
+} // namespace
+
+TEST_CASE("SoftwareRenderer.renderRectangle")
+{
+    auto renderer = SoftwareRenderer { makeSize(4, 4) };
+    renderer.setClearColor(RGBAColor { 0x000000FF });
+
+    renderer.renderRectangle(1, 1, Width(2), Height(2), RGBAColor { 0xFF0000FF });
+    renderer.renderRectangle(2, 2, Width(8), Height(8), RGBAColor { 0x0000FF80 });
+    execute(renderer);
+
+    CHECK(pixelAt(renderer, 0, 0) == array<uint8_t, 4> { 0x00, 0x00, 0x00, 0xFF });
+    CHECK(pixelAt(renderer, 1, 1) == array<uint8_t, 4> { 0xFF, 0x00, 0x00, 0xFF });
+
+    // Semi-transparent blue, blended onto red and onto the black background, and clipped to the frame.
+    CHECK(pixelAt(renderer, 2, 2) == array<uint8_t, 4> { 0x7F, 0x00, 0x80, 0xFF });
+    CHECK(pixelAt(renderer, 3, 3) == array<uint8_t, 4> { 0x00, 0x00, 0x80, 0xFF });
+    CHECK(renderer.stats().rectangles == 2);
+}
+
+TEST_CASE("SoftwareRenderer.renderTile")
+{
+    auto renderer = SoftwareRenderer { makeSize(4, 4) };
+    renderer.setClearColor(RGBAColor { 0x000000FF });
+
+    renderer.configureAtlas(atlas::ConfigureAtlas {
+        .size = makeSize(8, 8),
+        .properties = atlas::AtlasProperties { .format = atlas::Format::RGBA, .tileSize = makeSize(2, 2) },
+    });
+    CHECK(renderer.atlasSize() == makeSize(8, 8));
+
+    // 2x2 glyph with full coverage in the top row and none in the bottom row.
+    auto const location = atlas::TileLocation { atlas::TileLocation::X { 2 }, atlas::TileLocation::Y { 4 } };
+    renderer.uploadTile(atlas::UploadTile {
+        .location = location,
+        .bitmap = atlas::Buffer { 0xFF, 0xFF, 0x00, 0x00 },
+        .bitmapSize = makeSize(2, 2),
+        .bitmapFormat = atlas::Format::Red,
+    });
+
+    auto tile = atlas::RenderTile {};
+    tile.x = atlas::RenderTile::X { 1 };
+    tile.y = atlas::RenderTile::Y { 1 };
+    tile.bitmapSize = makeSize(2, 2);
+    tile.color = { 0.0f, 1.0f, 0.0f, 1.0f };
+    tile.tileLocation = location;
+    tile.fragmentShaderSelector = FRAGMENT_SELECTOR_GLYPH_ALPHA;
+    renderer.renderTile(tile);
+    execute(renderer);
+
+    CHECK(pixelAt(renderer, 1, 1) == array<uint8_t, 4> { 0x00, 0xFF, 0x00, 0xFF });
+    CHECK(pixelAt(renderer, 2, 1) == array<uint8_t, 4> { 0x00, 0xFF, 0x00, 0xFF });
+    CHECK(pixelAt(renderer, 1, 2) == array<uint8_t, 4> { 0x00, 0x00, 0x00, 0xFF });
+    CHECK(pixelAt(renderer, 0, 1) == array<uint8_t, 4> { 0x00, 0x00, 0x00, 0xFF });
+    CHECK(renderer.stats().uploads == 1);
+    CHECK(renderer.stats().tiles == 1);
+
+    auto const atlasScreenshot = renderer.readAtlas();
+    REQUIRE(atlasScreenshot.has_value());
+    CHECK(atlasScreenshot->buffer.size() == 8 * 8 * 4);
+}
+
+TEST_CASE("SoftwareRenderer.reuseFrame")
+{
+    auto renderer = SoftwareRenderer { makeSize(2, 3) };
+    renderer.setClearColor(RGBAColor { 0x000000FF });
+
+    // Nothing to reuse unless enabled.
+    CHECK_FALSE(renderer.reuseFrame({ FrameCopy { .sourceY = 1, .targetY = 0, .height = 2 } }));
+
+    renderer.setFrameReuse(true);
+
+    // Nothing to reuse before the first frame.
+    CHECK_FALSE(renderer.reuseFrame({ FrameCopy { .sourceY = 1, .targetY = 0, .height = 2 } }));
+
+    renderer.renderRectangle(0, 1, Width(2), Height(1), RGBAColor { 0xFF0000FF });
+    renderer.renderRectangle(0, 2, Width(2), Height(1), RGBAColor { 0x00FF00FF });
+    execute(renderer);
+
+    // Scroll up by one row, only rendering the newly exposed bottom row.
+    CHECK(renderer.reuseFrame({ FrameCopy { .sourceY = 1, .targetY = 0, .height = 2 } }));
+    renderer.renderRectangle(0, 2, Width(2), Height(1), RGBAColor { 0x0000FFFF });
+    execute(renderer);
+
+    CHECK(pixelAt(renderer, 0, 0) == array<uint8_t, 4> { 0xFF, 0x00, 0x00, 0xFF });
+    CHECK(pixelAt(renderer, 1, 1) == array<uint8_t, 4> { 0x00, 0xFF, 0x00, 0xFF });
+    CHECK(pixelAt(renderer, 1, 2) == array<uint8_t, 4> { 0x00, 0x00, 0xFF, 0xFF });
+    CHECK(renderer.stats().reusedFrames == 1);
+
+    // Invalidated frames are never reused.
+    renderer.clearCache();
+    CHECK_FALSE(renderer.reuseFrame({ FrameCopy { .sourceY = 1, .targetY = 0, .height = 2 } }));
+}
+
+TEST_CASE("SoftwareRenderer.renderTile.lcd")
+{
+    auto renderer = SoftwareRenderer { makeSize(2, 1) };
+    renderer.setClearColor(RGBAColor { 0x204060FF });
+
+    renderer.configureAtlas(atlas::ConfigureAtlas {
+        .size = makeSize(4, 4),
+        .properties = atlas::AtlasProperties { .format = atlas::Format::RGBA, .tileSize = makeSize(2, 1) },
+    });
+
+    // Full coverage of all subpixels in the left pixel, red subpixel only in the right one.
+    auto const location = atlas::TileLocation { atlas::TileLocation::X { 0 }, atlas::TileLocation::Y { 0 } };
+    renderer.uploadTile(atlas::UploadTile {
+        .location = location,
+        .bitmap = atlas::Buffer { 0xFF, 0xFF, 0xFF, 0xFF, 0x00, 0x00 },
+        .bitmapSize = makeSize(2, 1),
+        .bitmapFormat = atlas::Format::RGB,
+    });
+
+    auto tile = atlas::RenderTile {};
+    tile.x = atlas::RenderTile::X { 0 };
+    tile.y = atlas::RenderTile::Y { 0 };
+    tile.bitmapSize = makeSize(2, 1);
+    tile.color = { 1.0f, 1.0f, 1.0f, 1.0f };
+    tile.tileLocation = location;
+    tile.fragmentShaderSelector = FRAGMENT_SELECTOR_GLYPH_LCD;
+    renderer.renderTile(tile);
+    execute(renderer);
+
+    // Each subpixel is blended with its own coverage, and covered subpixels take the full text color.
+    CHECK(pixelAt(renderer, 0, 0) == array<uint8_t, 4> { 0xFF, 0xFF, 0xFF, 0xFF });
+    CHECK(pixelAt(renderer, 1, 0) == array<uint8_t, 4> { 0xFF, 0x40, 0x60, 0xFF });
+
+    // The tile's alpha scales the coverage of every subpixel.
+    tile.color = { 1.0f, 1.0f, 1.0f, 0.0f };
+    renderer.renderTile(tile);
+    execute(renderer);
+    CHECK(pixelAt(renderer, 0, 0) == array<uint8_t, 4> { 0x20, 0x40, 0x60, 0xFF });
+}
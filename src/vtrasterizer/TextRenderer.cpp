@@ -116,7 +116,6 @@ Making use of reserved glyph slots
 #include <vtrasterizer/shared_defines.h>
 #include <vtrasterizer/utils.h>
 
-#include <text_shaper/font_locator_provider.h>
 #include <text_shaper/fontconfig_locator.h>
 #include <text_shaper/mock_font_locator.h>
 
@@ -148,6 +147,7 @@ Making use of reserved glyph slots
 #include <range/v3/view/enumerate.hpp>
 
 #include <algorithm>
+#include <array>
 
 using crispy::point;
 using crispy::strong_hash;
@@ -182,6 +182,7 @@ namespace
     constexpr auto FirstReservedChar = char32_t { 0x21 };
     constexpr auto LastReservedChar = char32_t { 0x7E };
     constexpr auto DirectMappedCharsCount = LastReservedChar - FirstReservedChar + 1;
+    constexpr auto PinnedFontStyleCount = 4; // regular, bold, italic, bold-italic
 
     strong_hash hashGlyphKeyAndPresentation(text::glyph_key const& glyphKey,
                                             unicode::PresentationStyle presentation) noexcept
@@ -253,35 +254,25 @@ namespace
     }
 } // namespace
 
-text::font_locator& createFontLocator(FontLocatorEngine engine)
-{
-    switch (engine)
-    {
-        case FontLocatorEngine::Mock: return text::font_locator_provider::get().mock();
-        default: return text::font_locator_provider::get().native();
-    }
+// Number of distinct lines whose render tiles are kept. This should comfortably exceed
+// the number of lines on a page, so that scrolling back and forth keeps hitting the cache.
+constexpr uint32_t LineTileCacheSize = 1024;
 
-    crispy::unreachable();
-}
-
-// TODO: What's a good value here? Or do we want to make that configurable,
-// or even computed based on memory resources available?
-constexpr uint32_t TextShapingCacheSize = 4000;
+// Number of codepoints shaped per frame for prewarming, bounding the time taken from each frame.
+constexpr char32_t PrewarmCodepointsPerFrame = 256;
 
 TextRenderer::TextRenderer(GridMetrics const& gridMetrics,
-                           text::shaper& textShaper,
+                           std::shared_ptr<FontResources> const& fontResources,
                            FontDescriptions& fontDescriptions,
-                           FontKeys const& fontKeys,
                            TextRendererEvents& eventHandler):
     Renderable { gridMetrics },
     _textClusterGrouper { *this },
     _textRendererEvents { eventHandler },
     _fontDescriptions { fontDescriptions },
-    _fonts { fontKeys },
-    _textShapingCache { ShapingResultCache::create(crispy::strong_hashtable_size { 16384 },
-                                                   crispy::lru_capacity { TextShapingCacheSize },
-                                                   "Text shaping cache") },
-    _textShaper { textShaper },
+    _fontResources { fontResources },
+    _lineTileCache { LineTileCache::create(crispy::strong_hashtable_size { 4096 },
+                                           crispy::lru_capacity { LineTileCacheSize },
+                                           "Line tile cache") },
     _boxDrawingRenderer { gridMetrics }
 {
 }
@@ -289,14 +280,21 @@ TextRenderer::TextRenderer(GridMetrics const& gridMetrics,
 void TextRenderer::inspect(ostream& textOutput) const
 {
     textOutput << "TextRenderer:\n";
-    _textShapingCache->inspect(textOutput);
+    textOutput << fmt::format("pinned glyph tier   : {} fonts, {}\n", _pinnedFonts.size(), _pinnedGlyphStats);
+    _fontResources->inspect(textOutput);
+    _lineTileCache->inspect(textOutput);
+    if (_rasterizerPool)
+        _rasterizerPool->inspect(textOutput);
     _boxDrawingRenderer.inspect(textOutput);
 }
 
 void TextRenderer::setRenderTarget(
     RenderTarget& renderTarget, atlas::DirectMappingAllocator<RenderTileAttributes>& directMappingAllocator)
 {
-    _directMapping = directMappingAllocator.allocate(DirectMappedCharsCount);
+    _directMapping = directMappingAllocator.allocate(DirectMappedCharsCount * PinnedFontStyleCount);
+    _pinnedFonts.clear();
+    // The texture atlas belongs to the previous render target. The new one is set via setTextureAtlas().
+    _textureAtlas = nullptr;
     Renderable::setRenderTarget(renderTarget, directMappingAllocator);
     _boxDrawingRenderer.setRenderTarget(renderTarget, directMappingAllocator);
     clearCache();
@@ -306,6 +304,7 @@ void TextRenderer::setTextureAtlas(TextureAtlas& atlas)
 {
     Renderable::setTextureAtlas(atlas);
     _boxDrawingRenderer.setTextureAtlas(atlas);
+    _lineTileCache->clear();
 
     if (_directMapping)
         initializeDirectMapping();
@@ -313,10 +312,14 @@ void TextRenderer::setTextureAtlas(TextureAtlas& atlas)
 
 void TextRenderer::clearCache()
 {
+    discardPendingRasterization();
+    _prewarmNext = _prewarmBegin;
+
     if (_textureAtlas && _directMapping)
         initializeDirectMapping();
 
-    _textShapingCache->clear();
+    // The text shaping cache is not cleared, as it is shared and only depends on the fonts.
+    _lineTileCache->clear();
 
     _boxDrawingRenderer.clearCache();
 }
@@ -368,55 +371,122 @@ void TextRenderer::restrictToTileSize(TextureAtlas::TileCreateData& tileCreateDa
 void TextRenderer::initializeDirectMapping()
 {
     Require(_textureAtlas);
-    Require(_directMapping.count == DirectMappedCharsCount);
+    Require(_directMapping.count == DirectMappedCharsCount * PinnedFontStyleCount);
 
-    _directMappedGlyphKeyToTileIndex.clear();
-    _directMappedGlyphKeyToTileIndex.resize(LastReservedChar + 1);
+    _pinnedFonts.clear();
+    _pinnedGlyphStats = {};
 
-    for (char32_t codepoint = FirstReservedChar; codepoint <= LastReservedChar; ++codepoint)
+    auto const fontLock = _fontResources->lock();
+    FontKeys const& fontKeys = _fontResources->fonts();
+    auto const fonts = array { fontKeys.regular, fontKeys.bold, fontKeys.italic, fontKeys.boldItalic };
+    for (uint32_t styleIndex = 0; styleIndex < fonts.size(); ++styleIndex)
     {
-        if (optional<text::glyph_position> gposOpt = _textShaper.shape(_fonts.regular, codepoint))
+        auto const font = fonts[styleIndex];
+
+        // Styles without a font of their own share the regular font's key.
+        if (crispy::any_of(_pinnedFonts, [font](auto const& pinned) { return pinned.font == font; }))
+            continue;
+
+        auto& pinned = _pinnedFonts.emplace_back(PinnedFont { font, {} });
+        auto const baseIndex = styleIndex * DirectMappedCharsCount;
+        for (char32_t codepoint = FirstReservedChar; codepoint <= LastReservedChar; ++codepoint)
         {
+            optional<text::glyph_position> gposOpt = _fontResources->shaper().shape(font, codepoint);
+            if (!gposOpt.has_value())
+                continue;
+
             text::glyph_key const& glyph = gposOpt.value().glyph;
-            if (glyph.index.value >= _directMappedGlyphKeyToTileIndex.size())
-                _directMappedGlyphKeyToTileIndex.resize(glyph.index.value
-                                                        + (LastReservedChar - codepoint + 1));
-            _directMappedGlyphKeyToTileIndex[glyph.index.value] =
-                _directMapping.toTileIndex(codepoint - FirstReservedChar);
+            auto const tileIndex = _directMapping.toTileIndex(baseIndex + codepoint - FirstReservedChar);
+            auto tileCreateData = createRasterizedGlyph(
+                _textureAtlas->tileLocation(tileIndex), glyph, unicode::PresentationStyle::Text);
+
+            // Glyphs wider than a tile (such as overhanging italics) are left to the LRU tier,
+            // which splits them across multiple tiles rather than cutting them off.
+            // Glyphs taller than a tile would overflow into the neighbouring tile's slot and are
+            // left to the LRU tier, too.
+            if (!tileCreateData || tileCreateData->bitmapSize.width > _textureAtlas->tileSize().width
+                || tileCreateData->bitmapSize.height > _textureAtlas->tileSize().height)
+                continue;
+
+            _textureAtlas->setDirectMapping(tileIndex, std::move(*tileCreateData));
+            if (glyph.index.value >= pinned.glyphIndexToTileIndex.size())
+                pinned.glyphIndexToTileIndex.resize(glyph.index.value + 1);
+            pinned.glyphIndexToTileIndex[glyph.index.value] = tileIndex;
         }
     }
 }
 
-Renderable::AtlasTileAttributes const* TextRenderer::ensureRasterizedIfDirectMapped(
-    text::glyph_key const& glyph)
+Renderable::AtlasTileAttributes const* TextRenderer::getIfDirectMapped(text::glyph_key const& glyph)
 {
-    if (!isGlyphDirectMapped(glyph))
+    auto const tileIndex = directMappedTileIndex(glyph);
+    if (!tileIndex)
+    {
+        ++_pinnedGlyphStats.misses;
         return nullptr;
+    }
 
-    auto const tileIndex = _directMappedGlyphKeyToTileIndex[glyph.index.value];
+    ++_pinnedGlyphStats.hits;
+    return &_textureAtlas->directMapped(tileIndex);
+}
 
-    if (_textureAtlas->directMapped(tileIndex).bitmapSize.width.value)
-        // TODO: Find a better way to test if the glyph was rasterized&uploaded already.
-        // like: if (_textureAtlas->isDirectMappingSet(tileIndex)) ...
-        return &_textureAtlas->directMapped(tileIndex);
+void TextRenderer::configureRasterizerPool(size_t threadCount, bool deferGlyphs)
+{
+    _rasterizerPool.reset();
+    _deferGlyphs = false;
 
-    auto const tileLocation = _textureAtlas->tileLocation(tileIndex);
-    auto tileCreateData = createRasterizedGlyph(tileLocation, glyph, unicode::PresentationStyle::Text);
-    if (!tileCreateData)
-        return nullptr;
+    if (!threadCount)
+        return;
 
-    restrictToTileSize(*tileCreateData);
-    Require(tileCreateData->bitmapSize.width <= textureAtlas().tileSize().width);
+    if (!_fontResources->shaper().supports_concurrent_rasterization())
+    {
+        rendererLog()("Text shaper does not support concurrent glyph rasterization.");
+        return;
+    }
 
-    // fmt::print("Initialize direct mapping {} ({}) for {}; {}; {}\n",
-    //            tileIndex,
-    //            tileLocation,
-    //            glyph,
-    //            tileCreateData->bitmapSize,
-    //            tileCreateData->metadata);
+    _rasterizerRenderMode = _fontDescriptions.renderMode;
+    _rasterizerPool = make_unique<GlyphRasterizerPool>(threadCount, [this](text::glyph_key const& glyph) {
+        return _fontResources->shaper().rasterize_concurrently(glyph, _rasterizerRenderMode);
+    });
+    _deferGlyphs = deferGlyphs;
+}
 
-    _textureAtlas->setDirectMapping(tileIndex, std::move(*tileCreateData));
-    return &_textureAtlas->directMapped(tileIndex);
+void TextRenderer::prewarmGlyphs(char32_t first, char32_t last)
+{
+    _prewarmBegin = first;
+    _prewarmNext = first;
+    _prewarmEnd = last + 1;
+}
+
+void TextRenderer::discardPendingRasterization()
+{
+    if (!_rasterizerPool)
+        return;
+
+    _rasterizerPool->clear();
+    // No glyph is being rasterized now, so the render mode can be updated safely.
+    _rasterizerRenderMode = _fontDescriptions.renderMode;
+}
+
+void TextRenderer::prewarmNextGlyphs()
+{
+    if (!_rasterizerPool || !_rasterizerPool->threadCount() || _prewarmNext >= _prewarmEnd)
+        return;
+
+    auto const fontLock = _fontResources->lock();
+    auto const end = min<char32_t>(_prewarmNext + PrewarmCodepointsPerFrame, _prewarmEnd);
+    for (; _prewarmNext < end; ++_prewarmNext)
+    {
+        // Shaped just like text being rendered, so that the glyphs end up with the very same keys.
+        auto const codepoint = _prewarmNext;
+        auto cluster = 0u;
+        auto const glyphPositions = createTextShapedGlyphPositions(
+            u32string_view(&codepoint, 1), gsl::span(&cluster, 1), TextStyle::Regular);
+        for (text::glyph_position const& gpos: glyphPositions)
+            if (!directMappedTileIndex(gpos.glyph))
+                _rasterizerPool->submit(hashGlyphKeyAndPresentation(gpos.glyph, gpos.presentation),
+                                        gpos.glyph,
+                                        GlyphRasterizerPool::Priority::Prewarm);
+    }
 }
 
 void TextRenderer::updateFontMetrics()
@@ -430,21 +500,105 @@ void TextRenderer::updateFontMetrics()
 void TextRenderer::beginFrame()
 {
     _textClusterGrouper.beginFrame();
+    _linesWithDeferredGlyphs.clear();
+}
+
+template <typename RenderFn>
+void TextRenderer::renderCachedLine(strong_hash const& hash,
+                                    vtbackend::LineOffset line,
+                                    RenderFn renderUncached)
+{
+    auto const origin = _gridMetrics.map(line, vtbackend::ColumnOffset(0));
+    auto const atlasGeneration = textureAtlas().generation();
+
+    if (CachedLineTiles const* cached = _lineTileCache->try_get(hash);
+        cached && cached->atlasGeneration == atlasGeneration)
+    {
+        _textRendererEvents.onBeforeRenderingText();
+        for (atlas::RenderTile tile: cached->tiles)
+        {
+            tile.x.value += origin.x;
+            tile.y.value += origin.y;
+            textureScheduler().renderTile(tile);
+        }
+        _textRendererEvents.onAfterRenderingText();
+        return;
+    }
+
+    auto const deferredGlyphCount = _deferredGlyphCount;
+    _recordedLineTiles.clear();
+    setTileRecorder(&_recordedLineTiles);
+    _boxDrawingRenderer.setTileRecorder(&_recordedLineTiles);
+    {
+        auto _ = crispy::finally { [&]() noexcept {
+            setTileRecorder(nullptr);
+            _boxDrawingRenderer.setTileRecorder(nullptr);
+        } };
+        renderUncached();
+        _textClusterGrouper.forceGroupEnd();
+    }
+
+    // If tiles have been evicted from the atlas meanwhile, some of the recorded ones
+    // may already refer to other glyphs, so they must not be replayed.
+    if (textureAtlas().generation() != atlasGeneration)
+        return;
+
+    // Lines lacking glyphs yet to be rasterized are rendered once more when they are available.
+    if (_deferredGlyphCount != deferredGlyphCount)
+        return;
+
+    for (atlas::RenderTile& tile: _recordedLineTiles)
+    {
+        tile.x.value -= origin.x;
+        tile.y.value -= origin.y;
+    }
+    _lineTileCache->emplace(hash, CachedLineTiles { atlasGeneration, std::move(_recordedLineTiles) });
 }
 
 void TextRenderer::renderLine(vtbackend::RenderLine const& renderLine)
 {
-    _textClusterGrouper.renderLine(renderLine.text,
-                                   renderLine.lineOffset,
-                                   renderLine.textAttributes.foregroundColor,
-                                   makeTextStyle(renderLine.textAttributes.flags));
+    auto const style = makeTextStyle(renderLine.textAttributes.flags);
+    auto const hash = strong_hash::compute(renderLine.text.data(), renderLine.text.size())
+                      * renderLine.textAttributes.foregroundColor.value() * static_cast<uint32_t>(style);
+
+    renderCachedLine(hash, renderLine.lineOffset, [&]() {
+        _textClusterGrouper.renderLine(
+            renderLine.text, renderLine.lineOffset, renderLine.textAttributes.foregroundColor, style);
+    });
 }
 
-void TextRenderer::renderCell(vtbackend::RenderCell const& cell)
+void TextRenderer::renderLineCells(vtbackend::RenderBuffer const& buffer,
+                                   gsl::span<vtbackend::RenderCell const> cells)
+{
+    if (cells.empty())
+        return;
+
+    // Serialize everything that affects the text's render tiles, and hash that in one go.
+    _lineHashInput.clear();
+    for (vtbackend::RenderCell const& cell: cells)
+    {
+        auto const style = static_cast<uint32_t>(makeTextStyle(cell.attributes.flags));
+        _lineHashInput.push_back(unbox<uint32_t>(cell.position.column));
+        _lineHashInput.push_back(cell.attributes.foregroundColor.value());
+        _lineHashInput.push_back(style | (cell.groupStart ? 0x100u : 0u) | (cell.groupEnd ? 0x200u : 0u)
+                                 | (cell.codepointCount << 16));
+        auto const codepoints = buffer.codepointsOf(cell);
+        _lineHashInput.insert(_lineHashInput.end(), codepoints.begin(), codepoints.end());
+    }
+    auto const hash = strong_hash::compute(_lineHashInput.data(), _lineHashInput.size() * sizeof(uint32_t));
+
+    renderCachedLine(hash, cells.front().position.line, [&]() {
+        _textClusterGrouper.forceGroupStart();
+        for (vtbackend::RenderCell const& cell: cells)
+            renderCell(cell, buffer.codepointsOf(cell));
+    });
+}
+
+void TextRenderer::renderCell(vtbackend::RenderCell const& cell, std::u32string_view codepoints)
 {
     // fmt::print("renderCell: {} {} {} {} {}\n",
     //            cell.position,
-    //            unicode::convert_to<char>(u32string_view(cell.codepoints)),
+    //            unicode::convert_to<char>(codepoints),
     //            _forceUpdateInitialPenPosition ? "forcedRestart" : "-",
     //            cell.groupStart ? "groupStart" : "-",
     //            cell.groupEnd ? "groupEnd" : "-");
@@ -453,7 +607,7 @@ void TextRenderer::renderCell(vtbackend::RenderCell const& cell)
         _textClusterGrouper.forceGroupStart();
 
     _textClusterGrouper.renderCell(cell.position,
-                                   cell.codepoints,
+                                   codepoints,
                                    makeTextStyle(cell.attributes.flags),
                                    cell.attributes.foregroundColor);
 
@@ -472,6 +626,7 @@ void TextRenderer::renderCell(vtbackend::CellLocation position,
 void TextRenderer::endFrame()
 {
     _textClusterGrouper.endFrame();
+    prewarmNextGlyphs();
 }
 
 point TextRenderer::applyGlyphPositionToPen(point pen,
@@ -560,14 +715,24 @@ void TextRenderer::renderTextGroup(std::u32string_view codepoints,
         _textRendererEvents.onAfterRenderingText();
     } };
 
-    auto const hash = hashTextAndStyle(codepoints, style);
-    text::shape_result const& glyphPositions =
-        getOrCreateCachedGlyphPositions(hash, codepoints, clusters, style);
+    // The font resources are shared with other renderers, so they are locked for shaping only,
+    // but not while waiting for the rasterizer pool. The shaping result is copied, as it may be
+    // evicted from the shared cache once unlocked.
+    {
+        auto const fontLock = _fontResources->lock();
+        _glyphPositions = getOrCreateCachedGlyphPositions(
+            hashTextAndStyle(codepoints, style), codepoints, clusters, style);
+    }
+    text::shape_result const& glyphPositions = _glyphPositions;
     crispy::point pen = _gridMetrics.mapBottomLeft(initialPenPosition);
 
+    if (_rasterizerPool)
+        rasterizeMissingGlyphs(glyphPositions);
+    auto const deferredGlyphCount = _deferredGlyphCount;
+
     for (auto const& glyphPosition: glyphPositions)
     {
-        if (auto const* attributes = ensureRasterizedIfDirectMapped(glyphPosition.glyph))
+        if (auto const* attributes = getIfDirectMapped(glyphPosition.glyph))
         {
             auto const pen1 = applyGlyphPositionToPen(pen, *attributes, glyphPosition);
             renderRasterizedGlyph(pen1, color, *attributes);
@@ -608,6 +773,53 @@ void TextRenderer::renderTextGroup(std::u32string_view codepoints,
                 static_cast<decltype(pen.x)>(numberOfCellsToAdvance * (unbox(_gridMetrics.cellSize.width)));
         }
     }
+
+    if (_deferredGlyphCount != deferredGlyphCount
+        && (_linesWithDeferredGlyphs.empty() || _linesWithDeferredGlyphs.back() != initialPenPosition.line))
+        _linesWithDeferredGlyphs.emplace_back(initialPenPosition.line);
+}
+
+void TextRenderer::rasterizeMissingGlyphs(text::shape_result const& glyphPositions)
+{
+    _missingGlyphs.clear();
+    for (text::glyph_position const& glyphPosition: glyphPositions)
+    {
+        if (directMappedTileIndex(glyphPosition.glyph))
+            continue;
+
+        auto const hash = hashGlyphKeyAndPresentation(glyphPosition.glyph, glyphPosition.presentation);
+        if (textureAtlas().contains(hash))
+            continue;
+
+        _rasterizerPool->submit(hash, glyphPosition.glyph, GlyphRasterizerPool::Priority::Render);
+        _missingGlyphs.emplace_back(hash);
+    }
+
+    if (!_deferGlyphs && !_missingGlyphs.empty())
+        _rasterizerPool->wait(_missingGlyphs);
+}
+
+optional<text::rasterized_glyph> TextRenderer::rasterizeGlyph(text::glyph_key const& glyphKey,
+                                                              strong_hash const& hash)
+{
+    auto const rasterizeNow = [&]() {
+        auto const fontLock = _fontResources->lock();
+        return _fontResources->shaper().rasterize(glyphKey, _fontDescriptions.renderMode);
+    };
+
+    if (!_rasterizerPool)
+        return rasterizeNow();
+
+    if (auto result = _rasterizerPool->tryTake(hash); result.has_value())
+        return std::move(result->glyph);
+
+    if (!_deferGlyphs)
+        return rasterizeNow();
+
+    // Nothing is rendered for this glyph in this frame.
+    _rasterizerPool->submit(hash, glyphKey, GlyphRasterizerPool::Priority::Render);
+    ++_deferredGlyphCount;
+    return nullopt;
 }
 
 Renderable::AtlasTileAttributes const* TextRenderer::getOrCreateRasterizedMetadata(
@@ -631,7 +843,11 @@ auto TextRenderer::createSlicedRasterizedGlyph(atlas::TileLocation tileLocation,
                                                strong_hash const& hash)
     -> optional<TextureAtlas::TileCreateData>
 {
-    auto result = createRasterizedGlyph(tileLocation, glyphKey, presentation);
+    auto glyph = rasterizeGlyph(glyphKey, hash);
+    if (!glyph)
+        return nullopt;
+
+    auto result = createRasterizedGlyph(tileLocation, glyphKey, presentation, std::move(*glyph));
     if (!result)
         return result;
 
@@ -707,11 +923,19 @@ auto TextRenderer::createRasterizedGlyph(atlas::TileLocation tileLocation,
                                          unicode::PresentationStyle presentation)
     -> optional<TextureAtlas::TileCreateData>
 {
-    auto theGlyphOpt = _textShaper.rasterize(glyphKey, _fontDescriptions.renderMode);
-    if (!theGlyphOpt.has_value())
+    auto glyph = _fontResources->shaper().rasterize(glyphKey, _fontDescriptions.renderMode);
+    if (!glyph.has_value())
         return nullopt;
 
-    text::rasterized_glyph& glyph = theGlyphOpt.value();
+    return createRasterizedGlyph(tileLocation, glyphKey, presentation, std::move(*glyph));
+}
+
+auto TextRenderer::createRasterizedGlyph(atlas::TileLocation tileLocation,
+                                         text::glyph_key const& glyphKey,
+                                         unicode::PresentationStyle presentation,
+                                         text::rasterized_glyph glyph)
+    -> optional<TextureAtlas::TileCreateData>
+{
     Require(glyph.bitmap.size()
             == text::pixel_size(glyph.format) * unbox<size_t>(glyph.bitmapSize.width)
                    * unbox<size_t>(glyph.bitmapSize.height));
@@ -824,7 +1048,7 @@ text::shape_result const& TextRenderer::getOrCreateCachedGlyphPositions(strong_h
                                                                         gsl::span<unsigned> clusters,
                                                                         TextStyle style)
 {
-    return _textShapingCache->get_or_emplace(hash, [this, codepoints, clusters, style](auto) {
+    return _fontResources->shapingCache().get_or_emplace(hash, [this, codepoints, clusters, style](auto) {
         return createTextShapedGlyphPositions(codepoints, clusters, style);
     });
 }
@@ -864,16 +1088,17 @@ text::shape_result TextRenderer::shapeTextRun(unicode::run_segmenter::range cons
     auto const script = get<unicode::Script>(run.properties);
     auto const presentationStyle = get<unicode::PresentationStyle>(run.properties);
     auto const isEmojiPresentation = presentationStyle == unicode::PresentationStyle::Emoji;
-    auto const font = isEmojiPresentation ? _fonts.emoji : getFontForStyle(_fonts, style);
+    FontKeys const& fonts = _fontResources->fonts();
+    auto const font = isEmojiPresentation ? fonts.emoji : getFontForStyle(fonts, style);
 
     text::shape_result glyphPosition;
     glyphPosition.reserve(clusters.size());
-    _textShaper.shape(font,
-                      codepoints,
-                      clusters,
-                      script,            // get<unicode::Script>(run.properties),
-                      presentationStyle, // get<unicode::PresentationStyle>(run.properties),
-                      glyphPosition);
+    _fontResources->shaper().shape(font,
+                                   codepoints,
+                                   clusters,
+                                   script,            // get<unicode::Script>(run.properties),
+                                   presentationStyle, // get<unicode::PresentationStyle>(run.properties),
+                                   glyphPosition);
 
     if (rasterizerLog && !glyphPosition.empty())
     {
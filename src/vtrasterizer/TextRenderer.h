@@ -7,6 +7,8 @@
 
 #include <vtrasterizer/BoxDrawingRenderer.h>
 #include <vtrasterizer/FontDescriptions.h>
+#include <vtrasterizer/FontResourceRegistry.h>
+#include <vtrasterizer/GlyphRasterizerPool.h>
 #include <vtrasterizer/RenderTarget.h>
 #include <vtrasterizer/TextClusterGrouper.h>
 #include <vtrasterizer/TextureAtlas.h>
@@ -26,22 +28,12 @@
 #include <gsl/span>
 #include <gsl/span_ext>
 
+#include <memory>
 #include <vector>
 
 namespace vtrasterizer
 {
 
-text::font_locator& createFontLocator(FontLocatorEngine engine);
-
-struct FontKeys
-{
-    text::font_key regular;
-    text::font_key bold;
-    text::font_key italic;
-    text::font_key boldItalic;
-    text::font_key emoji;
-};
-
 struct TextRendererEvents
 {
     virtual ~TextRendererEvents() = default;
@@ -55,9 +47,8 @@ class TextRenderer: public Renderable, public TextClusterGrouper::Events
 {
   public:
     TextRenderer(GridMetrics const& gridMetrics,
-                 text::shaper& textShaper,
+                 std::shared_ptr<FontResources> const& fontResources,
                  FontDescriptions& fontDescriptions,
-                 FontKeys const& fontKeys,
                  TextRendererEvents& eventHandler);
 
     void setRenderTarget(RenderTarget& renderTarget, DirectMappingAllocator& directMappingAllocator) override;
@@ -76,7 +67,7 @@ class TextRenderer: public Renderable, public TextClusterGrouper::Events
 
     /// Renders a given terminal's grid cell that has been
     /// transformed into a RenderCell.
-    void renderCell(vtbackend::RenderCell const& cell);
+    void renderCell(vtbackend::RenderCell const& cell, std::u32string_view codepoints);
 
     void renderCell(vtbackend::CellLocation position,
                     std::u32string_view graphemeCluster,
@@ -85,12 +76,51 @@ class TextRenderer: public Renderable, public TextClusterGrouper::Events
 
     void renderLine(vtbackend::RenderLine const& renderLine);
 
+    /// Renders all cells of a single grid line.
+    ///
+    /// If the very same cells have been rendered before, the render tiles of that time
+    /// are replayed at this line's position, rather than grouping, shaping, and rasterizing
+    /// the text once again.
+    ///
+    /// @param buffer the render buffer holding the codepoints of the given cells.
+    /// @param cells  the cells of the line, as a range of the cells of @p buffer.
+    void renderLineCells(vtbackend::RenderBuffer const& buffer, gsl::span<vtbackend::RenderCell const> cells);
+
     /// Must be invoked when rendering the terminal's text has finished for this frame.
     void endFrame();
 
+    /// Rasterizes glyphs that are missing in the texture atlas on the given number of worker threads,
+    /// provided that the text shaper supports concurrent rasterization.
+    ///
+    /// @p deferGlyphs  Indicates whether glyphs that are not rasterized yet are skipped and
+    ///                 rendered in a later frame, rather than waited for.
+    void configureRasterizerPool(size_t threadCount, bool deferGlyphs);
+
+    /// Rasterizes the glyphs of the given codepoint range in the regular font in the background,
+    /// so that they can be uploaded right away once they are to be rendered.
+    void prewarmGlyphs(char32_t first, char32_t last);
+
+    /// Drops all glyphs queued for rasterization and waits for those currently being rasterized.
+    ///
+    /// Must be called before the font resources are replaced.
+    void discardPendingRasterization();
+
+    /// Screen lines of the most recently rendered frame that lack glyphs yet to be rasterized.
+    [[nodiscard]] std::vector<vtbackend::LineOffset> const& linesWithDeferredGlyphs() const noexcept
+    {
+        return _linesWithDeferredGlyphs;
+    }
+
   private:
     void initializeDirectMapping();
 
+    /// Replays the render tiles cached for the given line hash, or else renders the line
+    /// via @p renderUncached and caches the render tiles it produced.
+    template <typename RenderFn>
+    void renderCachedLine(crispy::strong_hash const& hash,
+                          vtbackend::LineOffset line,
+                          RenderFn renderUncached);
+
     void renderTextGroup(std::u32string_view codepoints,
                          gsl::span<unsigned> clusters,
                          vtbackend::CellLocation initialPenPosition,
@@ -101,7 +131,9 @@ class TextRenderer: public Renderable, public TextClusterGrouper::Events
                               char32_t codepoint,
                               vtbackend::RGBColor foregroundColor) override;
 
-    /// Gets the text shaping result of the current text cluster group
+    /// Gets the text shaping result of the current text cluster group.
+    ///
+    /// The font resources must be locked for as long as the result is used.
     text::shape_result const& getOrCreateCachedGlyphPositions(crispy::strong_hash hash,
                                                               std::u32string_view codepoints,
                                                               gsl::span<unsigned> clusters,
@@ -114,6 +146,16 @@ class TextRenderer: public Renderable, public TextClusterGrouper::Events
                                     gsl::span<unsigned> clusters,
                                     TextStyle style);
 
+    /// Submits the glyphs that are missing in the texture atlas to the rasterizer pool,
+    /// and unless deferred, waits for them.
+    void rasterizeMissingGlyphs(text::shape_result const& glyphPositions);
+
+    /// Rasterizes the given glyph, or takes it from the rasterizer pool.
+    ///
+    /// Locks the font resources for rasterizing, so they must not be locked already.
+    std::optional<text::rasterized_glyph> rasterizeGlyph(text::glyph_key const& glyphKey,
+                                                         crispy::strong_hash const& hash);
+
     AtlasTileAttributes const* getOrCreateRasterizedMetadata(crispy::strong_hash const& hash,
                                                              text::glyph_key const& glyphKey,
                                                              unicode::PresentationStyle presentationStyle);
@@ -128,11 +170,20 @@ class TextRenderer: public Renderable, public TextClusterGrouper::Events
         unicode::PresentationStyle presentation,
         crispy::strong_hash const& hash);
 
+    /// Rasterizes the given glyph. The font resources must be locked.
     std::optional<TextureAtlas::TileCreateData> createRasterizedGlyph(
         atlas::TileLocation tileLocation,
         text::glyph_key const& glyphKey,
         unicode::PresentationStyle presentation);
 
+    std::optional<TextureAtlas::TileCreateData> createRasterizedGlyph(
+        atlas::TileLocation tileLocation,
+        text::glyph_key const& glyphKey,
+        unicode::PresentationStyle presentation,
+        text::rasterized_glyph glyph);
+
+    void prewarmNextGlyphs();
+
     void restrictToTileSize(TextureAtlas::TileCreateData& tileCreateData);
 
     crispy::point applyGlyphPositionToPen(crispy::point pen,
@@ -148,33 +199,68 @@ class TextRenderer: public Renderable, public TextClusterGrouper::Events
     TextClusterGrouper _textClusterGrouper;
     TextRendererEvents& _textRendererEvents;
     FontDescriptions& _fontDescriptions;
-    FontKeys const& _fonts;
+
+    // Shared with all renderers of the same fonts. Used with its lock held, see FontResources.
+    std::shared_ptr<FontResources> const& _fontResources;
 
     // performance optimizations
     //
     bool _pressure = false;
 
-    using ShapingResultCache = crispy::strong_lru_hashtable<text::shape_result>;
-    using ShapingResultCachePtr = ShapingResultCache::ptr;
+    // Render tiles of a single line, positioned relative to the top left of that line.
+    struct CachedLineTiles
+    {
+        uint64_t atlasGeneration = 0;
+        std::vector<atlas::RenderTile> tiles;
+    };
+
+    using LineTileCache = crispy::strong_lru_hashtable<CachedLineTiles>;
+    using LineTileCachePtr = LineTileCache::ptr;
 
-    ShapingResultCachePtr _textShapingCache;
-    // TODO: make unique_ptr, get owned, export cref for other users in Renderer impl.
-    text::shaper& _textShaper;
+    LineTileCachePtr _lineTileCache;
+    std::vector<uint32_t> _lineHashInput;
+    std::vector<atlas::RenderTile> _recordedLineTiles;
 
+    // Pinned glyph tier: printable ASCII of the regular, bold, italic, and bold-italic fonts is
+    // rasterized eagerly into direct-mapped tiles, which are never evicted from the texture atlas.
     DirectMapping _directMapping {};
 
-    // Maps from glyph index to tile index.
-    std::vector<uint32_t> _directMappedGlyphKeyToTileIndex {};
+    struct PinnedFont
+    {
+        text::font_key font;
+        std::vector<uint32_t> glyphIndexToTileIndex; // 0 if the glyph is not pinned
+    };
+
+    std::vector<PinnedFont> _pinnedFonts {};
+
+    // Hits are glyphs rendered from the pinned tier, misses are glyphs left to the texture atlas' LRU.
+    crispy::lru_hashtable_stats _pinnedGlyphStats {};
 
-    [[nodiscard]] bool isGlyphDirectMapped(text::glyph_key const& glyph) const noexcept
+    [[nodiscard]] uint32_t directMappedTileIndex(text::glyph_key const& glyph) const noexcept
     {
-        return _directMapping                  // Is direct mapping enabled?
-               && glyph.font == _fonts.regular // Only regular font is direct-mapped for now.
-               && glyph.index.value < _directMappedGlyphKeyToTileIndex.size()
-               && _directMappedGlyphKeyToTileIndex[glyph.index.value] != 0;
+        for (PinnedFont const& pinned: _pinnedFonts)
+            if (pinned.font == glyph.font)
+                return glyph.index.value < pinned.glyphIndexToTileIndex.size()
+                           ? pinned.glyphIndexToTileIndex[glyph.index.value]
+                           : 0;
+        return 0;
     }
 
-    AtlasTileAttributes const* ensureRasterizedIfDirectMapped(text::glyph_key const& glyphKey);
+    AtlasTileAttributes const* getIfDirectMapped(text::glyph_key const& glyphKey);
+
+    // Glyphs missing in the texture atlas are rasterized by the pool's worker threads (optional).
+    std::unique_ptr<GlyphRasterizerPool> _rasterizerPool;
+    text::render_mode _rasterizerRenderMode = text::render_mode::gray; // Render mode used by the pool.
+    bool _deferGlyphs = false;
+    std::vector<crispy::strong_hash> _missingGlyphs;
+    text::shape_result _glyphPositions; // text group being rendered, copied out of the shared cache
+    size_t _deferredGlyphCount = 0;
+    std::vector<vtbackend::LineOffset> _linesWithDeferredGlyphs;
+
+    // Codepoints to be prewarmed, of which only a few are shaped and submitted per frame.
+    char32_t _prewarmBegin = 0;
+    char32_t _prewarmNext = 0;
+    char32_t _prewarmEnd = 0;
 
     // sub-renderer
     //
@@ -10,6 +10,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <variant> // monostate
 #include <vector>
@@ -302,6 +303,11 @@ class TextureAtlas
     // Retrieves the number of total tiles that can be stored.
     [[nodiscard]] size_t capacity() const noexcept { return _tileLocations.size(); }
 
+    // Retrieves a counter that is incremented whenever a tile location is being reused for another tile,
+    // i.e. on LRU eviction or reset. Tile locations obtained earlier are only guaranteed to still refer
+    // to the same contents as long as this value has not changed.
+    [[nodiscard]] uint64_t generation() const noexcept { return _generation; }
+
     void inspect(std::ostream& output) const;
 
     [[nodiscard]] uint32_t tilesInX() const noexcept { return _tilesInX; }
@@ -335,6 +341,11 @@ class TextureAtlas
     std::string _name;
 
     std::vector<TileAttributes<Metadata>> _directMapping;
+
+    // Whether or not a tile has already been uploaded to the given tile location.
+    std::vector<bool> _tileLocationInUse;
+
+    uint64_t _generation = 0;
 };
 
 template <typename Metadata = std::monostate>
@@ -532,6 +543,7 @@ TextureAtlas<Metadata>::TextureAtlas(AtlasBackend& backend, AtlasProperties atla
     }
 
     _directMapping.resize(_atlasProperties.directMappingCount);
+    _tileLocationInUse.resize(_tileLocations.size());
 }
 
 template <typename Metadata>
@@ -555,6 +567,11 @@ auto TextureAtlas<Metadata>::constructTile(CreateTileDataFn createTileData,
     if (!tileCreateDataOpt)
         return std::nullopt;
 
+    // Only now the previous tile at this location, if any, gets overwritten.
+    if (_tileLocationInUse[tileIndex])
+        ++_generation;
+    _tileLocationInUse[tileIndex] = true;
+
     TileCreateData& tileCreateData = *tileCreateDataOpt;
 
     auto tileUpload = UploadTile {};
@@ -633,6 +650,8 @@ void TextureAtlas<Metadata>::reset(AtlasProperties atlasProperties)
 {
     _atlasProperties = atlasProperties;
     _tileCache->clear();
+    std::fill(_tileLocationInUse.begin(), _tileLocationInUse.end(), false);
+    ++_generation;
 }
 
 template <typename Metadata>
@@ -0,0 +1,255 @@
+// SPDX-License-Identifier: Apache-2.0
+#include <vtbackend/MockTerm.h>
+#include <vtbackend/Terminal.h>
+#include <vtbackend/logging.h>
+
+#include <vtrasterizer/Renderer.h>
+#include <vtrasterizer/SoftwareRenderer.h>
+
+#include <vtpty/MockViewPty.h>
+
+#include <crispy/App.h>
+#include <crispy/CLI.h>
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <iostream>
+#include <string_view>
+
+#include <libtermbench/termbench.h>
+
+using namespace std;
+
+using namespace contour;
+
+namespace CLI = crispy::cli;
+
+namespace
+{
+
+vtrasterizer::FontDescriptions defaultFontDescriptions(string_view family)
+{
+    auto const makeFont = [&](text::font_weight weight, text::font_slant slant) {
+        auto fd = text::font_description::parse(family);
+        fd.weight = weight;
+        fd.slant = slant;
+        fd.spacing = text::font_spacing::mono;
+        return fd;
+    };
+
+    return vtrasterizer::FontDescriptions {
+        .dpiScale = 1.0,
+        .dpi = { 96, 96 },
+        .size = { 12 },
+        .regular = makeFont(text::font_weight::normal, text::font_slant::normal),
+        .bold = makeFont(text::font_weight::bold, text::font_slant::normal),
+        .italic = makeFont(text::font_weight::normal, text::font_slant::italic),
+        .boldItalic = makeFont(text::font_weight::bold, text::font_slant::italic),
+        .emoji = text::font_description { .familyName = { "emoji" } },
+        .renderMode = text::render_mode::gray,
+        .textShapingEngine = vtrasterizer::TextShapingEngine::OpenShaper,
+        .fontLocator = vtrasterizer::FontLocatorEngine::Native,
+        .builtinBoxDrawing = true,
+    };
+}
+
+} // namespace
+
+class ContourRenderBench: public crispy::app
+{
+  public:
+    ContourRenderBench():
+        app("bench-render", "Contour Render Benchmark", CONTOUR_VERSION_STRING, "Apache-2.0")
+    {
+        using Project = crispy::cli::about::project;
+        crispy::cli::about::registerProjects(
+            Project { "range-v3", "Boost Software License 1.0", "https://github.com/ericniebler/range-v3" },
+            Project { "termbench-pro", "Apache-2.0", "https://github.com/contour-terminal/termbench-pro" },
+            Project { "fmt", "MIT", "https://github.com/fmtlib/fmt" });
+        link("bench-render.run", bind(&ContourRenderBench::benchRender, this));
+
+        char const* logFilterString = getenv("LOG");
+        if (logFilterString)
+        {
+            logstore::configure(logFilterString);
+            crispy::app::customizeLogStoreOutput();
+        }
+    }
+
+    [[nodiscard]] crispy::cli::command parameterDefinition() const override
+    {
+        auto const options = CLI::option_list {
+            CLI::option { "size", CLI::value { 8u }, "Number of megabyte to process per test.", "MB" },
+            CLI::option { "cat", CLI::value { false }, "Enable cat-style short-line ASCII stream test." },
+            CLI::option { "long", CLI::value { false }, "Enable long-line ASCII stream test." },
+            CLI::option { "sgr", CLI::value { false }, "Enable SGR stream test." },
+            CLI::option { "binary", CLI::value { false }, "Enable binary stream test." },
+            CLI::option { "frame-interval",
+                          CLI::value { 64u },
+                          "Number of kilobytes to process between two rendered frames.",
+                          "KB" },
+            CLI::option {
+                "font", CLI::value { "monospace"s }, "Font family to render text with.", "FAMILY" },
+            CLI::option {
+                "frame-reuse", CLI::value { false }, "Reuse parts of the previous frame when scrolling." },
+        };
+
+        return CLI::command {
+            "bench-render",
+            "Contour Terminal Emulator " CONTOUR_VERSION_STRING
+            " - https://github.com/contour-terminal/contour/ ;-)",
+            CLI::option_list {},
+            CLI::command_list {
+                CLI::command { "help", "Shows this help and exits." },
+                CLI::command { "version", "Shows the version and exits." },
+                CLI::command { "license",
+                               "Shows the license, and project URL of the used projects and Contour." },
+                CLI::command { "run",
+                               "Replays benchmark streams through the terminal and renders them "
+                               "using the software renderer.",
+                               options },
+            }
+        };
+    }
+
+    int benchRender()
+    {
+        using std::chrono::steady_clock;
+
+        auto const prefix = "bench-render.run."s;
+        auto manyLines = parameters().boolean(prefix + "cat");
+        auto longLines = parameters().boolean(prefix + "long");
+        auto sgr = parameters().boolean(prefix + "sgr");
+        auto const binary = parameters().boolean(prefix + "binary");
+        auto const testSizeMB = parameters().uint(prefix + "size");
+        auto const frameInterval = size_t { parameters().uint(prefix + "frame-interval") } * 1024;
+        auto const frameReuse = parameters().boolean(prefix + "frame-reuse");
+
+        if (!(binary || longLines || manyLines || sgr))
+        {
+            cout << "No test cases specified. Defaulting to: cat, long, sgr.\n";
+            manyLines = true;
+            longLines = true;
+            sgr = true;
+        }
+
+        auto pageSize = vtbackend::PageSize { vtbackend::LineCount(24), vtbackend::ColumnCount(80) };
+        size_t const ptyReadBufferSize = 1'000'000;
+        auto maxHistoryLineCount = vtbackend::LineCount(4000);
+        auto vt = vtbackend::MockTerm<vtpty::MockViewPty>(pageSize, maxHistoryLineCount, ptyReadBufferSize);
+        auto* pty = dynamic_cast<vtpty::MockViewPty*>(&vt.terminal.device());
+        vt.terminal.setMode(vtbackend::DECMode::AutoWrap, true);
+
+        auto renderer = vtrasterizer::Renderer {
+            pageSize,
+            defaultFontDescriptions(parameters().str(prefix + "font")),
+            vt.terminal.colorPalette(),
+            crispy::strong_hashtable_size { 4096 },
+            crispy::lru_capacity { 4000 },
+            false,
+            vtrasterizer::Decorator::DottedUnderline,
+            vtrasterizer::Decorator::Underline,
+        };
+
+        auto const cellSize = renderer.cellSize();
+        auto renderTarget = vtrasterizer::SoftwareRenderer { vtbackend::ImageSize {
+            vtbackend::Width::cast_from(unbox(cellSize.width) * unbox(pageSize.columns)),
+            vtbackend::Height::cast_from(unbox(cellSize.height) * unbox(pageSize.lines)) } };
+        renderTarget.setFrameReuse(frameReuse);
+        renderer.setRenderTarget(renderTarget);
+
+        auto frameCount = uint64_t { 0 };
+        auto renderTime = steady_clock::duration::zero();
+        auto bytesSinceLastFrame = size_t { 0 };
+
+        auto const renderFrame = [&]() {
+            auto const start = steady_clock::now();
+#if defined(LIBTERMINAL_PASSIVE_RENDER_BUFFER_UPDATE)
+            vt.terminal.refreshRenderBuffer();
+#endif
+            renderer.render(vt.terminal, false);
+            renderTime += steady_clock::now() - start;
+            ++frameCount;
+            bytesSinceLastFrame = 0;
+        };
+
+        auto const titleText = fmt::format(
+            "Running benchmark: render (test size: {} MB, frame interval: {} KB)",
+            testSizeMB,
+            frameInterval / 1024);
+        cout << titleText << '\n' << string(titleText.size(), '=') << '\n';
+
+        auto tbp = contour::termbench::Benchmark {
+            [&](char const* a, size_t b) -> bool {
+                if (pty->isClosed())
+                    return false;
+                // clang-format off
+                pty->setReadData({ a, b });
+                do vt.terminal.processInputOnce();
+                while (!pty->isClosed() && !pty->stdoutBuffer().empty());
+                // clang-format on
+                bytesSinceLastFrame += b;
+                if (bytesSinceLastFrame >= frameInterval)
+                    renderFrame();
+                return true;
+            },
+            testSizeMB,
+            unbox(pageSize.columns),
+            unbox(pageSize.lines),
+            [&](contour::termbench::Test const& test) {
+                cout << fmt::format("Running test {} ...\n", test.name);
+            }
+        };
+
+        if (manyLines)
+            tbp.add(termbench::tests::many_lines());
+
+        if (longLines)
+            tbp.add(termbench::tests::long_lines());
+
+        if (sgr)
+        {
+            tbp.add(termbench::tests::sgr_fg_lines());
+            tbp.add(termbench::tests::sgr_fgbg_lines());
+        }
+
+        if (binary)
+            tbp.add(termbench::tests::binary());
+
+        tbp.runAll();
+
+        cout << '\n';
+        cout << "Results\n";
+        cout << "-------\n";
+        tbp.summarize(cout);
+        cout << '\n';
+
+        if (!frameCount)
+            return EXIT_SUCCESS;
+
+        auto const seconds = std::chrono::duration<double>(renderTime).count();
+        auto const nanoseconds = std::chrono::duration<double, std::nano>(renderTime).count();
+        auto const cellCount = static_cast<double>(frameCount) * static_cast<double>(pageSize.area());
+        auto const& stats = renderTarget.stats();
+
+        cout << "Rendering\n";
+        cout << "---------\n";
+        cout << fmt::format("{:>16}: {}\n", "render size", renderTarget.renderSize());
+        cout << fmt::format("{:>16}: {}\n", "frames", frameCount);
+        cout << fmt::format("{:>16}: {}\n", "reused frames", stats.reusedFrames);
+        cout << fmt::format("{:>16}: {:.3f} ms\n", "render time", seconds * 1000.0);
+        cout << fmt::format("{:>16}: {:.1f}\n", "frames/s", static_cast<double>(frameCount) / seconds);
+        cout << fmt::format("{:>16}: {:.1f}\n", "ns per cell", nanoseconds / cellCount);
+        cout << fmt::format("{:>16}: {:.1f}\n", "tiles per frame", double(stats.tiles) / double(frameCount));
+        cout << fmt::format("{:>16}: {}\n\n", "tile uploads", stats.uploads);
+
+        return EXIT_SUCCESS;
+    }
+};
+
+int main(int argc, char const* argv[])
+{
+    ContourRenderBench app;
+    return app.run(argc, argv);
+}